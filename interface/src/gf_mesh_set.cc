@@ -372,19 +372,32 @@ void gf_mesh_set(getfemint::mexargs_in& m_in,
        );
 
 
-    /*@SET ('optimize structure'[, @int with_renumbering])
+    /*@SET ('optimize structure'[, @int with_renumbering[, @str method]])
     Reset point and convex numbering.
 
     After optimisation, the points (resp. convexes) will
     be consecutively numbered from @MATLAB{1 to MESH:GET('max pid')
     (resp. MESH:GET('max cvid'))}@SCILAB{1 to MESH:GET('max pid')
     (resp. MESH:GET('max cvid'))}@PYTHON{``0`` to
-    ``MESH:GET('max pid')-1`` (resp. ``MESH:GET('max cvid')-1``)}.@*/
+    ``MESH:GET('max pid')-1`` (resp. ``MESH:GET('max cvid')-1``)}.
+    If `with_renumbering` is true (default), the convexes are renumbered
+    with the method 'Cuthill-McKee' (default), or along a 'Morton' or
+    'Hilbert' space filling curve (the points are then also renumbered
+    along the curve).@*/
     sub_command
-      ("optimize structure", 0, 1, 0, 0,
+      ("optimize structure", 0, 2, 0, 0,
        bool with_renumbering = true;
+       getfem::mesh::renumbering_method meth = getfem::mesh::CUTHILL_MCKEE;
        if (in.remaining()) with_renumbering = (in.pop().to_integer(0,1) != 0);
-       pmesh->optimize_structure(with_renumbering);
+       if (in.remaining()) {
+         std::string s = in.pop().to_string();
+         if (cmd_strmatch(s, "Morton")) meth = getfem::mesh::MORTON;
+         else if (cmd_strmatch(s, "Hilbert")) meth = getfem::mesh::HILBERT;
+         else if (!cmd_strmatch(s, "Cuthill-McKee"))
+           THROW_BADARG("expecting 'Cuthill-McKee', 'Morton' or 'Hilbert', "
+                        "got '" << s << "'");
+       }
+       pmesh->optimize_structure(with_renumbering, meth);
        );
 
 
@@ -150,6 +150,18 @@ gf_spmat_get_data(gmm::csc_matrix_ref<const T*, const unsigned int *, const unsi
   }
 }
 
+template <typename T> static void
+gf_spmat_get_native_csc(gmm::csc_matrix_ref<const T*, const unsigned int *, const unsigned int *> M,
+			getfemint::mexargs_out& out) {
+  size_type nz = M.jc[M.nc];
+  mexarg_out o = out.pop();
+  o.arg = checked_gfi_create_sparse(int(M.nr), int(M.nc), int(nz),
+				    gmm::is_complex(T()) ? GFI_COMPLEX : GFI_REAL);
+  memcpy(gfi_sparse_get_pr(o.arg), M.pr, sizeof(T)*nz);
+  memcpy(gfi_sparse_get_ir(o.arg), M.ir, sizeof(unsigned)*nz);
+  memcpy(gfi_sparse_get_jc(o.arg), M.jc, sizeof(unsigned)*(M.nc+1));
+}
+
 template <typename T> static void
 gf_spmat_get_Dirichlet_nullspace(gsparse &H, getfemint::mexargs_in& in, getfemint::mexargs_out& out, T) {
   garray<T> R            = in.pop().to_garray(T());
@@ -320,6 +332,24 @@ void gf_spmat_get(getfemint::mexargs_in& m_in,
        );
 
 
+    /*@GET S = ('csc')
+      Return a copy of `M` as a native sparse matrix in CSC format.
+
+      With the python interface, `S` is a scipy.sparse.csc_matrix whose
+      arrays are handed to NumPy without any further copy (or the tuple
+      (data, indices, indptr, shape) if SciPy is not installed). Use
+      `S.tocsr()` to obtain the CSR format.
+      If `M` is not stored as a CSC matrix, it is converted into CSC.@*/
+    sub_command
+      ("csc", 0, 0, 0, 1,
+       gsp.to_csc();
+       if (!gsp.is_complex())
+	 gf_spmat_get_native_csc(gsp.csc(scalar_type()),  out);
+       else
+	 gf_spmat_get_native_csc(gsp.csc(complex_type()), out);
+       );
+
+
     /*@GET @CELL{N, U0} = ('dirichlet nullspace', @vec R)
     Solve the dirichlet conditions `M.U=R`.
 
@@ -576,6 +576,78 @@ build_gfi_array_list(gcollect *gc, PyObject *tuple, const char **pfunction_name,
   return l;
 }
 
+/* Wrap a buffer allocated by gfi_malloc in a Fortran ordered numpy
+   array, without copy. The ownership of the buffer is transferred to a
+   capsule which is the base object of the array, so that the buffer is
+   released by gfi_free when the array is garbage collected. On success,
+   *pdata is set to NULL so that gfi_array_destroy does not free it. */
+#define GFI_BUFFER_CAPSULE "getfem.gfi_buffer"
+
+static void
+gfi_buffer_capsule_destructor(PyObject *capsule) {
+  gfi_free(PyCapsule_GetPointer(capsule, GFI_BUFFER_CAPSULE));
+}
+
+static PyObject *
+gfi_buffer_to_PyArray(int nd, const u_int *dims, int type, void **pdata) {
+  PyObject *o, *capsule;
+  npy_intp *dim = PyDimMem_NEW(nd);
+  for (int i=0; i < nd; i++) dim[i] = (npy_intp)dims[i];
+  o = PyArray_New(&PyArray_Type, nd, dim, type, NULL, *pdata, 0,
+                  NPY_ARRAY_FARRAY, NULL);
+  PyDimMem_FREE(dim);
+  if (!o) return NULL;
+  if (!(capsule = PyCapsule_New(*pdata, GFI_BUFFER_CAPSULE,
+                                gfi_buffer_capsule_destructor))) {
+    Py_DECREF(o); return NULL;
+  }
+  /* PyArray_SetBaseObject steals the reference, even on failure */
+  if (PyArray_SetBaseObject((PyArrayObject *)o, capsule) < 0) {
+    *pdata = NULL; Py_DECREF(o); return NULL;
+  }
+  *pdata = NULL;
+  return o;
+}
+
+/* Native sparse matrices are returned in CSC format as a
+   scipy.sparse.csc_matrix built on the index and value arrays of the
+   gfi_array, without copy. If scipy is not available, the tuple
+   (data, indices, indptr, shape) is returned instead. */
+static PyObject *
+gfi_sparse_to_PyObject(gfi_array *t) {
+  gfi_sparse *sp = &t->storage.gfi_storage_u.sp;
+  u_int nnz = sp->ir.ir_len, n = t->dim.dim_val[1];
+  PyObject *data = NULL, *indices = NULL, *indptr = NULL, *shape = NULL;
+  PyObject *o = NULL, *scipy_sparse, *csc;
+
+  if (!(data = gfi_buffer_to_PyArray(1, &nnz, sp->is_complex ? NPY_CDOUBLE
+                                                             : NPY_DOUBLE,
+                                     (void **)(&sp->pr.pr_val)))) goto end;
+  if (!(indices = gfi_buffer_to_PyArray(1, &nnz, NPY_INT,
+                                        (void **)(&sp->ir.ir_val)))) goto end;
+  n += 1;
+  if (!(indptr = gfi_buffer_to_PyArray(1, &n, NPY_INT,
+                                       (void **)(&sp->jc.jc_val)))) goto end;
+  if (!(shape = Py_BuildValue("(II)", t->dim.dim_val[0],
+                              t->dim.dim_val[1]))) goto end;
+
+  if ((scipy_sparse = PyImport_ImportModule("scipy.sparse"))) {
+    csc = PyObject_GetAttrString(scipy_sparse, "csc_matrix");
+    Py_DECREF(scipy_sparse);
+    if (csc) {
+      o = PyObject_CallFunction(csc, "(OOO)O", data, indices, indptr, shape);
+      Py_DECREF(csc);
+    }
+  } else if (PyErr_ExceptionMatches(PyExc_ImportError)) {
+    PyErr_Clear();
+    o = Py_BuildValue("(OOOO)", data, indices, indptr, shape);
+  }
+ end:
+  Py_XDECREF(data); Py_XDECREF(indices); Py_XDECREF(indptr);
+  Py_XDECREF(shape);
+  return o;
+}
+
 PyObject*
 gfi_array_to_PyObject(gfi_array *t, int in__init__) {
   PyObject *o = NULL;
@@ -586,50 +658,27 @@ gfi_array_to_PyObject(gfi_array *t, int in__init__) {
     //printf("GFI_INT32\n");
     if (t->dim.dim_len == 0)
       return PyLong_FromLong(TGFISTORE(int32,val)[0]);
-    else {
-      npy_intp *dim = PyDimMem_NEW(t->dim.dim_len);
-      for (u_int i=0; i < t->dim.dim_len; i++)
-        dim[i] = (npy_intp)t->dim.dim_val[i];
-      if (!(o = PyArray_EMPTY(t->dim.dim_len, dim, NPY_INT, 1)))
-        return NULL;
-      PyDimMem_FREE(dim);
-
-      npy_intp itemsize = PyArray_ITEMSIZE((PyArrayObject *)o);
-      npy_intp size = PyArray_Size(o); /* Number of elements. */
-      memcpy(PyArray_DATA((PyArrayObject *)o), TGFISTORE(int32,val),
-             size*itemsize); // new copy
-    }
+    else /* the buffer is handed over to numpy, no copy */
+      o = gfi_buffer_to_PyArray(t->dim.dim_len, t->dim.dim_val, NPY_INT,
+                                (void **)(&TGFISTORE(int32,val)));
   } break;
   case GFI_DOUBLE: {
     // printf("GFI_DOUBLE\n");
     if (!gfi_array_is_complex(t)) {
       if (t->dim.dim_len == 0)
         return PyFloat_FromDouble(TGFISTORE(double,val)[0]);
-      else {
-        npy_intp *dim = PyDimMem_NEW(t->dim.dim_len);
-        for (u_int i=0; i < t->dim.dim_len; i++)
-          dim[i] = (npy_intp)t->dim.dim_val[i];
-        if (!(o = PyArray_EMPTY(t->dim.dim_len, dim, NPY_DOUBLE, 1)))
-          return NULL;
-        PyDimMem_FREE(dim);
-      }
+      else
+        o = gfi_buffer_to_PyArray(t->dim.dim_len, t->dim.dim_val, NPY_DOUBLE,
+                                  (void **)(&TGFISTORE(double,val)));
     } else {
       if (t->dim.dim_len == 0)
         return PyComplex_FromDoubles(TGFISTORE(double,val)[0],
                                      TGFISTORE(double,val)[1]);
-      else {
-        npy_intp *dim = PyDimMem_NEW(t->dim.dim_len);
-        for (u_int i=0; i < t->dim.dim_len; i++)
-          dim[i] = (npy_intp)t->dim.dim_val[i];
-        if (!(o = PyArray_EMPTY(t->dim.dim_len, dim, NPY_CDOUBLE, 1)))
-          return NULL;
-        PyDimMem_FREE(dim);
-      }
+      else /* interleaved real and imaginary parts, as NPY_CDOUBLE */
+        o = gfi_buffer_to_PyArray(t->dim.dim_len, t->dim.dim_val,
+                                  NPY_CDOUBLE,
+                                  (void **)(&TGFISTORE(double,val)));
     }
-    npy_intp itemsize = PyArray_ITEMSIZE((PyArrayObject *)o);
-    npy_intp size = PyArray_Size(o); /* Number of elements. */
-    memcpy(PyArray_DATA((PyArrayObject *)o), TGFISTORE(double,val),
-           size*itemsize); // new copy
   } break;
   case GFI_CHAR: {
     //printf("GFI_CHAR\n");
@@ -691,9 +740,7 @@ gfi_array_to_PyObject(gfi_array *t, int in__init__) {
   } break;
   case GFI_SPARSE: {
     //printf("GFI_SPARSE\n");
-    PyErr_SetString(PyExc_RuntimeError,
-                    "Numpy does not have Native sparse matrices. "
-                    "Use getfem sparse objects instead.");
+    o = gfi_sparse_to_PyObject(t);
   } break;
   default:  {
     assert(0);
@@ -0,0 +1,102 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+# Python GetFEM interface
+#
+# Copyright (C) 2026 agent.
+#
+# This file is a part of GetFEM
+#
+# GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+# under  the  terms  of the  GNU  Lesser General Public License as published
+# by  the  Free Software Foundation;  either version 2.1 of the License,  or
+# (at your option) any later version.
+# This program  is  distributed  in  the  hope  that it will be useful,  but
+# WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+# License for more details.
+# You  should  have received a copy of the GNU Lesser General Public License
+# along  with  this program;  if not, write to the Free Software Foundation,
+# Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+#
+############################################################################
+"""  Test of the arrays returned by the interface.
+
+  This program checks that the NumPy arrays built without copy on the
+  buffers of the interface own their data until their last view is
+  released, and the native CSC export of sparse matrices.
+
+  $Id$
+"""
+import gc
+
+import numpy as np
+
+import getfem as gf
+
+m = gf.Mesh('cartesian', np.arange(0., 1.1, 0.25), np.arange(0., 1.1, 0.5))
+mf = gf.MeshFem(m, 1)
+mf.set_classical_fem(1)
+
+# Real arrays: the buffer is handed to NumPy, in Fortran order.
+P = mf.basic_dof_nodes()
+assert(P.shape == (2, mf.nbdof()))
+assert(not P.flags['OWNDATA'] and P.base is not None)
+assert(P.flags['F_CONTIGUOUS'])
+ref = P.copy()
+row = P[1, :]                # a view keeps the buffer alive
+del P, mf, m
+gc.collect()
+assert(np.array_equal(row, ref[1, :]))
+del row
+gc.collect()
+
+# Integer arrays and repeated calls.
+m = gf.Mesh('cartesian', np.arange(0., 1.1, 0.25), np.arange(0., 1.1, 0.5))
+mf = gf.MeshFem(m, 1)
+mf.set_classical_fem(2)
+for i in range(200):
+  D = mf.basic_dof_from_cv(i % m.nbcvs())
+  assert(D.dtype.kind == 'i' and D.size == 9)
+  P = mf.basic_dof_nodes()
+  assert(np.array_equal(P[:, D[0]], mf.basic_dof_nodes()[:, D[0]]))
+del D, P
+
+# Sparse matrices exported in CSC format, real then complex.
+def dense_of_csc(S):
+  if isinstance(S, tuple):   # without SciPy
+    data, indices, indptr, shape = S
+    A = np.zeros(shape, dtype=data.dtype)
+    for j in range(shape[1]):
+      for k in range(indptr[j], indptr[j+1]):
+        A[indices[k], j] = data[k]
+    return A
+  assert(S.format == 'csc')
+  return S.toarray()
+
+M = gf.Spmat('empty', 4, 5)
+for (i, j, v) in [(0, 0, 1.), (2, 0, 2.), (1, 3, 3.), (3, 4, 4.), (0, 4, 5.)]:
+  M[i, j] = v
+for cplx in [False, True]:
+  if cplx:
+    M.to_complex()
+    M.scale(2.+1.j)
+  F = M.full()
+  S = M.csc()
+  JC, IR = M.csc_ind()
+  V = M.csc_val()
+  if isinstance(S, tuple):
+    data, indices, indptr, shape = S
+  else:
+    data, indices, indptr, shape = S.data, S.indices, S.indptr, S.shape
+  assert(shape == (4, 5))
+  assert(np.array_equal(indptr, JC) and np.array_equal(indices, IR))
+  assert(np.array_equal(data, V))
+  assert(np.array_equal(dense_of_csc(S), F))
+  assert(np.iscomplexobj(data) == cplx)
+  N = gf.Spmat('copy', M)    # the exported arrays outlive the matrix
+  S = N.csc()
+  del N
+  gc.collect()
+  assert(np.array_equal(dense_of_csc(S), F))
+
+print('numpy arrays are ok')
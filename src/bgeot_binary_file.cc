@@ -0,0 +1,387 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+#include "getfem/bgeot_binary_file.h"
+#include "getfem/getfem_omp.h"
+#include <cstring>
+#if defined(GETFEM_HAVE_ZLIB_H)
+#  include <zlib.h>
+#endif
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace bgeot {
+
+  static const char binary_file_magic[8] = { 'G', 'F', 'E', 'M', 'B', 'I',
+                                             'N', '\0' };
+  /* version 2 files have compressed sections */
+  static const gmm::uint32_type binary_file_version = 2;
+  static const gmm::uint32_type binary_file_endianness = 0x01020304;
+  static const size_type binary_file_alignment = 64;
+  static const size_type binary_file_block_size = 65536;
+
+  struct binary_file_header {
+    char magic[8];
+    gmm::uint32_type version;
+    gmm::uint32_type endianness;
+    gmm::uint64_type toc_offset;
+    gmm::uint64_type nb_sections;
+    char reserved[32];
+  };
+
+  bool is_binary_file(const std::string &name) {
+    std::ifstream f(name.c_str(), std::ios::binary);
+    char magic[8];
+    if (!f.read(magic, 8)) return false;
+    return std::memcmp(magic, binary_file_magic, 8) == 0;
+  }
+
+  gmm::uint64_type binary_checksum(const void *data, size_type nb) {
+    const gmm::uint64_type prime = 0x100000001b3ULL;
+    gmm::uint64_type h = 0xcbf29ce484222325ULL, w;
+    const char *p = static_cast<const char *>(data);
+    size_type i = 0;
+    for (; i + sizeof(w) <= nb; i += sizeof(w)) {
+      std::memcpy(&w, p + i, sizeof(w));
+      h = (h ^ w) * prime;
+    }
+    for (; i < nb; ++i)
+      h = (h ^ gmm::uint64_type(static_cast<unsigned char>(p[i]))) * prime;
+    return h ^ gmm::uint64_type(nb);
+  }
+
+  /* ******************************************************************** */
+  /*    Writer.                                                            */
+  /* ******************************************************************** */
+
+  binary_file_writer::binary_file_writer(const std::string &name)
+    : f(name.c_str(), std::ios::binary | std::ios::trunc), name_(name),
+      compress(false), has_compressed(false) {
+    GMM_ASSERT1(f, "impossible to write to file '" << name << "'");
+    binary_file_header h;
+    std::memset(&h, 0, sizeof(h));
+    f.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    pos = sizeof(h);
+  }
+
+  binary_file_writer::~binary_file_writer() {
+    if (f.is_open()) {
+      try { close(); }
+      catch (...) { GMM_WARNING1("Error while closing file " << name_); }
+    }
+  }
+
+  void binary_file_writer::pad() {
+    static const char zeros[binary_file_alignment] = { 0 };
+    size_type r = size_type(pos % binary_file_alignment);
+    if (r) {
+      f.write(zeros, std::streamsize(binary_file_alignment - r));
+      pos += binary_file_alignment - r;
+    }
+  }
+
+  void binary_file_writer::write_section(const std::string &tag,
+                                         size_type id, const void *data,
+                                         size_type nb, size_type elem_size) {
+    GMM_ASSERT1(f.is_open(), "Binary file " << name_ << " already closed");
+    GMM_ASSERT1(tag.size() > 0 && tag.size() < 16, "Invalid section tag '"
+                << tag << "'");
+    GMM_ASSERT1(written.insert(std::make_pair(tag, gmm::uint64_type(id)))
+                .second, "Section " << tag << " " << id << " written twice");
+    pad();
+    binary_section_record r;
+    std::memset(&r, 0, sizeof(r));
+    std::strncpy(r.tag, tag.c_str(), 15);
+    r.id = id; r.offset = pos; r.nb = nb;
+    r.elem_size = gmm::uint32_type(elem_size);
+    if (compress && nb) {
+#if defined(GETFEM_HAVE_ZLIB_H)
+      /* header: number of blocks, size of the blocks and compressed size of
+         each block, followed by the compressed blocks */
+      const unsigned char *p = static_cast<const unsigned char *>(data);
+      size_type n = nb * elem_size, bs = binary_file_block_size;
+      size_type nbb = (n + bs - 1) / bs;
+      std::vector<std::vector<unsigned char>> blocks(nbb);
+      auto compress_block = [&](size_type i) {
+        uLong sz = uLong(std::min(bs, n - i*bs));
+        uLongf len = compressBound(sz);
+        blocks[i].resize(len);
+        int res = compress2(&blocks[i][0], &len, p + i*bs, sz,
+                            Z_DEFAULT_COMPRESSION);
+        GMM_ASSERT1(res == Z_OK, "zlib compression error " << res);
+        blocks[i].resize(len);
+      };
+      GETFEM_OMP_FOR(size_type i = 0, i < nbb, ++i, compress_block(i););
+      std::vector<gmm::uint64_type> hdr = { nbb, bs };
+      for (const auto &b : blocks) hdr.push_back(b.size());
+      f.write(reinterpret_cast<const char *>(hdr.data()),
+              std::streamsize(hdr.size() * sizeof(gmm::uint64_type)));
+      pos += hdr.size() * sizeof(gmm::uint64_type);
+      for (const auto &b : blocks) {
+        f.write(reinterpret_cast<const char *>(b.data()),
+                std::streamsize(b.size()));
+        pos += b.size();
+      }
+      r.flags = 1;
+      has_compressed = true;
+#endif
+    } else {
+      if (nb) f.write(static_cast<const char *>(data),
+                      std::streamsize(nb * elem_size));
+      pos += nb * elem_size;
+    }
+    GMM_ASSERT1(f, "Error while writing to file " << name_);
+    toc.push_back(r);
+  }
+
+  void binary_file_writer::write_index_section
+  (const std::string &tag, size_type id, const std::vector<size_type> &v) {
+    const gmm::uint64_type nil32(gmm::uint32_type(-1));
+    bool small = true;
+    for (size_type i : v)
+      if (i != size_type(-1) && gmm::uint64_type(i) >= nil32)
+        { small = false; break; }
+    if (small) {
+      std::vector<gmm::uint32_type> w(v.size());
+      for (size_type i = 0; i < v.size(); ++i)
+        w[i] = gmm::uint32_type(v[i]);
+      write_section(tag, id, w);
+    } else {
+      std::vector<gmm::uint64_type> w(v.begin(), v.end());
+      write_section(tag, id, w);
+    }
+  }
+
+  void binary_file_writer::write_string_section
+  (const std::string &tag, size_type id, const std::vector<std::string> &v) {
+    std::vector<char> w;
+    for (const std::string &s : v) {
+      w.insert(w.end(), s.begin(), s.end());
+      w.push_back('\0');
+    }
+    write_section(tag, id, w);
+  }
+
+  bool binary_file_writer::compression_available() {
+#if defined(GETFEM_HAVE_ZLIB_H)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void binary_file_writer::set_compression(bool c) {
+    GMM_ASSERT1(!c || compression_available(),
+                "GetFEM was built without zlib");
+    compress = c;
+  }
+
+  /* The table of contents is written after the last section, and the
+     header is rewritten to point to it only once it is on the disk. The
+     next sections are written after this table of contents, so that the
+     file stays readable up to the last flush() if the writing is
+     interrupted. */
+  void binary_file_writer::write_header_and_toc() {
+    pad();
+    binary_file_header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, binary_file_magic, 8);
+    h.version = has_compressed ? binary_file_version : 1;
+    h.endianness = binary_file_endianness;
+    h.toc_offset = pos;
+    h.nb_sections = toc.size();
+    if (toc.size())
+      f.write(reinterpret_cast<const char *>(toc.data()),
+              std::streamsize(toc.size() * sizeof(binary_section_record)));
+    pos += toc.size() * sizeof(binary_section_record);
+    f.flush();
+    f.seekp(0);
+    f.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    f.seekp(std::streamoff(pos));
+  }
+
+  void binary_file_writer::flush() {
+    GMM_ASSERT1(f.is_open(), "Binary file " << name_ << " already closed");
+    write_header_and_toc();
+    f.flush();
+    GMM_ASSERT1(f, "Error while writing to file " << name_);
+  }
+
+  void binary_file_writer::close() {
+    if (!f.is_open()) return;
+    write_header_and_toc();
+    bool ok = bool(f);
+    f.close();
+    GMM_ASSERT1(ok, "Error while writing to file " << name_);
+  }
+
+  /* ******************************************************************** */
+  /*    Reader.                                                            */
+  /* ******************************************************************** */
+
+  binary_file_reader::binary_file_reader(const std::string &name)
+    : name_(name), mapped(0), mapped_size(0) {
+    binary_file_header h;
+    f.open(name.c_str(), std::ios::binary);
+    GMM_ASSERT1(f, "Binary file '" << name << "' does not exist");
+    f.read(reinterpret_cast<char *>(&h), sizeof(h));
+    GMM_ASSERT1(f && std::memcmp(h.magic, binary_file_magic, 8) == 0,
+                "File '" << name << "' is not a GetFEM binary file");
+    GMM_ASSERT1(h.version <= binary_file_version, "File '" << name
+                << "' was written with a more recent version of GetFEM");
+    GMM_ASSERT1(h.endianness == binary_file_endianness, "File '" << name
+                << "' was written on a machine of different endianness");
+    toc.resize(size_type(h.nb_sections));
+    f.seekg(std::streamoff(h.toc_offset));
+    if (toc.size())
+      f.read(reinterpret_cast<char *>(toc.data()),
+             std::streamsize(toc.size() * sizeof(binary_section_record)));
+    GMM_ASSERT1(f, "Truncated binary file '" << name << "'");
+    for (size_type i = 0; i < toc.size(); ++i)
+      index[std::make_pair(std::string(toc[i].tag), toc[i].id)] = i;
+
+#ifndef _WIN32
+    int fd = ::open(name.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *p = mmap(0, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        mapped = static_cast<const char *>(p);
+        mapped_size = size_type(st.st_size);
+      }
+    }
+    if (fd >= 0) ::close(fd);
+#endif
+    if (mapped) f.close();
+  }
+
+  binary_file_reader::~binary_file_reader() {
+#ifndef _WIN32
+    if (mapped) munmap(const_cast<char *>(mapped), mapped_size);
+#endif
+  }
+
+  size_type binary_file_reader::find_section(const std::string &tag,
+                                             size_type id) const {
+    auto it = index.find(std::make_pair(tag, gmm::uint64_type(id)));
+    return (it == index.end()) ? size_type(-1) : it->second;
+  }
+
+  std::vector<size_type>
+  binary_file_reader::section_ids(const std::string &tag) const {
+    std::vector<size_type> ids;
+    for (const binary_section_record &r : toc)
+      if (tag.compare(r.tag) == 0) ids.push_back(size_type(r.id));
+    std::sort(ids.begin(), ids.end());
+    return ids;
+  }
+
+  void binary_file_reader::read_raw(gmm::uint64_type offset, size_type size,
+                                    char *p) const {
+    if (mapped) {
+      GMM_ASSERT1(offset + size <= mapped_size, "Truncated binary file '"
+                  << name_ << "'");
+      std::memcpy(p, mapped + offset, size);
+    } else {
+      getfem::local_guard lock = locks_.get_lock();
+      f.seekg(std::streamoff(offset));
+      f.read(p, std::streamsize(size));
+      GMM_ASSERT1(f, "Truncated binary file '" << name_ << "'");
+    }
+  }
+
+  const char *binary_file_reader::section_data
+  (size_type i, std::unique_ptr<char[]> &buf) const {
+    const binary_section_record &r = toc[i];
+    size_type size = size_type(r.nb) * r.elem_size;
+    if (mapped && !(r.flags & 1)) {
+      GMM_ASSERT1(r.offset + size <= mapped_size, "Truncated binary file '"
+                  << name_ << "'");
+      return mapped + r.offset;
+    }
+    buf.reset(new char[size ? size : 1]);
+    if (r.flags & 1) {
+#if defined(GETFEM_HAVE_ZLIB_H)
+      gmm::uint64_type nbb_bs[2];
+      read_raw(r.offset, sizeof(nbb_bs), (char *)(nbb_bs));
+      size_type nbb = size_type(nbb_bs[0]), bs = size_type(nbb_bs[1]);
+      GMM_ASSERT1(nbb == (size + bs - 1) / bs, "Corrupted binary file '"
+                  << name_ << "'");
+      std::vector<gmm::uint64_type> csize(nbb);
+      read_raw(r.offset + sizeof(nbb_bs), nbb * sizeof(gmm::uint64_type),
+               (char *)(csize.data()));
+      gmm::uint64_type offset = r.offset + sizeof(nbb_bs)
+        + nbb * sizeof(gmm::uint64_type);
+      std::vector<unsigned char> block;
+      for (size_type j = 0; j < nbb; ++j) {
+        block.resize(size_type(csize[j]));
+        read_raw(offset, block.size(), (char *)(block.data()));
+        uLongf len = uLongf(std::min(bs, size - j*bs));
+        int res = uncompress((unsigned char *)(buf.get()) + j*bs, &len,
+                             block.data(), uLong(block.size()));
+        GMM_ASSERT1(res == Z_OK && len == std::min(bs, size - j*bs),
+                    "Corrupted binary file '" << name_ << "'");
+        offset += csize[j];
+      }
+#else
+      GMM_ASSERT1(false, "GetFEM was built without zlib, cannot read the "
+                  "compressed sections of file '" << name_ << "'");
+#endif
+    } else
+      read_raw(r.offset, size, buf.get());
+    return buf.get();
+  }
+
+  void binary_file_reader::read_index_section
+  (const std::string &tag, size_type id, std::vector<size_type> &v) const {
+    size_type i = find_section(tag, id);
+    GMM_ASSERT1(i != size_type(-1), "Missing section " << tag << " " << id
+                << " in binary file " << name_);
+    if (toc[i].elem_size == 4) {
+      binary_section<gmm::uint32_type> p = section<gmm::uint32_type>(tag, id);
+      v.resize(p.size());
+      for (size_type j = 0; j < p.size(); ++j)
+        v[j] = (p[j] == gmm::uint32_type(-1)) ? size_type(-1)
+                                              : size_type(p[j]);
+    } else {
+      binary_section<gmm::uint64_type> p = section<gmm::uint64_type>(tag, id);
+      v.assign(p.begin(), p.end());
+    }
+  }
+
+  void binary_file_reader::read_string_section
+  (const std::string &tag, size_type id, std::vector<std::string> &v) const {
+    binary_section<char> p = section<char>(tag, id);
+    size_type nb = p.size();
+    v.resize(0);
+    for (size_type j = 0; j < nb; ) {
+      size_type l = 0;
+      while (j + l < nb && p[j+l]) ++l;
+      v.push_back(std::string(p.data() + j, l));
+      j += l + 1;
+    }
+  }
+
+}  /* end of namespace bgeot.                                           */
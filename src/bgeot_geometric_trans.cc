@@ -1336,17 +1336,19 @@ namespace bgeot {
 
   geotrans_precomp_::geotrans_precomp_(pgeometric_trans pg,
                                        pstored_point_tab ps)
-    : pgt(pg), pspt(ps)
-  { DAL_STORED_OBJECT_DEBUG_CREATED(this, "Geotrans precomp"); }
+    : pgt(pg), pspt(ps), hess_computed_(false) {
+    DAL_STORED_OBJECT_DEBUG_CREATED(this, "Geotrans precomp");
+    init_val(); init_grad();
+  }
 
-  void geotrans_precomp_::init_val() const {
+  void geotrans_precomp_::init_val() {
     c.clear();
     c.resize(pspt->size(), base_vector(pgt->nb_points()));
     for (size_type j = 0; j < pspt->size(); ++j)
       pgt->poly_vector_val((*pspt)[j], c[j]);
   }
 
-  void geotrans_precomp_::init_grad() const {
+  void geotrans_precomp_::init_grad() {
     dim_type N = pgt->dim();
     pc.clear();
     pc.resize(pspt->size(), base_matrix(pgt->nb_points() , N));
@@ -1355,17 +1357,18 @@ namespace bgeot {
   }
 
   void geotrans_precomp_::init_hess() const {
-    base_poly P, Q;
+    GLOBAL_OMP_GUARD
+    if (hess_computed_) return;
     dim_type N = pgt->structure()->dim();
     hpc.clear();
     hpc.resize(pspt->size(), base_matrix(pgt->nb_points(), gmm::sqr(N)));
     for (size_type j = 0; j < pspt->size(); ++j)
       pgt->poly_vector_hess((*pspt)[j], hpc[j]);
+    hess_computed_ = true;
   }
 
   base_node geotrans_precomp_::transform(size_type i,
                                          const base_matrix &G) const {
-    if (c.empty()) init_val();
     size_type N = G.nrows(), k = pgt->nb_points();
     base_node P(N);
     base_matrix::const_iterator git = G.begin();
@@ -1381,7 +1384,7 @@ namespace bgeot {
                                      pstored_point_tab pspt,
                                      dal::pstatic_stored_object dep) {
     dal::pstatic_stored_object_key pk= std::make_shared<pre_geot_key_>(pg,pspt);
-    dal::pstatic_stored_object o = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
     if (o) return std::dynamic_pointer_cast<const geotrans_precomp_>(o);
     pgeotrans_precomp p = std::make_shared<geotrans_precomp_>(pg, pspt);
     dal::add_stored_object(pk, p, pg, pspt, dal::AUTODELETE_STATIC_OBJECT);
@@ -1392,5 +1395,15 @@ namespace bgeot {
   void delete_geotrans_precomp(pgeotrans_precomp pgp)
   { dal::del_stored_object(pgp, true); }
 
+  pgeotrans_precomp geotrans_precomp_pool::operator()(pgeometric_trans pg,
+                                                      pstored_point_tab pspt) {
+    dal::pstatic_stored_object_key pk= std::make_shared<pre_geot_key_>(pg,pspt);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
+    if (o) return std::dynamic_pointer_cast<const geotrans_precomp_>(o);
+    pgeotrans_precomp p = geotrans_precomp(pg, pspt, 0);
+    precomps.insert(p);
+    return p;
+  }
+
 }  /* end of namespace bgeot.                                            */
 
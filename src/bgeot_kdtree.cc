@@ -198,7 +198,8 @@ namespace bgeot {
           scalar_type dist = it[k] - p.pos[k];
           dist2 += dist * dist;
         }
-        if (dist2 < p.dist2 || p.dist2 < scalar_type(0)){
+        if (dist2 < p.dist2 || p.dist2 < scalar_type(0)
+            || (dist2 == p.dist2 && itpt->i < p.ipt->i)) {
           *(p.ipt) = *itpt;
           p.dist2 = dist2;
         }
@@ -25,6 +25,7 @@
 #include "getfem/bgeot_small_vector.h"
 #include "getfem/bgeot_ftool.h"
 #include "getfem/getfem_locale.h"
+#include <map>
 
 namespace bgeot {
 
@@ -250,5 +251,112 @@ namespace bgeot {
     return read_base_poly(n, f);
   }
 
+  /* ******************************************************************** */
+  /*    Compiled evaluation of a set of polynomials.                      */
+  /* ******************************************************************** */
+
+  polynomial_set_evaluator::polynomial_set_evaluator
+  (const std::vector<base_poly> &P)
+    : n(P.empty() ? 0 : P[0].dim()), R(P.size()), max_degree(0) {
+    for (const base_poly &p : P)
+      GMM_ASSERT1(p.dim() == n, "Polynomials of different dimensions");
+
+    // Numbering of the monomials of the polynomials and their derivatives
+    std::map<std::vector<short_type>, size_type> monomials;
+    std::vector<short_type> a(n), b(n), c(n);
+    for (const base_poly &p : P) {
+      power_index mi(n);
+      for (size_type l = 0; l < p.size(); ++l, ++mi) {
+        if (p[l] == opt_long_scalar_type(0)) continue;
+        std::copy(mi.begin(), mi.end(), a.begin());
+        monomials[a] = 0;
+        for (short_type j = 0; j < n; ++j) {
+          if (a[j] == 0) continue;
+          b = a; b[j]--; monomials[b] = 0;
+          for (short_type k = 0; k < n; ++k)
+            if (b[k] > 0) { c = b; c[k]--; monomials[c] = 0; }
+        }
+      }
+    }
+    size_type nm = 0;
+    powers.resize(monomials.size() * n);
+    for (auto &m : monomials) {
+      std::copy(m.first.begin(), m.first.end(), powers.begin() + nm*n);
+      for (short_type e : m.first) max_degree = std::max(max_degree, e);
+      m.second = nm++;
+    }
+    nb_monomials_ = nm;
+
+    gmm::resize(coeffs[0], R, nm);
+    gmm::resize(coeffs[1], R*n, nm);
+    gmm::resize(coeffs[2], R*n*n, nm);
+    for (size_type i = 0; i < R; ++i) {
+      power_index mi(n);
+      for (size_type l = 0; l < P[i].size(); ++l, ++mi) {
+        scalar_type v = to_scalar(P[i][l]);
+        if (v == scalar_type(0)) continue;
+        std::copy(mi.begin(), mi.end(), a.begin());
+        coeffs[0](i, monomials[a]) += v;
+        for (short_type j = 0; j < n; ++j) {
+          if (a[j] == 0) continue;
+          b = a; b[j]--;
+          coeffs[1](i+R*j, monomials[b]) += v * scalar_type(a[j]);
+          for (short_type k = 0; k < n; ++k)
+            if (b[k] > 0) {
+              c = b; c[k]--;
+              coeffs[2](i+R*(j+n*k), monomials[c])
+                += v * scalar_type(a[j]) * scalar_type(b[k]);
+            }
+        }
+      }
+    }
+  }
+
+  void polynomial_set_evaluator::monomial_values
+  (const scalar_type *x, scalar_type *v, scalar_type *pw) const {
+    size_type D = size_type(max_degree) + 1;
+    for (short_type j = 0; j < n; ++j) {
+      pw[j*D] = scalar_type(1);
+      for (size_type k = 1; k < D; ++k) pw[j*D+k] = pw[j*D+k-1] * x[j];
+    }
+    const short_type *e = powers.data();
+    for (size_type m = 0; m < nb_monomials_; ++m, e += n) {
+      scalar_type a(1);
+      for (short_type j = 0; j < n; ++j) if (e[j]) a *= pw[j*D+e[j]];
+      v[m] = a;
+    }
+  }
+
+  void polynomial_set_evaluator::eval(short_type order, const scalar_type *x,
+                                      scalar_type *res,
+                                      scalar_type *work) const {
+    GMM_ASSERT1(order <= 2, "Only orders 0, 1 and 2 are available");
+    const base_matrix &C = coeffs[order];
+    size_type nr = gmm::mat_nrows(C);
+    std::fill(res, res + nr, scalar_type(0));
+    if (nr == 0 || nb_monomials_ == 0) return;
+    const scalar_type *v = work;
+    monomial_values(x, work, work + nb_monomials_);
+    for (size_type m = 0; m < nb_monomials_; ++m) {
+      const scalar_type *pc = &(C(0, m)), a = v[m];
+      for (size_type i = 0; i < nr; ++i) res[i] += pc[i] * a;
+    }
+  }
+
+  void polynomial_set_evaluator::eval(short_type order, const scalar_type *x,
+                                      size_type np, base_matrix &res) const {
+    GMM_ASSERT1(order <= 2, "Only orders 0, 1 and 2 are available");
+    const base_matrix &C = coeffs[order];
+    size_type nr = gmm::mat_nrows(C);
+    gmm::resize(res, nr, np);
+    if (nr == 0 || np == 0) return;
+    if (nb_monomials_ == 0) { gmm::clear(res); return; }
+    base_matrix V(nb_monomials_, np);
+    std::vector<scalar_type> pw(work_size() - nb_monomials_);
+    for (size_type p = 0; p < np; ++p)
+      monomial_values(x + p*n, &(V(0, p)), pw.data());
+    gmm::mult(C, V, res);
+  }
+
 
 }  /* end of namespace bgeot.                                             */
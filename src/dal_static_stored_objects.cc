@@ -139,6 +139,14 @@ namespace dal {
   #define ON_STORED_DEBUG(expression)
 #endif
 
+  /* Index of the i-th table to be visited when looking for an object,
+     beginning with the table of the current thread, which is the one
+     where the objects are usually stored. */
+  static inline size_t thread_in_search_order(size_t i) {
+    return (singleton<stored_object_tab>::this_thread() + i)
+      % singleton<stored_object_tab>::num_threads();
+  }
+
   // Gives a pointer to a key of an object from its pointer, while looking in the storage of
   // a specific thread
   pstatic_stored_object_key key_of_stored_object(pstatic_stored_object o, size_t thread){
@@ -197,8 +205,9 @@ namespace dal {
 
   std::pair<stored_object_tab::iterator, stored_object_tab::iterator>
     iterators_of_object(pstatic_stored_object o){
-    for(size_t thread = 0; thread != singleton<stored_object_tab>::num_threads(); ++thread){
-      auto& stored_objects = singleton<stored_object_tab>::instance(thread);
+    for(size_t i = 0; i != singleton<stored_object_tab>::num_threads(); ++i){
+      auto& stored_objects
+        = singleton<stored_object_tab>::instance(thread_in_search_order(i));
       ON_STORED_DEBUG(if (!dal_static_stored_tab_valid__) continue;)
       auto it = stored_objects.iterator_of_object_(o);
       if (it != stored_objects.end()) return {it, stored_objects.end()};
@@ -230,8 +239,9 @@ namespace dal {
   void add_dependency(pstatic_stored_object o1,
                       pstatic_stored_object o2) {
     bool dep_added = false;
-    for(size_t thread = 0; thread != singleton<stored_object_tab>::num_threads(); ++thread){
-      auto& stored_objects = singleton<stored_object_tab>::instance(thread);
+    for(size_t i = 0; i != singleton<stored_object_tab>::num_threads(); ++i){
+      auto& stored_objects
+        = singleton<stored_object_tab>::instance(thread_in_search_order(i));
       ON_STORED_DEBUG(if (!dal_static_stored_tab_valid__) return)
       if ((dep_added = stored_objects.add_dependency_(o1,o2))) break;
     }
@@ -240,8 +250,9 @@ namespace dal {
                 << " of type "  << typeid(*o2).name() << ". ");
 
     bool dependent_added = false;
-    for(size_t thread = 0; thread != singleton<stored_object_tab>::num_threads(); ++thread){
-      auto& stored_objects = singleton<stored_object_tab>::instance(thread);
+    for(size_t i = 0; i != singleton<stored_object_tab>::num_threads(); ++i){
+      auto& stored_objects
+        = singleton<stored_object_tab>::instance(thread_in_search_order(i));
       if ((dependent_added = stored_objects.add_dependent_(o1,o2))) break;
     }
     GMM_ASSERT1(dependent_added, "Failed to add dependent between " << o1
@@ -255,8 +266,9 @@ namespace dal {
   Return true if o2 has no more dependent object. */
   bool del_dependency(pstatic_stored_object o1, pstatic_stored_object o2){
     bool dep_deleted = false;
-    for(size_t thread = 0; thread != singleton<stored_object_tab>::num_threads(); ++thread){
-      auto& stored_objects = singleton<stored_object_tab>::instance(thread);
+    for(size_t i = 0; i != singleton<stored_object_tab>::num_threads(); ++i){
+      auto& stored_objects
+        = singleton<stored_object_tab>::instance(thread_in_search_order(i));
       ON_STORED_DEBUG(if (!dal_static_stored_tab_valid__) return false)
       if ((dep_deleted = stored_objects.del_dependency_(o1,o2))) break;
     }
@@ -266,8 +278,9 @@ namespace dal {
 
     bool dependent_deleted = false;
     bool dependent_empty = false;
-    for(size_t thread = 0; thread != singleton<stored_object_tab>::num_threads(); ++thread){
-      auto& stored_objects = singleton<stored_object_tab>::instance(thread);
+    for(size_t i = 0; i != singleton<stored_object_tab>::num_threads(); ++i){
+      auto& stored_objects
+        = singleton<stored_object_tab>::instance(thread_in_search_order(i));
       dependent_deleted = stored_objects.del_dependent_(o1,o2);
       if (dependent_deleted){
         dependent_empty = stored_objects.has_dependent_objects(o2);
@@ -414,19 +427,83 @@ namespace dal {
 */
   stored_object_tab::stored_object_tab()
     : std::map<enr_static_stored_object_key, enr_static_stored_object>(),
-      locks_{}, stored_keys_{}{
+      locks_{}, stored_keys_{}, snapshot_{nullptr}, nb_added_{0} {
       ON_STORED_DEBUG(dal_static_stored_tab_valid__ = true;)
     }
 
   stored_object_tab::~stored_object_tab(){
+    delete snapshot_.exchange(nullptr);
     ON_STORED_DEBUG(dal_static_stored_tab_valid__ = false;)
   }
 
+  size_t stored_object_tab::lookup_snapshot::position
+  (const enr_static_stored_object_key &k) const {
+    auto it = std::lower_bound(tab.begin(), tab.end(), k,
+                               [](const decltype(tab)::value_type &a,
+                                  const enr_static_stored_object_key &b)
+                               { return a.first < b; });
+    return (it != tab.end() && !(k < it->first)) ? size_t(it - tab.begin())
+                                                 : size_t(-1);
+  }
+
+  pstatic_stored_object stored_object_tab::lookup_snapshot::search
+  (const enr_static_stored_object_key &k) const {
+    size_t i = position(k);
+    if (i == size_t(-1) || dead[i].load(std::memory_order_acquire))
+      return nullptr;
+    return tab[i].second;
+  }
+
+  /* Replace the snapshot by a copy of the current table. Should be called
+     with the lock of the table. The previous snapshot may still be read
+     by other threads in a parallel region. Out of a parallel region,
+     nobody else reads the table, and the retired snapshots are released. */
+  void stored_object_tab::update_snapshot_() const {
+    auto s = std::make_unique<lookup_snapshot>();
+    s->tab.reserve(size());
+    for (const auto &pair : *this)
+      s->tab.emplace_back(pair.first, pair.second.p);
+    s->dead.reset(new std::atomic<bool>[s->tab.size()]);
+    for (size_t i = 0; i < s->tab.size(); ++i) s->dead[i] = false;
+    s->nb_added = nb_added_; s->nb_dead = 0;
+    std::unique_ptr<const lookup_snapshot>
+      old(snapshot_.exchange(s.release(), std::memory_order_acq_rel));
+    if (getfem::me_is_multithreaded_now()) {
+      if (old) retired_.push_back(std::move(old));
+    } else
+      retired_.clear();
+  }
+
+  /* Mark a deleted object in the snapshot, instead of rebuilding it at
+     each deletion. Should be called with the lock of the table. */
+  void stored_object_tab::mark_dead_
+  (const enr_static_stored_object_key &k) const {
+    const lookup_snapshot *s = snapshot_.load(std::memory_order_acquire);
+    if (!s) return;
+    size_t i = s->position(k);
+    if (i != size_t(-1) && !s->dead[i].exchange(true))
+      ++(s->nb_dead);
+  }
+
+  /* A key missing from the snapshot is only trusted if no object has been
+     added since the snapshot was built. The snapshot read may be older
+     than the current one, so its own add counter is compared, not a
+     counter reset when the snapshot is rebuilt. */
   pstatic_stored_object
   stored_object_tab::search_stored_object(pstatic_stored_object_key k) const{
+    enr_static_stored_object_key ek(k);
+    const lookup_snapshot *s = snapshot_.load(std::memory_order_acquire);
+    if (s) {
+      auto p = s->search(ek);
+      if (p || nb_added_ == s->nb_added) return p;
+    }
     auto guard = locks_.get_lock();
-    auto it = find(enr_static_stored_object_key(k));
-    return (it != end()) ? it->second.p : nullptr;
+    auto it = find(ek);
+    pstatic_stored_object p = (it != end()) ? it->second.p : nullptr;
+    s = snapshot_.load(std::memory_order_acquire);
+    if (!s || nb_added_ - s->nb_added + s->nb_dead > s->tab.size() / 8 + 8)
+      update_snapshot_();
+    return p;
   }
 
   bool stored_object_tab::add_dependency_(pstatic_stored_object o1,
@@ -449,6 +526,7 @@ namespace dal {
     stored_keys_[o] = k;
     insert(std::make_pair(enr_static_stored_object_key(k),
                           enr_static_stored_object(o, perm)));
+    ++nb_added_;
     auto t = singleton<stored_object_tab>::this_thread();
     GMM_ASSERT2(stored_keys_.size() == size() && t != size_t(-1),
       "stored_keys are not consistent with stored_object tab");
@@ -518,6 +596,7 @@ namespace dal {
       auto ito = end();
       if (itk != stored_keys_.end()){
           ito = find(itk->second);
+          if (ito != end()) mark_dead_(ito->first);
           stored_keys_.erase(itk);
       }
       if (ito != end()){
@@ -525,6 +604,9 @@ namespace dal {
         it = to_delete.erase(it);
       } else ++it;
     }
+    // The dead objects are released when the snapshot is rebuilt.
+    const lookup_snapshot *s = snapshot_.load(std::memory_order_acquire);
+    if (s && s->nb_dead > s->tab.size() / 8 + 8) update_snapshot_();
   }
 
 }/* end of namespace dal                                                             */
\ No newline at end of file
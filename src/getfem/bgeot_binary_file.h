@@ -0,0 +1,211 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*===========================================================================
+
+ Copyright (C) 2026 agent
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ As a special exception, you  may use  this file  as it is a part of a free
+ software  library  without  restriction.  Specifically,  if   other  files
+ instantiate  templates  or  use macros or inline functions from this file,
+ or  you compile this  file  and  link  it  with other files  to produce an
+ executable, this file  does  not  by itself cause the resulting executable
+ to be covered  by the GNU Lesser General Public License.  This   exception
+ does not  however  invalidate  any  other  reasons why the executable file
+ might be covered by the GNU Lesser General Public License.
+
+===========================================================================*/
+
+/**@file bgeot_binary_file.h
+   @author  agent <agent@local>
+   @date 2026.
+   @brief Versioned binary container made of typed sections.
+
+   A binary file begins with a 64 bytes header (magic string, format
+   version, endianness marker, position of the table of contents) followed
+   by the data of the sections, each one aligned on 64 bytes, and ends with
+   the table of contents. A section is identified by a tag (at most 15
+   characters) and an integer id, and holds an array of fixed size
+   elements.
+
+   On POSIX systems the reader maps the file in memory, so that only the
+   pages of the sections actually accessed are read from the disk, and
+   the data of a section is accessed without copy. Elsewhere, each section
+   is read on demand in a buffer owned by the caller (see binary_section).
+
+   When GetFEM is built with zlib, the sections can be compressed by
+   blocks of 64 KiB (see binary_file_writer::set_compression). They are
+   transparently uncompressed by the reader when they are accessed.
+*/
+
+#ifndef BGEOT_BINARY_FILE_H
+#define BGEOT_BINARY_FILE_H
+
+#include "bgeot_config.h"
+#include "getfem_omp.h"
+#include <fstream>
+#include <map>
+#include <set>
+#include <memory>
+
+namespace bgeot {
+
+  /// Description of a section in the table of contents.
+  struct binary_section_record {
+    char tag[16];
+    gmm::uint64_type id;
+    gmm::uint64_type offset;
+    gmm::uint64_type nb;        // number of elements
+    gmm::uint32_type elem_size; // size in bytes of an element
+    gmm::uint32_type flags;     // 1 for a section compressed with zlib
+  };
+
+  /// Return true if the file begins with the binary container magic string.
+  bool is_binary_file(const std::string &name);
+
+  /** 64 bits checksum (FNV-1a on 64 bits words) of nb bytes, to detect
+      the corruption of a stored array. */
+  gmm::uint64_type binary_checksum(const void *data, size_type nb);
+
+  /** Writing of a binary container. The table of contents is written
+      by close(), which is called by the destructor. */
+  class binary_file_writer {
+    std::ofstream f;
+    std::string name_;
+    gmm::uint64_type pos;
+    std::vector<binary_section_record> toc;
+    std::set<std::pair<std::string, gmm::uint64_type>> written;
+    bool compress, has_compressed;
+    void pad();
+    void write_header_and_toc();
+
+  public :
+    /** Write a section of nb elements of elem_size bytes. A section with
+        the same tag and id should not already have been written. */
+    void write_section(const std::string &tag, size_type id,
+                       const void *data, size_type nb, size_type elem_size);
+    template <typename T>
+    void write_section(const std::string &tag, size_type id,
+                       const std::vector<T> &v)
+    { write_section(tag, id, v.data(), v.size(), sizeof(T)); }
+    /** Write a vector of indices on 32 bits if all of them are smaller than
+        2^32 - 1 (size_type(-1) is preserved) and on 64 bits otherwise. */
+    void write_index_section(const std::string &tag, size_type id,
+                             const std::vector<size_type> &v);
+    /// Write a list of strings separated by null characters.
+    void write_string_section(const std::string &tag, size_type id,
+                              const std::vector<std::string> &v);
+
+    /** Compress the sections written from now on (only possible if
+        compression_available()). */
+    void set_compression(bool c);
+    static bool compression_available();
+
+    /** Write the table of contents, so that the file is readable, and
+        flush it. Sections can still be appended afterwards: they are
+        written after this table of contents, which stays valid until
+        the next flush() or close(). */
+    void flush();
+    const std::string &name() const { return name_; }
+    void close();
+    explicit binary_file_writer(const std::string &name);
+    ~binary_file_writer();
+  };
+
+  class binary_file_reader;
+
+  /** Data of a section returned by binary_file_reader::section. It points
+      on the file mapped in memory when possible, and otherwise on a buffer
+      owned by this object, so that the data is valid as long as this
+      object and the reader exist. */
+  template <typename T> class binary_section {
+    std::unique_ptr<char[]> buf;
+    const T *p;
+    size_type nb;
+    friend class binary_file_reader;
+
+  public :
+    const T *data() const { return p; }
+    const T *begin() const { return p; }
+    const T *end() const { return p + nb; }
+    size_type size() const { return nb; }
+    const T &operator[](size_type i) const { return p[i]; }
+    binary_section() : p(0), nb(0) {}
+  };
+
+  /** Reading of a binary container. The sections can be read by several
+      threads at the same time: when the file is not mapped in memory, the
+      reads on the shared stream are serialized. */
+  class binary_file_reader {
+    std::string name_;
+    std::vector<binary_section_record> toc;
+    const char *mapped;
+    size_type mapped_size;
+    std::map<std::pair<std::string, gmm::uint64_type>, size_type> index;
+    mutable std::ifstream f;
+    getfem::lock_factory locks_;
+    void read_raw(gmm::uint64_type offset, size_type size, char *p) const;
+    /* Data of the i-th section: in the mapped file if possible, otherwise
+       read in buf. */
+    const char *section_data(size_type i, std::unique_ptr<char[]> &buf) const;
+
+  public :
+    /** Index of the section in the table of contents, or size_type(-1)
+        if there is no such section. */
+    size_type find_section(const std::string &tag, size_type id = 0) const;
+    bool has_section(const std::string &tag, size_type id = 0) const
+    { return find_section(tag, id) != size_type(-1); }
+    /// Record of the i-th section of the table of contents.
+    const binary_section_record &section_record(size_type i) const
+    { return toc[i]; }
+    /// Ids of the sections having a given tag, in increasing order.
+    std::vector<size_type> section_ids(const std::string &tag) const;
+    /** Return the data of a section. The size of the elements should be
+        sizeof(T). The data is not copied, except for the compressed
+        sections and when the file is not mapped in memory. */
+    template <typename T>
+    binary_section<T> section(const std::string &tag, size_type id) const {
+      size_type i = find_section(tag, id);
+      GMM_ASSERT1(i != size_type(-1), "Missing section " << tag << " "
+                  << id << " in binary file " << name_);
+      GMM_ASSERT1(toc[i].elem_size == sizeof(T), "Wrong element size for "
+                  "section " << tag << " in binary file " << name_);
+      binary_section<T> s;
+      s.nb = size_type(toc[i].nb);
+      s.p = reinterpret_cast<const T *>(section_data(i, s.buf));
+      return s;
+    }
+    template <typename T>
+    void read_section(const std::string &tag, size_type id,
+                      std::vector<T> &v) const {
+      binary_section<T> s = section<T>(tag, id);
+      v.assign(s.begin(), s.end());
+    }
+    /// Read a section written by write_index_section.
+    void read_index_section(const std::string &tag, size_type id,
+                            std::vector<size_type> &v) const;
+    /// Read a section written by write_string_section.
+    void read_string_section(const std::string &tag, size_type id,
+                             std::vector<std::string> &v) const;
+
+    const std::string &name() const { return name_; }
+    explicit binary_file_reader(const std::string &name);
+    ~binary_file_reader();
+  };
+
+}  /* end of namespace bgeot.                                           */
+
+#endif /* BGEOT_BINARY_FILE_H */
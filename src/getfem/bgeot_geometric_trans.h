@@ -39,6 +39,7 @@
 #define BGEOT_GEOMETRIC_TRANSFORMATION_H__
 
 #include <set>
+#include <atomic>
 #include "bgeot_config.h"
 #include "bgeot_convex_ref.h"
 #include "getfem/dal_naming_system.h"
@@ -289,24 +290,30 @@ namespace bgeot {
    *  precomputed geometric transformation operations use this for
    *  repetitive evaluation of a geometric transformations on a set of
    *  points "pspt" in the reference convex which do not change.
+   *
+   *  The values and the gradients are computed at the construction, the
+   *  hessians at their first use (under a lock), and the tables are never
+   *  modified afterwards, so that a geotrans_precomp_ can be shared by all
+   *  the threads without synchronization. The tables are stored point by
+   *  point, as a base_vector or a base_matrix for each point, since the
+   *  callers use them as such.
    */
   class APIDECL geotrans_precomp_ : virtual public dal::static_stored_object {
   protected:
     pgeometric_trans pgt;
     pstored_point_tab pspt;  /* a set of points in the reference elt*/
-    mutable std::vector<base_vector> c;  /* precomputed values for the     */
+    std::vector<base_vector> c;          /* precomputed values for the     */
                                          /* transformation                 */
-    mutable std::vector<base_matrix> pc; /* precomputed values for gradient*/
+    std::vector<base_matrix> pc;         /* precomputed values for gradient*/
                                          /* of the transformation.         */
     mutable std::vector<base_matrix> hpc; /* precomputed values for hessian*/
                                           /*  of the transformation.       */
+    mutable std::atomic<bool> hess_computed_;
   public:
-    inline const base_vector &val(size_type i) const
-    { if (c.empty()) init_val(); return c[i]; }
-    inline const base_matrix &grad(size_type i) const
-    { if (pc.empty()) init_grad(); return pc[i]; }
+    inline const base_vector &val(size_type i) const { return c[i]; }
+    inline const base_matrix &grad(size_type i) const { return pc[i]; }
     inline const base_matrix &hessian(size_type i) const
-    { if (hpc.empty()) init_hess(); return hpc[i]; }
+    { if (!hess_computed_) init_hess(); return hpc[i]; }
 
     /**
      *  Apply the geometric transformation from the reference convex to
@@ -331,8 +338,8 @@ namespace bgeot {
       { DAL_STORED_OBJECT_DEBUG_DESTROYED(this, "Geotrans precomp"); }
 
   private:
-    void init_val() const;
-    void init_grad() const;
+    void init_val();
+    void init_grad();
     void init_hess() const;
 
     /**
@@ -346,6 +353,9 @@ namespace bgeot {
   };
 
 
+  /** Return the precomputations of pg on the points of ps. The object is
+      searched among the ones stored by all the threads before being built,
+      so that the threads share the same tables. */
   pgeotrans_precomp
   geotrans_precomp(pgeometric_trans pg, pstored_point_tab ps,
                    dal::pstatic_stored_object dep);
@@ -355,7 +365,6 @@ namespace bgeot {
                                     VEC& pt) const {
     size_type k = 0;
     gmm::clear(pt);
-    if (c.empty()) init_val();
     for (typename CONT::const_iterator itk = G.begin();
          itk != G.end(); ++itk, ++k)
       gmm::add(gmm::scaled(*itk, c[j][k]), pt);
@@ -366,7 +375,6 @@ namespace bgeot {
   template <typename CONT>
   void geotrans_precomp_::transform(const CONT& G,
                                     stored_point_tab& pt_tab) const {
-    if (c.empty()) init_val();
     pt_tab.clear(); pt_tab.resize(c.size(), base_node(G[0].size()));
     for (size_type j = 0; j < c.size(); ++j) {
       transform(G, j, pt_tab[j]);
@@ -378,7 +386,9 @@ namespace bgeot {
   /**
    *  The object geotrans_precomp_pool Allow to allocate a certain number
    *  of geotrans_precomp and automatically delete them when it is
-   *  deleted itself.
+   *  deleted itself. Only the geotrans_precomp built by the pool are
+   *  deleted, not the ones found in the storage of the threads, which
+   *  may be in use elsewhere.
    */
   class APIDECL geotrans_precomp_pool {
     std::set<pgeotrans_precomp> precomps;
@@ -386,11 +396,7 @@ namespace bgeot {
   public :
 
     pgeotrans_precomp operator()(pgeometric_trans pg,
-                                 pstored_point_tab pspt) {
-      pgeotrans_precomp p = geotrans_precomp(pg, pspt, 0);
-      precomps.insert(p);
-      return p;
-    }
+                                 pstored_point_tab pspt);
     ~geotrans_precomp_pool() {
       for (std::set<pgeotrans_precomp>::iterator it = precomps.begin();
            it != precomps.end(); ++it)
@@ -133,7 +133,8 @@ namespace bgeot {
                        const base_node &min,
                        const base_node &max);
     /* assigns at ipt the index of the nearest neighbor at location
-       pos and returns the square of the distance to this point*/
+       pos and returns the square of the distance to this point. Among
+       points at the same distance, the one of lowest index is chosen. */
     scalar_type nearest_neighbor(index_node_pair &ipt,
                                  const base_node &pos);
   private:
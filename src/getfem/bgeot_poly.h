@@ -627,6 +627,53 @@ namespace bgeot
   /** read a base_poly on the string s. */
   base_poly read_base_poly(short_type n, const std::string &s);
 
+  /** Compiled form of a set of polynomials of the same dimension, for the
+      evaluation of all of them, of their gradients or of their hessians
+      at a batch of points. The monomials of the polynomials and of their
+      derivatives are numbered once, and the values are obtained as the
+      product of a dense coefficient matrix by the matrix of the values of
+      the monomials at the points (a Vandermonde matrix).
+
+      The result of order 0, 1 or 2 for a point has R*N^order components
+      (R polynomials, N the dimension), the polynomial index being the
+      fastest: P_i, then dP_i/dx_j at i + R*j, then d2P_i/dx_jdx_k at
+      i + R*(j + N*k).
+  */
+  class polynomial_set_evaluator {
+    short_type n;
+    size_type R;
+    short_type max_degree;
+    size_type nb_monomials_;
+    std::vector<short_type> powers; // n powers for each monomial
+    base_matrix coeffs[3];          // (R*n^order) x nb_monomials
+
+    void monomial_values(const scalar_type *x, scalar_type *v,
+                         scalar_type *pw) const;
+
+  public :
+    short_type dim() const { return n; }
+    size_type nb_polynomials() const { return R; }
+    size_type nb_monomials() const { return nb_monomials_; }
+    /// Number of components of the result of a given order for one point.
+    size_type nb_components(short_type order) const
+    { return gmm::mat_nrows(coeffs[order]); }
+    /// Number of scalars of the work buffer of the evaluation at one point.
+    size_type work_size() const
+    { return nb_monomials_ + size_type(n) * (size_type(max_degree) + 1); }
+    /** Evaluation at one point x (of size dim()), the result being stored
+        in res[0..nb_components(order)-1]. work is a buffer of at least
+        work_size() scalars, given by the caller so that the evaluation
+        does not allocate. */
+    void eval(short_type order, const scalar_type *x, scalar_type *res,
+              scalar_type *work) const;
+    /** Evaluation at np points stored contiguously in x, the result for
+        the i-th point being the i-th column of res. */
+    void eval(short_type order, const scalar_type *x, size_type np,
+              base_matrix &res) const;
+
+    explicit polynomial_set_evaluator(const std::vector<base_poly> &P);
+  };
+
 
   /**********************************************************************/
   /* A class for rational fractions                                     */
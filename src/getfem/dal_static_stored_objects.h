@@ -63,6 +63,15 @@ dependency);
 @endcode
 
 std::shared_ptr are used.
+
+Each thread has its own table of stored objects. A search by key in the
+table of the current thread does not take any lock: it is done in an
+sorted copy of the table (a snapshot), which is rebuilt when enough
+objects have been added or deleted. The deleted objects are only marked
+dead in the snapshot, which keeps them alive until it is rebuilt since
+their keys may refer to them. Only the searches of keys which are not in
+the snapshot, while objects have been added since it was built, take the
+lock of the table.
 */
 #ifndef DAL_STATIC_STORED_OBJECTS_H__
 #define DAL_STATIC_STORED_OBJECTS_H__
@@ -78,6 +87,8 @@ std::shared_ptr are used.
 #include "getfem/getfem_arch_config.h"
 
 #include <atomic>
+#include <memory>
+#include <vector>
 
 #define DAL_STORED_OBJECT_DEBUG 0
 
@@ -316,15 +327,31 @@ namespace dal {
 
 
 
-  /** Table of stored objects. Thread safe, uses thread specific mutexes. */
+  /** Table of stored objects. Thread safe, uses thread specific mutexes
+      for the modifications and a lock-free snapshot for the searches. */
   struct stored_object_tab :
     public std::map<enr_static_stored_object_key, enr_static_stored_object> {
 
     typedef std::map<pstatic_stored_object,pstatic_stored_object_key>
       stored_key_tab;
 
+    /** Copy of the (key, object) pairs, sorted as the table. The only
+        change done afterwards is the marking of the deleted objects. */
+    struct lookup_snapshot {
+      std::vector<std::pair<enr_static_stored_object_key,
+                            pstatic_stored_object>> tab;
+      std::unique_ptr<std::atomic<bool>[]> dead;
+      size_t nb_added; // value of the add counter of the table when built
+      mutable size_t nb_dead; // modified with the lock of the table
+      size_t position(const enr_static_stored_object_key &k) const;
+      pstatic_stored_object search(const enr_static_stored_object_key &k)
+        const;
+    };
+
     stored_object_tab();
     ~stored_object_tab();
+    stored_object_tab(const stored_object_tab &) = delete;
+    stored_object_tab &operator =(const stored_object_tab &) = delete;
     pstatic_stored_object
       search_stored_object(pstatic_stored_object_key k) const;
     bool has_dependent_objects(pstatic_stored_object o) const;
@@ -358,6 +385,17 @@ namespace dal {
 
     getfem::lock_factory locks_;
     stored_key_tab stored_keys_;
+
+  private :
+    /* The snapshots replaced while other threads may be reading them are
+       kept in retired_ and released at the next modification done out of
+       a parallel region. */
+    mutable std::atomic<const lookup_snapshot *> snapshot_;
+    // number of objects added since the creation of the table (never reset)
+    mutable std::atomic<size_t> nb_added_;
+    mutable std::vector<std::unique_ptr<const lookup_snapshot>> retired_;
+    void update_snapshot_() const;
+    void mark_dead_(const enr_static_stored_object_key &k) const;
   };
 
 
@@ -390,6 +390,46 @@ namespace getfem {
                       bool in_reference_conf, const model_real_plain_vector &coeff,
                       base_node &n0, base_node &n, base_matrix &grad);
 
+  // Bounding volume hierarchy on the influence boxes. It is kept from a
+  // computation of the contact pairs to the next one: as long as the set
+  // of master faces is unchanged, the bounds of the nodes are only
+  // updated (refitted) for the new deformed configuration. The hierarchy
+  // is built again when the faces change or when the refitted nodes
+  // become too loose.
+  struct influence_box_tree {
+    size_type N;
+    std::vector<scalar_type> box_min, box_max;   // N * nb_boxes values
+    std::vector<size_type> box_order; // Box ids, sorted by leaf
+    struct tree_node {
+      size_type first, last; // Range in box_order for a leaf
+      size_type left, right; // Children, size_type(-1) for a leaf
+    };
+    std::vector<tree_node> nodes;     // A child is stored after its parent
+    std::vector<scalar_type> node_min, node_max;
+    scalar_type built_extent;         // Total extent of the nodes when built
+
+    enum { BOXES_PER_LEAF = 8 };
+    size_type nb_boxes(void) const
+    { return N ? box_min.size() / N : 0; }
+    size_type build_node(size_type first, size_type last,
+                         std::vector<scalar_type> &centers);
+    void fit_node(size_type i);
+    scalar_type total_extent(void) const;
+    // Build the hierarchy on the given boxes.
+    void build(size_type NN, std::vector<scalar_type> &bmin,
+               std::vector<scalar_type> &bmax);
+    // Replace the bounds of the boxes, which should be as many as before,
+    // and update the hierarchy accordingly.
+    void refit(std::vector<scalar_type> &bmin,
+               std::vector<scalar_type> &bmax);
+    // Ids of the boxes containing P, in increasing order. Thread safe.
+    void find_boxes_at_point(const base_node &P,
+                             std::vector<size_type> &ids) const;
+    void clear(void);
+    influence_box_tree(void) : N(0), built_extent(0) {}
+  };
+
+
   //=========================================================================
   //
   //  Structure which stores the contact boundaries, rigid obstacles and
@@ -489,7 +529,7 @@ namespace getfem {
         : ind_boundary(ib), ind_element(ie), ind_face(iff), mean_normal(n) {}
     };
 
-    bgeot::rtree element_boxes;                  // influence boxes
+    influence_box_tree element_boxes;            // influence boxes
     std::vector<influence_box> element_boxes_info;
 
     //
@@ -608,6 +648,7 @@ namespace getfem {
     // Compute the influence boxes of master boundary elements. To be run
     // before the detection of contact pairs. The influence box is the
     // bounding box extended by a distance equal to the release distance.
+    // The hierarchy of the previous call is refitted when possible.
     void compute_influence_boxes(void);
 
     // For delaunay triangulation. Advantages compared to influence boxes:
@@ -39,6 +39,7 @@
 #define GETFEM_CONTACT_AND_FRICTION_NODAL_H__
 
 #include "getfem_models.h"
+#include "bgeot_kdtree.h"
 
 namespace getfem {
 
@@ -571,6 +572,61 @@ namespace getfem {
       (md, mim, varname_u, multname_n, multname_t, dataname_r,
        dataname_friction_coeff, rg1, rg2, slave1, slave2, aug_version); }
 
+  /** Uniform grid on a set of contact nodes, for the search of the
+      nearest node by the nodal contact bricks. The nodes lying on a
+      surface, the cells are sized so that there is about one node per
+      cell on this surface. The occupied cells are stored sorted by their
+      index, so that the grid is built in linear memory whatever the extent
+      of the surface. The cells are searched by rings around the point, the
+      search being stopped by the distance from the point to the cells not
+      yet visited. The points far from the nodes (compared to the cell
+      size) are searched in a kdtree instead.
+
+      The nodes are not copied: the vector given to the constructor has
+      to outlive the grid and must not be modified.
+  */
+  class contact_node_grid {
+    size_type N;
+    scalar_type h;
+    base_node org;
+    std::vector<size_type> nc;              // Number of cells per direction
+    const std::vector<base_node> *pts;
+    std::vector<size_type> cell_keys, cell_start, ids;
+    mutable bgeot::kdtree tree;             // built by the constructor
+
+    struct search_state {
+      const base_node &P;
+      const std::vector<long> &c;
+      std::vector<long> cc;
+      std::vector<scalar_type> g;           // distance to the grid box
+      long r;
+      scalar_type dist2, g2;
+      size_type ind;
+      search_state(const base_node &P_, const std::vector<long> &c_,
+                   scalar_type d2)
+        : P(P_), c(c_), cc(c_.size()), g(c_.size()), r(0), dist2(d2),
+          g2(0), ind(size_type(-1)) {}
+    };
+
+    size_type key_of(const std::vector<long> &c) const;
+    void search_cell(search_state &s) const;
+    void search_ring(search_state &s, size_type k, bool on_ring) const;
+    scalar_type ring_dist2(const search_state &s) const;
+    scalar_type far_nearest_node(const base_node &P, scalar_type max_dist2,
+                                 size_type &ind) const;
+
+  public:
+    /** Index (in ind) of the nearest node to P whose square distance is
+        less than max_dist2, or size_type(-1). The square distance is
+        returned (max_dist2 if no node is found). Among nodes at the same
+        distance, the one of lowest index is chosen. Can be called
+        simultaneously by several threads. */
+    scalar_type nearest_node(const base_node &P, scalar_type max_dist2,
+                             size_type &ind) const;
+    explicit contact_node_grid(const std::vector<base_node> &pts_);
+    contact_node_grid(std::vector<base_node> &&) = delete;
+  };
+
 }  /* end of namespace getfem.                                             */
 
 
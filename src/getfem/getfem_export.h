@@ -41,6 +41,7 @@
 #include "getfem_interpolation.h"
 #include "getfem_mesh_slice.h"
 #include <list>
+#include <cstdio>
 
 namespace getfem {
 
@@ -66,6 +67,15 @@ namespace getfem {
       A vtk_export can store multiple scalar/vector fields.
   */
   class vtk_export {
+  public:
+    /** Encoding of the binary data of a .vtu file. VTU_BASE64 writes each
+        data array inline, encoded in base64. VTU_APPENDED_RAW writes the
+        raw bytes of all the arrays in the appended data section at the end
+        of the file, which is smaller and faster to write and read.
+        VTU_APPENDED_ZLIB additionally compresses the arrays by blocks with
+        zlib, the blocks being compressed in parallel (only available when
+        GetFEM is built with zlib). */
+    enum vtu_binary_format { VTU_BASE64, VTU_APPENDED_RAW, VTU_APPENDED_ZLIB };
   protected:
     std::ostream &os;
     char header[256]; // hard limit in vtk/vtu
@@ -78,7 +88,13 @@ namespace getfem {
     std::ofstream real_os;
     dim_type dim_;
     bool reverse_endian;
-    std::vector<unsigned char> vals;
+    vtu_binary_format vtu_format;
+    std::vector<unsigned char> vals; // binary data of the current array
+    /* In the appended formats, each array is spilled to a temporary file
+       once written, and the file is copied to the appended data section
+       by the destructor. appended_size is the size of this section. */
+    std::FILE *appended;
+    size_type appended_size;
     enum { EMPTY, HEADER_WRITTEN, STRUCTURE_WRITTEN, IN_CELL_DATA,
            IN_POINT_DATA } state;
 
@@ -88,6 +104,10 @@ namespace getfem {
     void write_separ();
     void clear_vals();
     void write_vals();
+    void write_appended(const void *p, size_type n);
+    bool is_appended() const
+    { return !vtk && !ascii && vtu_format != VTU_BASE64; }
+    std::string data_array_format();
 
   public:
     vtk_export(const std::string& fname, bool ascii_ = false, bool vtk_= true);
@@ -97,6 +117,14 @@ namespace getfem {
     void exporting(const mesh& m);
     void exporting(const mesh_fem& mf);
     void exporting(const stored_mesh_slice& sl);
+    /** Export only the convexes of cvlst (a piece of a partitioned mesh).
+        The cell data should still be given for all the convexes of the
+        mesh. */
+    void exporting(const mesh_fem& mf, const dal::bit_vector &cvlst);
+
+    /** Select the encoding of the binary data of a .vtu file. Should be
+        called before anything is written. */
+    void set_vtu_binary_format(vtu_binary_format f);
 
     /** the header is the second line of text in the exported file,
        you can put whatever you want -- call this before any write_dataset
@@ -241,10 +269,25 @@ namespace getfem {
                                   size_type qdim, bool cell_data) {
     write_mesh();
     size_type nb_val = 0;
+    /* U has a value per convex of the mesh, but only the values of the
+       exported convexes are written, so that there is one value per cell.
+       This is the case when a part of the mesh is exported and when the
+       mesh_fem is not defined on the whole mesh (all the values used to
+       be written in the latter case). ind gives the indices of the values
+       of the exported convexes. */
+    std::vector<size_type> ind;
+    bool part = false;
     if (cell_data) {
       switch_to_cell_data();
       nb_val = psl ? psl->linked_mesh().convex_index().card()
                    : pmf->linked_mesh().convex_index().card();
+      if (!psl && pmf->convex_index().card() != nb_val) {
+        part = true;
+        size_type i = 0;
+        for (dal::bv_visitor cv(pmf->linked_mesh().convex_index());
+             !cv.finished(); ++cv, ++i)
+          if (pmf->convex_index().is_in(cv)) ind.push_back(i);
+      }
     } else {
       switch_to_point_data();
       nb_val = psl ? psl->nb_points() : pmf_dof_used.card();
@@ -254,26 +297,26 @@ namespace getfem {
     GMM_ASSERT1(gmm::vect_size(U) == nb_val*Q,
                 "inconsistency in the size of the dataset: "
                 << gmm::vect_size(U) << " != " << nb_val << "*" << Q);
+    size_type nb_written = part ? ind.size() : nb_val;
     if (vtk) write_separ();
-    if (!vtk && !ascii) write_val(float(gmm::vect_size(U)));
     if (Q == 1) {
       if (vtk)
         os << "SCALARS " << remove_spaces(name) << " float 1\n"
            << "LOOKUP_TABLE default\n";
       else
         os << "<DataArray type=\"Float32\" Name=\"" << remove_spaces(name) << "\" "
-           << (ascii ? "format=\"ascii\">\n" : "format=\"binary\">\n");
-      for (size_type i=0; i < nb_val; ++i)
-        write_val(float(U[i]));
+           << data_array_format();
+      for (size_type i=0; i < nb_written; ++i)
+        write_val(float(U[part ? ind[i] : i]));
     } else if (Q <= 3) {
       if (vtk)
         os << "VECTORS " << remove_spaces(name) << " float\n";
       else
         os << "<DataArray type=\"Float32\" Name=\"" << remove_spaces(name) << "\" "
            << "NumberOfComponents=\"3\" "
-           << (ascii ? "format=\"ascii\">\n" : "format=\"binary\">\n");
-      for (size_type i=0; i < nb_val; ++i)
-        write_vec(U.begin() + i*Q, Q);
+           << data_array_format();
+      for (size_type i=0; i < nb_written; ++i)
+        write_vec(U.begin() + (part ? ind[i] : i)*Q, Q);
     } else if (Q == gmm::sqr(dim_)) {
       /* tensors : coef are supposed to be stored in FORTRAN order
          in the VTK/VTU file, they are written with C (row major) order
@@ -283,15 +326,15 @@ namespace getfem {
       else
         os << "<DataArray type=\"Float32\" Name=\"" << remove_spaces(name)
            << "\" NumberOfComponents=\"9\" "
-           << (ascii ? "format=\"ascii\">\n" : "format=\"binary\">\n");
-      for (size_type i=0; i < nb_val; ++i)
-        write_3x3tensor(U.begin() + i*Q);
+           << data_array_format();
+      for (size_type i=0; i < nb_written; ++i)
+        write_3x3tensor(U.begin() + (part ? ind[i] : i)*Q);
     } else
       GMM_ASSERT1(false, std::string(vtk ? "vtk" : "vtu")
                          + " does not accept vectors of dimension > 3");
     write_vals();
     if (vtk) write_separ();
-    if (!vtk) os << "\n" << "</DataArray>\n";
+    if (!vtk && !is_appended()) os << "\n" << "</DataArray>\n";
   }
 
 
@@ -301,6 +344,80 @@ namespace getfem {
     vtu_export(std::ostream &os_, bool ascii_ = false) : vtk_export(os_, ascii_, false) {}
   };
 
+  /** @brief Parallel VTU export.
+
+      The mesh is partitioned (see getfem_mesh_partition.h) and each part
+      is written to its own .vtu piece, the pieces being written in
+      parallel. A .pvtu file referencing the pieces is written by close(),
+      which has to be called once all the data is written. The pieces are
+      named basename_i.vtu and the .pvtu file basename.pvtu.
+  */
+  class pvtu_export {
+    std::string basename;
+    size_type nb_pieces;
+    bool ascii;
+    vtk_export::vtu_binary_format format;
+    const mesh *pmesh;
+    std::unique_ptr<mesh_fem> pmf; // when a mesh is exported
+    std::vector<std::unique_ptr<vtk_export>> pieces;
+    bool closed;
+    /* name and number of components of the data arrays */
+    std::vector<std::pair<std::string, size_type>> point_data, cell_data;
+    static size_type nb_components(size_type Q)
+    { return (Q == 1) ? 1 : ((Q <= 3) ? 3 : 9); }
+
+  public:
+    pvtu_export(const std::string &basename_, size_type nb_pieces_,
+                bool ascii_ = false,
+                vtk_export::vtu_binary_format f
+                = vtk_export::VTU_APPENDED_RAW);
+    /** Does not write the .pvtu file (see close()), and never throws. */
+    ~pvtu_export();
+    /** Complete the pieces and write the .pvtu file. Nothing can be
+        written afterwards. */
+    void close();
+    /** should be called before write_*_data */
+    void exporting(const mesh& m);
+    void exporting(const mesh_fem& mf);
+    void write_mesh();
+    size_type nb_exported_pieces() const { return pieces.size(); }
+    /** append a new field defined on mf to each piece (see
+        vtk_export::write_point_data). */
+    template<class VECT> void write_point_data(const getfem::mesh_fem &mf,
+                                               const VECT& U,
+                                               const std::string& name);
+    /** export data which is constant over each element. U should have
+        convex_index().card() elements (for the whole mesh). */
+    template<class VECT> void write_cell_data(const VECT& U,
+                                              const std::string& name,
+                                              size_type qdim = 1);
+  };
+
+  template<class VECT>
+  void pvtu_export::write_point_data(const getfem::mesh_fem &mf,
+                                     const VECT& U,
+                                     const std::string& name) {
+    GMM_ASSERT1(!closed, "the export is closed");
+    mf.nb_dof(); // dof enumeration before the parallel section
+    point_data.push_back(std::make_pair
+                         (name, nb_components((gmm::vect_size(U)/mf.nb_dof())
+                                              * mf.get_qdim())));
+    GETFEM_OMP_FOR(size_type i = 0, i < pieces.size(), ++i,
+                   pieces[i]->write_point_data(mf, U, name););
+  }
+
+  template<class VECT>
+  void pvtu_export::write_cell_data(const VECT& U, const std::string& name,
+                                    size_type qdim) {
+    GMM_ASSERT1(pmesh, "nothing exported");
+    GMM_ASSERT1(!closed, "the export is closed");
+    size_type Q = qdim;
+    if (Q == 1) Q = gmm::vect_size(U) / pmesh->convex_index().card();
+    cell_data.push_back(std::make_pair(name, nb_components(Q)));
+    GETFEM_OMP_FOR(size_type i = 0, i < pieces.size(), ++i,
+                   pieces[i]->write_cell_data(U, name, qdim););
+  }
+
   /** @brief A (quite large) class for exportation of data to IBM OpenDX.
 
                      http://www.opendx.org/
@@ -749,6 +866,7 @@ namespace getfem {
     }
     os << "};\n";
   }
+
 }  /* end of namespace getfem. */
 
 #endif /* GETFEM_EXPORT_H__  */
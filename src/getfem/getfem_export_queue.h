@@ -0,0 +1,114 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*===========================================================================
+
+ Copyright (C) 2026 agent
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ As a special exception, you  may use  this file  as it is a part of a free
+ software  library  without  restriction.  Specifically,  if   other  files
+ instantiate  templates  or  use macros or inline functions from this file,
+ or  you compile this  file  and  link  it  with other files  to produce an
+ executable, this file  does  not  by itself cause the resulting executable
+ to be covered  by the GNU Lesser General Public License.  This   exception
+ does not  however  invalidate  any  other  reasons why the executable file
+ might be covered by the GNU Lesser General Public License.
+
+===========================================================================*/
+
+
+/**@file getfem_export_queue.h
+   @author  agent <agent@local>
+   @date 2026.
+   @brief Asynchronous writing of the export files.
+
+   Only the writing to the disk is done in the background: the exported
+   data is formatted on the computation thread, since the exporters
+   (vtk_export, pos_export ...) use the shared objects of GetFEM.
+*/
+#ifndef GETFEM_EXPORT_QUEUE_H__
+#define GETFEM_EXPORT_QUEUE_H__
+
+#include "getfem_config.h"
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace getfem {
+
+  /** @brief Asynchronous writing of export files.
+
+      Tasks pushed in the queue are executed in order by a background
+      thread, so that the writing of the results to the disk overlaps the
+      next time steps. At most max_pending tasks can be waiting or
+      running: push() blocks until the oldest one is completed, which
+      bounds the memory used by the file contents (two by default, i.e.
+      double buffering).
+
+      A task should only use its own data (a copy of the vectors to be
+      exported, or a file content built in memory). It should not call
+      functions using the shared objects of GetFEM (meshes, mesh_fems,
+      fem and integration method descriptors ...) which are not protected
+      against a concurrent access by the computation thread. The usual
+      pattern is to build the file in memory with an exporter writing to a
+      std::stringstream (for instance a vtu_export with the
+      VTU_APPENDED_RAW format, for which this is mostly a copy of the
+      values) and to leave the writing to the disk to the queue:
+
+      @code
+      std::stringstream s;
+      {
+        getfem::vtu_export exp(s);
+        exp.set_vtu_binary_format(getfem::vtk_export::VTU_APPENDED_RAW);
+        exp.exporting(mf);
+        exp.write_point_data(mf, U, "u");
+      }
+      queue.write_file("u_" + std::to_string(step) + ".vtu", s.str());
+      @endcode
+
+      An error raised by a task is thrown again by the next call to push(),
+      write_file() or wait().
+  */
+  class async_export_queue {
+    size_type max_pending;
+    std::deque<std::function<void()>> tasks; // the front one is running
+    bool stop;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread worker;
+    void run();
+    void rethrow_error();
+
+  public:
+    /** Queue a task. Blocks while max_pending tasks are not completed. */
+    void push(std::function<void()> task);
+    /** Queue the writing of a file content. */
+    void write_file(const std::string &fname, std::string content);
+    /** Wait for the completion of all the queued tasks. */
+    void wait();
+    /** Number of tasks not completed. */
+    size_type nb_pending();
+
+    explicit async_export_queue(size_type max_pending_ = 2);
+    ~async_export_queue(); // waits for the completion of all the tasks
+  };
+
+}  /* end of namespace getfem. */
+
+#endif /* GETFEM_EXPORT_QUEUE_H__  */
@@ -142,6 +142,7 @@
 #include "getfem_integration.h"
 #include "dal_naming_system.h"
 #include <deque>
+#include <atomic>
 
 namespace getfem {
 
@@ -438,6 +439,15 @@ namespace getfem {
      */
     virtual void hess_base_value(const base_node &x, base_tensor &t) const = 0;
 
+    /** Give at each point of pts the values (order 0), the gradients
+     *  (order 1) or the hessians (order 2) of the base functions, as
+     *  base_value, grad_base_value and hess_base_value do for one point.
+     *  Used by fem_precomp.
+     */
+    virtual void base_value_batch(const bgeot::stored_point_tab &pts,
+                                  short_type order,
+                                  std::vector<base_tensor> &t) const;
+
     /** Give the value of all components of the base functions at the
         current point of the fem_interpolation_context.  Used by
         elementary computations.  if withM is false the matrix M for
@@ -497,10 +507,44 @@ namespace getfem {
     void copy(const virtual_fem &f);
   };
 
+  typedef std::shared_ptr<const bgeot::polynomial_set_evaluator>
+  pcompiled_fem_base;
+
+  /* Compiled form of the base functions, only for plain polynomials
+     (see bgeot::polynomial_set_evaluator). */
+  template <class FUNC> inline pcompiled_fem_base
+  compile_fem_base(const std::vector<FUNC> &) { return pcompiled_fem_base(); }
+#ifndef GETFEM_HAVE_QDLIB
+  inline pcompiled_fem_base
+  compile_fem_base(const std::vector<bgeot::base_poly> &base)
+  { return std::make_shared<bgeot::polynomial_set_evaluator>(base); }
+#endif
+
+  /* Lazily built compiled form of the base functions of a fem. It is not
+     copied with the fem, since the base functions of a copy are usually
+     modified afterwards. p is published to the other threads by the
+     release store of computed. */
+  struct compiled_fem_base_ {
+    pcompiled_fem_base p;
+    std::atomic<bool> computed;
+    void reset()
+    { p.reset(); computed.store(false, std::memory_order_release); }
+    compiled_fem_base_() : computed(false) {}
+    compiled_fem_base_(const compiled_fem_base_ &) : computed(false) {}
+    compiled_fem_base_ &operator =(const compiled_fem_base_ &)
+    { reset(); return *this; }
+  };
+
   /**
      virtual_fem implementation as a vector of generic functions. The
      class FUNC should provide "derivative" and "eval" member
      functions (this is the case for bgeot::polynomial<T>).
+
+     For plain polynomials, the base functions are compiled at their first
+     evaluation into a dense coefficient matrix acting on the values of
+     the monomials (see bgeot::polynomial_set_evaluator), so that all the
+     base functions, gradients and hessians are evaluated at once, and at
+     a batch of points by a single matrix product.
   */
   template <class FUNC> class fem : public virtual_fem {
   protected :
@@ -508,6 +552,34 @@ namespace getfem {
     mutable std::vector<std::vector<FUNC>> grad_, hess_;
     mutable bool grad_computed_ = false;
     mutable bool hess_computed_ = false;
+    mutable compiled_fem_base_ compiled_;
+
+    const bgeot::polynomial_set_evaluator *compiled_base_() const {
+      if (!compiled_.computed.load(std::memory_order_acquire)) {
+        GLOBAL_OMP_GUARD
+        if (!compiled_.computed.load(std::memory_order_relaxed)) {
+          if (dim() > 0 && base_.size() == nb_base_components(0))
+            compiled_.p = compile_fem_base(base_);
+          compiled_.computed.store(true, std::memory_order_release);
+        }
+      }
+      return compiled_.p.get();
+    }
+
+    /* Work buffer of the evaluation at one point, one per thread, which
+       only grows. */
+    static scalar_type *work_(const bgeot::polynomial_set_evaluator *pc) {
+      THREAD_SAFE_STATIC std::vector<scalar_type> w;
+      if (w.size() < pc->work_size()) w.resize(pc->work_size());
+      return w.data();
+    }
+
+    void adjust_sizes_(short_type order, base_tensor &t) const {
+      bgeot::multi_index mi(2+order);
+      mi[0] = short_type(nb_base(0)); mi[1] = target_dim();
+      for (short_type k = 0; k < order; ++k) mi[2+k] = dim();
+      t.adjust_sizes(mi);
+    }
 
     void compute_grad_() const {
       if (grad_computed_) return;
@@ -548,13 +620,13 @@ namespace getfem {
 
     /// Gives the array of basic functions (components).
     const std::vector<FUNC> &base() const { return base_; }
-    std::vector<FUNC> &base() { return base_; }
+    std::vector<FUNC> &base() { compiled_.reset(); return base_; }
     /** Evaluates at point x, all base functions and returns the result in
         t(nb_base,target_dim) */
     void base_value(const base_node &x, base_tensor &t) const {
-      bgeot::multi_index mi(2);
-      mi[1] = target_dim(); mi[0] = short_type(nb_base(0));
-      t.adjust_sizes(mi);
+      adjust_sizes_(0, t);
+      const bgeot::polynomial_set_evaluator *pc = compiled_base_();
+      if (pc) { pc->eval(0, &(*(x.begin())), t.data(), work_(pc)); return; }
       size_type R = nb_base_components(0);
       base_tensor::iterator it = t.begin();
       for (size_type  i = 0; i < R; ++i, ++it)
@@ -564,6 +636,12 @@ namespace getfem {
         reference element directions 0,..,dim-1 and returns the result in
         t(nb_base,target_dim,dim) */
     void grad_base_value(const base_node &x, base_tensor &t) const {
+      const bgeot::polynomial_set_evaluator *pc = compiled_base_();
+      if (pc) {
+        adjust_sizes_(1, t);
+        pc->eval(1, &(*(x.begin())), t.data(), work_(pc));
+        return;
+      }
       if (!grad_computed_) compute_grad_();
       bgeot::multi_index mi(3);
       dim_type n = dim();
@@ -579,6 +657,12 @@ namespace getfem {
         reference element directions 0,..,dim-1 and returns the result in
         t(nb_base,target_dim,dim,dim) */
     void hess_base_value(const base_node &x, base_tensor &t) const {
+      const bgeot::polynomial_set_evaluator *pc = compiled_base_();
+      if (pc) {
+        adjust_sizes_(2, t);
+        pc->eval(2, &(*(x.begin())), t.data(), work_(pc));
+        return;
+      }
       if (!hess_computed_) compute_hess_();
       bgeot::multi_index mi(4);
       dim_type n = dim();
@@ -592,6 +676,29 @@ namespace getfem {
           for (size_type i = 0; i < R; ++i, ++it)
 	    *it = bgeot::to_scalar(hess_[i][j+k*n].eval(x.begin()));
     }
+    /** Evaluates at all the points of pts the base functions, their
+        gradients or their hessians, by a single matrix product for plain
+        polynomials. */
+    void base_value_batch(const bgeot::stored_point_tab &pts,
+                          short_type order,
+                          std::vector<base_tensor> &t) const {
+      const bgeot::polynomial_set_evaluator *pc = compiled_base_();
+      if (!pc || pts.empty())
+        { virtual_fem::base_value_batch(pts, order, t); return; }
+      size_type np = pts.size();
+      dim_type n = dim();
+      std::vector<scalar_type> x(np*n);
+      for (size_type i = 0; i < np; ++i)
+        std::copy(pts[i].begin(), pts[i].end(), x.begin() + i*n);
+      base_matrix res;
+      pc->eval(order, x.data(), np, res);
+      t.resize(np);
+      for (size_type i = 0; i < np; ++i) {
+        adjust_sizes_(order, t[i]);
+        std::copy(gmm::mat_col(res, i).begin(), gmm::mat_col(res, i).end(),
+                  t[i].begin());
+      }
+    }
 
   };
 
@@ -650,6 +757,13 @@ namespace getfem {
      Pre-computations on a fem (given a fixed set of points on the
      reference convex, this object computes the value/gradient/hessian
      of all base functions on this set of points and stores them.
+
+     The values are computed at the construction (for a fem defined on
+     the reference element), the gradients and hessians at their first
+     use, under a lock. The tables are never modified afterwards, so that
+     a fem_precomp_ can be shared by all the threads without
+     synchronization. The tables are stored point by point, as a
+     base_tensor for each point, since the callers use them as such.
   */
   class fem_precomp_ : virtual public dal::static_stored_object {
   protected:
@@ -658,16 +772,17 @@ namespace getfem {
     mutable std::vector<base_tensor> c;   // stored values of base functions
     mutable std::vector<base_tensor> pc;  // stored gradients of base functions
     mutable std::vector<base_tensor> hpc; // stored hessians of base functions
+    mutable std::atomic<bool> computed_[3];
   public:
     /// returns values of the base functions
     inline const base_tensor &val(size_type i) const
-      { if (c.empty()) init_val(); return c[i]; }
+      { if (!computed_[0]) init(0); return c[i]; }
     /// returns gradients of the base functions
     inline const base_tensor &grad(size_type i) const
-      { if (pc.empty()) init_grad(); return pc[i]; }
+      { if (!computed_[1]) init(1); return pc[i]; }
     /// returns hessians of the base functions
     inline const base_tensor &hess(size_type i) const
-      { if (hpc.empty()) init_hess(); return hpc[i]; }
+      { if (!computed_[2]) init(2); return hpc[i]; }
     inline pfem get_pfem() const { return pf; }
     // inline const bgeot::stored_point_tab& get_point_tab() const
     //  { return *pspt; }
@@ -676,9 +791,7 @@ namespace getfem {
     fem_precomp_(const pfem, const bgeot::pstored_point_tab);
     ~fem_precomp_() { DAL_STORED_OBJECT_DEBUG_DESTROYED(this, "Fem_precomp"); }
   private:
-    void init_val() const;
-    void init_grad() const;
-    void init_hess() const;
+    void init(short_type order) const;
   };
 
 
@@ -696,6 +809,9 @@ namespace getfem {
      points. This means that you should NOT alter its content at any
      time after using this function.
 
+     The object is searched among the ones stored by all the threads
+     before being built, so that the threads share the same tables.
+
      If you need a set of "temporary" getfem::fem_precomp_, create
      them via a getfem::fem_precomp_pool structure. All memory will be
      freed when this structure will be destroyed.  */
@@ -732,11 +848,9 @@ namespace getfem {
         points. This means that you should NOT alter its content until
         the fem_precomp_pool is destroyed.
     */
-    pfem_precomp operator()(pfem pf, bgeot::pstored_point_tab pspt) {
-      pfem_precomp p = fem_precomp(pf, pspt, 0);
-      precomps.insert(p);
-      return p;
-    }
+    pfem_precomp operator()(pfem pf, bgeot::pstored_point_tab pspt);
+    /** Delete the pfem_precomp built by the pool. The ones found in the
+        storage of the threads, which may be in use elsewhere, are kept. */
     void clear();
     ~fem_precomp_pool() { clear(); }
   };
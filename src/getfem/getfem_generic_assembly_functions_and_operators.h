@@ -75,6 +75,13 @@ namespace getfem {
                                    const std::string &der2);
   public:
     scalar_type operator()(scalar_type t_, scalar_type u_ = 0.) const;
+    /** Evaluation on n values: res[i] = f(t_[i*inct], u_[i*incu]) (a zero
+        increment repeats the same argument, u_ is not used for a function
+        of one argument). For a function defined by an expression, the
+        thread local data is fetched once for all the values. */
+    void operator()(size_type n, const scalar_type *t_, size_type inct,
+                    const scalar_type *u_, size_type incu,
+                    scalar_type *res) const;
 
     bool is_affine(const std::string &varname) const;
 
@@ -80,6 +80,11 @@ namespace getfem {
        in Gmsh, that which does not occur in GetFEM since there is
        only one "type of region".
 
+       The format 4.1 is read in ASCII as well as in binary, by a
+       streaming reader. Its nodes being identified by their tags, they
+       are added without search of duplicated points (the option
+       remove_duplicated_nodes only applies to the older formats).
+
 
       - "cdb" for meshes generated by ANSYS (in blocked format).
 
@@ -76,6 +76,10 @@ namespace getfem {
     { return (i == 0) ? primary_ : secondary_; }
     const std::vector<scalar_type> &values(unsigned i = 0) const
     { return (i == 0) ? primary_ : secondary_; }
+    /** Set the values of the level-set function (lsnum = 0) or of the
+        secondary one (lsnum = 1) to the interpolation of a signed
+        distance, evaluated on all the dofs at once. */
+    void set_values(const mesher_signed_distance &dist, unsigned lsnum = 0);
 
     pmesher_signed_distance mls_of_convex(size_type cv, unsigned lsnum = 0,
                                           bool inverted = false) const;
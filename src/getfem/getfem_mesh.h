@@ -39,7 +39,9 @@
 #define GETFEM_MESH_H__
 
 #include <bitset>
+#include <deque>
 #include "bgeot_ftool.h"
+#include "bgeot_binary_file.h"
 #include "bgeot_mesh.h"
 #include "bgeot_geotrans_inv.h"
 #include "getfem_context.h"
@@ -122,6 +124,15 @@ namespace getfem {
     mutable bool cuthill_mckee_uptodate;
     dal::dynamic_array<gmm::uint64_type> cvs_v_num;
     mutable std::vector<size_type> cmk_order; // cuthill-mckee
+    // Journal of the last renumberings of the convexes: for each of them,
+    // original index and original version number of each renumbered convex.
+    struct convex_renumbering {
+      gmm::uint64_type stamp;
+      std::vector<size_type> origin;
+      std::vector<gmm::uint64_type> v_num;
+    };
+    std::deque<convex_renumbering> cvs_renum;
+    gmm::uint64_type cvs_renum_dropped_stamp = 0;
     void init();
 
 #if GETFEM_PARA_LEVEL > 1
@@ -215,6 +226,13 @@ namespace getfem {
     gmm::uint64_type convex_version_number(size_type ic) const
     { return cvs_v_num[ic]; }
 
+    /** Return the index the convex ic had at the version v if it has only
+        been renumbered (by optimize_structure or renumber_convexes) since
+        this version, and size_type(-1) if not. Allows mesh_fem and mesh_im
+        to follow the renumberings. */
+    size_type renumbered_convex_origin(size_type ic,
+                                       gmm::uint64_type v) const;
+
     /** Add a convex to the mesh.
         This methods assume that the convex nodes have already been
         added to the mesh.
@@ -451,9 +469,23 @@ namespace getfem {
     /** Remove all references to a convex from all regions stored in the mesh.
      @param cv the convex number.*/
     void sup_convex_from_regions(size_type cv);
+    /** Renumbering strategies of optimize_structure. */
+    enum renumbering_method { CUTHILL_MCKEE, MORTON, HILBERT };
     /** Pack the mesh : renumber convexes and nodes such that there
-        is no holes in their numbering. Do NOT do the Cuthill-McKee. */
-    void optimize_structure(bool with_renumbering = true);
+        is no holes in their numbering. If with_renumbering is true, the
+        convexes are also renumbered either with the Cuthill-McKee
+        algorithm or along a Morton or Hilbert space filling curve of
+        their centroids (in that case, the points are also renumbered
+        along the curve). Regions are updated and the dependent mesh_fem
+        and mesh_im keep their methods on the renumbered convexes. */
+    void optimize_structure(bool with_renumbering = true,
+                            renumbering_method meth = CUTHILL_MCKEE);
+    /** Renumber the convexes such that the convex of index order[i]
+        becomes the convex of index i, order being a permutation of the
+        convex indices. The mesh is packed by the way. Regions are updated
+        and the dependent mesh_fem and mesh_im keep their methods on the
+        renumbered convexes. */
+    void renumber_convexes(const std::vector<size_type> &order);
     /// Return the list of convex IDs for a Cuthill-McKee ordering
     const std::vector<size_type> &cuthill_mckee_ordering() const;
     /// Erase the mesh.
@@ -476,6 +508,20 @@ namespace getfem {
         @see getfem::import_mesh.
     */
     void read_from_file(std::istream &ist);
+    /** Write the mesh to a binary file (see bgeot_binary_file.h), whose
+        loading is much faster than the one of the text format.
+        @param name the file name.
+    */
+    void write_to_binary_file(const std::string &name) const;
+    /** Write the sections of the mesh to an open binary file. */
+    void write_to_binary_file(bgeot::binary_file_writer &f) const;
+    /** Load the mesh from a binary file. read_from_file also detects the
+        binary files.
+        @param name the file name.
+    */
+    void read_from_binary_file(const std::string &name);
+    /** Load the mesh from the sections of an open binary file. */
+    void read_from_binary_file(const bgeot::binary_file_reader &f);
     /** Clone a mesh */
     void copy_from(const mesh& m); /* might be the copy constructor */
     size_type memsize() const;
@@ -483,6 +529,12 @@ namespace getfem {
     friend class mesh_region;
   private:
     void swap_convex_in_regions(size_type c1, size_type c2);
+    void start_convex_renumbering(std::vector<size_type> &,
+                                  std::vector<gmm::uint64_type> &) const;
+    void reorder_convexes(const std::vector<size_type> &,
+                          std::vector<size_type> &);
+    void end_convex_renumbering(const std::vector<size_type> &,
+                                const std::vector<gmm::uint64_type> &);
     void touch_from_region(size_type /*id*/) { touch(); }
     void to_edges() {} /* to be done, the to_edges of mesh_structure does   */
                        /* not handle geotrans */
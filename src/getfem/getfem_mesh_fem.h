@@ -152,6 +152,10 @@ namespace getfem {
 
     void copy_from(const mesh_fem &mf); /* Remember to change copy_from if
                                            adding components to mesh_fem */
+    /* Fast path of enumerate_dof identifying the dofs through the mesh
+       vertices. Returns false if it cannot be applied. A derived class
+       may disable it, the dofs being then identified with a kdtree. */
+    virtual bool enumerate_dof_by_topology() const;
 
     std::vector<pfem> f_elems;
     dal::bit_vector fe_convex;
@@ -632,6 +636,28 @@ namespace getfem {
         saved to the file.
     */
     void write_to_file(const std::string &name, bool with_mesh=false) const;
+    /** Write the finite element methods, the dof partition, the dof
+        enumeration and the reduction matrices to a binary file (see
+        bgeot_binary_file.h).
+
+        @param name the file name
+
+        @param with_mesh if set, then the linked_mesh() will also be
+        saved to the file.
+    */
+    void write_to_binary_file(const std::string &name,
+                              bool with_mesh=false) const;
+    /** Write the sections of the mesh_fem to an open binary file. Several
+        mesh_fems can be stored in the same file with different ids. */
+    void write_to_binary_file(bgeot::binary_file_writer &f,
+                              size_type id = 0) const;
+    /** Read the mesh_fem from a binary file. The dof enumeration is read,
+        not recomputed. read_from_file also detects the binary files.
+        @param name the file name. */
+    void read_from_binary_file(const std::string &name);
+    /** Read the mesh_fem from the sections of an open binary file. */
+    void read_from_binary_file(const bgeot::binary_file_reader &f,
+                               size_type id = 0);
   };
 
   /** Gives the descriptor of a classical finite element method of degree K
@@ -146,6 +146,26 @@ namespace getfem {
         saved to the file.
     */
     void write_to_file(const std::string &name, bool with_mesh=false) const;
+    /** Write the mesh_im to a binary file (see bgeot_binary_file.h).
+
+        @param name the file name
+
+        @param with_mesh if set, then the linked_mesh() will also be
+        saved to the file.
+    */
+    void write_to_binary_file(const std::string &name,
+                              bool with_mesh=false) const;
+    /** Write the sections of the mesh_im to an open binary file. Several
+        mesh_ims can be stored in the same file with different ids. */
+    void write_to_binary_file(bgeot::binary_file_writer &f,
+                              size_type id = 0) const;
+    /** Read the mesh_im from a binary file. read_from_file also detects
+        the binary files.
+        @param name the file name. */
+    void read_from_binary_file(const std::string &name);
+    /** Read the mesh_im from the sections of an open binary file. */
+    void read_from_binary_file(const bgeot::binary_file_reader &f,
+                               size_type id = 0);
   };
 
   /** Dummy mesh_im for default parameter of functions. */
@@ -66,13 +66,26 @@ namespace getfem {
 				   ignored (for instance because
 				   INTEGRATE_INSIDE and the convex
 				   is outside etc.) */
-    std::vector<pintegration_method> build_methods;
+    /* Configuration of a cut convex (see method_key_of_convex). The cut
+       convexes having the same configuration share the same integration
+       method, which is kept from one call of adapt to the next one. */
+    struct cut_method_key {
+      std::vector<dal::pstatic_stored_object> objects;
+      std::vector<scalar_type> values;
+      bool operator <(const cut_method_key &k) const {
+	if (objects != k.objects) return objects < k.objects;
+	return values < k.values;
+      }
+    };
+    std::map<cut_method_key, pintegration_method> build_methods;
+    std::string build_methods_csg; // csg description used by build_methods
 
     mutable bool is_adapted;
     int integrate_where; // INTEGRATE_INSIDE or INTEGRATE_OUTSIDE
 
     void clear_build_methods();
-    void build_method_of_convex(size_type cv);
+    void method_key_of_convex(size_type cv, cut_method_key &key) const;
+    pintegration_method build_method_of_convex(size_type cv);
 
     /* CSG (constructive solid geometry) description for the
        definition of the domain with respect to one or more levelsets.
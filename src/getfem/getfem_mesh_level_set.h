@@ -74,6 +74,9 @@ namespace getfem {
       pmesh pmsh;
       zoneset zones;
       mesh_region ls_border_faces;
+      // values of the level sets and vertices of the convex when it was
+      // cut (see adapt).
+      std::vector<scalar_type> ls_values;
       convex_info() : pmsh(0) {}
     };
 
@@ -107,7 +110,8 @@ namespace getfem {
 	res += sizeof(convex_info)
 	  + it->second.pmsh->memsize()
 	  + it->second.zones.size()
-	  * (level_sets.size() + sizeof(std::string *) + sizeof(std::string));
+	  * (level_sets.size() + sizeof(std::string *) + sizeof(std::string))
+	  + it->second.ls_values.size() * sizeof(scalar_type);
       }
       return res;
     }
@@ -131,8 +135,13 @@ namespace getfem {
 
     /** fill m with the (non-conformal) "cut" mesh. */
     void global_cut_mesh(mesh &m) const;
-    /** do all the work (cut the convexes wrt the levelsets) */
-    void adapt(void);
+    /** do all the work (cut the convexes wrt the levelsets). The convexes
+        are cut in parallel. If incremental is true, the sub-meshes and
+        zones of the convexes already cut by the previous call are kept
+        when the values of the level sets on them and their vertices did
+        not change, which avoids to cut again the whole mesh when the
+        level sets only move locally. */
+    void adapt(bool incremental = false);
     void merge_zoneset(zoneset &zones1, const zoneset &zones2) const;
     void merge_zoneset(zoneset &zones1, const std::string &subz) const;
     const std::string &primary_zone_of_convex(size_type cv) const
@@ -169,8 +178,10 @@ namespace getfem {
 			  scalar_type radius);
     int sub_simplex_is_not_crossed_by(size_type cv, plevel_set ls,
 				      size_type sub_cv, scalar_type radius);
-    void find_zones_of_element(size_type cv, std::string &prezone,
-			       scalar_type radius);
+    void find_zones_of_element(size_type cv, const std::string &prezone,
+			       scalar_type radius,
+			       std::vector<std::string> &subzones);
+    void convex_ls_values(size_type cv, std::vector<scalar_type> &v) const;
 
     /** For each levelset, if the convex cv is crossed, add the levelset number
 	into 'prim' (and 'sec' is the levelset has a secondary part).
@@ -0,0 +1,116 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*===========================================================================
+
+ Copyright (C) 2026 agent
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ As a special exception, you  may use  this file  as it is a part of a free
+ software  library  without  restriction.  Specifically,  if   other  files
+ instantiate  templates  or  use macros or inline functions from this file,
+ or  you compile this  file  and  link  it  with other files  to produce an
+ executable, this file  does  not  by itself cause the resulting executable
+ to be covered  by the GNU Lesser General Public License.  This   exception
+ does not  however  invalidate  any  other  reasons why the executable file
+ might be covered by the GNU Lesser General Public License.
+
+===========================================================================*/
+
+/**@file getfem_mesh_partition.h
+   @author  agent <agent@local>
+   @date 2026.
+   @brief Built-in partitioning of the convexes of a mesh.
+
+   The partitioner does not need any external library. An initial
+   partition is computed by a weighted recursive coordinate bisection of
+   the centroids of the convexes and is then improved by a few greedy
+   refinement passes on the dual graph of the mesh (two convexes are
+   connected if they share a face) in order to reduce the edge cut while
+   keeping the load balance.
+*/
+#ifndef GETFEM_MESH_PARTITION_H__
+#define GETFEM_MESH_PARTITION_H__
+
+#include "getfem_mesh_im.h"
+
+namespace getfem {
+
+  /** Quality measures of a partition of the convexes of a mesh. */
+  struct mesh_partition_statistics {
+    size_type nb_parts;
+    /// Number of pairs of neighbor convexes lying in different parts.
+    size_type edge_cut;
+    /// Total weight of each part.
+    std::vector<scalar_type> part_weight;
+    scalar_type max_weight, mean_weight;
+    /// Ratio of the heaviest part weight to the mean one (1 is optimal).
+    scalar_type imbalance() const
+    { return (mean_weight > scalar_type(0)) ? max_weight / mean_weight : 1; }
+    mesh_partition_statistics() : nb_parts(0), edge_cut(0),
+                                  max_weight(0), mean_weight(0) {}
+  };
+
+  /** Partition the convexes of a mesh into nb_parts parts.
+      @param m the mesh.
+      @param nb_parts the number of parts.
+      @param part on output, part[cv] is the part of the convex cv
+      (size_type(-1) for the unused convex indices).
+      @param weights the weights of the convexes, indexed by the convex
+      indices (unit weights if empty). See mesh_im_convex_weights.
+      @param nb_refinement_passes the number of greedy refinement passes
+      applied to the initial coordinate bisection.
+      @param max_imbalance maximal ratio of the heaviest part weight to
+      the mean one allowed by the refinement passes.
+  */
+  void partition_mesh(const mesh &m, size_type nb_parts,
+                      std::vector<size_type> &part,
+                      const std::vector<scalar_type> &weights
+                      = std::vector<scalar_type>(),
+                      size_type nb_refinement_passes = 4,
+                      scalar_type max_imbalance = scalar_type(1.05));
+
+  /** Compute the edge cut and the load balance of a partition. */
+  void partition_statistics(const mesh &m,
+                            const std::vector<size_type> &part,
+                            mesh_partition_statistics &stats,
+                            const std::vector<scalar_type> &weights
+                            = std::vector<scalar_type>());
+
+  /** Estimate of the assembly cost of each convex: the number of
+      integration points of the approximate integration method on
+      it (1 for the exact methods and 0 for the convexes without
+      integration method). */
+  void mesh_im_convex_weights(const mesh_im &mim,
+                              std::vector<scalar_type> &weights);
+
+  /** Partition the mesh and renumber its convexes part by part (see
+      mesh::renumber_convexes), such that the contiguous chunks of regions
+      dispatched to the threads of the parallel assembly correspond to
+      connected sets of convexes. If nb_parts is 0, the number of
+      partitions of the partition_master is used. The weights are given
+      for the numbering before the call and the statistics correspond to
+      the final partition.
+  */
+  void renumber_convexes_by_partition(mesh &m, size_type nb_parts = 0,
+                                      const std::vector<scalar_type> &weights
+                                      = std::vector<scalar_type>(),
+                                      mesh_partition_statistics *stats
+                                      = nullptr);
+
+}  /* end of namespace getfem.                                             */
+
+
+#endif /* GETFEM_MESH_PARTITION_H__  */
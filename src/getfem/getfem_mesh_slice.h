@@ -204,6 +204,8 @@ namespace getfem {
     void build(const getfem::mesh& m, const slicer_action &a,
                const slicer_action &b, const slicer_action &c, 
                size_type nrefine = 1) { build(m,&a,&b,&c,nrefine); }
+    /** Build the slice. The convexes are sliced in parallel when all the
+        slicer_action are thread safe (see slicer_action::thread_safe). */
     void build(const getfem::mesh& m, const slicer_action *a,
                const slicer_action *b, const slicer_action *c, 
                size_type nrefine);
@@ -238,6 +238,10 @@ namespace getfem {
   public:
     static const float EPS;
     virtual void exec(mesh_slicer &ms) = 0;
+    /** Return true if exec may be called simultaneously by several
+        threads, each one with its own mesh_slicer. The slicers having a
+        side effect on a shared object are not thread safe. */
+    virtual bool thread_safe() const { return false; }
     virtual ~slicer_action() {}
   };
 
@@ -246,6 +250,7 @@ namespace getfem {
   public:
     slicer_none() {}
     void exec(mesh_slicer &/*ms*/) {}
+    bool thread_safe() const { return true; }
     static slicer_none& static_instance();
   };
 
@@ -262,6 +267,7 @@ namespace getfem {
     slicer_boundary(const mesh& m,
                     slicer_action &sA = slicer_none::static_instance());
     void exec(mesh_slicer &ms);
+    bool thread_safe() const { return !A || A->thread_safe(); }
   };
 
   /* Apply a precomputed deformation to the slice nodes */
@@ -300,18 +306,21 @@ namespace getfem {
         untils no simplex crosses the boundary
     */
     int orient;
-    dal::bit_vector pt_in, pt_bin;    
+    /* nodes of the current convex inside the volume and on its boundary
+       (one copy per thread). */
+    omp_distribute<dal::bit_vector> pt_in, pt_bin;
     
     /** Overload either 'prepare' or 'test_point'.
      */
     virtual void prepare(size_type /*cv*/,
                          const mesh_slicer::cs_nodes_ct& nodes,
                          const dal::bit_vector& nodes_index) {
-      pt_in.clear(); pt_bin.clear();
+      dal::bit_vector &ptin = pt_in, &ptbin = pt_bin;
+      ptin.clear(); ptbin.clear();
       for (dal::bv_visitor i(nodes_index); !i.finished(); ++i) {
         bool in, bin; test_point(nodes[i].pt, in, bin);        
-        if (bin || ((orient > 0) ? !in : in)) pt_in.add(i);
-        if (bin) pt_bin.add(i);
+        if (bin || ((orient > 0) ? !in : in)) ptin.add(i);
+        if (bin) ptbin.add(i);
       }
     }
     virtual void test_point(const base_node&, bool& in, bool& bound) const
@@ -367,6 +376,7 @@ namespace getfem {
       slicer_volume(orient_), x0(x0_), n(n_/gmm::vect_norm2(n_)) {
         //n *= (1./bgeot::vect_norm2(n));
     }
+    bool thread_safe() const { return true; }
   };
 
   /**
@@ -386,7 +396,7 @@ namespace getfem {
       const base_node& B=nodes[iB].pt;
       scalar_type a,b,c; // a*x^2 + b*x + c = 0
       a = gmm::vect_norm2_sqr(B-A);
-      if (a < EPS) return pt_bin.is_in(iA) ? 0. : 1./EPS;
+      if (a < EPS) return pt_bin.thrd_cast().is_in(iA) ? 0. : 1./EPS;
       b = 2*gmm::vect_sp(A-x0,B-A);
       c = gmm::vect_norm2_sqr(A-x0)-R*R;
       return slicer_volume::trinom(a,b,c);
@@ -398,6 +408,7 @@ namespace getfem {
     slicer_sphere(base_node x0_, scalar_type R_, int orient_) : 
       slicer_volume(orient_), x0(x0_), R(R_) {}
     //cerr << "slicer_volume, x0=" << x0 << ", R=" << R << endl; }
+    bool thread_safe() const { return true; }
   };
   
   /**
@@ -429,7 +440,7 @@ namespace getfem {
       scalar_type Fd = gmm::vect_sp(F,d);
       scalar_type Dd = gmm::vect_sp(D,d);
       scalar_type a = gmm::vect_norm2_sqr(D) - gmm::sqr(Dd);
-      if (a < EPS) return pt_bin.is_in(iA) ? 0. : 1./EPS;
+      if (a < EPS) return pt_bin.thrd_cast().is_in(iA) ? 0. : 1./EPS;
       assert(a> -EPS);
       scalar_type b = 2*(gmm::vect_sp(F,D) - Fd*Dd);
       scalar_type c = gmm::vect_norm2_sqr(F) - gmm::sqr(Fd) - gmm::sqr(R);
@@ -440,6 +451,7 @@ namespace getfem {
       slicer_volume(orient_), x0(x0_), d(x1_-x0_), R(R_) {
       d /= gmm::vect_norm2(d);
     }
+    bool thread_safe() const { return true; }
   };
 
 
@@ -450,15 +462,16 @@ namespace getfem {
     std::unique_ptr<const mesh_slice_cv_dof_data_base> mfU;
     scalar_type val;
     scalar_type val_scaling; /* = max(abs(U)) */
-    std::vector<scalar_type> Uval;
+    omp_distribute<std::vector<scalar_type>> Uval;
     void prepare(size_type cv, const mesh_slicer::cs_nodes_ct& nodes,
                  const dal::bit_vector& nodes_index);
     scalar_type edge_intersect(size_type iA, size_type iB,
                                const mesh_slicer::cs_nodes_ct&) const {
-      assert(iA < Uval.size() && iB < Uval.size());
-      if (((Uval[iA] < val) && (Uval[iB] > val)) ||
-          ((Uval[iA] > val) && (Uval[iB] < val)))
-        return (val-Uval[iA])/(Uval[iB]-Uval[iA]);
+      const std::vector<scalar_type> &U = Uval;
+      assert(iA < U.size() && iB < U.size());
+      if (((U[iA] < val) && (U[iB] > val)) ||
+          ((U[iA] > val) && (U[iB] < val)))
+        return (val-U[iA])/(U[iB]-U[iA]);
       else return 1./EPS;
     }
   public:
@@ -470,6 +483,7 @@ namespace getfem {
                   "can't compute isovalues of a vector field !");
         val_scaling = mfU->maxval();
     }
+    bool thread_safe() const { return true; }
   };
   
   /** 
@@ -498,6 +512,7 @@ namespace getfem {
     slicer_union(const slicer_action &sA, const slicer_action &sB) : 
       A(&const_cast<slicer_action&>(sA)), B(&const_cast<slicer_action&>(sB)) {}
     void exec(mesh_slicer &ms);
+    bool thread_safe() const { return A->thread_safe() && B->thread_safe(); }
   };
 
   /**
@@ -508,6 +523,7 @@ namespace getfem {
   public:
     slicer_intersect(slicer_action &sA, slicer_action &sB) : A(&sA), B(&sB) {}
     void exec(mesh_slicer &ms);
+    bool thread_safe() const { return A->thread_safe() && B->thread_safe(); }
   };
 
   /**
@@ -518,6 +534,7 @@ namespace getfem {
   public:
     slicer_complementary(slicer_action &sA) : A(&sA) {}
     void exec(mesh_slicer &ms);
+    bool thread_safe() const { return A->thread_safe(); }
   };
   
   /**
@@ -582,6 +599,7 @@ namespace getfem {
     */
     slicer_explode(scalar_type c) : coef(c) {}
     void exec(mesh_slicer &ms);
+    bool thread_safe() const { return true; }
   };
 
 }
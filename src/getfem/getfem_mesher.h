@@ -46,6 +46,7 @@
 #include "getfem_export.h"
 #include "bgeot_kdtree.h"
 #include <typeinfo>
+#include <atomic>
 
 namespace getfem {
 
@@ -83,6 +84,16 @@ namespace getfem {
     virtual void register_constraints(std::vector<const
 				      mesher_signed_distance*>& list) const=0;
     virtual scalar_type operator()(const base_node &P) const  = 0;
+    /** Evaluation of the signed distance on nb points of dimension N
+	given in structure of arrays layout (X[k*nb+i] is the k-th
+	coordinate of the i-th point). The default implementation calls
+	operator() on each point. */
+    virtual void batch_eval(size_type N, size_type nb, const scalar_type *X,
+			    scalar_type *d) const;
+    /** Same as batch_eval, the gradients being stored in G with the
+	layout of X. */
+    virtual void batch_grad(size_type N, size_type nb, const scalar_type *X,
+			    scalar_type *d, scalar_type *G) const;
   };
 
   typedef std::shared_ptr<const mesher_signed_distance> pmesher_signed_distance;
@@ -112,6 +123,10 @@ namespace getfem {
       G = n; G *= scalar_type(-1); 
       return xon - gmm::vect_sp(P,n);
     }
+    void batch_eval(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d) const;
+    void batch_grad(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d, scalar_type *G) const;
     void hess(const base_node &P, base_matrix &H) const {
       gmm::resize(H, P.size(), P.size()); gmm::clear(H);
     }
@@ -127,14 +142,15 @@ namespace getfem {
     mutable std::vector<base_poly> gradient;
     mutable std::vector<base_poly> hessian;
     const fem<base_poly> *pf;
-    mutable int initialized;
+    mutable std::atomic<int> initialized; // 1: gradient, 2: hessian built
     scalar_type shift_ls;     // for the computation of a gap on a level_set.
   public:
-    bool is_initialized(void) const { return initialized; }
+    bool is_initialized(void) const
+    { return initialized.load(std::memory_order_acquire) != 0; }
     mesher_level_set() : initialized(0) {}
     template <typename VECT>
     mesher_level_set(pfem pf_, const VECT &coeff_,
-		     scalar_type shift_ls_ = scalar_type(0)) {
+		     scalar_type shift_ls_ = scalar_type(0)) : initialized(0) {
       init_base(pf_, coeff_);
       set_shift(shift_ls_);
     }
@@ -176,7 +192,7 @@ namespace getfem {
     for (unsigned i=0; i < pf->nb_base(0); ++i) {
       base += pf->base()[i] * coeff[i];
     }
-    initialized = 0; 
+    initialized.store(0, std::memory_order_release);
   }
 
   template <typename VECT> 
@@ -214,6 +230,10 @@ namespace getfem {
       G /= e;
       return d;
     }
+    void batch_eval(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d) const;
+    void batch_grad(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d, scalar_type *G) const;
     void hess(const base_node &, base_matrix &) const {
       GMM_ASSERT1(false, "Sorry, to be done");
     }
@@ -267,6 +287,10 @@ namespace getfem {
       }
       return hfs[i].grad(P, G);
     }
+    void batch_eval(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d) const;
+    void batch_grad(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d, scalar_type *G) const;
     void hess(const base_node &P, base_matrix &H) const {
       gmm::resize(H, P.size(), P.size()); gmm::clear(H);
     }
@@ -407,13 +431,24 @@ namespace getfem {
 
   class mesher_union : public mesher_signed_distance {
     std::vector<pmesher_signed_distance> dists;
-    mutable std::vector<scalar_type> vd;
-    mutable bool isin;
     bool with_min;
+    scalar_type smooth_union(const base_node &P, std::vector<scalar_type> &vd,
+			     bool &isin) const {
+      scalar_type f(0), g(1);
+      isin = false;
+      for (size_type k = 0; k < dists.size(); ++k) {
+	vd[k] = (*(dists[k]))(P);
+	if (vd[k] <= scalar_type(0)) isin = true;
+	f += gmm::sqr(gmm::neg(vd[k]));
+	g *= gmm::pos(vd[k]);
+      }
+      return isin ? -gmm::sqrt(f)
+	: pow(g, scalar_type(1) / scalar_type(dists.size()));
+    }
   public:
     mesher_union(const std::vector<pmesher_signed_distance>
 			&dists_) : dists(dists_) 
-    { vd.resize(dists.size()); with_min = true; }
+    { with_min = true; }
 
     mesher_union
     (const pmesher_signed_distance &a,
@@ -456,7 +491,6 @@ namespace getfem {
       if (r) dists.push_back(r);
       if (s) dists.push_back(s);
       if (t) dists.push_back(t);
-      vd.resize(dists.size());
     }
     
     bool bounding_box(base_node &bmin, base_node &bmax) const {
@@ -474,26 +508,21 @@ namespace getfem {
       return true;
     }
     virtual scalar_type operator()(const base_node &P) const {
-      scalar_type d, f(0), g(1);
+      scalar_type d;
       if (with_min) {
 	d = (*(dists[0]))(P);
 	for (size_type k = 1; k < dists.size(); ++k)
 	  d = std::min(d, (*(dists[k]))(P));
       }
       else { // essai raté ...
-	isin = false;
-	for (size_type k = 0; k < dists.size(); ++k) {
-	  vd[k] = (*(dists[k]))(P);
-	  if (vd[k] <= scalar_type(0)) isin = true;
-	  f += gmm::sqr(gmm::neg(vd[k]));
-	  g *= gmm::pos(vd[k]);
-	}
-	d = isin ? -gmm::sqrt(f)
-	  : pow(g, scalar_type(1) / scalar_type(dists.size()));
+	std::vector<scalar_type> vd(dists.size());
+	bool isin;
+	d = smooth_union(P, vd, isin);
       }
       return d;
     }
     scalar_type operator()(const base_node &P, dal::bit_vector &bv) const {
+      std::vector<scalar_type> vd(dists.size());
       if (with_min) {
 	scalar_type d = vd[0] = (*(dists[0]))(P);
 	bool ok = (d > -SEPS);
@@ -535,7 +564,9 @@ namespace getfem {
 	return dists[i]->grad(P, G);
       }
       else { // essai raté ...
-	d = operator()(P);
+	std::vector<scalar_type> vd(dists.size());
+	bool isin;
+	d = smooth_union(P, vd, isin);
 	base_small_vector Gloc;
 	for (size_type k = 0; k < dists.size(); ++k) {
 	  dists[k]->grad(P, Gloc);
@@ -552,6 +583,10 @@ namespace getfem {
 	return d;
       }
     }
+    void batch_eval(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d) const;
+    void batch_grad(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d, scalar_type *G) const;
     void hess(const base_node &P, base_matrix &H) const {
       scalar_type d = (*(dists[0]))(P);
       if (with_min || gmm::abs(d) < SEPS) {
@@ -601,14 +636,12 @@ namespace getfem {
 
   class mesher_intersection : public mesher_signed_distance {
     std::vector<pmesher_signed_distance> dists;
-    mutable std::vector<scalar_type> vd;
 
     // const mesher_signed_distance &a, &b;
   public:
     
     mesher_intersection(const std::vector<pmesher_signed_distance>
-			&dists_) : dists(dists_) 
-    { vd.resize(dists.size()); }
+			&dists_) : dists(dists_) {}
     
     mesher_intersection
     (const pmesher_signed_distance &a,
@@ -650,7 +683,6 @@ namespace getfem {
       if (r) dists.push_back(r);
       if (s) dists.push_back(s);
       if (t) dists.push_back(t);
-      vd.resize(dists.size());
     }
     bool bounding_box(base_node &bmin, base_node &bmax) const {
       base_node bmin2, bmax2;
@@ -675,6 +707,7 @@ namespace getfem {
 
     }
     scalar_type operator()(const base_node &P, dal::bit_vector &bv) const {
+      std::vector<scalar_type> vd(dists.size());
       scalar_type d = vd[0] = (*(dists[0]))(P);
       bool ok = (d < SEPS);
       for (size_type k = 1; k < dists.size(); ++k) {
@@ -701,6 +734,10 @@ namespace getfem {
       }
       return dists[i]->grad(P, G);
     }
+    void batch_eval(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d) const;
+    void batch_grad(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d, scalar_type *G) const;
     void hess(const base_node &P, base_matrix &H) const {
       scalar_type d = (*(dists[0]))(P);
       size_type i = 0;
@@ -769,6 +806,10 @@ namespace getfem {
       if (da > db) return a->grad(P, G);
       else { b->grad(P, G); G *= scalar_type(-1); return db; }
     }
+    void batch_eval(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d) const;
+    void batch_grad(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d, scalar_type *G) const;
     void hess(const base_node &P, base_matrix &H) const {
       scalar_type da = (*a)(P), db = -(*b)(P);
       if (da > db) a->hess(P, H);
@@ -817,6 +858,10 @@ namespace getfem {
       G /= e;
       return d;
     }
+    void batch_eval(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d) const;
+    void batch_grad(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d, scalar_type *G) const;
     void hess(const base_node &, base_matrix &) const {
       GMM_ASSERT1(false, "Sorry, to be done");
     }
@@ -854,6 +899,12 @@ namespace getfem {
     { return (*i1)(P, bv); }
     scalar_type grad(const base_node &P, base_small_vector &G) const
       { return i1->grad(P, G); }
+    void batch_eval(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d) const
+    { i1->batch_eval(N, nb, X, d); }
+    void batch_grad(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d, scalar_type *G) const
+    { i1->batch_grad(N, nb, X, d, G); }
     void hess(const base_node &, base_matrix &) const {
       GMM_ASSERT1(false, "Sorry, to be done");
     }
@@ -946,6 +997,12 @@ namespace getfem {
     { return (*i1)(P, bv); }
     scalar_type grad(const base_node &P, base_small_vector &G) const
       { return i1->grad(P, G); }
+    void batch_eval(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d) const
+    { i1->batch_eval(N, nb, X, d); }
+    void batch_grad(size_type N, size_type nb, const scalar_type *X,
+		    scalar_type *d, scalar_type *G) const
+    { i1->batch_grad(N, nb, X, d, G); }
     void hess(const base_node &, base_matrix &) const {
       GMM_ASSERT1(false, "Sorry, to be done");
     }
@@ -1069,6 +1126,7 @@ namespace getfem {
   { return std::make_shared<mesher_torus>(R,r); }
   
   // mesher
+  // (the signed distance is evaluated in parallel when OpenMP is enabled)
   void build_mesh(mesh &m, const pmesher_signed_distance& dist_,
 		  scalar_type h0, const std::vector<base_node> &fixed_points
 		  = std::vector<base_node>(), size_type K = 1, int noise = -1,
@@ -1087,6 +1145,11 @@ namespace getfem {
   scalar_type min_curvature_radius_estimate
   (const std::vector<const mesher_signed_distance*> &list_constraints,
    const base_node &X, const dal::bit_vector &cts, size_type hide_first = 0);
+  /** Signed distance on a set of points, evaluated by blocks of points
+      with batch_eval (and in parallel when OpenMP is enabled). */
+  void signed_distance_of_points(const mesher_signed_distance &dist,
+				 const std::vector<base_node> &pts,
+				 std::vector<scalar_type> &d);
 
 }
 
@@ -83,6 +83,15 @@ namespace getfem {
     typedef VECT VECTOR;
     virtual void operator ()(const MAT &, VECT &, const VECT &,
                              gmm::iteration &) const = 0;
+    /* Solve M x[i] = b[i] for several right hand sides. The direct solvers
+       factorize the matrix only once and the iterative ones build their
+       preconditioner only once. */
+    virtual void solve_multiple_rhs(const MAT &M, std::vector<VECT> &x,
+                                    const std::vector<VECT> &b,
+                                    gmm::iteration &iter) const {
+      for (size_type i = 0; i < b.size(); ++i)
+        { iter.init(); (*this)(M, x[i], b[i], iter); }
+    }
     virtual ~abstract_linear_solver() {}
   };
 
@@ -95,6 +104,15 @@ namespace getfem {
       gmm::cg(M, x, b, P, iter);
       if (!iter.converged()) GMM_WARNING2("cg did not converge!");
     }
+    void solve_multiple_rhs(const MAT &M, std::vector<VECT> &x,
+                            const std::vector<VECT> &b,
+                            gmm::iteration &iter) const {
+      gmm::ildlt_precond<MAT> P(M);
+      for (size_type i = 0; i < b.size(); ++i) {
+        iter.init(); gmm::cg(M, x[i], b[i], P, iter);
+        if (!iter.converged()) GMM_WARNING2("cg did not converge!");
+      }
+    }
   };
 
   template <typename MAT, typename VECT>
@@ -106,6 +124,15 @@ namespace getfem {
       gmm::gmres(M, x, b, P, 500, iter);
       if (!iter.converged()) GMM_WARNING2("gmres did not converge!");
     }
+    void solve_multiple_rhs(const MAT &M, std::vector<VECT> &x,
+                            const std::vector<VECT> &b,
+                            gmm::iteration &iter) const {
+      gmm::ilu_precond<MAT> P(M);
+      for (size_type i = 0; i < b.size(); ++i) {
+        iter.init(); gmm::gmres(M, x[i], b[i], P, 500, iter);
+        if (!iter.converged()) GMM_WARNING2("gmres did not converge!");
+      }
+    }
   };
 
   template <typename MAT, typename VECT>
@@ -117,6 +144,15 @@ namespace getfem {
       gmm::gmres(M, x, b, P, 500, iter);
       if (!iter.converged()) GMM_WARNING2("gmres did not converge!");
     }
+    void solve_multiple_rhs(const MAT &M, std::vector<VECT> &x,
+                            const std::vector<VECT> &b,
+                            gmm::iteration &iter) const {
+      gmm::identity_matrix P;
+      for (size_type i = 0; i < b.size(); ++i) {
+        iter.init(); gmm::gmres(M, x[i], b[i], P, 500, iter);
+        if (!iter.converged()) GMM_WARNING2("gmres did not converge!");
+      }
+    }
   };
 
   template <typename MAT, typename VECT>
@@ -128,6 +164,15 @@ namespace getfem {
       gmm::gmres(M, x, b, P, 500, iter);
       if (!iter.converged()) GMM_WARNING2("gmres did not converge!");
     }
+    void solve_multiple_rhs(const MAT &M, std::vector<VECT> &x,
+                            const std::vector<VECT> &b,
+                            gmm::iteration &iter) const {
+      gmm::ilut_precond<MAT> P(M, 40, 1E-7);
+      for (size_type i = 0; i < b.size(); ++i) {
+        iter.init(); gmm::gmres(M, x[i], b[i], P, 500, iter);
+        if (!iter.converged()) GMM_WARNING2("gmres did not converge!");
+      }
+    }
   };
 
   template <typename MAT, typename VECT>
@@ -139,6 +184,15 @@ namespace getfem {
       gmm::gmres(M, x, b, P, 500, iter);
       if (!iter.converged()) GMM_WARNING2("gmres did not converge!");
     }
+    void solve_multiple_rhs(const MAT &M, std::vector<VECT> &x,
+                            const std::vector<VECT> &b,
+                            gmm::iteration &iter) const {
+      gmm::ilutp_precond<MAT> P(M, 20, 1E-7);
+      for (size_type i = 0; i < b.size(); ++i) {
+        iter.init(); gmm::gmres(M, x[i], b[i], P, 500, iter);
+        if (!iter.converged()) GMM_WARNING2("gmres did not converge!");
+      }
+    }
   };
 
   template <typename MAT, typename VECT>
@@ -154,6 +208,14 @@ namespace getfem {
       iter.enforce_converged(info == 0);
       if (iter.get_noisy()) cout << "condition number: " << 1.0/rcond<< endl;
     }
+    void solve_multiple_rhs(const MAT &M, std::vector<VECT> &x,
+                            const std::vector<VECT> &b,
+                            gmm::iteration &iter) const {
+      double rcond;
+      int info = SuperLU_solve_multiple_rhs(M, x, b, rcond);
+      iter.enforce_converged(info == 0);
+      if (iter.get_noisy()) cout << "condition number: " << 1.0/rcond<< endl;
+    }
   };
 
   template <typename MAT, typename VECT>
@@ -166,6 +228,19 @@ namespace getfem {
       gmm::lu_solve(MM, x, b);
       iter.enforce_converged(true);
     }
+    void solve_multiple_rhs(const MAT &M, std::vector<VECT> &x,
+                            const std::vector<VECT> &b,
+                            gmm::iteration &iter) const {
+      typedef typename gmm::linalg_traits<MAT>::value_type T;
+      gmm::dense_matrix<T> MM(gmm::mat_nrows(M),gmm::mat_ncols(M));
+      gmm::copy(M, MM);
+      gmm::lapack_ipvt ipvt(gmm::mat_nrows(M));
+      size_type info = gmm::lu_factor(MM, ipvt);
+      GMM_ASSERT1(!info, "Singular system, pivot = " << info);
+      for (size_type i = 0; i < b.size(); ++i)
+        gmm::lu_solve(MM, ipvt, x[i], b[i]);
+      iter.enforce_converged(true);
+    }
   };
 
 #ifdef GMM_USES_MUMPS
@@ -176,6 +251,12 @@ namespace getfem {
       bool ok = gmm::MUMPS_solve(M, x, b, false);
       iter.enforce_converged(ok);
     }
+    void solve_multiple_rhs(const MAT &M, std::vector<VECT> &x,
+                            const std::vector<VECT> &b,
+                            gmm::iteration &iter) const {
+      bool ok = gmm::MUMPS_solve_multiple_rhs(M, x, b, false);
+      iter.enforce_converged(ok);
+    }
   };
   template <typename MAT, typename VECT>
   struct linear_solver_mumps_sym : public abstract_linear_solver<MAT, VECT> {
@@ -184,6 +265,12 @@ namespace getfem {
       bool ok = gmm::MUMPS_solve(M, x, b, true);
       iter.enforce_converged(ok);
     }
+    void solve_multiple_rhs(const MAT &M, std::vector<VECT> &x,
+                            const std::vector<VECT> &b,
+                            gmm::iteration &iter) const {
+      bool ok = gmm::MUMPS_solve_multiple_rhs(M, x, b, true);
+      iter.enforce_converged(ok);
+    }
   };
 #endif
 
@@ -1098,6 +1098,25 @@ namespace getfem {
     */
     virtual void next_iter();
 
+    /** Write the state of the model to a binary file (see
+        bgeot_binary_file.h): all the versions of the variables and data
+        (including the previous time steps stored for the time integration
+        schemes and the internal variables on im_data), the layout of their
+        mesh_fem or im_data, a checksum of each vector and the time
+        integration parameters. The affine dependent variables are not
+        stored.
+    */
+    void write_checkpoint(const std::string &name) const;
+    void write_checkpoint(bgeot::binary_file_writer &f) const;
+    /** Restore the state written by write_checkpoint. The model should have
+        been built in the same way (same variables, on the same mesh_fems
+        and im_data). The variables of the model absent from the file are
+        left unchanged. The whole file is checked before the model is
+        modified: if an error is raised, the model is left unchanged.
+    */
+    void read_checkpoint(const std::string &name);
+    void read_checkpoint(const bgeot::binary_file_reader &f);
+
     /** Add an interpolate transformation to the model to be used with the
         generic assembly.
     */
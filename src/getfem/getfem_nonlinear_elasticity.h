@@ -642,12 +642,17 @@ namespace getfem {
       to the model with respect to the variable
       `varname` (the displacement).
       For 2D meshes, switch automatically to plane strain elasticity.
-      High-level generic assembly version.
+      High-level generic assembly version. If `closed_form` is true and
+      the law has a closed form first Piola-Kirchhoff stress operator
+      (all the laws except Generalized_Blatz_Ko), the term is expressed
+      with it, which gives directly the stress and the tangent from
+      Grad_u. Otherwise, it is expressed with the second Piola-Kirchhoff
+      stress operator of the law.
   */
   size_type add_finite_strain_elasticity_brick
   (model &md, const mesh_im &mim, const std::string &lawname,
    const std::string &varname, const std::string &params,
-   size_type region = size_type(-1));
+   size_type region = size_type(-1), bool closed_form = true);
 
 
   /** Add a finite strain incompressibility term (for large strain elasticity)
@@ -453,7 +453,7 @@ namespace getfem
   };
 
   #ifdef __GNUC__
-    #define pragma_op(arg) _Pragma("arg")
+    #define pragma_op(arg) _Pragma(#arg)
   #else
     #define pragma_op(arg) __pragma(arg)
   #endif
@@ -472,7 +472,7 @@ namespace getfem
 
     /**execute for loop in parallel. Not iterating over partitions*/
     #define GETFEM_OMP_FOR(init, check, increment, body) {\
-      auto boilerplate = getfem::parallel_boilerplate{};  \
+      getfem::parallel_boilerplate boilerplate;           \
       pragma_op(omp parallel for)                         \
       for (init; check; increment){                       \
         boilerplate.run_lambda([&](){body;});              \
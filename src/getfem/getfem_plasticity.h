@@ -149,6 +149,11 @@ namespace getfem {
       of the previous time step (typically "u" to "Previous_u").
       It has to be called before any use of
       `compute_small_strain_elastoplasticity_Von_Mises`.
+      With `unknowns_type = DISPLACEMENT_ONLY` and when the plastic strain,
+      the plastic multiplier and (if any) the accumulated plastic strain
+      are all stored on im_data of the same mesh_im and region, the return
+      mapping is computed directly on the integration points, by blocks of
+      points and in parallel, instead of by the generic assembly.
    */
   void small_strain_elastoplasticity_next_iter
   (model &md, const mesh_im &mim,
@@ -50,7 +50,8 @@
 namespace gmm {
 
   template<typename T>
-  int SuperLU_solve(const gmm::csc_matrix<T> &A, T *X_, T *B, double& rcond_, int permc_spec = 3);
+  int SuperLU_solve(const gmm::csc_matrix<T> &A, T *X_, T *B, double& rcond_,
+                    int permc_spec = 3, int nrhs = 1);
   /** solve a sparse linear system AX=B (float, double, complex<float>
       or complex<double>) via SuperLU.
 
@@ -59,6 +60,8 @@ namespace gmm {
       @param B the right hand side.
       @param rcond_ contains on output an estimate of the condition number of A.
       @param permc_spec specify the kind of renumbering than SuperLU should do.
+      @param nrhs number of right hand sides, stored one after the other
+      in X and B (for the first signature only).
   */
   template<typename MAT, typename V1, typename V2>
   int SuperLU_solve(const MAT &A, const V1& X, const V2& B, double& rcond_, int permc_spec = 3) {
@@ -74,6 +77,30 @@ namespace gmm {
     gmm::copy(sol, const_cast<V1 &>(X));
     return info;
   }
+
+  /** solve a sparse linear system AX_i=B_i for several right hand sides
+      with a single factorization of A. */
+  template<typename MAT, typename V1, typename V2>
+  int SuperLU_solve_multiple_rhs(const MAT &A, std::vector<V1> &X,
+                                 const std::vector<V2> &B, double& rcond_,
+                                 int permc_spec = 3) {
+    typedef typename gmm::linalg_traits<MAT>::value_type T;
+
+    int m = int(mat_nrows(A)), n = int(mat_ncols(A)), nrhs = int(B.size());
+    GMM_ASSERT1(X.size() == B.size(), "dimensions mismatch");
+    if (nrhs == 0) return 0;
+    gmm::csc_matrix<T> csc_A(m,n);
+    gmm::copy(A,csc_A);
+    std::vector<T> rhs(m*nrhs), sol(m*nrhs);
+    for (int i = 0; i < nrhs; ++i)
+      gmm::copy(B[i], gmm::sub_vector(rhs, gmm::sub_interval(i*m, m)));
+
+    int info = SuperLU_solve(csc_A, &sol[0], &rhs[0], rcond_, permc_spec,
+                             nrhs);
+    for (int i = 0; i < nrhs; ++i)
+      gmm::copy(gmm::sub_vector(sol, gmm::sub_interval(i*m, m)), X[i]);
+    return info;
+  }
   
   struct SuperLU_factor_impl_common;
 
@@ -0,0 +1,188 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*===========================================================================
+
+ Copyright (C) 2026 agent
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ As a special exception, you  may use  this file  as it is a part of a free
+ software  library  without  restriction.  Specifically,  if   other  files
+ instantiate  templates  or  use macros or inline functions from this file,
+ or  you compile this  file  and  link  it  with other files  to produce an
+ executable, this file  does  not  by itself cause the resulting executable
+ to be covered  by the GNU Lesser General Public License.  This   exception
+ does not  however  invalidate  any  other  reasons why the executable file
+ might be covered by the GNU Lesser General Public License.
+
+===========================================================================*/
+
+
+/**@file getfem_time_series.h
+   @author  agent <agent@local>
+   @date 2026.
+   @brief Binary container for the results of a time dependent computation.
+
+   A time series is a binary file (see bgeot_binary_file.h) which stores
+   once the mesh and the descriptions (mesh_fem or im_data) of a set of
+   fields, and then the values of these fields for each time step. The
+   values of a field at a given step are stored in their own section, so
+   that the reader accesses them directly, without reading the other
+   steps and fields. On POSIX systems the file is mapped in memory and the
+   uncompressed values are accessed without copy.
+
+   The steps are appended to the file as the computation goes on. The
+   table of contents is written by flush() and close(), a file being
+   readable up to the last call of flush() if the computation is
+   interrupted.
+
+   All the fields described by a mesh_fem or an im_data should be defined
+   on the same mesh.
+*/
+#ifndef GETFEM_TIME_SERIES_H__
+#define GETFEM_TIME_SERIES_H__
+
+#include "getfem_mesh_fem.h"
+#include "getfem_im_data.h"
+
+namespace getfem {
+
+  class model;
+
+  /** Writing of a time series. */
+  class time_series_writer {
+    bgeot::binary_file_writer f;
+    const mesh *pmesh;
+    std::vector<const mesh_fem *> mfs;
+    std::vector<const mesh_im *> mims;
+    std::vector<std::string> names;
+    size_type nb_steps_;
+
+    void set_mesh(const mesh &m);
+    size_type new_field(const std::string &name,
+                        const std::vector<gmm::uint64_type> &desc);
+    void write_field_data(size_type i, const void *data, size_type nb,
+                          size_type elem_size);
+
+  public:
+    /** Declare a field defined on a mesh_fem. Return its index. */
+    size_type add_field(const std::string &name, const mesh_fem &mf);
+    /** Declare a field defined on the integration points of an im_data. */
+    size_type add_field(const std::string &name, const im_data &imd);
+    /** Declare a field without description (a vector of any size). */
+    size_type add_field(const std::string &name);
+    /** Declare the variables of a model (and its data if with_data is
+        set) as fields, except for the affine dependent ones. The fields
+        already declared are skipped. */
+    void add_model_variables(const model &md, bool with_data = false);
+
+    /** Index of a field, or size_type(-1) if there is no such field. */
+    size_type field_index(const std::string &name) const;
+    size_type nb_fields() const { return names.size(); }
+
+    /** Begin a new step at time t. Return its number. */
+    size_type new_step(scalar_type t);
+    size_type nb_steps() const { return nb_steps_; }
+
+    /** Write the value of the field i for the current step. */
+    void write_field(size_type i, const std::vector<scalar_type> &V)
+    { write_field_data(i, V.data(), V.size(), sizeof(scalar_type)); }
+    void write_field(size_type i, const std::vector<complex_type> &V)
+    { write_field_data(i, V.data(), V.size(), sizeof(complex_type)); }
+    template <typename VECT> void write_field(size_type i, const VECT &V) {
+      std::vector<typename gmm::linalg_traits<VECT>::value_type>
+        W(gmm::vect_size(V));
+      gmm::copy(V, W);
+      write_field(i, W);
+    }
+    template <typename VECT>
+    void write_field(const std::string &name, const VECT &V) {
+      size_type i = field_index(name);
+      GMM_ASSERT1(i != size_type(-1), "Undeclared field " << name);
+      write_field(i, V);
+    }
+    /** Write the current value of the fields which are variables of the
+        model for the current step. */
+    void write_model_variables(const model &md);
+
+    /** Write the table of contents. The file is then readable, and steps
+        can still be appended. */
+    void flush() { f.flush(); }
+    void close() { f.close(); }
+
+    /** Create the file. If compress is set (only possible when GetFEM is
+        built with zlib), the values are compressed with zlib by blocks. */
+    explicit time_series_writer(const std::string &name,
+                                bool compress = false);
+  };
+
+  /** Reading of a time series. */
+  class time_series_reader {
+    bgeot::binary_file_reader f;
+    std::vector<std::string> names;
+    std::vector<std::vector<gmm::uint64_type>> descs;
+    std::vector<scalar_type> times;
+
+    static std::string data_tag(size_type i);
+    const std::vector<gmm::uint64_type> &desc(size_type i) const;
+
+  public:
+    size_type nb_steps() const { return times.size(); }
+    scalar_type time(size_type s) const { return times[s]; }
+    size_type nb_fields() const { return names.size(); }
+    const std::string &field_name(size_type i) const { return names[i]; }
+    /** Index of a field, or size_type(-1) if there is no such field. */
+    size_type field_index(const std::string &name) const;
+    /** Return true if the field i has been written at step s. */
+    bool has_field(size_type s, size_type i) const
+    { return f.has_section(data_tag(i), s); }
+    bool field_is_complex(size_type s, size_type i) const;
+
+    /** Values of the field i at step s. T should be scalar_type or
+        complex_type. */
+    template <typename T>
+    bgeot::binary_section<T> field_data(size_type s, size_type i) const
+    { return f.section<T>(data_tag(i), s); }
+    template <typename T>
+    void read_field(size_type s, size_type i, std::vector<T> &V) const
+    { f.read_section(data_tag(i), s, V); }
+
+    bool has_mesh() const { return f.has_section("MESH"); }
+    void read_mesh(mesh &m) const { m.read_from_binary_file(f); }
+    /** Return true if the field i is described by a mesh_fem. */
+    bool field_on_mesh_fem(size_type i) const;
+    /** Read the mesh_fem of the field i (mf should be defined on the mesh
+        read by read_mesh). */
+    void read_mesh_fem(size_type i, mesh_fem &mf) const;
+    /** Return true if the field i is described by an im_data. */
+    bool field_on_im_data(size_type i) const;
+    /** Read the integration method of the im_data of the field i. */
+    void read_mesh_im(size_type i, mesh_im &mim) const;
+    /** Tensor size and filtered region of the im_data of the field i. */
+    bgeot::multi_index im_data_tensor_size(size_type i) const;
+    size_type im_data_filtered_region(size_type i) const;
+
+    /** Set the value of the variables of the model which have been written
+        at step s. */
+    void read_model_variables(size_type s, model &md) const;
+
+    const bgeot::binary_file_reader &file() const { return f; }
+    explicit time_series_reader(const std::string &name);
+  };
+
+}  /* end of namespace getfem.                                             */
+
+
+#endif /* GETFEM_TIME_SERIES_H__  */
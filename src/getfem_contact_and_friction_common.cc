@@ -197,11 +197,11 @@ namespace getfem {
     if (!found) sfi.push_back(face_info(ib, ie, iff));
   }
 
+  // The influence boxes and their hierarchy are kept for the next
+  // computation of the contact pairs.
   void multi_contact_frame::clear_aux_info() {
     boundary_points = std::vector<base_node>();
     boundary_points_info = std::vector<boundary_point>();
-    element_boxes.clear();
-    element_boxes_info = std::vector<influence_box>();
     potential_pairs = std::vector<std::vector<face_info> >();
   }
 
@@ -211,7 +211,8 @@ namespace getfem {
                                            bool rayt, int nmode, bool refc)
     : N(NN), self_contact(selfc), ref_conf(refc), use_delaunay(dela),
       nodes_mode(nmode), raytrace(rayt), release_distance(r_dist),
-      cut_angle(cut_a), EPS(1E-8), md(0), coordinates(N), pt(N) {
+      cut_angle(cut_a), EPS(1E-8), md(0), coordinates(N), pt(N), ptx(1),
+      pty(1), ptz(1), ptw(1) {
     if (N > 0) coordinates[0] = "x";
     if (N > 1) coordinates[1] = "y";
     if (N > 2) coordinates[2] = "z";
@@ -228,7 +229,7 @@ namespace getfem {
     : N(NN), self_contact(selfc), ref_conf(refc),
       use_delaunay(dela), nodes_mode(nmode), raytrace(rayt),
       release_distance(r_dist), cut_angle(cut_a), EPS(1E-8), md(&mdd),
-      coordinates(N), pt(N) {
+      coordinates(N), pt(N), ptx(1), pty(1), ptz(1), ptw(1) {
     if (N > 0) coordinates[0] = "x";
     if (N > 1) coordinates[1] = "y";
     if (N > 2) coordinates[2] = "z";
@@ -551,11 +552,143 @@ namespace getfem {
   }
 
 
+  //=========================================================================
+  //
+  //  Bounding volume hierarchy on the influence boxes
+  //
+  //=========================================================================
+
+  void influence_box_tree::fit_node(size_type i) {
+    tree_node &nd = nodes[i];
+    scalar_type *nmin = &(node_min[i*N]), *nmax = &(node_max[i*N]);
+    if (nd.left == size_type(-1)) {
+      for (size_type k = 0; k < N; ++k)
+        { nmin[k] = 1E300; nmax[k] = -1E300; }
+      for (size_type j = nd.first; j < nd.last; ++j) {
+        size_type ib = box_order[j];
+        for (size_type k = 0; k < N; ++k) {
+          nmin[k] = std::min(nmin[k], box_min[ib*N+k]);
+          nmax[k] = std::max(nmax[k], box_max[ib*N+k]);
+        }
+      }
+    } else {
+      for (size_type k = 0; k < N; ++k) {
+        nmin[k] = std::min(node_min[nd.left*N+k], node_min[nd.right*N+k]);
+        nmax[k] = std::max(node_max[nd.left*N+k], node_max[nd.right*N+k]);
+      }
+    }
+  }
+
+  size_type influence_box_tree::build_node
+  (size_type first, size_type last, std::vector<scalar_type> &centers) {
+    size_type i = nodes.size();
+    tree_node nd; nd.first = first; nd.last = last;
+    nd.left = nd.right = size_type(-1);
+    nodes.push_back(nd);
+    node_min.resize(nodes.size()*N); node_max.resize(nodes.size()*N);
+
+    if (last - first > size_type(BOXES_PER_LEAF)) {
+      // Split at the median of the box centers along the largest extent.
+      size_type dir = 0;
+      scalar_type ext = scalar_type(-1);
+      for (size_type k = 0; k < N; ++k) {
+        scalar_type cmin(1E300), cmax(-1E300);
+        for (size_type j = first; j < last; ++j) {
+          cmin = std::min(cmin, centers[box_order[j]*N+k]);
+          cmax = std::max(cmax, centers[box_order[j]*N+k]);
+        }
+        if (cmax - cmin > ext) { ext = cmax - cmin; dir = k; }
+      }
+      size_type mid = (first + last) / 2, NN = N;
+      std::nth_element(box_order.begin()+first, box_order.begin()+mid,
+                       box_order.begin()+last,
+                       [&centers, dir, NN](size_type a, size_type b)
+                       { return centers[a*NN+dir] < centers[b*NN+dir]; });
+      size_type l = build_node(first, mid, centers);
+      size_type r = build_node(mid, last, centers);
+      nodes[i].left = l; nodes[i].right = r;
+    }
+    fit_node(i);
+    return i;
+  }
+
+  scalar_type influence_box_tree::total_extent() const {
+    scalar_type e(0);
+    for (size_type i = 0; i < node_min.size(); ++i)
+      e += node_max[i] - node_min[i];
+    return e;
+  }
+
+  void influence_box_tree::build
+  (size_type NN, std::vector<scalar_type> &bmin,
+   std::vector<scalar_type> &bmax) {
+    N = NN;
+    box_min.swap(bmin); box_max.swap(bmax);
+    size_type nb = nb_boxes();
+    nodes.resize(0); node_min.resize(0); node_max.resize(0);
+    box_order.resize(nb);
+    for (size_type i = 0; i < nb; ++i) box_order[i] = i;
+    std::vector<scalar_type> centers(nb*N);
+    for (size_type i = 0; i < nb*N; ++i)
+      centers[i] = (box_min[i] + box_max[i]) / scalar_type(2);
+    if (nb) build_node(0, nb, centers);
+    built_extent = total_extent();
+  }
+
+  void influence_box_tree::refit
+  (std::vector<scalar_type> &bmin, std::vector<scalar_type> &bmax) {
+    GMM_ASSERT1(bmin.size() == box_min.size() &&
+                bmax.size() == box_max.size(), "Wrong number of boxes");
+    box_min.swap(bmin); box_max.swap(bmax);
+    for (size_type i = nodes.size(); i > 0; --i) fit_node(i-1);
+    // When the boxes have moved too much relatively to each other, the
+    // refitted nodes overlap a lot and the search degenerates.
+    if (total_extent() > scalar_type(2) * built_extent) {
+      bmin = box_min; bmax = box_max;
+      build(N, bmin, bmax);
+    }
+  }
+
+  void influence_box_tree::find_boxes_at_point
+  (const base_node &P, std::vector<size_type> &ids) const {
+    ids.resize(0);
+    if (nodes.empty()) return;
+    std::vector<size_type> stack(1, 0);
+    while (!stack.empty()) {
+      size_type i = stack.back(); stack.pop_back();
+      bool in = true;
+      for (size_type k = 0; k < N && in; ++k)
+        in = (P[k] >= node_min[i*N+k] && P[k] <= node_max[i*N+k]);
+      if (!in) continue;
+      const tree_node &nd = nodes[i];
+      if (nd.left == size_type(-1)) {
+        for (size_type j = nd.first; j < nd.last; ++j) {
+          size_type ib = box_order[j];
+          bool inb = true;
+          for (size_type k = 0; k < N && inb; ++k)
+            inb = (P[k] >= box_min[ib*N+k] && P[k] <= box_max[ib*N+k]);
+          if (inb) ids.push_back(ib);
+        }
+      } else {
+        stack.push_back(nd.right); stack.push_back(nd.left);
+      }
+    }
+    std::sort(ids.begin(), ids.end());
+  }
+
+  void influence_box_tree::clear() {
+    N = 0; built_extent = scalar_type(0);
+    box_min.clear(); box_max.clear(); box_order.clear();
+    nodes.clear(); node_min.clear(); node_max.clear();
+  }
+
   void multi_contact_frame::compute_influence_boxes() {
     fem_precomp_pool fppool;
     bool avert = false;
     base_matrix G;
     model_real_plain_vector coeff;
+    std::vector<influence_box> boxes_info;
+    std::vector<scalar_type> boxes_min, boxes_max;
 
     for (size_type i = 0; i < contact_boundaries.size(); ++i)
       if (!is_slave_boundary(i)) {
@@ -644,12 +777,28 @@ namespace getfem {
             { bmin[k] -= release_distance; bmax[k] += release_distance; }
 
           // Store the influence box and additional information.
-          element_boxes.add_box(bmin, bmax, element_boxes_info.size());
+          boxes_min.insert(boxes_min.end(), bmin.begin(), bmin.end());
+          boxes_max.insert(boxes_max.end(), bmax.begin(), bmax.end());
           n_mean /= gmm::vect_norm2(n_mean);
-          element_boxes_info.push_back(influence_box(i, cv, v.f(), n_mean));
+          boxes_info.push_back(influence_box(i, cv, v.f(), n_mean));
         }
       }
-    element_boxes.build_tree();
+
+    // The hierarchy of the previous computation is refitted if the master
+    // faces are the same.
+    bool same_faces = (element_boxes.N == N
+                       && boxes_info.size() == element_boxes_info.size());
+    for (size_type i = 0; same_faces && i < boxes_info.size(); ++i)
+      same_faces = (boxes_info[i].ind_boundary
+                    == element_boxes_info[i].ind_boundary
+                    && boxes_info[i].ind_element
+                    == element_boxes_info[i].ind_element
+                    && boxes_info[i].ind_face == element_boxes_info[i].ind_face);
+    element_boxes_info.swap(boxes_info);
+    if (same_faces)
+      element_boxes.refit(boxes_min, boxes_max);
+    else
+      element_boxes.build(N, boxes_min, boxes_max);
   }
 
   void multi_contact_frame::compute_potential_contact_pairs_influence_boxes() {
@@ -659,17 +808,22 @@ namespace getfem {
     potential_pairs = std::vector<std::vector<face_info> >();
     potential_pairs.resize(boundary_points.size());
 
-    for (size_type ip = 0; ip < boundary_points.size(); ++ip) {
+    // The search in the hierarchy is done in parallel, the selection of
+    // the candidate faces sequentially.
+    size_type nbpt = boundary_points.size();
+    std::vector<std::vector<size_type> > candidates(nbpt);
+    GETFEM_OMP_FOR(size_type ip = 0, ip < nbpt, ++ip,
+                   element_boxes.find_boxes_at_point(boundary_points[ip],
+                                                     candidates[ip]););
+
+    for (size_type ip = 0; ip < nbpt; ++ip) {
 
-      bgeot::rtree::pbox_set bset;
-      element_boxes.find_boxes_at_point(boundary_points[ip], bset);
       boundary_point *pt_info = &(boundary_points_info[ip]);
       const mesh_fem &mf1 = mfdisp_of_boundary(pt_info->ind_boundary);
       size_type ib1 = pt_info->ind_boundary;
 
-      bgeot::rtree::pbox_set::iterator it = bset.begin();
-      for (; it != bset.end(); ++it) {
-        influence_box &ibx = element_boxes_info[(*it)->id];
+      for (size_type ic = 0; ic < candidates[ip].size(); ++ic) {
+        influence_box &ibx = element_boxes_info[candidates[ip][ic]];
         size_type ib2 = ibx.ind_boundary;
         const mesh_fem &mf2 = mfdisp_of_boundary(ib2);
 
@@ -24,10 +24,6 @@
 #include "getfem/getfem_contact_and_friction_common.h"
 #include "getfem/getfem_assembling.h"
 
-#ifndef GETFEM_HAVE_QHULL_QHULL_H
-#include <getfem/bgeot_kdtree.h>
-#endif
-
 namespace getfem {
 
   typedef bgeot::convex<base_node>::dref_convex_pt_ct dref_convex_pt_ct;
@@ -78,9 +74,195 @@ namespace getfem {
       {dist2 = threshold * threshold; is_active = false;}
   };
 
+  size_type contact_node_grid::key_of(const std::vector<long> &c) const {
+    size_type key = 0;
+    for (size_type k = N; k > 0; --k) key = key * nc[k-1] + size_type(c[k-1]);
+    return key;
+  }
+
+  void contact_node_grid::search_cell(search_state &s) const {
+    size_type key = key_of(s.cc);
+    auto it = std::lower_bound(cell_keys.begin(), cell_keys.end(), key);
+    if (it == cell_keys.end() || *it != key) return;
+    size_type ic = size_type(it - cell_keys.begin());
+    for (size_type j = cell_start[ic]; j < cell_start[ic+1]; ++j) {
+      scalar_type d2 = gmm::vect_dist2_sqr((*pts)[ids[j]], s.P);
+      if (d2 < s.dist2 || (d2 == s.dist2 && s.ind != size_type(-1)
+                           && ids[j] < s.ind))
+        { s.dist2 = d2; s.ind = ids[j]; }
+    }
+  }
+
+  // Visits the cells at distance s.r (in number of cells, for the
+  // maximum norm) of the cell of the point.
+  void contact_node_grid::search_ring(search_state &s, size_type k,
+                                     bool on_ring) const {
+    if (k == N) { search_cell(s); return; }
+    long lo = s.c[k] - s.r, hi = s.c[k] + s.r;
+    if (k == N-1 && !on_ring) {
+      if (lo >= 0 && lo < long(nc[k])) { s.cc[k] = lo; search_cell(s); }
+      if (hi >= 0 && hi < long(nc[k])) { s.cc[k] = hi; search_cell(s); }
+    } else {
+      for (long v = std::max(lo, 0L); v <= std::min(hi, long(nc[k])-1); ++v)
+        { s.cc[k] = v; search_ring(s, k+1, on_ring || v == lo || v == hi); }
+    }
+  }
+
+  // Lower bound of the square distance from s.P to the cells at distance
+  // at least s.r (in number of cells) of the cell of the point, i.e. to
+  // the cells of the grid outside the box of the previous rings. Such a
+  // cell lies beyond this box in at least one direction k, and in the
+  // grid box in the other ones.
+  scalar_type contact_node_grid::ring_dist2(const search_state &s) const {
+    scalar_type d2 = std::numeric_limits<scalar_type>::max();
+    for (size_type k = 0; k < N; ++k) {
+      long a = s.c[k] - s.r + 1, b = s.c[k] + s.r;
+      // slack for the rounding of the cell of the nodes
+      scalar_type tol = 1E-8 * (h + gmm::abs(s.P[k]));
+      scalar_type o2 = s.g2 - s.g[k] * s.g[k], d;
+      if (a > 0) {                            // cells below the box
+        d = std::max(s.P[k] - org[k] - scalar_type(a) * h - tol,
+                     scalar_type(0));
+        d2 = std::min(d2, o2 + d * d);
+      }
+      if (b < long(nc[k])) {                  // cells above the box
+        d = std::max(org[k] + scalar_type(b) * h - s.P[k] - tol,
+                     scalar_type(0));
+        d2 = std::min(d2, o2 + d * d);
+      }
+    }
+    return d2;
+  }
+
+  scalar_type contact_node_grid::far_nearest_node(const base_node &P,
+                                                  scalar_type max_dist2,
+                                                  size_type &ind) const {
+    bgeot::index_node_pair ipt;
+    tree.nearest_neighbor(ipt, P);  // lowest index among equal distances
+    ind = size_type(-1);
+    if (ipt.i == size_type(-1)) return max_dist2;
+    scalar_type d2 = gmm::vect_dist2_sqr((*pts)[ipt.i], P);
+    if (d2 < max_dist2) { ind = ipt.i; max_dist2 = d2; }
+    return max_dist2;
+  }
+
+  scalar_type contact_node_grid::nearest_node(const base_node &P,
+                                              scalar_type max_dist2,
+                                              size_type &ind) const {
+    ind = size_type(-1);
+    if (pts->empty()) return max_dist2;
+    std::vector<long> c(N);
+    search_state s(P, c, max_dist2);
+    long rmin = 0, rmax = 0;
+    for (size_type k = 0; k < N; ++k) {
+      // A point far from the grid is brought back next to it, its distance
+      // to the grid box being taken into account by ring_dist2.
+      scalar_type ck = std::floor((P[k] - org[k]) / h);
+      c[k] = long(std::max(scalar_type(-1),
+                           std::min(ck, scalar_type(nc[k]))));
+      rmin = std::max(rmin, std::max(-c[k], c[k] - long(nc[k]) + 1));
+      rmax = std::max(rmax, std::max(c[k], long(nc[k]) - 1 - c[k]));
+      s.g[k] = std::max(scalar_type(0),
+                        std::max(org[k] - P[k],
+                                 P[k] - org[k] - scalar_type(nc[k]) * h));
+      s.g2 += s.g[k] * s.g[k];
+    }
+    for (s.r = rmin; s.r <= rmax; ++s.r) {
+      if (s.r > 0 && ring_dist2(s) >= s.dist2) break;
+      // Far from the nodes, the number of cells of the rings would grow
+      // faster than the number of nodes.
+      if (s.r > rmin + 3) return far_nearest_node(P, max_dist2, ind);
+      search_ring(s, 0, s.r == 0);
+    }
+    ind = s.ind;
+    return s.dist2;
+  }
+
+  contact_node_grid::contact_node_grid(const std::vector<base_node> &pts_)
+    : N(0), h(1), pts(&pts_) {
+    size_type n = pts_.size();
+    if (!n) return;
+    N = pts_[0].size();
+    org = pts_[0];
+    base_node pmax = pts_[0];
+    for (size_type i = 1; i < n; ++i)
+      for (size_type k = 0; k < N; ++k) {
+        org[k] = std::min(org[k], pts_[i][k]);
+        pmax[k] = std::max(pmax[k], pts_[i][k]);
+      }
+
+    // Cell size from the extent of the surface (the N-1 largest extents)
+    std::vector<scalar_type> ext(N);
+    for (size_type k = 0; k < N; ++k) ext[k] = pmax[k] - org[k];
+    std::vector<scalar_type> sext = ext;
+    std::sort(sext.begin(), sext.end(), std::greater<scalar_type>());
+    scalar_type surf(1); size_type ms = 0;
+    for (size_type k = 0; k < std::max(N-1, size_type(1)); ++k)
+      if (sext[k] > scalar_type(0)) { surf *= sext[k]; ++ms; }
+    if (ms) h = pow(surf / scalar_type(n), scalar_type(1)/scalar_type(ms));
+    if (!(h > scalar_type(0))) h = scalar_type(1);
+    nc.resize(N);
+    for (;;) {
+      scalar_type nbcells(1);
+      for (size_type k = 0; k < N; ++k) {
+        nc[k] = size_type(std::floor(ext[k] / h)) + 1;
+        nbcells *= scalar_type(nc[k]);
+      }
+      if (nbcells < 1E15) break;
+      h *= scalar_type(2);
+    }
+
+    std::vector<std::pair<size_type, size_type> > key_ids(n);
+    std::vector<long> c(N);
+    for (size_type i = 0; i < n; ++i) {
+      for (size_type k = 0; k < N; ++k)
+        c[k] = std::min(long(std::floor((pts_[i][k] - org[k]) / h)),
+                        long(nc[k]) - 1);
+      key_ids[i] = std::make_pair(key_of(c), i);
+    }
+    std::sort(key_ids.begin(), key_ids.end());
+    ids.resize(n);
+    for (size_type i = 0; i < n; ++i) {
+      ids[i] = key_ids[i].second;
+      if (i == 0 || key_ids[i].first != key_ids[i-1].first) {
+        cell_keys.push_back(key_ids[i].first);
+        cell_start.push_back(i);
+      }
+    }
+    cell_start.push_back(n);
+
+    tree.reserve(n);
+    for (size_type i = 0; i < n; ++i) tree.add_point_with_id(pts_[i], i);
+    bgeot::index_node_pair ipt;
+    tree.nearest_neighbor(ipt, org); // builds the tree before the searches
+  }
+
   // contact_node's pair list
   class contact_node_pair_list : public std::vector<contact_node_pair> {
 
+    // Pairs each slave node of cnl_s with the nearest node of cnl_m. The
+    // pairs are stored from the index ii0.
+    void min_dist_cn_pairs(const std::vector<contact_node> &cnl_s,
+                           const std::vector<base_node> &pts_s,
+                           const std::vector<contact_node> &cnl_m,
+                           const std::vector<base_node> &pts_m,
+                           size_type ii0) {
+      contact_node_grid grid(pts_m);
+      size_type nb = cnl_s.size();
+      std::vector<size_type> ind(nb);
+      std::vector<scalar_type> dist2(nb);
+      GETFEM_OMP_FOR(size_type i = 0, i < nb, ++i,
+                     dist2[i] = grid.nearest_node
+                     (pts_s[i], (*this)[ii0+i].dist2, ind[i]););
+      for (size_type i = 0; i < nb; ++i)
+        if (ind[i] != size_type(-1)) {
+          (*this)[ii0+i].cn_s = cnl_s[i];
+          (*this)[ii0+i].cn_m = cnl_m[ind[i]];
+          (*this)[ii0+i].dist2 = dist2[i];
+          (*this)[ii0+i].is_active = true;
+        }
+    }
+
     void contact_node_list_from_region
       (const mesh_fem &mf, size_type contact_region,
        std::vector<contact_node> &cnl) {
@@ -128,110 +310,15 @@ namespace getfem {
       size_type size1 = slave1 ? cnl1.size() : 0;
       size_type size2 = slave2 ? cnl2.size() : 0;
       this->resize( size0 + size1 + size2 );
-# ifndef GETFEM_HAVE_QHULL_QHULL_H
-      bgeot::kdtree tree1, tree2;
-      for (size_type i1 = 0; i1 < cnl1.size(); ++i1) {
-        contact_node *cn1 = &cnl1[i1];
-        tree1.add_point_with_id(cn1->mf->point_of_basic_dof(cn1->dof), i1);
-      }
-      for (size_type i2 = 0; i2 < cnl2.size(); ++i2) {
-        contact_node *cn2 = &cnl2[i2];
-        tree2.add_point_with_id(cn2->mf->point_of_basic_dof(cn2->dof), i2);
-      }
-      if (slave1) {
-        size_type ii1=size0;
-        for (size_type i1 = 0; i1 < cnl1.size(); ++i1, ++ii1) {
-          contact_node *cn1 = &cnl1[i1];
-          base_node node1 = cn1->mf->point_of_basic_dof(cn1->dof);
-          bgeot::index_node_pair ipt;
-          scalar_type dist2 = tree2.nearest_neighbor(ipt, node1);
-          if (ipt.i != size_type(-1) && dist2 < (*this)[ii1].dist2) {
-            (*this)[ii1].cn_s = *cn1;
-            (*this)[ii1].cn_m = cnl2[ipt.i];
-            (*this)[ii1].dist2 = dist2;
-            (*this)[ii1].is_active = true;
-          }
-        }
-      }
-      if (slave2) {
-        size_type ii2=size0+size1;
-        for (size_type i2 = 0; i2 < cnl2.size(); ++i2, ++ii2) {
-          contact_node *cn2 = &cnl2[i2];
-          base_node node2 = cn2->mf->point_of_basic_dof(cn2->dof);
-          bgeot::index_node_pair ipt;
-          scalar_type dist2 = tree1.nearest_neighbor(ipt, node2);
-          if (ipt.i != size_type(-1) && dist2 < (*this)[ii2].dist2) {
-            (*this)[ii2].cn_s = *cn2;
-            (*this)[ii2].cn_m = cnl1[ipt.i];
-            (*this)[ii2].dist2 = dist2;
-            (*this)[ii2].is_active = true;
-          }
-        }
-      }
-# else
-      std::vector<base_node> pts;
-      for (size_type i1 = 0; i1 < cnl1.size(); ++i1) {
-        contact_node *cn1 = &cnl1[i1];
-        pts.push_back(cn1->mf->point_of_basic_dof(cn1->dof));
-      }
-      for (size_type i2 = 0; i2 < cnl2.size(); ++i2) {
-        contact_node *cn2 = &cnl2[i2];
-        pts.push_back(cn2->mf->point_of_basic_dof(cn2->dof));
-      }
-      gmm::dense_matrix<size_type> simplexes;
-
-      getfem::delaunay(pts, simplexes);
-
-      size_type nb_vertices = gmm::mat_nrows(simplexes);
-      std::vector<size_type> facet_vertices(nb_vertices);
-      std::vector< std::vector<size_type> > pt1_neighbors(size1);
-      for (size_type i = 0; i < gmm::mat_ncols(simplexes); ++i) {
-        gmm::copy(gmm::mat_col(simplexes, i), facet_vertices);
-        for (size_type iv1 = 0; iv1 < nb_vertices-1; ++iv1) {
-          size_type v1 = facet_vertices[iv1];
-          bool v1_on_surface1 = (v1 < size1);
-          for (size_type iv2 = iv1 + 1; iv2 < nb_vertices; ++iv2) {
-            size_type v2 = facet_vertices[iv2];
-            bool v2_on_surface1 = (v2 < size1);
-            if (v1_on_surface1 ^ v2_on_surface1) {
-              bool already_in = false;
-              size_type vv1 = (v1_on_surface1 ? v1 : v2);
-              size_type vv2 = (v2_on_surface1 ? v1 : v2);
-              for (size_type j = 0; j < pt1_neighbors[vv1].size(); ++j)
-                if (pt1_neighbors[vv1][j] == vv2) {
-                  already_in = true;
-                  break;
-                }
-              if (!already_in) pt1_neighbors[vv1].push_back(vv2);
-            }
-          }
-        }
-      }
 
-      for (size_type i1 = 0; i1 < size1; ++i1)
-        for (size_type j = 0; j < pt1_neighbors[i1].size(); ++j) {
-          size_type i2 = pt1_neighbors[i1][j] - size1;
-          size_type ii1 = size0 + i1;
-          size_type ii2 = size0 + size1 + i2;
-          contact_node *cn1 = &cnl1[i1];
-          base_node node1 = cn1->mf->point_of_basic_dof(cn1->dof);
-          contact_node *cn2 = &cnl2[i2];
-          base_node node2 = cn2->mf->point_of_basic_dof(cn2->dof);
-          scalar_type dist2 = gmm::vect_norm2_sqr(node1-node2);
-          if (slave1 && dist2 < (*this)[ii1].dist2) {
-            (*this)[ii1].cn_s = *cn1;
-            (*this)[ii1].cn_m = *cn2;
-            (*this)[ii1].dist2 = dist2;
-            (*this)[ii1].is_active = true;
-          }
-          if (slave2 && dist2 < (*this)[ii2].dist2) {
-            (*this)[ii2].cn_s = *cn2;
-            (*this)[ii2].cn_m = *cn1;
-            (*this)[ii2].dist2 = dist2;
-            (*this)[ii2].is_active = true;
-          }
-        }
-#endif
+      std::vector<base_node> pts1(cnl1.size()), pts2(cnl2.size());
+      for (size_type i1 = 0; i1 < cnl1.size(); ++i1)
+        pts1[i1] = cnl1[i1].mf->point_of_basic_dof(cnl1[i1].dof);
+      for (size_type i2 = 0; i2 < cnl2.size(); ++i2)
+        pts2[i2] = cnl2[i2].mf->point_of_basic_dof(cnl2[i2].dof);
+
+      if (slave1) min_dist_cn_pairs(cnl1, pts1, cnl2, pts2, size0);
+      if (slave2) min_dist_cn_pairs(cnl2, pts2, cnl1, pts1, size0 + size1);
     }
 
     void append_min_dist_cn_pairs(const mesh_fem &mf,
@@ -408,37 +495,59 @@ namespace getfem {
       GMM_ASSERT1( gmm::mat_nrows(*BT2) == cnpl.size() * d, "Wrong size of BT2");
     }
     gmm::fill(gap, scalar_type(10));  //FIXME: Needs a threshold value
-    for (size_type row = 0; row < cnpl.size(); ++row) {
+
+    // Projection of the slave nodes on the faces adjacent to their master
+    // node, done in parallel before the sequential filling of the matrices.
+    size_type nbp = cnpl.size();
+    std::vector<base_node> slave_nodes(nbp), master_nodes(nbp);
+    std::vector<base_node> un_sels(nbp, base_node(qdim));
+    std::vector<base_node> proj_node_sels(nbp, base_node(qdim));
+    std::vector<base_node> proj_node_ref_sels(nbp, base_node(qdim));
+    std::vector<scalar_type> is_in_mins(nbp, 1e5);  //FIXME
+    std::vector<size_type> cv_sels(nbp, 0);
+    std::vector<short_type> fc_sels(nbp, 0);
+    for (size_type row = 0; row < nbp; ++row)
+      if (cnpl[row].is_active) {
+        const contact_node &cn_s = cnpl[row].cn_s, &cn_m = cnpl[row].cn_m;
+        slave_nodes[row] = cn_s.mf->point_of_basic_dof(cn_s.dof);
+        master_nodes[row] = cn_m.mf->point_of_basic_dof(cn_m.dof);
+        GMM_ASSERT1(slave_nodes[row].size() == qdim
+                    && master_nodes[row].size() == qdim, "Internal error");
+      }
+    auto project_node = [&](size_type row) {
+      const contact_node &cn_m = cnpl[row].cn_m;
+      const mesh &mesh_m = cn_m.mf->linked_mesh();
+      base_node un(qdim), proj_node(qdim), proj_node_ref(qdim);
+      for (size_type i = 0; i < cn_m.cvs.size() && i < cn_m.fcs.size(); ++i) {
+        scalar_type is_in = projection_on_convex_face
+          (mesh_m, cn_m.cvs[i], cn_m.fcs[i], master_nodes[row],
+           slave_nodes[row], un, proj_node, proj_node_ref);
+        if (is_in < is_in_mins[row]) {
+          is_in_mins[row] = is_in;
+          cv_sels[row] = cn_m.cvs[i];
+          fc_sels[row] = cn_m.fcs[i];
+          un_sels[row] = un;
+          proj_node_sels[row] = proj_node;
+          proj_node_ref_sels[row] = proj_node_ref;
+        }
+      }
+    };
+    GETFEM_OMP_FOR(size_type row = 0, row < nbp, ++row,
+                   if (cnpl[row].is_active) project_node(row););
+
+    for (size_type row = 0; row < nbp; ++row) {
       contact_node_pair *cnp = &cnpl[row];
       if (cnp->is_active) {
         contact_node *cn_s = &cnp->cn_s;  //slave contact node
         contact_node *cn_m = &cnp->cn_m;  //master contact node
         const mesh &mesh_m = cn_m->mf->linked_mesh();
-        base_node slave_node = cn_s->mf->point_of_basic_dof(cn_s->dof);
-        base_node master_node = cn_m->mf->point_of_basic_dof(cn_m->dof);
-        GMM_ASSERT1(slave_node.size() == qdim && master_node.size() == qdim,
-                    "Internal error");
-        base_node un_sel(qdim), proj_node_sel(qdim), proj_node_ref_sel(qdim);
-        scalar_type is_in_min = 1e5;  //FIXME
-        size_type cv_sel = 0;
-        short_type fc_sel = 0;
-        std::vector<size_type>::iterator cv;
-        std::vector<short_type>::iterator fc;
-        for (cv = cn_m->cvs.begin(), fc = cn_m->fcs.begin();
-             cv != cn_m->cvs.end() && fc != cn_m->fcs.end(); cv++, fc++) {
-          base_node un(qdim), proj_node(qdim), proj_node_ref(qdim);
-          scalar_type is_in = projection_on_convex_face
-            (mesh_m, *cv, *fc, master_node, slave_node, un, proj_node, proj_node_ref);
-          if (is_in < is_in_min) {
-            is_in_min = is_in;
-            cv_sel = *cv;
-            fc_sel = *fc;
-            un_sel = un;
-            proj_node_sel = proj_node;
-            proj_node_ref_sel = proj_node_ref;
-          }
-        }
-        if (is_in_min < 0.05) {  //FIXME
+        const base_node &slave_node = slave_nodes[row];
+        const base_node &un_sel = un_sels[row];
+        const base_node &proj_node_sel = proj_node_sels[row];
+        const base_node &proj_node_ref_sel = proj_node_ref_sels[row];
+        size_type cv_sel = cv_sels[row];
+        short_type fc_sel = fc_sels[row];
+        if (is_in_mins[row] < 0.05) {  //FIXME
           gap[row] = gmm::vect_sp(slave_node-proj_node_sel, un_sel);
 
 	  std::vector<base_node> ut(d);
@@ -67,8 +67,12 @@ namespace getfem {
     if (noisy() > 2) cout << "starting linear solver" << endl;
     gmm::iteration iter(maxres_solve, (noisy() >= 2) ? noisy() - 2 : 0,
                         40000);
-    (*lsolver)(A, g1, L1, iter);
-    iter.init(); (*lsolver)(A, g2, L2, iter); // (can be optimised)
+    // both right hand sides are solved with a single factorization
+    std::vector<base_vector> g(2), L(2);
+    g[0].swap(g1); g[1].swap(g2);
+    L[0] = L1; L[1] = L2;
+    lsolver->solve_multiple_rhs(A, g, L, iter);
+    g1.swap(g[0]); g2.swap(g[1]);
     if (noisy() > 2) cout << "linear solver done" << endl;
   }
 
@@ -23,6 +23,10 @@
 #include "getfem/dal_singleton.h"
 #include "getfem/bgeot_comma_init.h"
 #include "getfem/getfem_export.h"
+#include "getfem/getfem_mesh_partition.h"
+#if defined(GETFEM_HAVE_ZLIB_H)
+# include <zlib.h>
+#endif
 
 namespace getfem
 {
@@ -214,8 +218,19 @@ namespace getfem
       if (state == IN_POINT_DATA) os << "</PointData>\n";
       os << "</Piece>\n";
       os << "</UnstructuredGrid>\n";
+      if (is_appended()) {
+        os << "<AppendedData encoding=\"raw\">\n_";
+        if (appended) {
+          std::rewind(appended);
+          char buf[65536];
+          for (size_t n; (n = std::fread(buf, 1, sizeof(buf), appended)) > 0;)
+            os.write(buf, std::streamsize(n));
+        }
+        os << "\n</AppendedData>\n";
+      }
       os << "</VTKFile>\n";
     }
+    if (appended) std::fclose(appended);
   }
 
   void vtk_export::init() {
@@ -223,10 +238,21 @@ namespace getfem
     psl = 0; dim_ = dim_type(-1);
     static int test_endian = 0x01234567;
     reverse_endian = (*((char*)&test_endian) == 0x67);
+    vtu_format = VTU_BASE64;
     state = EMPTY;
+    appended = 0; appended_size = 0;
     clear_vals();
   }
 
+  void vtk_export::set_vtu_binary_format(vtu_binary_format f) {
+    GMM_ASSERT1(state == EMPTY, "the binary format should be selected "
+                "before anything is written");
+#   if !defined(GETFEM_HAVE_ZLIB_H)
+    GMM_ASSERT1(f != VTU_APPENDED_ZLIB, "GetFEM was built without zlib");
+#   endif
+    vtu_format = f;
+  }
+
   void vtk_export::switch_to_cell_data() {
     if (state != IN_CELL_DATA) {
       if (vtk) {
@@ -280,6 +306,12 @@ namespace getfem
   }
 
   void vtk_export::exporting(const mesh_fem& mf) {
+    dal::bit_vector cvlst = mf.convex_index();
+    exporting(mf, cvlst);
+  }
+
+  void vtk_export::exporting(const mesh_fem& mf,
+                             const dal::bit_vector &cvlst) {
     dim_ = mf.linked_mesh().dim();
     GMM_ASSERT1(dim_ <= 3, "attempt to export a " << int(dim_)
                 << "D mesh_fem (not supported)");
@@ -287,7 +319,8 @@ namespace getfem
       pmf = std::make_unique<mesh_fem>(mf.linked_mesh());
     /* initialize pmf with finite elements suitable for VTK (which only knows
        isoparametric FEMs of order 1 and 2) */
-    for (dal::bv_visitor cv(mf.convex_index()); !cv.finished(); ++cv) {
+    for (dal::bv_visitor cv(cvlst); !cv.finished(); ++cv) {
+      if (!mf.convex_index().is_in(cv)) continue;
       bgeot::pgeometric_trans pgt = mf.linked_mesh().trans_of_convex(cv);
       pfem pf = mf.fem_of_element(cv);
 
@@ -398,7 +431,13 @@ namespace getfem
       os << (ascii ? "ASCII\n" : "BINARY\n");
     } else {
       os << "<?xml version=\"1.0\"?>\n";
-      os << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" ";
+      if (is_appended())
+        os << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" "
+           << "header_type=\"UInt64\" "
+           << (vtu_format == VTU_APPENDED_ZLIB
+               ? "compressor=\"vtkZLibDataCompressor\" " : "");
+      else
+        os << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" ";
       os << "byte_order=\"" << (reverse_endian ? "LittleEndian" : "BigEndian") << "\">\n";
       os << "<!--" << header << "-->\n";
       os << "<UnstructuredGrid>\n";
@@ -412,10 +451,72 @@ namespace getfem
   void vtk_export::clear_vals()
   { if (!vtk && !ascii) vals.clear(); }
 
+  std::string vtk_export::data_array_format() {
+    if (ascii) return "format=\"ascii\">\n";
+    if (!is_appended()) return "format=\"binary\">\n";
+    std::stringstream s;
+    s << "format=\"appended\" offset=\"" << appended_size << "\"/>\n";
+    return s.str();
+  }
+
+  void vtk_export::write_appended(const void *p, size_type n) {
+    if (!appended) {
+      appended = std::tmpfile();
+      GMM_ASSERT1(appended, "impossible to create a temporary file for the "
+                  "appended data section");
+    }
+    GMM_ASSERT1(std::fwrite(p, 1, n, appended) == n,
+                "error writing the appended data section to a temporary file");
+    appended_size += n;
+  }
+
+  /* Blocks of the zlib compressed arrays (the default of VTK is 32768) */
+  static const size_type vtu_zlib_block_size = 65536;
+
   void vtk_export::write_vals() {
-    if (!vtk && !ascii) {
+    if (vtk || ascii) return;
+    switch (vtu_format) {
+    case VTU_BASE64: {
+      /* The data is preceded by its size in bytes, as a 32-bit integer
+         (the default header_type of VTK). The datasets used to be
+         preceded by their number of values as a float, that VTK readers
+         interpreted as a wrong byte count. */
+      unsigned n = unsigned(vals.size());
+      const unsigned char *p = reinterpret_cast<const unsigned char *>(&n);
+      vals.insert(vals.begin(), p, p + sizeof(n));
       os << base64_encode(vals);
-      clear_vals();
+      vals.clear();
+    } break;
+    case VTU_APPENDED_RAW: {
+      gmm::uint64_type n = vals.size();
+      write_appended(&n, sizeof(n));
+      write_appended(vals.data(), vals.size());
+      vals.clear();
+    } break;
+    case VTU_APPENDED_ZLIB: {
+#     if defined(GETFEM_HAVE_ZLIB_H)
+      size_type n = vals.size(), bs = vtu_zlib_block_size;
+      size_type nb = (n + bs - 1) / bs;
+      std::vector<std::vector<unsigned char>> blocks(nb);
+      auto compress_block = [&](size_type i) {
+        uLong sz = uLong(std::min(bs, n - i*bs));
+        uLongf len = compressBound(sz);
+        blocks[i].resize(len);
+        int r = compress2(&blocks[i][0], &len, &vals[i*bs], sz,
+                          Z_DEFAULT_COMPRESSION);
+        GMM_ASSERT1(r == Z_OK, "zlib compression error " << r);
+        blocks[i].resize(len);
+      };
+      GETFEM_OMP_FOR(size_type i = 0, i < nb, ++i, compress_block(i););
+      /* header: number of blocks, size of the blocks, size of the last
+         block if it is partial and compressed size of each block */
+      std::vector<gmm::uint64_type> header = { nb, bs, n % bs };
+      for (const auto &b : blocks) header.push_back(b.size());
+      write_appended(header.data(), header.size() * sizeof(header[0]));
+      for (const auto &b : blocks) write_appended(b.data(), b.size());
+      vals.clear();
+#     endif
+    } break;
     }
   }
 
@@ -447,8 +548,7 @@ namespace getfem
       os << "<Points>\n";
       os << "<DataArray type=\"Float32\" Name=\"Points\" ";
       os << "NumberOfComponents=\"3\" ";
-      os << (ascii ? "format=\"ascii\">\n" : "format=\"binary\">\n");
-      if (!ascii) write_val(int(sizeof(float)*psl->nb_points()*3));
+      os << data_array_format();
     }
     /*
        points are not merge, vtk is mostly fine with that (except for
@@ -462,7 +562,7 @@ namespace getfem
     }
     write_vals();
     if (!vtk) {
-      os << (ascii ? "" : "\n") << "</DataArray>\n";
+      if (!is_appended()) os << (ascii ? "" : "\n") << "</DataArray>\n";
       os << "</Points>\n";
     }
 
@@ -473,15 +573,7 @@ namespace getfem
     } else {
       os << "<Cells>\n";
       os << "<DataArray type=\"Int32\" Name=\"connectivity\" ";
-      os << (ascii ? "format=\"ascii\">\n" : "format=\"binary\">\n");
-      if (!ascii) {
-        int size = 0;
-        for (size_type ic=0; ic < psl->nb_convex(); ++ic) {
-          for (const slice_simplex &s : psl->simplexes(ic))
-            size += int((s.dim()+1)*sizeof(int));
-        }
-        write_val(size);
-      }
+      os << data_array_format();
     }
     for (size_type ic=0; ic < psl->nb_convex(); ++ic) {
       for (const slice_simplex &s : psl->simplexes(ic)) {
@@ -498,15 +590,9 @@ namespace getfem
     if (vtk) {
       write_separ(); os << "CELL_TYPES " << splx_cnt << "\n";
     } else {
-      os << (ascii ? "" : "\n") << "</DataArray>\n";
+      if (!is_appended()) os << (ascii ? "" : "\n") << "</DataArray>\n";
       os << "<DataArray type=\"Int32\" Name=\"offsets\" ";
-      os << (ascii ? "format=\"ascii\">\n" : "format=\"binary\">\n");
-      if (!ascii) {
-        int size = 0;
-        for (size_type ic=0; ic < psl->nb_convex(); ++ic)
-          size += int(psl->simplexes(ic).size()*sizeof(int));
-        write_val(size);
-      }
+      os << data_array_format();
     }
     int cnt = 0;
     for (size_type ic=0; ic < psl->nb_convex(); ++ic) {
@@ -523,20 +609,14 @@ namespace getfem
     write_vals();
     assert(splx_cnt == 0); // sanity check
     if (!vtk) {
-      os << (ascii ? "" : "\n") << "</DataArray>\n";
+      if (!is_appended()) os << (ascii ? "" : "\n") << "</DataArray>\n";
       os << "<DataArray type=\"Int32\" Name=\"types\" ";
-      os << (ascii ? "format=\"ascii\">\n" : "format=\"binary\">\n");
-      if (!ascii) {
-        int size = 0;
-        for (size_type ic=0; ic < psl->nb_convex(); ++ic)
-          size += int(psl->simplexes(ic).size()*sizeof(int));
-        write_val(size);
-      }
+      os << data_array_format();
       for (size_type ic=0; ic < psl->nb_convex(); ++ic)
         for (const slice_simplex &s : psl->simplexes(ic))
           write_val(int(vtk_simplex_code[s.dim()]));
       write_vals();
-      os << "\n" << "</DataArray>\n";
+      if (!is_appended()) os << "\n" << "</DataArray>\n";
       os << "</Cells>\n";
     }
     state = STRUCTURE_WRITTEN;
@@ -556,8 +636,7 @@ namespace getfem
       os << "<Points>\n";
       os << "<DataArray type=\"Float32\" Name=\"Points\" ";
       os << "NumberOfComponents=\"3\" ";
-      os << (ascii ? "format=\"ascii\">\n" : "format=\"binary\">\n");
-      if (!ascii) write_val(int(sizeof(float)*pmf_dof_used.card()*3));
+      os << data_array_format();
     }
     std::vector<int> dofmap(pmf->nb_dof());
     int cnt = 0;
@@ -577,19 +656,11 @@ namespace getfem
       write_separ();
       os << "CELLS " << pmf->convex_index().card() << " " << nb_cell_values << "\n";
     } else {
-      os << (ascii ? "" : "\n") << "</DataArray>\n";
+      if (!is_appended()) os << (ascii ? "" : "\n") << "</DataArray>\n";
       os << "</Points>\n";
       os << "<Cells>\n";
       os << "<DataArray type=\"Int32\" Name=\"connectivity\" ";
-      os << (ascii ? "format=\"ascii\">\n" : "format=\"binary\">\n");
-      if (!ascii) {
-        int size = 0;
-        for (dal::bv_visitor cv(pmf->convex_index()); !cv.finished(); ++cv) {
-          const std::vector<unsigned> &dmap = select_vtk_dof_mapping(pmf_mapping_type[cv]);
-          size += int(sizeof(int)*dmap.size());
-        }
-        write_val(size);
-      }
+      os << data_array_format();
     }
 
     for (dal::bv_visitor cv(pmf->convex_index()); !cv.finished(); ++cv) {
@@ -605,11 +676,9 @@ namespace getfem
       write_separ();
       os << "CELL_TYPES " << pmf->convex_index().card() << "\n";
     } else {
-      os << (ascii ? "" : "\n") << "</DataArray>\n";
+      if (!is_appended()) os << (ascii ? "" : "\n") << "</DataArray>\n";
       os << "<DataArray type=\"Int32\" Name=\"offsets\" ";
-      os << (ascii ? "format=\"ascii\">\n" : "format=\"binary\">\n");
-      if (!ascii)
-        write_val(int(pmf->convex_index().card()*sizeof(int)));
+      os << data_array_format();
       cnt = 0;
       for (dal::bv_visitor cv(pmf->convex_index()); !cv.finished(); ++cv) {
         const std::vector<unsigned> &dmap = select_vtk_dof_mapping(pmf_mapping_type[cv]);
@@ -617,18 +686,19 @@ namespace getfem
         write_val(cnt);
       }
       write_vals();
-      os << "\n" << "</DataArray>\n";
+      if (!is_appended()) os << "\n" << "</DataArray>\n";
       os << "<DataArray type=\"Int32\" Name=\"types\" ";
-      os << (ascii ? "format=\"ascii\">\n" : "format=\"binary\">\n");
-      if (!ascii)
-        write_val(int(pmf->convex_index().card()*sizeof(int)));
+      os << data_array_format();
     }
     for (dal::bv_visitor cv(pmf->convex_index()); !cv.finished(); ++cv) {
       write_val(int(select_vtk_type(pmf_mapping_type[cv])));
       if (vtk) write_separ();
     }
     write_vals();
-    if (!vtk) os << "\n" << "</DataArray>\n" << "</Cells>\n";
+    if (!vtk) {
+      if (!is_appended()) os << "\n" << "</DataArray>\n";
+      os << "</Cells>\n";
+    }
 
     state = STRUCTURE_WRITTEN;
   }
@@ -652,6 +722,108 @@ namespace getfem
   }
 
 
+  /* -------------------------------------------------------------
+   * Parallel VTU export
+   * ------------------------------------------------------------- */
+
+  pvtu_export::pvtu_export(const std::string &basename_,
+                           size_type nb_pieces_, bool ascii_,
+                           vtk_export::vtu_binary_format f)
+    : basename(basename_), nb_pieces(nb_pieces_), ascii(ascii_), format(f),
+      pmesh(0), closed(false)
+  { GMM_ASSERT1(nb_pieces > 0, "The number of pieces should be positive"); }
+
+  pvtu_export::~pvtu_export() {
+    /* The pieces are completed by their own destructor. */
+    if (!closed && !pieces.empty())
+      GMM_WARNING1("pvtu_export '" << basename << "' destroyed without "
+                   "being closed, no .pvtu file is written");
+  }
+
+  void pvtu_export::close() {
+    if (closed) return;
+    closed = true;
+    if (pieces.empty()) return;
+    /* completion of the pieces */
+    GETFEM_OMP_FOR(size_type i = 0, i < pieces.size(), ++i,
+                   pieces[i].reset(););
+    pieces.clear();
+
+    std::ofstream os((basename + ".pvtu").c_str());
+    GMM_ASSERT1(os, "impossible to write to file '" << basename << ".pvtu'");
+    std::string piece_name = basename;
+    size_type sep = piece_name.find_last_of("/\\");
+    if (sep != std::string::npos) piece_name = piece_name.substr(sep+1);
+
+    os << "<?xml version=\"1.0\"?>\n";
+    os << "<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\">\n";
+    os << "<PUnstructuredGrid GhostLevel=\"0\">\n";
+    os << "<PPoints>\n<PDataArray type=\"Float32\" "
+       << "NumberOfComponents=\"3\"/>\n</PPoints>\n";
+    if (point_data.size()) {
+      os << "<PPointData>\n";
+      for (const auto &d : point_data)
+        os << "<PDataArray type=\"Float32\" Name=\"" << remove_spaces(d.first)
+           << "\" NumberOfComponents=\"" << d.second << "\"/>\n";
+      os << "</PPointData>\n";
+    }
+    if (cell_data.size()) {
+      os << "<PCellData>\n";
+      for (const auto &d : cell_data)
+        os << "<PDataArray type=\"Float32\" Name=\"" << remove_spaces(d.first)
+           << "\" NumberOfComponents=\"" << d.second << "\"/>\n";
+      os << "</PCellData>\n";
+    }
+    for (size_type i = 0; i < nb_pieces; ++i)
+      os << "<Piece Source=\"" << piece_name << "_" << i << ".vtu\"/>\n";
+    os << "</PUnstructuredGrid>\n";
+    os << "</VTKFile>\n";
+    GMM_ASSERT1(os.good(), "error while writing file '" << basename
+                << ".pvtu'");
+  }
+
+  void pvtu_export::exporting(const mesh& m) {
+    pmf = std::make_unique<mesh_fem>(const_cast<mesh&>(m), dim_type(1));
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+      bgeot::pgeometric_trans pgt = m.trans_of_convex(cv);
+      pfem pf = getfem::classical_fem(pgt, pgt->complexity() > 1 ? 2 : 1);
+      pmf->set_finite_element(cv, pf);
+    }
+    exporting(*pmf);
+  }
+
+  void pvtu_export::exporting(const mesh_fem& mf) {
+    GMM_ASSERT1(!closed, "the export is closed");
+    GMM_ASSERT1(pieces.empty(), "The mesh is already exported");
+    const mesh &m = mf.linked_mesh();
+    GMM_ASSERT1(m.nb_convex() > 0, "Cannot export an empty mesh");
+    pmesh = &m;
+    nb_pieces = std::min(nb_pieces, m.nb_convex());
+    std::vector<size_type> part;
+    partition_mesh(m, nb_pieces, part);
+
+    std::vector<dal::bit_vector> cvlst(nb_pieces);
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+      cvlst[part[cv]].add(cv);
+    /* The pieces are built sequentially since each one adds a mesh_fem
+       depending on the mesh. */
+    pieces.resize(nb_pieces);
+    for (size_type i = 0; i < nb_pieces; ++i) {
+      std::stringstream name;
+      name << basename << "_" << i << ".vtu";
+      pieces[i] = std::make_unique<vtk_export>(name.str(), ascii, false);
+      if (!ascii) pieces[i]->set_vtu_binary_format(format);
+      pieces[i]->exporting(mf, cvlst[i]);
+    }
+  }
+
+  void pvtu_export::write_mesh() {
+    GMM_ASSERT1(!closed, "the export is closed");
+    GETFEM_OMP_FOR(size_type i = 0, i < pieces.size(), ++i,
+                   pieces[i]->write_mesh(););
+  }
+
+
   /* -------------------------------------------------------------
    * OPENDX export
    * ------------------------------------------------------------- */
@@ -1302,4 +1474,5 @@ namespace getfem
     os << "View[" << view++ << "].DrawTensors = 0;\n";
     state = IN_CELL_DATA;
   }
+
 }  /* end of namespace getfem. */
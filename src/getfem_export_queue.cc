@@ -0,0 +1,101 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+#include <fstream>
+#include "getfem/getfem_export_queue.h"
+
+namespace getfem {
+
+  async_export_queue::async_export_queue(size_type max_pending_)
+    : max_pending(std::max(max_pending_, size_type(1))), stop(false),
+      worker(&async_export_queue::run, this) {}
+
+  async_export_queue::~async_export_queue() {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      stop = true;
+    }
+    cond.notify_all();
+    worker.join();
+    if (error) GMM_WARNING1("Error in an asynchronous export task");
+  }
+
+  void async_export_queue::run() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this] { return stop || !tasks.empty(); });
+        if (tasks.empty()) return;
+        task = std::move(tasks.front());
+      }
+      std::exception_ptr e;
+      try { task(); } catch (...) { e = std::current_exception(); }
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (e && !error) error = e;
+        tasks.pop_front();
+      }
+      cond.notify_all();
+    }
+  }
+
+  void async_export_queue::rethrow_error() {
+    if (error) {
+      std::exception_ptr e = error;
+      error = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+
+  void async_export_queue::push(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this] { return tasks.size() < max_pending; });
+    rethrow_error();
+    tasks.push_back(std::move(task));
+    lock.unlock();
+    cond.notify_all();
+  }
+
+  void async_export_queue::write_file(const std::string &fname,
+                                      std::string content) {
+    // std::function needs a copyable task: the content is shared, not copied
+    auto pc = std::make_shared<std::string>(std::move(content));
+    push([fname, pc]() {
+        std::ofstream f(fname.c_str(), std::ios::binary | std::ios::trunc);
+        GMM_ASSERT1(f, "impossible to write to file '" << fname << "'");
+        f.write(pc->data(), std::streamsize(pc->size()));
+        GMM_ASSERT1(f, "Error while writing to file " << fname);
+      });
+  }
+
+  void async_export_queue::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this] { return tasks.empty(); });
+    rethrow_error();
+  }
+
+  size_type async_export_queue::nb_pending() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return tasks.size();
+  }
+
+}  /* end of namespace getfem. */
@@ -307,6 +307,19 @@ namespace getfem {
     }
   }
 
+  void virtual_fem::base_value_batch(const bgeot::stored_point_tab &pts,
+                                     short_type order,
+                                     std::vector<base_tensor> &t) const {
+    GMM_ASSERT1(order <= 2, "Only orders 0, 1 and 2 are available");
+    t.resize(pts.size());
+    for (size_type i = 0; i < pts.size(); ++i)
+      switch (order) {
+      case 0 : base_value(pts[i], t[i]); break;
+      case 1 : grad_base_value(pts[i], t[i]); break;
+      case 2 : hess_base_value(pts[i], t[i]); break;
+      }
+  }
+
   void virtual_fem::real_base_value(const fem_interpolation_context &c,
                                     base_tensor &t, bool withM) const
   { c.base_value(t, withM); }
@@ -4684,30 +4697,22 @@ namespace getfem {
     DAL_STORED_OBJECT_DEBUG_CREATED(this, "Fem_precomp");
     for (const auto &p : *pspt)
       GMM_ASSERT1(p.size() == pf->dim(), "dimensions mismatch");
+    for (auto &b : computed_) b = false;
+    if (!(pf->is_on_real_element())) init(0);
   }
 
-  void fem_precomp_::init_val() const {
-    c.resize(pspt->size());
-    for (size_type i = 0; i < pspt->size(); ++i)
-      pf->base_value((*pspt)[i], c[i]);
-  }
-
-  void fem_precomp_::init_grad() const {
-    pc.resize(pspt->size());
-    for (size_type i = 0; i < pspt->size(); ++i)
-      pf->grad_base_value((*pspt)[i], pc[i]);
-  }
-
-  void fem_precomp_::init_hess() const {
-    hpc.resize(pspt->size());
-    for (size_type i = 0; i < pspt->size(); ++i)
-      pf->hess_base_value((*pspt)[i], hpc[i]);
+  void fem_precomp_::init(short_type order) const {
+    GLOBAL_OMP_GUARD
+    if (computed_[order]) return;
+    std::vector<base_tensor> &v = (order == 0) ? c : ((order == 1) ? pc : hpc);
+    pf->base_value_batch(*pspt, order, v);
+    computed_[order] = true;
   }
 
   pfem_precomp fem_precomp(pfem pf, bgeot::pstored_point_tab pspt,
                            dal::pstatic_stored_object dep) {
     dal::pstatic_stored_object_key pk = std::make_shared<pre_fem_key_>(pf,pspt);
-    dal::pstatic_stored_object o = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
     if (o) return std::dynamic_pointer_cast<const fem_precomp_>(o);
     pfem_precomp p = std::make_shared<fem_precomp_>(pf, pspt);
     dal::add_stored_object(pk, p, pspt, dal::AUTODELETE_STATIC_OBJECT);
@@ -4716,6 +4721,16 @@ namespace getfem {
     return p;
   }
 
+  pfem_precomp fem_precomp_pool::operator()(pfem pf,
+                                            bgeot::pstored_point_tab pspt) {
+    dal::pstatic_stored_object_key pk = std::make_shared<pre_fem_key_>(pf,pspt);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
+    if (o) return std::dynamic_pointer_cast<const fem_precomp_>(o);
+    pfem_precomp p = fem_precomp(pf, pspt, 0);
+    precomps.insert(p);
+    return p;
+  }
+
   void fem_precomp_pool::clear() {
     for (const pfem_precomp &p : precomps)
       dal::del_stored_object(p, true);
@@ -1868,7 +1868,7 @@ namespace getfem {
       : t(t_), tc1(tc1_), n(n_) {}
   };
 
-  struct ga_instruction_transpose : public ga_instruction { // To be optimized
+  struct ga_instruction_transpose : public ga_instruction {
     base_tensor &t;
     const base_tensor &tc1;
     size_type n1, n2, nn;
@@ -1897,7 +1897,7 @@ namespace getfem {
       : t(t_), tc1(tc1_), n1(n1_), n2(n2_), nn(nn_) {}
   };
 
-  struct ga_instruction_swap_indices : public ga_instruction {// To be optimized
+  struct ga_instruction_swap_indices : public ga_instruction {
     base_tensor &t;
     const base_tensor &tc1;
     size_type nn1, nn2, ii2, ii3;
@@ -1906,15 +1906,20 @@ namespace getfem {
       GA_DEBUG_ASSERT(t.size() == tc1.size(), "Wrong sizes");
       size_type ii1 = t.size() / (nn1*nn2*ii2*ii3);
 
+      size_type sj = ii1, sk = ii1*nn1, sl = sk*ii2, si = sl*nn2;
       auto it = t.begin();
-      for (size_type i = 0; i < ii3; ++i)
-        for (size_type j = 0; j < nn1; ++j)
-          for (size_type k = 0; k < ii2; ++k)
-            for (size_type l = 0; l < nn2; ++l) {
-              size_type ind = j*ii1+k*ii1*nn1+l*ii1*nn1*ii2+i*ii1*nn1*ii2*nn2;
-              for (size_type m = 0; m < ii1; ++m, ++it)
-                *it = tc1[m+ind];
-            }
+      auto it1i = tc1.cbegin();
+      for (size_type i = 0; i < ii3; ++i, it1i += si) {
+        auto it1j = it1i;
+        for (size_type j = 0; j < nn1; ++j, it1j += sj) {
+          auto it1k = it1j;
+          for (size_type k = 0; k < ii2; ++k, it1k += sk) {
+            auto it1l = it1k;
+            for (size_type l = 0; l < nn2; ++l, it1l += sl)
+              it = std::copy(it1l, it1l + ii1, it);
+          }
+        }
+      }
       GA_DEBUG_ASSERT(it == t.end(), "Wrong sizes");
       return 0;
     }
@@ -2039,6 +2044,149 @@ namespace getfem {
       : t(t_), tc1(tc1_) {}
   };
 
+  // Versions of the trace, deviator, transpose, sym and skew instructions
+  // for N x N matrices (possibly with test functions), with N = 2 or 3
+  // known at compile time.
+
+  template<int N> inline scalar_type ga_diag_sum_unrolled_
+  (base_tensor::const_iterator it, size_type s)
+  { return *it + ga_diag_sum_unrolled_<N-1>(it + s, s); }
+  template<> inline scalar_type ga_diag_sum_unrolled_<1>
+  (base_tensor::const_iterator it, size_type)
+  { return *it; }
+
+  template <int N>
+  struct ga_instruction_trace_unrolled : public ga_instruction {
+    base_tensor &t;
+    const base_tensor &tc1;
+    // tc1(:,:,...,N,N) --> t(:,:,...)
+    virtual int exec() {
+      GA_DEBUG_INFO("Instruction: unrolled trace");
+      GA_DEBUG_ASSERT(t.size()*N*N == tc1.size(), "Wrong sizes");
+      size_type s = t.size() * (N+1);
+      auto it1 = tc1.cbegin();
+      for (auto it = t.begin(); it != t.end(); ++it, ++it1)
+        *it = ga_diag_sum_unrolled_<N>(it1, s);
+      return 0;
+    }
+    ga_instruction_trace_unrolled(base_tensor &t_, const base_tensor &tc1_)
+      : t(t_), tc1(tc1_) {}
+  };
+
+  template <int N>
+  struct ga_instruction_deviator_unrolled : public ga_instruction {
+    base_tensor &t;
+    const base_tensor &tc1;
+    // tc1(:,:,...,N,N) --> t(:,:,...,N,N)
+    virtual int exec() {
+      GA_DEBUG_INFO("Instruction: unrolled deviator");
+      GA_DEBUG_ASSERT(t.size() == tc1.size(), "Wrong sizes");
+      std::copy(tc1.begin(), tc1.end(), t.begin());
+      size_type nb = t.size()/(N*N), s = nb * (N+1);
+      auto it = t.begin();
+      auto it1 = tc1.cbegin();
+      for (size_type j = 0; j < nb; ++it, ++it1, ++j) {
+        scalar_type tr = ga_diag_sum_unrolled_<N>(it1, s) / scalar_type(N);
+        for (size_type i = 0; i < N; ++i) it[i*s] -= tr;
+      }
+      return 0;
+    }
+    ga_instruction_deviator_unrolled(base_tensor &t_, const base_tensor &tc1_)
+      : t(t_), tc1(tc1_) {}
+  };
+
+  template <int N>
+  struct ga_instruction_transpose_unrolled : public ga_instruction {
+    base_tensor &t;
+    const base_tensor &tc1;
+    size_type nn;
+    virtual int exec() {
+      GA_DEBUG_INFO("Instruction: unrolled transpose");
+      GA_DEBUG_ASSERT(t.size() == tc1.size(), "Wrong sizes");
+      size_type n0 = tc1.size() / (N*N*nn);
+      auto it = t.begin();
+      auto it1 = tc1.cbegin();
+      for (size_type i = 0; i < nn; ++i, it1 += N*N*n0)
+        for (size_type j = 0; j < N; ++j)
+          for (size_type k = 0; k < N; ++k) {
+            auto it2 = it1 + (j + k*N)*n0;
+            it = std::copy(it2, it2 + n0, it);
+          }
+      GA_DEBUG_ASSERT(it == t.end(), "Wrong sizes");
+      return 0;
+    }
+    ga_instruction_transpose_unrolled(base_tensor &t_, const base_tensor &tc1_,
+                                      size_type nn_)
+      : t(t_), tc1(tc1_), nn(nn_) {}
+  };
+
+  template <int N>
+  struct ga_instruction_transpose_no_test_unrolled : public ga_instruction {
+    base_tensor &t;
+    const base_tensor &tc1;
+    virtual int exec() {
+      GA_DEBUG_INFO("Instruction: unrolled transpose");
+      GA_DEBUG_ASSERT(t.size() == tc1.size(), "Wrong sizes");
+      size_type nn = t.size() / (N*N);
+      auto it = t.begin();
+      auto it1 = tc1.cbegin();
+      for (size_type i = 0; i < nn; ++i, it1 += N*N)
+        for (size_type j = 0; j < N; ++j)
+          for (size_type k = 0; k < N; ++k, ++it)
+            *it = it1[j + k*N];
+      return 0;
+    }
+    ga_instruction_transpose_no_test_unrolled(base_tensor &t_,
+                                              const base_tensor &tc1_)
+      : t(t_), tc1(tc1_) {}
+  };
+
+  template <int N, bool SKEW>
+  struct ga_instruction_sym_skew_unrolled : public ga_instruction {
+    base_tensor &t;
+    const base_tensor &tc1;
+    virtual int exec() {
+      GA_DEBUG_INFO("Instruction: unrolled symmetric or skew-symmetric part");
+      GA_DEBUG_ASSERT(t.size() == tc1.size(), "Wrong sizes");
+      size_type s = t.size() / (N*N);
+      for (size_type i = 0; i < N;  ++i)
+        for (size_type j = 0; j < N;  ++j) {
+          auto it = t.begin() + s*(i + N*j);
+          auto it1 = tc1.cbegin() + s*(i + N*j);
+          auto it1T = tc1.cbegin() + s*(j + N*i);
+          if (SKEW)
+            for (size_type k = 0; k < s; ++k) *it++ = 0.5*(*it1++ - *it1T++);
+          else
+            for (size_type k = 0; k < s; ++k) *it++ = 0.5*(*it1++ + *it1T++);
+        }
+      return 0;
+    }
+    ga_instruction_sym_skew_unrolled(base_tensor &t_, const base_tensor &tc1_)
+      : t(t_), tc1(tc1_) {}
+  };
+
+  // Selects the unrolled version of an instruction on N x N matrices for
+  // N = 2 or 3, or returns a null pointer.
+  template <template <int> class INSTR, typename... ARGS>
+  pga_instruction ga_unrolled_instruction_switch(size_type N,
+                                                 ARGS&&... args) {
+    switch (N) {
+    case 2: return std::make_shared<INSTR<2>>(std::forward<ARGS>(args)...);
+    case 3: return std::make_shared<INSTR<3>>(std::forward<ARGS>(args)...);
+    default: return nullptr;
+    }
+  }
+  // Dimension of the square matrix given by the two last indices, or 0.
+  inline size_type ga_square_size(const bgeot::multi_index &mi) {
+    size_type o = mi.size();
+    return (o >= 2 && mi[o-2] == mi[o-1]) ? mi[o-1] : 0;
+  }
+
+  template <int N> using ga_instruction_sym_unrolled
+    = ga_instruction_sym_skew_unrolled<N, false>;
+  template <int N> using ga_instruction_skew_unrolled
+    = ga_instruction_sym_skew_unrolled<N, true>;
+
   struct ga_instruction_scalar_add : public ga_instruction {
     scalar_type &t;
     const scalar_type &c, &d;
@@ -3716,7 +3864,7 @@ namespace getfem {
       GA_DEBUG_INFO("Instruction: evaluation of a one argument "
                     "predefined function on tensor");
       GA_DEBUG_ASSERT(t.size() == tc1.size(), "Wrong sizes");
-      for (size_type i = 0; i < t.size(); ++i)  t[i] = F(tc1[i]);
+      F(t.size(), tc1.data(), 1, 0, 0, t.data());
       return 0;
     }
     ga_instruction_eval_func_1arg_expr(base_tensor &t_, base_tensor &c_,
@@ -3781,7 +3929,7 @@ namespace getfem {
       GA_DEBUG_INFO("Instruction: evaluation of a two arguments "
                     "predefined function on one scalar and one tensor");
       GA_DEBUG_ASSERT(t.size() == tc2.size(), "Wrong sizes");
-      for (size_type i = 0; i < t.size(); ++i)  t[i] = F(tc1[0], tc2[i]);
+      F(t.size(), tc1.data(), 0, tc2.data(), 1, t.data());
       return 0;
     }
     ga_instruction_eval_func_2arg_first_scalar_expr
@@ -3815,7 +3963,7 @@ namespace getfem {
       GA_DEBUG_INFO("Instruction: evaluation of a two arguments "
                     "predefined function on one tensor and one scalar");
       GA_DEBUG_ASSERT(t.size() == tc1.size(), "Wrong sizes");
-      for (size_type i = 0; i < t.size(); ++i)  t[i] = F(tc1[i], tc2[0]);
+      F(t.size(), tc1.data(), 1, tc2.data(), 0, t.data());
       return 0;
     }
     ga_instruction_eval_func_2arg_second_scalar_expr
@@ -3850,7 +3998,7 @@ namespace getfem {
       GA_DEBUG_ASSERT(t.size() == tc1.size() && t.size() == tc2.size(),
                       "Wrong sizes");
 
-      for (size_type i = 0; i < t.size(); ++i)  t[i] = F(tc1[i], tc2[i]);
+      F(t.size(), tc1.data(), 1, tc2.data(), 1, t.data());
       return 0;
     }
     ga_instruction_eval_func_2arg_expr(base_tensor &t_, base_tensor &c_,
@@ -6776,10 +6924,20 @@ namespace getfem {
            size_type nn = 1;
            for (size_type i = 2; i < child0->tensor_order(); ++i)
              nn *= child0->tensor_proper_size(i);
-           if (child0->nb_test_functions() == 0)
+           bool no_test = (child0->nb_test_functions() == 0);
+           pgai = nullptr;
+           if (n1 == n2 && no_test)
+             pgai = ga_unrolled_instruction_switch
+               <ga_instruction_transpose_no_test_unrolled>
+               (n1, pnode->tensor(), child0->tensor());
+           else if (n1 == n2)
+             pgai = ga_unrolled_instruction_switch
+               <ga_instruction_transpose_unrolled>
+               (n1, pnode->tensor(), child0->tensor(), nn);
+           if (!pgai && no_test)
              pgai = std::make_shared<ga_instruction_transpose_no_test>
                (pnode->tensor(), child0->tensor(), n1, n2, nn);
-           else
+           else if (!pgai)
              pgai = std::make_shared<ga_instruction_transpose>
                (pnode->tensor(), child0->tensor(), n1, n2, nn);
            rmi.instructions.push_back(std::move(pgai));
@@ -6790,8 +6948,11 @@ namespace getfem {
 
        case GA_SYM:
          if (pnode->tensor_proper_size() != 1) {
-           pgai = std::make_shared<ga_instruction_sym>
-             (pnode->tensor(), child0->tensor());
+           pgai = ga_unrolled_instruction_switch<ga_instruction_sym_unrolled>
+             (ga_square_size(size0), pnode->tensor(), child0->tensor());
+           if (!pgai)
+             pgai = std::make_shared<ga_instruction_sym>
+               (pnode->tensor(), child0->tensor());
            rmi.instructions.push_back(std::move(pgai));
          } else {
            pnode->t.set_to_copy(child0->t);
@@ -6800,8 +6961,11 @@ namespace getfem {
 
        case GA_SKEW:
          {
-           pgai = std::make_shared<ga_instruction_skew>
-             (pnode->tensor(), child0->tensor());
+           pgai = ga_unrolled_instruction_switch<ga_instruction_skew_unrolled>
+             (ga_square_size(size0), pnode->tensor(), child0->tensor());
+           if (!pgai)
+             pgai = std::make_shared<ga_instruction_skew>
+               (pnode->tensor(), child0->tensor());
            rmi.instructions.push_back(std::move(pgai));
          }
          break;
@@ -6812,8 +6976,12 @@ namespace getfem {
            if (N == 1) {
              pnode->t.set_to_copy(child0->t);
            } else {
-             pgai = std::make_shared<ga_instruction_trace>
-               (pnode->tensor(), child0->tensor(), N);
+             pgai = ga_unrolled_instruction_switch
+               <ga_instruction_trace_unrolled>
+               (N, pnode->tensor(), child0->tensor());
+             if (!pgai)
+               pgai = std::make_shared<ga_instruction_trace>
+                 (pnode->tensor(), child0->tensor(), N);
              rmi.instructions.push_back(std::move(pgai));
            }
          }
@@ -6822,8 +6990,12 @@ namespace getfem {
        case GA_DEVIATOR:
          {
            size_type N = (child0->tensor_proper_size() == 1) ? 1:size0.back();
-           pgai = std::make_shared<ga_instruction_deviator>
-             (pnode->tensor(), child0->tensor(), N);
+           pgai = ga_unrolled_instruction_switch
+             <ga_instruction_deviator_unrolled>
+             (N, pnode->tensor(), child0->tensor());
+           if (!pgai)
+             pgai = std::make_shared<ga_instruction_deviator>
+               (pnode->tensor(), child0->tensor(), N);
            rmi.instructions.push_back(std::move(pgai));
          }
          break;
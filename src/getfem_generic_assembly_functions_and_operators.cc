@@ -61,6 +61,36 @@ namespace getfem {
     return 0.;
   }
 
+  void ga_predef_function::operator()(size_type n, const scalar_type *t_,
+                                      size_type inct, const scalar_type *u_,
+                                      size_type incu,
+                                      scalar_type *res) const {
+    switch(ftype_) {
+    case 0:
+      if (nbargs_ == 2)
+        for (size_type i = 0; i < n; ++i, t_ += inct, u_ += incu)
+          res[i] = (*f2_)(*t_, *u_);
+      else
+        for (size_type i = 0; i < n; ++i, t_ += inct)
+          res[i] = (*f1_)(*t_);
+      break;
+    case 1:
+      {
+        base_vector &tt = t.thrd_cast(), &uu = u.thrd_cast();
+        ga_workspace &w = workspace.thrd_cast();
+        uu[0] = scalar_type(0);
+        for (size_type i = 0; i < n; ++i, t_ += inct) {
+          tt[0] = *t_;
+          if (nbargs_ == 2) { uu[0] = *u_; u_ += incu; }
+          w.assembled_potential() = scalar_type(0);
+          ga_function_exec(*gis);
+          res[i] = w.assembled_potential();
+        }
+      }
+      break;
+    }
+  }
+
   bool ga_predef_function::is_affine(const std::string &varname) const {
     if (ftype_ == 1) {
       for (size_type i = 0; i < workspace.thrd_cast().nb_trees(); ++i) {
@@ -247,6 +277,58 @@ namespace getfem {
     }
   };
 
+  // Closed form adjugate (transposed cofactor matrix) of the N x N matrix A
+  // in B (N = 1, 2 or 3). Returns the determinant.
+  template <int N> scalar_type ga_adjugate_unrolled(const scalar_type *A,
+                                                    scalar_type *B);
+  template <> inline scalar_type ga_adjugate_unrolled<1>(const scalar_type *A,
+                                                         scalar_type *B) {
+    B[0] = scalar_type(1);
+    return A[0];
+  }
+  template <> inline scalar_type ga_adjugate_unrolled<2>(const scalar_type *A,
+                                                         scalar_type *B) {
+    B[0] = A[3]; B[1] = -A[1]; B[2] = -A[2]; B[3] = A[0];
+    return A[0]*A[3] - A[1]*A[2];
+  }
+  template <> inline scalar_type ga_adjugate_unrolled<3>(const scalar_type *A,
+                                                         scalar_type *B) {
+    B[0] = A[4]*A[8] - A[5]*A[7]; B[3] = A[5]*A[6] - A[3]*A[8];
+    B[6] = A[3]*A[7] - A[4]*A[6];
+    B[1] = A[2]*A[7] - A[1]*A[8]; B[2] = A[1]*A[5] - A[2]*A[4];
+    B[4] = A[0]*A[8] - A[2]*A[6]; B[5] = A[2]*A[3] - A[0]*A[5];
+    B[7] = A[1]*A[6] - A[0]*A[7]; B[8] = A[0]*A[4] - A[1]*A[3];
+    return A[0] * B[0] + A[1] * B[3] + A[2] * B[6];
+  }
+
+  // Closed form inverse of the N x N matrix A in B (N = 1, 2 or 3).
+  // Returns the determinant, B is not computed for a singular matrix.
+  template <int N> inline scalar_type ga_inverse_unrolled(const scalar_type *A,
+                                                          scalar_type *B) {
+    scalar_type adj[9];
+    scalar_type det = ga_adjugate_unrolled<N>(A, adj);
+    if (det != scalar_type(0))
+      for (int i = 0; i < N*N; ++i) B[i] = adj[i] / det;
+    return det;
+  }
+
+  // Inverse of the N x N matrix t, computed in B (of size at least 9) for
+  // N <= 3 and in __mat_aux1() otherwise. Returns a pointer on the
+  // inverse and the determinant in det.
+  static const scalar_type *ga_inverse(const base_tensor &t, size_type N,
+                                       scalar_type *B, scalar_type &det) {
+    switch (N) {
+    case 1: det = ga_inverse_unrolled<1>(t.data(), B); return B;
+    case 2: det = ga_inverse_unrolled<2>(t.data(), B); return B;
+    case 3: det = ga_inverse_unrolled<3>(t.data(), B); return B;
+    default:
+      __mat_aux1().base_resize(N, N);
+      gmm::copy(t.as_vector(), __mat_aux1().as_vector());
+      det = bgeot::lu_inverse(__mat_aux1());
+      return &(*(__mat_aux1().begin()));
+    }
+  }
+
   // Det Operator
   struct det_operator : public ga_nonlinear_operator {
     bool result_size(const arg_list &args, bgeot::multi_index &sizes) const {
@@ -264,54 +346,70 @@ namespace getfem {
       result[0] = bgeot::lu_det(&(*(args[0]->begin())), N);
     }
 
-    // Derivative : det(M)M^{-T}
+    // Derivative : det(M)M^{-T}, i.e. the cofactor matrix of M, computed
+    // without dividing by det(M) for N <= 3 (it does not vanish for a
+    // singular matrix of rank N-1).
     void derivative(const arg_list &args, size_type,
                     base_tensor &result) const {
       size_type N = args[0]->sizes()[0];
-      if (N) {
-        __mat_aux1().base_resize(N, N);
-        gmm::copy(args[0]->as_vector(), __mat_aux1().as_vector());
-        scalar_type det = bgeot::lu_inverse(__mat_aux1());
+      const scalar_type *A = &(*(args[0]->begin()));
+      scalar_type B[9], det(1);
+      const scalar_type *a = B;
+      switch (N) {
+      case 0: return;
+      case 1: ga_adjugate_unrolled<1>(A, B); break;
+      case 2: ga_adjugate_unrolled<2>(A, B); break;
+      case 3: ga_adjugate_unrolled<3>(A, B); break;
+      default:
+        a = ga_inverse(*args[0], N, B, det);
         if (det == scalar_type(0))
-          gmm::clear(result.as_vector());
-        else {
-          auto it = result.begin();
-          auto ita = __mat_aux1().begin();
-          for (size_type j = 0; j < N; ++j, ++ita) {
-            auto itaa = ita;
-            *it = (*itaa) * det; ++it;
-            for (size_type i = 1; i < N; ++i, ++it)
-              { itaa += N; *it = (*itaa) * det; }
-          }
-          GA_DEBUG_ASSERT(it == result.end(), "Internal error");
-        }
+          { gmm::clear(result.as_vector()); return; }
       }
+      auto it = result.begin();
+      for (size_type j = 0; j < N; ++j)
+        for (size_type i = 0; i < N; ++i, ++it)
+          *it = a[j+i*N] * det;
+      GA_DEBUG_ASSERT(it == result.end(), "Internal error");
     }
 
     // Second derivative : det(M)(M^{-T}@M^{-T} - M^{-T}_{kj}M^{-T}_{il})
     //                   = det(M)(M^{-1}_{ji}@M^{-1}_{lk} - M^{-1}_{jk}M^{-1}_{li})
+    // For N <= 3, it is computed from the expansion of the determinant:
+    // for i != k and j != l, the signed complementary minor of the rows
+    // i, k and columns j, l (M_{mn} for N = 3, 1 for N = 2).
     void second_derivative(const arg_list &args, size_type, size_type,
                            base_tensor &result) const {
       size_type N = args[0]->sizes()[0];
-      __mat_aux1().base_resize(N, N);
-      gmm::copy(args[0]->as_vector(), __mat_aux1().as_vector());
-      scalar_type det = bgeot::lu_inverse(__mat_aux1());
+      if (N <= 3) {
+        const base_tensor &t = *args[0];
+        // sign of the permutation (a, b, 3-a-b) of (0, 1, 2), or of (a, b)
+        // of (0, 1) for N = 2
+        auto eps = [N](size_type a, size_type b) {
+          return (N == 2) ? ((a < b) ? 1 : -1) : (((b+3-a) % 3 == 1) ? 1 : -1);
+        };
+        auto it = result.begin();
+        for (size_type l = 0; l < N; ++l)
+          for (size_type k = 0; k < N; ++k)
+            for (size_type j = 0; j < N; ++j)
+              for (size_type i = 0; i < N; ++i, ++it) {
+                if (i == k || j == l) { *it = scalar_type(0); continue; }
+                scalar_type s = scalar_type(eps(i, k) * eps(j, l));
+                *it = (N == 2) ? s : s * t[(3-i-k) + (3-j-l)*N];
+              }
+        GA_DEBUG_ASSERT(it == result.end(), "Internal error");
+        return;
+      }
+      scalar_type B[9], det;
+      const scalar_type *a = ga_inverse(*args[0], N, B, det);
       if (det == scalar_type(0))
         gmm::clear(result.as_vector());
       else {
         auto it = result.begin();
-        auto ita = __mat_aux1().begin();
-        for (size_type l = 0; l < N; ++l) {
-          auto ita_lk = ita + l, ita_0k = ita;
-          for (size_type k = 0; k < N; ++k, ita_lk += N, ita_0k += N) {
-            auto ita_jk = ita_0k;
-            for (size_type j = 0; j < N; ++j, ++ita_jk) {
-              auto ita_ji = ita + j, ita_li = ita + l;
-              for (size_type i = 0; i < N; ++i, ++it, ita_ji += N, ita_li += N)
-                *it = ((*ita_ji) * (*ita_lk) - (*ita_jk) * (*ita_li)) * det;
-            }
-          }
-        }
+        for (size_type l = 0; l < N; ++l)
+          for (size_type k = 0; k < N; ++k)
+            for (size_type j = 0; j < N; ++j)
+              for (size_type i = 0; i < N; ++i, ++it)
+                *it = (a[j+i*N] * a[l+k*N] - a[j+k*N] * a[l+i*N]) * det;
         GA_DEBUG_ASSERT(it == result.end(), "Internal error");
       }
     }
@@ -329,10 +427,10 @@ namespace getfem {
     // Value : M^{-1}
     void value(const arg_list &args, base_tensor &result) const {
       size_type N = args[0]->sizes()[0];
-      __mat_aux1().base_resize(N, N);
-      gmm::copy(args[0]->as_vector(), __mat_aux1().as_vector());
-      bgeot::lu_inverse(__mat_aux1());
-      gmm::copy(__mat_aux1().as_vector(), result.as_vector());
+      scalar_type B[9], det;
+      const scalar_type *a = ga_inverse(*args[0], N, B, det);
+      GMM_ASSERT1(det != scalar_type(0), "Non invertible matrix");
+      std::copy(a, a+N*N, result.begin());
     }
 
     // Derivative : -M^{-1}{ik}M^{-1}{lj}  (comes from H -> -M^{-1}HM^{-1})
@@ -340,24 +438,15 @@ namespace getfem {
                     base_tensor &result) const { // to be verified
       size_type N = args[0]->sizes()[0];
       if (!N) return;
-      __mat_aux1().base_resize(N, N);
-      gmm::copy(args[0]->as_vector(), __mat_aux1().as_vector());
-      bgeot::lu_inverse(__mat_aux1());
+      scalar_type B[9], det;
+      const scalar_type *a = ga_inverse(*args[0], N, B, det);
+      GMM_ASSERT1(det != scalar_type(0), "Non invertible matrix");
       auto it = result.begin();
-      auto ita = __mat_aux1().begin(), ita_l = ita;
-      for (size_type l = 0; l < N; ++l, ++ita_l) {
-        auto ita_k = ita;
-        for (size_type k = 0; k < N; ++k, ita_k += N) {
-          auto ita_lj = ita_l, ita_ik = ita_k;
-          for (size_type i = 0; i < N; ++i, ++it, ++ita_ik)
-              *it = -(*ita_ik) * (*ita_lj);
-          for (size_type j = 1; j < N; ++j) {
-            ita_lj += N; ita_ik = ita_k;
-            for (size_type i = 0; i < N; ++i, ++it, ++ita_ik)
-              *it = -(*ita_ik) * (*ita_lj);
-          }
-        }
-      }
+      for (size_type l = 0; l < N; ++l)
+        for (size_type k = 0; k < N; ++k)
+          for (size_type j = 0; j < N; ++j)
+            for (size_type i = 0; i < N; ++i, ++it)
+              *it = -a[i+k*N] * a[l+j*N];
       GA_DEBUG_ASSERT(it == result.end(), "Internal error");
     }
 
@@ -367,9 +456,9 @@ namespace getfem {
     void second_derivative(const arg_list &args, size_type, size_type,
                            base_tensor &result) const { // to be verified
       size_type N = args[0]->sizes()[0];
-      __mat_aux1().base_resize(N, N);
-      gmm::copy(args[0]->as_vector(), __mat_aux1().as_vector());
-      bgeot::lu_inverse(__mat_aux1());
+      scalar_type B[9], det;
+      const scalar_type *a = ga_inverse(*args[0], N, B, det);
+      GMM_ASSERT1(det != scalar_type(0), "Non invertible matrix");
       base_tensor::iterator it = result.begin();
       for (size_type n = 0; n < N; ++n)
         for (size_type m = 0; m < N; ++m)
@@ -377,8 +466,8 @@ namespace getfem {
             for (size_type k = 0; k < N; ++k)
               for (size_type j = 0; j < N; ++j)
                 for (size_type i = 0; i < N; ++i, ++it)
-                  *it = __mat_aux1()(i,k)*__mat_aux1()(l,m)*__mat_aux1()(n,j)
-                    + __mat_aux1()(i,m)*__mat_aux1()(n,k)*__mat_aux1()(l,j);
+                  *it = a[i+k*N]*a[l+m*N]*a[n+j*N]
+                    + a[i+m*N]*a[n+k*N]*a[l+j*N];
       GA_DEBUG_ASSERT(it == result.end(), "Internal error");
     }
   };
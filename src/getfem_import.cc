@@ -22,6 +22,8 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <cstring>
+#include <unordered_map>
 
 #include "getfem/getfem_mesh.h"
 #include "getfem/getfem_import.h"
@@ -176,6 +178,253 @@ namespace getfem {
     }
   };
 
+  /* Reordering of the nodes of a gmsh element to the GetFEM order
+     (should be completed ?).
+     http://www.geuz.org/gmsh/doc/texinfo/gmsh.html#Node-ordering */
+  static void gmsh_to_getfem_node_order(unsigned type, size_type *nodes,
+                                        size_type nb) {
+    size_type tmp_nodes[32];
+    GMM_ASSERT1(nb <= 32, "Too many nodes in a gmsh element");
+    std::copy(nodes, nodes + nb, tmp_nodes);
+    switch(type) {
+    case 3 : {
+      nodes[2] = tmp_nodes[3];
+      nodes[3] = tmp_nodes[2];
+    } break;
+    case 5 : { /* First order hexaedron */
+      //nodes[0] = tmp_nodes[0];
+      //nodes[1] = tmp_nodes[1];
+      nodes[2] = tmp_nodes[3];
+      nodes[3] = tmp_nodes[2];
+      //nodes[4] = tmp_nodes[4];
+      //nodes[5] = tmp_nodes[5];
+      nodes[6] = tmp_nodes[7];
+      nodes[7] = tmp_nodes[6];
+    } break;
+    case 7 : { /* first order pyramid */
+      //nodes[0] = tmp_nodes[0];
+      nodes[1] = tmp_nodes[2];
+      nodes[2] = tmp_nodes[1];
+      // nodes[3] = tmp_nodes[3];
+      // nodes[4] = tmp_nodes[4];
+    } break;
+    case 8 : { /* Second order line */
+      //nodes[0] = tmp_nodes[0];
+      nodes[1] = tmp_nodes[2];
+      nodes[2] = tmp_nodes[1];
+    } break;
+    case 9 : { /* Second order triangle */
+      //nodes[0] = tmp_nodes[0];
+      nodes[1] = tmp_nodes[3];
+      nodes[2] = tmp_nodes[1];
+      nodes[3] = tmp_nodes[5];
+      //nodes[4] = tmp_nodes[4];
+      nodes[5] = tmp_nodes[2];
+    } break;
+    case 10 : { /* Second order quadrangle */
+      //nodes[0] = tmp_nodes[0];
+      nodes[1] = tmp_nodes[4];
+      nodes[2] = tmp_nodes[1];
+      nodes[3] = tmp_nodes[7];
+      nodes[4] = tmp_nodes[8];
+      //nodes[5] = tmp_nodes[5];
+      nodes[6] = tmp_nodes[3];
+      nodes[7] = tmp_nodes[6];
+      nodes[8] = tmp_nodes[2];
+    } break;
+    case 11: { /* Second order tetrahedron */
+      //nodes[0] = tmp_nodes[0];
+      nodes[1] = tmp_nodes[4];
+      nodes[2] = tmp_nodes[1];
+      nodes[3] = tmp_nodes[6];
+      nodes[4] = tmp_nodes[5];
+      nodes[5] = tmp_nodes[2];
+      nodes[6] = tmp_nodes[7];
+      nodes[7] = tmp_nodes[9];
+      //nodes[8] = tmp_nodes[8];
+      nodes[9] = tmp_nodes[3];
+    } break;
+    case 12: { /* Second order hexahedron */
+      //nodes[0] = tmp_nodes[0];
+      nodes[1] = tmp_nodes[8];
+      nodes[2] = tmp_nodes[1];
+      nodes[3] = tmp_nodes[9];
+      nodes[4] = tmp_nodes[20];
+      nodes[5] = tmp_nodes[11];
+      nodes[6] = tmp_nodes[3];
+      nodes[7] = tmp_nodes[13];
+      nodes[8] = tmp_nodes[2];
+      nodes[9] = tmp_nodes[10];
+      nodes[10] = tmp_nodes[21];
+      nodes[11] = tmp_nodes[12];
+      nodes[12] = tmp_nodes[22];
+      nodes[13] = tmp_nodes[26];
+      nodes[14] = tmp_nodes[23];
+      //nodes[15] = tmp_nodes[15];
+      nodes[16] = tmp_nodes[24];
+      nodes[17] = tmp_nodes[14];
+      nodes[18] = tmp_nodes[4];
+      nodes[19] = tmp_nodes[16];
+      nodes[20] = tmp_nodes[5];
+      nodes[21] = tmp_nodes[17];
+      nodes[22] = tmp_nodes[25];
+      nodes[23] = tmp_nodes[18];
+      nodes[24] = tmp_nodes[7];
+      nodes[25] = tmp_nodes[19];
+      nodes[26] = tmp_nodes[6];
+    } break;
+    case 16 : { /* Incomplete second order quadrangle */
+      //nodes[0] = tmp_nodes[0];
+      nodes[1] = tmp_nodes[4];
+      nodes[2] = tmp_nodes[1];
+      nodes[3] = tmp_nodes[7];
+      nodes[4] = tmp_nodes[5];
+      nodes[5] = tmp_nodes[3];
+      nodes[6] = tmp_nodes[6];
+      nodes[7] = tmp_nodes[2];
+    } break;
+    case 17: { /* Incomplete second order hexahedron */
+      //nodes[0] = tmp_nodes[0];
+      nodes[1] = tmp_nodes[8];
+      nodes[2] = tmp_nodes[1];
+      nodes[3] = tmp_nodes[9];
+      nodes[4] = tmp_nodes[11];
+      nodes[5] = tmp_nodes[3];
+      nodes[6] = tmp_nodes[13];
+      nodes[7] = tmp_nodes[2];
+      nodes[8] = tmp_nodes[10];
+      nodes[9] = tmp_nodes[12];
+      nodes[10] = tmp_nodes[15];
+      nodes[11] = tmp_nodes[14];
+      nodes[12] = tmp_nodes[4];
+      nodes[13] = tmp_nodes[16];
+      nodes[14] = tmp_nodes[5];
+      nodes[15] = tmp_nodes[17];
+      nodes[16] = tmp_nodes[18];
+      nodes[17] = tmp_nodes[7];
+      nodes[18] = tmp_nodes[19];
+      nodes[19] = tmp_nodes[6];
+    } break;
+    case 26 : { /* Third order line */
+      //nodes[0] = tmp_nodes[0];
+      nodes[1] = tmp_nodes[2];
+      nodes[2] = tmp_nodes[3];
+      nodes[3] = tmp_nodes[1];
+    } break;
+    case 21 : { /* Third order triangle */
+      //nodes[0] = tmp_nodes[0];
+      nodes[1] = tmp_nodes[3];
+      nodes[2] = tmp_nodes[4];
+      nodes[3] = tmp_nodes[1];
+      nodes[4] = tmp_nodes[8];
+      nodes[5] = tmp_nodes[9];
+      nodes[6] = tmp_nodes[5];
+      //nodes[7] = tmp_nodes[7];
+      nodes[8] = tmp_nodes[6];
+      nodes[9] = tmp_nodes[2];
+    } break;
+    case 23: { /* Fourth order triangle */
+    //nodes[0]  = tmp_nodes[0];
+      nodes[1]  = tmp_nodes[3];
+      nodes[2]  = tmp_nodes[4];
+      nodes[3]  = tmp_nodes[5];
+      nodes[4]  = tmp_nodes[1];
+      nodes[5]  = tmp_nodes[11];
+      nodes[6]  = tmp_nodes[12];
+      nodes[7]  = tmp_nodes[13];
+      nodes[8]  = tmp_nodes[6];
+      nodes[9]  = tmp_nodes[10];
+      nodes[10] = tmp_nodes[14];
+      nodes[11] = tmp_nodes[7];
+      nodes[12] = tmp_nodes[9];
+      nodes[13] = tmp_nodes[8];
+      nodes[14] = tmp_nodes[2];
+    } break;
+    case 27: { /* Fourth order line */
+    //nodes[0]  = tmp_nodes[0];
+      nodes[1]  = tmp_nodes[2];
+      nodes[2]  = tmp_nodes[3];
+      nodes[3]  = tmp_nodes[4];
+      nodes[4]  = tmp_nodes[1];
+    } break;
+    }
+  }
+
+  /* Insertion of a gmsh element in a mesh of dimension N. The elements of
+     lower dimension are added to the regions as faces of the elements of
+     higher dimension, or as independant convexes (see below). */
+  static void gmsh_add_element
+  (mesh &m, unsigned N, unsigned id, unsigned type, unsigned region,
+   bgeot::pgeometric_trans pgt, const size_type *nodes, size_type nb_nodes,
+   std::set<size_type> *lower_dim_convex_rg, bool add_all_element_type,
+   std::map<size_type, std::set<size_type>> *nodal_map) {
+    bool cvok = false;
+    bool is_node = (type == 15);
+    unsigned ci_dim = (is_node) ? 0 : pgt->dim();
+    //  cout << "importing cv dim=" << ci_dim << " N=" << N
+    //       << " region: " << region << " type: " << type << "\n";
+
+    //main convex import
+    if (ci_dim == N) {
+      size_type ic = m.add_convex(pgt, nodes);
+      cvok = true;
+      m.region(region).add(ic);
+
+    //convexes with lower dimensions
+    }
+    else {
+      //convex that lies within the regions of lower_dim_convex_rg
+      //is imported explicitly as a convex.
+      if (lower_dim_convex_rg != NULL &&
+          lower_dim_convex_rg->find(region) != lower_dim_convex_rg->end()
+          && !is_node) {
+          size_type ic = m.add_convex(pgt, nodes);
+          cvok = true; m.region(region).add(ic);
+      }
+      //find if the convex is part of a face of higher dimension convex
+      else{
+        bgeot::mesh_structure::ind_cv_ct ct=m.convex_to_point(nodes[0]);
+        for (bgeot::mesh_structure::ind_cv_ct::const_iterator
+               it = ct.begin(); it != ct.end(); ++it) {
+          if (m.structure_of_convex(*it)->dim() == ci_dim + 1) {
+            for (short_type face=0;
+                 face < m.structure_of_convex(*it)->nb_faces(); ++face) {
+              if (m.is_convex_face_having_points(*it, face,
+                                                 short_type(nb_nodes),
+                                                 nodes)) {
+                m.region(region).add(*it,face);
+                cvok = true;
+              }
+            }
+          }
+        }
+        if (is_node && (nodal_map != NULL)) {
+          for (size_type i = 0; i < nb_nodes; ++i)
+            (*nodal_map)[region].insert(nodes[i]);
+        }
+        // if the convex is not part of the face of others
+        if (!cvok) {
+          if (is_node) {
+            if (nodal_map == NULL){
+              GMM_WARNING2("gmsh import ignored a node id: "
+                           << id << " region :" << region <<
+                           " point is not added explicitly as an element.");
+            }
+          }
+          else if (add_all_element_type) {
+            size_type ic = m.add_convex(pgt, nodes);
+            m.region(region).add(ic);
+            cvok = true;
+          } else {
+            GMM_WARNING2("gmsh import ignored an element of type "
+                         << bgeot::name_of_geometric_trans(pgt) <<
+                " as it does not belong to the face of another element");
+          }
+        }
+      }
+    }
+  }
+
   std::map<std::string, size_type> read_region_names_from_gmsh_mesh_file(std::istream& f)
   {
     std::map<std::string, size_type> region_map;
@@ -200,6 +449,277 @@ namespace getfem {
     return region_map;
   }
 
+  /* Buffered reading of a gmsh file in format 4.1, ASCII or binary. The
+     stream is read by blocks of 1MB and the numbers are converted directly
+     in the buffer, which is always terminated by a null character. */
+  class gmsh41_reader {
+    std::istream &f;
+    std::ios::iostate exceptions;
+    std::vector<char> buf;
+    size_type pos, end;
+    bool eof_;
+
+    // Ensure that at least n characters are available, if possible.
+    bool fill(size_type n) {
+      if (end - pos >= n) return true;
+      if (eof_) return false;
+      std::copy(buf.begin() + pos, buf.begin() + end, buf.begin());
+      end -= pos; pos = 0;
+      if (buf.size() < n + 1) buf.resize(n + 1);
+      while (end < n && !eof_) {
+        f.read(&buf[end], std::streamsize(buf.size() - 1 - end));
+        end += size_type(f.gcount());
+        if (!f) eof_ = true;
+      }
+      buf[end] = '\0';
+      return end - pos >= n;
+    }
+
+    const char *token() {
+      while (fill(1) && isspace(static_cast<unsigned char>(buf[pos]))) ++pos;
+      fill(64); // enough for any number
+      return &buf[pos];
+    }
+
+    template <typename T> T get() {
+      GMM_ASSERT1(fill(sizeof(T)), "Unexpected end of gmsh file");
+      T v;
+      std::memcpy(&v, &buf[pos], sizeof(T));
+      pos += sizeof(T);
+      return v;
+    }
+
+  public :
+    bool binary;
+    size_type data_size;
+
+    size_type read_size() {
+      if (binary)
+        return (data_size == 8) ? size_type(get<gmm::uint64_type>())
+                                : size_type(get<gmm::uint32_type>());
+      const char *b = token(); char *e;
+      unsigned long long v = strtoull(b, &e, 10);
+      GMM_ASSERT1(e != b, "Syntax error in gmsh file");
+      pos += size_type(e - b);
+      return size_type(v);
+    }
+
+    int read_int() {
+      if (binary) return get<int>();
+      const char *b = token(); char *e;
+      long v = strtol(b, &e, 10);
+      GMM_ASSERT1(e != b, "Syntax error in gmsh file");
+      pos += size_type(e - b);
+      return int(v);
+    }
+
+    double read_double() {
+      if (binary) return get<double>();
+      const char *b = token(); char *e;
+      double v = strtod(b, &e);
+      GMM_ASSERT1(e != b, "Syntax error in gmsh file");
+      pos += size_type(e - b);
+      return v;
+    }
+
+    /* Read the end of the current line, without the leading and trailing
+       blank characters. */
+    std::string read_line() {
+      size_type i = 0; // position relative to pos, which fill may change
+      for (;;) {
+        while (pos + i < end && buf[pos+i] != '\n') ++i;
+        if (pos + i < end || !fill(i + 1)) break;
+      }
+      size_type b = pos, e = pos + i;
+      pos = (e < end) ? e + 1 : end;
+      while (b < e && isspace(static_cast<unsigned char>(buf[b]))) ++b;
+      while (e > b && isspace(static_cast<unsigned char>(buf[e-1]))) --e;
+      return std::string(buf.begin() + b, buf.begin() + e);
+    }
+
+    void skip_to(const std::string &s) {
+      while (!eof() && read_line() != s) {}
+    }
+
+    bool eof() { return !fill(1); }
+
+    // The end of file is detected without exception.
+    explicit gmsh41_reader(std::istream &f_)
+      : f(f_), exceptions(f_.exceptions()), buf(size_type(1) << 20), pos(0),
+        end(0), eof_(false), binary(false), data_size(8) {
+      buf[0] = '\0';
+      f.exceptions(exceptions & std::ios::badbit);
+    }
+    ~gmsh41_reader() { f.clear(); f.exceptions(exceptions); }
+  };
+
+  /* Streaming import of the format 4.1 (ASCII or binary). The nodes are
+     identified by their tags, so that they are added without search of
+     duplicated points, and the elements of a block share the same type
+     and region and are stored in a single array of nodes. */
+  static void import_gmsh41_mesh_file
+  (std::istream& f, mesh& m, std::map<std::string, size_type> *region_map,
+   std::set<size_type> *lower_dim_convex_rg, bool add_all_element_type,
+   bool remove_last_dimension,
+   std::map<size_type, std::set<size_type>> *nodal_map) {
+    gmm::standard_locale sl;
+    gmsh41_reader s(f);
+    int file_type = s.read_int();
+    s.data_size = s.read_size();
+    s.read_line();
+    GMM_ASSERT1(s.data_size == 4 || s.data_size == 8,
+                "Unsupported data size " << s.data_size << " in gmsh file");
+    if (file_type == 1) {
+      s.binary = true;
+      GMM_ASSERT1(s.read_int() == 1, "Binary gmsh file written on a machine "
+                  "of different endianness");
+    }
+    s.skip_to("$EndMeshFormat");
+
+    // Correspondance between the node tags and the getfem nodes, in a
+    // vector when the tags are dense and in a map otherwise.
+    size_type min_tag = 0;
+    std::vector<size_type> tag_2_node;
+    std::unordered_map<size_type, size_type> tag_2_node_map;
+    auto getfem_node = [&](size_type tag) {
+      size_type ip = size_type(-1);
+      if (!tag_2_node.empty()) {
+        if (tag >= min_tag && tag - min_tag < tag_2_node.size())
+          ip = tag_2_node[tag - min_tag];
+      } else {
+        auto it = tag_2_node_map.find(tag);
+        if (it != tag_2_node_map.end()) ip = it->second;
+      }
+      GMM_ASSERT1(ip != size_type(-1), "Invalid node ID " << tag
+                  << " in gmsh file");
+      return ip;
+    };
+
+    struct element_block {
+      unsigned dim, type, region;
+      bgeot::pgeometric_trans pgt;
+      size_type nb_nodes;
+      std::vector<unsigned> ids;
+      std::vector<size_type> nodes;
+    };
+    std::vector<element_block> blocks;
+    dal::bit_vector reg;
+
+    while (!s.eof()) {
+      std::string section = s.read_line();
+      if (section.empty()) continue;
+      GMM_ASSERT1(section[0] == '$', "Syntax error in gmsh file near '"
+                  << section << "'");
+      if (section == "$PhysicalNames") { // Always in ASCII
+        bool binary = s.binary; s.binary = false;
+        size_type nb_regions = s.read_size();
+        s.read_line();
+        for (size_type i = 0; i < nb_regions; ++i) {
+          s.read_int();
+          size_type ri = s.read_size();
+          std::string region_name = s.read_line();
+          size_t p = region_name.find_first_of("\"");
+          if (p != region_name.npos) {
+            region_name.erase(0, p+1);
+            p = region_name.find_last_of("\"");
+            region_name.erase(p);
+          }
+          if (region_map) (*region_map)[region_name] = ri;
+        }
+        s.binary = binary;
+      } else if (section == "$Nodes") {
+        size_type nb_block = s.read_size(), nb_node = s.read_size();
+        min_tag = s.read_size();
+        size_type max_tag = s.read_size();
+        if (nb_node && max_tag >= min_tag
+            && max_tag - min_tag < 2 * nb_node + 1024)
+          tag_2_node.assign(max_tag - min_tag + 1, size_type(-1));
+        std::vector<size_type> tags;
+        base_node pt(3);
+        for (size_type block = 0; block < nb_block; ++block) {
+          int entity_dim = s.read_int();
+          s.read_int();
+          int parametric = s.read_int();
+          size_type nb = s.read_size();
+          tags.resize(nb);
+          for (size_type i = 0; i < nb; ++i) tags[i] = s.read_size();
+          size_type nbc = 3 + (parametric ? size_type(entity_dim) : 0);
+          for (size_type i = 0; i < nb; ++i) {
+            for (size_type k = 0; k < nbc; ++k) {
+              double c = s.read_double();
+              if (k < 3) pt[k] = c;
+            }
+            size_type ip = m.add_point(pt, scalar_type(-1));
+            if (!tag_2_node.empty()) {
+              GMM_ASSERT1(tags[i] >= min_tag && tags[i] <= max_tag,
+                          "Invalid node ID " << tags[i] << " in gmsh file");
+              tag_2_node[tags[i] - min_tag] = ip;
+            } else
+              tag_2_node_map[tags[i]] = ip;
+          }
+        }
+      } else if (section == "$Elements") {
+        size_type nb_block = s.read_size();
+        s.read_size(); s.read_size(); s.read_size();
+        for (size_type block = 0; block < nb_block; ++block) {
+          s.read_int();
+          unsigned region = unsigned(s.read_int());
+          unsigned type = unsigned(s.read_int());
+          size_type nb = s.read_size();
+          if (reg.is_in(region)) {
+            GMM_WARNING2("Two regions share the same number, "
+                         "the region numbering is modified");
+            while (reg.is_in(region)) region += 5;
+          }
+          reg.add(region);
+
+          gmsh_cv_info ci;
+          ci.type = type;
+          ci.set_nb_nodes();
+          if (type != 15) ci.set_pgt();
+          blocks.push_back(element_block());
+          element_block &eb = blocks.back();
+          eb.type = type; eb.region = region; eb.pgt = ci.pgt;
+          eb.dim = (type == 15) ? 0 : ci.pgt->dim();
+          eb.nb_nodes = ci.nodes.size();
+          eb.ids.resize(nb);
+          eb.nodes.resize(nb * eb.nb_nodes);
+          for (size_type i = 0; i < nb; ++i) {
+            eb.ids[i] = unsigned(s.read_size() - 1);
+            size_type *nodes = &(eb.nodes[i * eb.nb_nodes]);
+            for (size_type j = 0; j < eb.nb_nodes; ++j)
+              nodes[j] = getfem_node(s.read_size());
+            gmsh_to_getfem_node_order(type, nodes, eb.nb_nodes);
+          }
+        }
+      }
+      s.skip_to("$End" + section.substr(1));
+    }
+
+    std::stable_sort(blocks.begin(), blocks.end(),
+                     [](const element_block &a, const element_block &b) {
+                       if (a.dim == b.dim) return a.region < b.region;
+                       return a.dim > b.dim;
+                     });
+    if (blocks.size()) {
+      if (blocks.front().type == 15) {
+        GMM_WARNING2("Only nodes defined in the mesh! No elements are added.");
+        return;
+      }
+      unsigned N = blocks.front().dim;
+      for (element_block &eb : blocks) {
+        for (size_type i = 0; i < eb.ids.size(); ++i)
+          gmsh_add_element(m, N, eb.ids[i], eb.type, eb.region, eb.pgt,
+                           &(eb.nodes[i * eb.nb_nodes]), eb.nb_nodes,
+                           lower_dim_convex_rg, add_all_element_type,
+                           nodal_map);
+        eb.ids = std::vector<unsigned>();
+        eb.nodes = std::vector<size_type>();
+      }
+    }
+    if (remove_last_dimension) maybe_remove_last_dimension(m);
+  }
+
   /*
      Format version 1 [for gmsh version < 2.0].
      structure: $NOD list_of_nodes $ENDNOD $ELT list_of_elt $ENDELT
@@ -256,6 +776,13 @@ namespace getfem {
     else
       GMM_ASSERT1(false, "can't read Gmsh format: " << header);
 
+    if (version >= 4.05) {
+      import_gmsh41_mesh_file(f, m, region_map, lower_dim_convex_rg,
+                              add_all_element_type, remove_last_dimension,
+                              nodal_map);
+      return;
+    }
+
     /* read the region names */
     if (region_map != NULL) {
       if (version >= 2.) {
@@ -379,171 +906,7 @@ namespace getfem {
         }
         if (ci.type != 15)
           ci.set_pgt();
-        // Reordering nodes for certain elements (should be completed ?)
-        // http://www.geuz.org/gmsh/doc/texinfo/gmsh.html#Node-ordering
-        std::vector<size_type> tmp_nodes(ci.nodes);
-        switch(ci.type) {
-        case 3 : {
-          ci.nodes[2] = tmp_nodes[3];
-          ci.nodes[3] = tmp_nodes[2];
-        } break;
-        case 5 : { /* First order hexaedron */
-          //ci.nodes[0] = tmp_nodes[0];
-          //ci.nodes[1] = tmp_nodes[1];
-          ci.nodes[2] = tmp_nodes[3];
-          ci.nodes[3] = tmp_nodes[2];
-          //ci.nodes[4] = tmp_nodes[4];
-          //ci.nodes[5] = tmp_nodes[5];
-          ci.nodes[6] = tmp_nodes[7];
-          ci.nodes[7] = tmp_nodes[6];
-        } break;
-        case 7 : { /* first order pyramid */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[2];
-          ci.nodes[2] = tmp_nodes[1];
-          // ci.nodes[3] = tmp_nodes[3];
-          // ci.nodes[4] = tmp_nodes[4];
-        } break;
-        case 8 : { /* Second order line */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[2];
-          ci.nodes[2] = tmp_nodes[1];
-        } break;
-        case 9 : { /* Second order triangle */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[3];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[5];
-          //ci.nodes[4] = tmp_nodes[4];
-          ci.nodes[5] = tmp_nodes[2];
-        } break;
-        case 10 : { /* Second order quadrangle */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[4];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[7];
-          ci.nodes[4] = tmp_nodes[8];
-          //ci.nodes[5] = tmp_nodes[5];
-          ci.nodes[6] = tmp_nodes[3];
-          ci.nodes[7] = tmp_nodes[6];
-          ci.nodes[8] = tmp_nodes[2];
-        } break;
-        case 11: { /* Second order tetrahedron */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[4];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[6];
-          ci.nodes[4] = tmp_nodes[5];
-          ci.nodes[5] = tmp_nodes[2];
-          ci.nodes[6] = tmp_nodes[7];
-          ci.nodes[7] = tmp_nodes[9];
-          //ci.nodes[8] = tmp_nodes[8];
-          ci.nodes[9] = tmp_nodes[3];
-        } break;
-        case 12: { /* Second order hexahedron */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[8];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[9];
-          ci.nodes[4] = tmp_nodes[20];
-          ci.nodes[5] = tmp_nodes[11];
-          ci.nodes[6] = tmp_nodes[3];
-          ci.nodes[7] = tmp_nodes[13];
-          ci.nodes[8] = tmp_nodes[2];
-          ci.nodes[9] = tmp_nodes[10];
-          ci.nodes[10] = tmp_nodes[21];
-          ci.nodes[11] = tmp_nodes[12];
-          ci.nodes[12] = tmp_nodes[22];
-          ci.nodes[13] = tmp_nodes[26];
-          ci.nodes[14] = tmp_nodes[23];
-          //ci.nodes[15] = tmp_nodes[15];
-          ci.nodes[16] = tmp_nodes[24];
-          ci.nodes[17] = tmp_nodes[14];
-          ci.nodes[18] = tmp_nodes[4];
-          ci.nodes[19] = tmp_nodes[16];
-          ci.nodes[20] = tmp_nodes[5];
-          ci.nodes[21] = tmp_nodes[17];
-          ci.nodes[22] = tmp_nodes[25];
-          ci.nodes[23] = tmp_nodes[18];
-          ci.nodes[24] = tmp_nodes[7];
-          ci.nodes[25] = tmp_nodes[19];
-          ci.nodes[26] = tmp_nodes[6];
-        } break;
-        case 16 : { /* Incomplete second order quadrangle */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[4];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[7];
-          ci.nodes[4] = tmp_nodes[5];
-          ci.nodes[5] = tmp_nodes[3];
-          ci.nodes[6] = tmp_nodes[6];
-          ci.nodes[7] = tmp_nodes[2];
-        } break;
-        case 17: { /* Incomplete second order hexahedron */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[8];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[9];
-          ci.nodes[4] = tmp_nodes[11];
-          ci.nodes[5] = tmp_nodes[3];
-          ci.nodes[6] = tmp_nodes[13];
-          ci.nodes[7] = tmp_nodes[2];
-          ci.nodes[8] = tmp_nodes[10];
-          ci.nodes[9] = tmp_nodes[12];
-          ci.nodes[10] = tmp_nodes[15];
-          ci.nodes[11] = tmp_nodes[14];
-          ci.nodes[12] = tmp_nodes[4];
-          ci.nodes[13] = tmp_nodes[16];
-          ci.nodes[14] = tmp_nodes[5];
-          ci.nodes[15] = tmp_nodes[17];
-          ci.nodes[16] = tmp_nodes[18];
-          ci.nodes[17] = tmp_nodes[7];
-          ci.nodes[18] = tmp_nodes[19];
-          ci.nodes[19] = tmp_nodes[6];
-        } break;
-        case 26 : { /* Third order line */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[2];
-          ci.nodes[2] = tmp_nodes[3];
-          ci.nodes[3] = tmp_nodes[1];
-        } break;
-        case 21 : { /* Third order triangle */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[3];
-          ci.nodes[2] = tmp_nodes[4];
-          ci.nodes[3] = tmp_nodes[1];
-          ci.nodes[4] = tmp_nodes[8];
-          ci.nodes[5] = tmp_nodes[9];
-          ci.nodes[6] = tmp_nodes[5];
-          //ci.nodes[7] = tmp_nodes[7];
-          ci.nodes[8] = tmp_nodes[6];
-          ci.nodes[9] = tmp_nodes[2];
-        } break;
-        case 23: { /* Fourth order triangle */
-        //ci.nodes[0]  = tmp_nodes[0];
-          ci.nodes[1]  = tmp_nodes[3];
-          ci.nodes[2]  = tmp_nodes[4];
-          ci.nodes[3]  = tmp_nodes[5];
-          ci.nodes[4]  = tmp_nodes[1];
-          ci.nodes[5]  = tmp_nodes[11];
-          ci.nodes[6]  = tmp_nodes[12];
-          ci.nodes[7]  = tmp_nodes[13];
-          ci.nodes[8]  = tmp_nodes[6];
-          ci.nodes[9]  = tmp_nodes[10];
-          ci.nodes[10] = tmp_nodes[14];
-          ci.nodes[11] = tmp_nodes[7];
-          ci.nodes[12] = tmp_nodes[9];
-          ci.nodes[13] = tmp_nodes[8];
-          ci.nodes[14] = tmp_nodes[2];
-        } break;
-        case 27: { /* Fourth order line */
-        //ci.nodes[0]  = tmp_nodes[0];
-          ci.nodes[1]  = tmp_nodes[2];
-          ci.nodes[2]  = tmp_nodes[3];
-          ci.nodes[3]  = tmp_nodes[4];
-          ci.nodes[4]  = tmp_nodes[1];
-        } break;
-        }
+        gmsh_to_getfem_node_order(ci.type, ci.nodes.data(), ci.nodes.size());
       }
     }
 
@@ -557,71 +920,11 @@ namespace getfem {
 
       unsigned N = cvlst.front().pgt->dim();
       for (size_type cv=0; cv < nb_cv; ++cv) {
-        bool cvok = false;
         gmsh_cv_info &ci = cvlst[cv];
-        bool is_node = (ci.type == 15);
-        unsigned ci_dim = (is_node) ? 0 : ci.pgt->dim();
-        //  cout << "importing cv dim=" << ci_dim << " N=" << N
-        //       << " region: " << ci.region << " type: " << ci.type << "\n";
-
-        //main convex import
-        if (ci_dim == N) {
-          size_type ic = m.add_convex(ci.pgt, ci.nodes.begin());
-          cvok = true;
-          m.region(ci.region).add(ic);
-
-        //convexes with lower dimensions
-        }
-        else {
-          //convex that lies within the regions of lower_dim_convex_rg
-          //is imported explicitly as a convex.
-          if (lower_dim_convex_rg != NULL &&
-              lower_dim_convex_rg->find(ci.region) != lower_dim_convex_rg->end()
-              && !is_node) {
-              size_type ic = m.add_convex(ci.pgt, ci.nodes.begin());
-              cvok = true; m.region(ci.region).add(ic);
-          }
-          //find if the convex is part of a face of higher dimension convex
-          else{
-            bgeot::mesh_structure::ind_cv_ct ct=m.convex_to_point(ci.nodes[0]);
-            for (bgeot::mesh_structure::ind_cv_ct::const_iterator
-                   it = ct.begin(); it != ct.end(); ++it) {
-              if (m.structure_of_convex(*it)->dim() == ci_dim + 1) {
-                for (short_type face=0;
-                     face < m.structure_of_convex(*it)->nb_faces(); ++face) {
-                  if (m.is_convex_face_having_points(*it, face,
-                                                    short_type(ci.nodes.size()),
-                                                    ci.nodes.begin())) {
-                    m.region(ci.region).add(*it,face);
-                    cvok = true;
-                  }
-                }
-              }
-            }
-            if (is_node && (nodal_map != NULL)) {
-              for (auto i : ci.nodes) (*nodal_map)[ci.region].insert(i);
-            }
-            // if the convex is not part of the face of others
-            if (!cvok) {
-              if (is_node) {
-                if (nodal_map == NULL){
-                  GMM_WARNING2("gmsh import ignored a node id: "
-                               << ci.id << " region :" << ci.region <<
-                               " point is not added explicitly as an element.");
-                }
-              }
-              else if (add_all_element_type) {
-                size_type ic = m.add_convex(ci.pgt, ci.nodes.begin());
-                m.region(ci.region).add(ic);
-                cvok = true;
-              } else {
-                GMM_WARNING2("gmsh import ignored an element of type "
-                             << bgeot::name_of_geometric_trans(ci.pgt) <<
-                    " as it does not belong to the face of another element");
-              }
-            }
-          }
-        }
+        gmsh_add_element(m, N, ci.id, ci.type, ci.region, ci.pgt,
+                         ci.nodes.data(), ci.nodes.size(),
+                         lower_dim_convex_rg, add_all_element_type,
+                         nodal_map);
       }
     }
     if (remove_last_dimension) maybe_remove_last_dimension(m);
@@ -1505,7 +1808,8 @@ namespace getfem {
   {
     m.clear();
     try {
-      std::ifstream f(filename.c_str());
+      /* binary mode for the binary gmsh files */
+      std::ifstream f(filename.c_str(), std::ios::in | std::ios::binary);
       GMM_ASSERT1(f.good(), "can't open file " << filename);
       /* throw exceptions when an error occurs */
       f.exceptions(std::ifstream::badbit | std::ifstream::failbit);
@@ -63,6 +63,16 @@ namespace getfem {
     touch();
   }
 
+  void level_set::set_values(const mesher_signed_distance &dist,
+                             unsigned lsnum) {
+    GMM_ASSERT1(lsnum == 0 || has_secondary(), "No secondary level-set");
+    std::vector<base_node> pts(mf->nb_basic_dof());
+    for (size_type i = 0; i < pts.size(); ++i)
+      pts[i] = mf->point_of_basic_dof(i);
+    signed_distance_of_points(dist, pts, values(lsnum));
+    touch();
+  }
+
   pmesher_signed_distance level_set::mls_of_convex(size_type cv, unsigned lsnum,
                                                    bool inverted) const {
     assert(this); assert(mf); 
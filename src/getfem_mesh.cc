@@ -24,6 +24,8 @@
 #include "gmm/gmm_condition_number.h"
 #include "getfem/getfem_mesh.h"
 #include "getfem/getfem_integration.h"
+#include "getfem/getfem_mesh_partition.h"
+#include <atomic>
 
 #if GETFEM_HAVE_METIS_OLD_API
 extern "C" void METIS_PartGraphKway(int *, int *, int *, int *, int *, int *,
@@ -34,8 +36,10 @@ extern "C" void METIS_PartGraphKway(int *, int *, int *, int *, int *, int *,
 
 namespace getfem {
 
+  // Atomic, since meshes are built concurrently, for instance in the
+  // parallel loops of mesh_level_set::adapt and mesh_im_level_set.
   gmm::uint64_type act_counter(void) {
-    static gmm::uint64_type c = gmm::uint64_type(1);
+    static std::atomic<gmm::uint64_type> c(gmm::uint64_type(1));
     return ++c;
   }
 
@@ -157,12 +161,12 @@ namespace getfem {
       mpi_region = mesh_region::all_convexes();
       mpi_region.from_mesh(*this);
     } else {
+      double t_ref = MPI_Wtime();
+#if GETFEM_HAVE_METIS || GETFEM_HAVE_METIS_OLD_API
       int ne = int(nb_convex());
       std::vector<int> xadj(ne+1), adjncy, numelt(ne), npart(ne);
       std::vector<int> indelt(nb_allocated_convex());
 
-      double t_ref = MPI_Wtime();
-
       int j = 0, k = 0;
       ind_set s;
       for (dal::bv_visitor ic(convex_index()); !ic.finished(); ++ic, ++j) {
@@ -193,6 +197,12 @@ namespace getfem {
 
       for (size_type i = 0; i < size_type(ne); ++i)
         if (npart[i] == rank) mpi_region.add(numelt[i]);
+#else
+      std::vector<size_type> npart;
+      partition_mesh(*this, size_type(size), npart);
+      for (dal::bv_visitor ic(convex_index()); !ic.finished(); ++ic)
+        if (npart[ic] == size_type(rank)) mpi_region.add(ic);
+#endif
 
       if (MPI_IS_MASTER())
         cout << "Partition time "<< MPI_Wtime()-t_ref << endl;
@@ -220,12 +230,146 @@ namespace getfem {
   }
 #endif
 
-  void mesh::optimize_structure(bool with_renumbering) {
+  /* Index along a Morton or a Hilbert space filling curve of a point of
+     integer coordinates X on nbits bits. The Hilbert index is computed
+     with the algorithm of J. Skilling, "Programming the Hilbert curve",
+     AIP Conf. Proc. 707, 2004.
+  */
+  static gmm::uint64_type
+  space_filling_curve_index(gmm::uint64_type *X, size_type n,
+                            unsigned nbits, bool hilbert) {
+    if (hilbert && nbits > 1) {
+      gmm::uint64_type M = gmm::uint64_type(1) << (nbits-1), P, Q, t;
+      for (Q = M; Q > 1; Q >>= 1) { // Inverse undo
+        P = Q - 1;
+        for (size_type i = 0; i < n; ++i)
+          if (X[i] & Q) X[0] ^= P;
+          else { t = (X[0] ^ X[i]) & P; X[0] ^= t; X[i] ^= t; }
+      }
+      for (size_type i = 1; i < n; ++i) X[i] ^= X[i-1]; // Gray encode
+      t = 0;
+      for (Q = M; Q > 1; Q >>= 1) if (X[n-1] & Q) t ^= Q - 1;
+      for (size_type i = 0; i < n; ++i) X[i] ^= t;
+    }
+    gmm::uint64_type h = 0;
+    for (unsigned b = nbits; b-- > 0; )
+      for (size_type i = 0; i < n; ++i) h = (h << 1) | ((X[i] >> b) & 1);
+    return h;
+  }
+
+  /* Order of the points c[0 .. nb-1] (stored contiguously with N
+     coordinates) along a space filling curve on the box [bmin, bmax]. */
+  static void space_filling_curve_order(const std::vector<scalar_type> &c,
+                                        size_type N, const base_node &bmin,
+                                        const base_node &bmax, bool hilbert,
+                                        std::vector<size_type> &order) {
+    GMM_ASSERT1(N > 0 && N < 64, "Invalid dimension " << N);
+    size_type nb = c.size() / N;
+    unsigned nbits = unsigned(std::min(size_type(31), size_type(63)/N));
+    scalar_type scale = scalar_type((gmm::uint64_type(1) << nbits) - 1);
+    std::vector<gmm::uint64_type> code(nb);
+    auto compute_code = [&](size_type i) {
+      gmm::uint64_type X[64];
+      for (size_type k = 0; k < N; ++k) {
+        scalar_type l = bmax[k] - bmin[k];
+        scalar_type u = (l > scalar_type(0)) ? (c[i*N+k] - bmin[k]) / l
+                                             : scalar_type(0);
+        u = std::max(scalar_type(0), std::min(scalar_type(1), u));
+        X[k] = gmm::uint64_type(u * scale);
+      }
+      code[i] = space_filling_curve_index(X, N, nbits, hilbert);
+    };
+    GETFEM_OMP_FOR(size_type i = 0, i < nb, ++i, compute_code(i););
+    order.resize(nb);
+    for (size_type i = 0; i < nb; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_type i, size_type j)
+              { return code[i] < code[j] || (code[i] == code[j] && i < j); });
+  }
+
+  void mesh::start_convex_renumbering
+  (std::vector<size_type> &cv_origin,
+   std::vector<gmm::uint64_type> &old_v_num) const {
+    cv_origin.resize(nb_allocated_convex());
+    old_v_num.assign(nb_allocated_convex(), 0);
+    for (size_type ic = 0; ic < cv_origin.size(); ++ic) {
+      cv_origin[ic] = ic;
+      if (convex_tab.index_valid(ic)) old_v_num[ic] = cvs_v_num[ic];
+    }
+  }
+
+  void mesh::reorder_convexes(const std::vector<size_type> &order,
+                              std::vector<size_type> &cv_origin) {
+    size_type nbc = nb_allocated_convex();
+    std::vector<size_type> iord(nbc), iordinv(nbc);
+    for (size_type i = 0; i < nbc; ++i) iord[i] = iordinv[i] = i;
+    for (size_type i = 0; i < order.size(); ++i) {
+      size_type j = iordinv[order[i]];
+      if (i != j) {
+        swap_convex(i, j);
+        std::swap(cv_origin[i], cv_origin[j]);
+        std::swap(iord[i], iord[j]);
+        std::swap(iordinv[iord[i]], iordinv[iord[j]]);
+      }
+    }
+  }
+
+  void mesh::end_convex_renumbering
+  (const std::vector<size_type> &cv_origin,
+   const std::vector<gmm::uint64_type> &old_v_num) {
+    size_type nbc = std::min(cv_origin.size(), nb_allocated_convex());
+    convex_renumbering r;
+    r.stamp = act_counter();
+    r.origin.assign(nbc, size_type(-1));
+    r.v_num.assign(nbc, 0);
+    bool moved = false;
+    for (size_type i = 0; i < nbc; ++i)
+      if (cv_origin[i] != i && convex_tab.index_valid(i)) {
+        r.origin[i] = cv_origin[i];
+        r.v_num[i] = old_v_num[cv_origin[i]];
+        cvs_v_num[i] = r.stamp;
+        moved = true;
+      }
+    if (!moved) return;
+    if (cvs_renum.size() >= 4) { // Only the last renumberings are kept
+      cvs_renum_dropped_stamp = cvs_renum.front().stamp;
+      cvs_renum.pop_front();
+    }
+    cvs_renum.push_back(std::move(r));
+  }
+
+  size_type mesh::renumbered_convex_origin(size_type ic,
+                                           gmm::uint64_type v) const {
+    if (cvs_renum.empty() || v >= cvs_renum.back().stamp
+        || v < cvs_renum_dropped_stamp || !convex_tab.index_valid(ic))
+      return size_type(-1);
+    size_type oc = ic;
+    gmm::uint64_type vv = cvs_v_num[ic];
+    bool moved = false;
+    for (auto it = cvs_renum.rbegin();
+         it != cvs_renum.rend() && v < it->stamp; ++it) {
+      if (vv > it->stamp) return size_type(-1); // modified afterwards
+      if (vv == it->stamp) {
+        vv = it->v_num[oc]; oc = it->origin[oc]; moved = true;
+      }
+    }
+    return (moved && vv <= v) ? oc : size_type(-1);
+  }
+
+  void mesh::optimize_structure(bool with_renumbering,
+                                renumbering_method meth) {
+    // Tracking of the original index of the convexes
+    std::vector<size_type> cv_origin;
+    std::vector<gmm::uint64_type> old_v_num;
+    start_convex_renumbering(cv_origin, old_v_num);
+
     pts.resort();
     size_type i, j = nb_convex(), nbc = j;
     for (i = 0; i < j; i++)
-      if (!convex_tab.index_valid(i))
-        swap_convex(i, convex_tab.ind_last());
+      if (!convex_tab.index_valid(i)) {
+        size_type k = convex_tab.ind_last();
+        swap_convex(i, k);
+        std::swap(cv_origin[i], cv_origin[k]);
+      }
     if (pts.size())
       for (i = 0, j = pts.size()-1;
            i < j && j != ST_NIL; ++i, --j) {
@@ -234,19 +378,65 @@ namespace getfem {
         if (i < j && j != ST_NIL ) swap_points(i, j);
       }
     if (with_renumbering) { // Could be optimized no using only swap_convex
-      std::vector<size_type> cmk, iord(nbc), iordinv(nbc);
-      for (i = 0; i < nbc; ++i) iord[i] = iordinv[i] = i;
-
-      bgeot::cuthill_mckee_on_convexes(*this, cmk);
-      for (i = 0; i < nbc; ++i) {
-        j = iordinv[cmk[i]];
-        if (i != j) {
-          swap_convex(i, j);
-          std::swap(iord[i], iord[j]);
-          std::swap(iordinv[iord[i]], iordinv[iord[j]]);
+      std::vector<size_type> cmk;
+
+      if (meth == CUTHILL_MCKEE)
+        bgeot::cuthill_mckee_on_convexes(*this, cmk);
+      else {
+        size_type N = dim(), nbp = nb_points();
+        base_node bmin(N), bmax(N);
+        bounding_box(bmin, bmax);
+        std::vector<scalar_type> c(nbc*N);
+        // The non-const access to the points is not thread safe.
+        const PT_TAB &cpts = pts;
+        auto centroid = [&](size_type ic) {
+          const auto &ipts = ind_points_of_convex(ic);
+          for (size_type ip : ipts)
+            for (size_type k = 0; k < N; ++k) c[ic*N+k] += cpts[ip][k];
+          for (size_type k = 0; k < N; ++k)
+            c[ic*N+k] /= scalar_type(ipts.size());
+        };
+        GETFEM_OMP_FOR(size_type ic = 0, ic < nbc, ++ic, centroid(ic););
+        space_filling_curve_order(c, N, bmin, bmax, meth == HILBERT, cmk);
+
+        // Renumbering of the points along the curve
+        std::vector<size_type> pord, piord(nbp), piordinv(nbp);
+        c.resize(nbp*N);
+        for (i = 0; i < nbp; ++i) {
+          piord[i] = piordinv[i] = i;
+          for (size_type k = 0; k < N; ++k) c[i*N+k] = pts[i][k];
+        }
+        space_filling_curve_order(c, N, bmin, bmax, meth == HILBERT, pord);
+        for (i = 0; i < nbp; ++i) {
+          j = piordinv[pord[i]];
+          if (i != j) {
+            swap_points(i, j);
+            std::swap(piord[i], piord[j]);
+            std::swap(piordinv[piord[i]], piordinv[piord[j]]);
+          }
         }
       }
+      reorder_convexes(cmk, cv_origin);
+    }
+
+    // Record of the renumbering for the dependent objects
+    end_convex_renumbering(cv_origin, old_v_num);
+  }
+
+  void mesh::renumber_convexes(const std::vector<size_type> &order) {
+    GMM_ASSERT1(order.size() == nb_convex(),
+                "The order should contain all the convexes");
+    dal::bit_vector found;
+    for (size_type ic : order) {
+      GMM_ASSERT1(convex_index().is_in(ic) && !found.is_in(ic),
+                  "Invalid or repeated convex " << ic << " in the order");
+      found.add(ic);
     }
+    std::vector<size_type> cv_origin;
+    std::vector<gmm::uint64_type> old_v_num;
+    start_convex_renumbering(cv_origin, old_v_num);
+    reorder_convexes(order, cv_origin);
+    end_convex_renumbering(cv_origin, old_v_num);
   }
 
   void mesh::translation(const base_small_vector &V)
@@ -276,6 +466,7 @@ namespace getfem {
     gtab.clear(); trans_exists.clear();
     cvf_sets.clear(); valid_cvf_sets.clear();
     cvs_v_num.clear();
+    cvs_renum.clear(); cvs_renum_dropped_stamp = 0;
     Bank_info = nullptr;
     touch();
   }
@@ -653,6 +844,7 @@ namespace getfem {
   }
 
   void mesh::read_from_file(const std::string &name) {
+    if (bgeot::is_binary_file(name)) { read_from_binary_file(name); return; }
     std::ifstream o(name.c_str());
     GMM_ASSERT1(o, "Mesh file '" << name << "' does not exist");
     read_from_file(o);
@@ -715,6 +907,144 @@ namespace getfem {
     o.close();
   }
 
+  /* Sections of a mesh in a binary file:
+     MESH       : format version, dimension, number of points and convexes
+     MESH_PTI   : indices of the points (omitted if they are 0 ... n-1)
+     MESH_PTS   : coordinates of the points
+     MESH_GT    : names of the geometric transformations
+     MESH_CVI   : indices of the convexes (omitted if they are 0 ... n-1)
+     MESH_CVGT  : geometric transformation of each convex
+     MESH_CVPTS : point indices of the convexes, concatenated
+     MESH_RGCV i, MESH_RGF i : convexes and faces of region i
+  */
+  void mesh::write_to_binary_file(bgeot::binary_file_writer &f) const {
+    size_type N = dim(), np = pts.card(), nbc = nb_convex();
+    std::vector<gmm::uint64_type> hdr = { 1, N, np, nbc };
+    f.write_section("MESH", 0, hdr);
+
+    std::vector<size_type> ind;
+    std::vector<scalar_type> coords;
+    coords.reserve(np*N);
+    for (dal::bv_visitor ip(pts.index()); !ip.finished(); ++ip) {
+      ind.push_back(ip);
+      coords.insert(coords.end(), pts[ip].begin(), pts[ip].end());
+    }
+    if (np && ind.back() != np-1) f.write_index_section("MESH_PTI", 0, ind);
+    f.write_section("MESH_PTS", 0, coords);
+
+    std::map<bgeot::pgeometric_trans, size_type> gtnum;
+    std::vector<std::string> gtnames;
+    std::vector<size_type> cvgt, cvpts;
+    ind.resize(0);
+    cvgt.reserve(nbc);
+    for (dal::bv_visitor ic(convex_index()); !ic.finished(); ++ic) {
+      bgeot::pgeometric_trans pgt = trans_of_convex(ic);
+      auto it = gtnum.find(pgt);
+      if (it == gtnum.end()) {
+        it = gtnum.emplace(pgt, gtnames.size()).first;
+        gtnames.push_back(bgeot::name_of_geometric_trans(pgt));
+      }
+      ind.push_back(ic);
+      cvgt.push_back(it->second);
+      cvpts.insert(cvpts.end(), ind_points_of_convex(ic).begin(),
+                   ind_points_of_convex(ic).end());
+    }
+    f.write_string_section("MESH_GT", 0, gtnames);
+    if (nbc && ind.back() != nbc-1) f.write_index_section("MESH_CVI", 0, ind);
+    f.write_index_section("MESH_CVGT", 0, cvgt);
+    f.write_index_section("MESH_CVPTS", 0, cvpts);
+
+    for (dal::bv_visitor bnum(valid_cvf_sets); !bnum.finished(); ++bnum) {
+      std::vector<short_type> faces;
+      ind.resize(0);
+      for (mr_visitor i(region(bnum)); !i.finished(); ++i) {
+        ind.push_back(i.cv());
+        faces.push_back(i.is_face() ? i.f() : short_type(-1));
+      }
+      f.write_index_section("MESH_RGCV", bnum, ind);
+      f.write_section("MESH_RGF", bnum, faces);
+    }
+  }
+
+  void mesh::write_to_binary_file(const std::string &name) const {
+    bgeot::binary_file_writer f(name);
+    write_to_binary_file(f);
+    f.close();
+  }
+
+  void mesh::read_from_binary_file(const bgeot::binary_file_reader &f) {
+    clear();
+    bgeot::binary_section<gmm::uint64_type>
+      hdr = f.section<gmm::uint64_type>("MESH", 0);
+    GMM_ASSERT1(hdr.size() >= 4 && hdr[0] == 1, "Unsupported version of "
+                "the mesh sections in binary file " << f.name());
+    size_type N = size_type(hdr[1]), np = size_type(hdr[2]);
+    size_type nbc = size_type(hdr[3]);
+
+    // Points are added without any search of duplicates
+    std::vector<size_type> ind;
+    if (f.has_section("MESH_PTI")) f.read_index_section("MESH_PTI", 0, ind);
+    else { ind.resize(np); for (size_type i = 0; i < np; ++i) ind[i] = i; }
+    bgeot::binary_section<scalar_type>
+      coords = f.section<scalar_type>("MESH_PTS", 0);
+    GMM_ASSERT1(ind.size() == np && coords.size() == np*N,
+                "Corrupted binary file " << f.name());
+    size_type npmax = np ? ind.back() + 1 : 0, k = 0;
+    std::vector<size_type> holes;
+    base_node P(N);
+    for (size_type i = 0; i < npmax; ++i) {
+      if (k < np && ind[k] == i) {
+        std::copy(coords.begin() + k*N, coords.begin() + (k+1)*N,
+                  P.begin()); ++k;
+      } else { gmm::clear(P); holes.push_back(i); }
+      size_type ip = add_point(P, scalar_type(-1));
+      GMM_ASSERT1(ip == i, "Corrupted binary file " << f.name());
+    }
+    GMM_ASSERT1(k == np, "Corrupted binary file " << f.name());
+
+    std::vector<std::string> gtnames;
+    f.read_string_section("MESH_GT", 0, gtnames);
+    std::vector<bgeot::pgeometric_trans> gts(gtnames.size());
+    for (size_type i = 0; i < gtnames.size(); ++i)
+      gts[i] = bgeot::geometric_trans_descriptor(gtnames[i]);
+    if (f.has_section("MESH_CVI")) f.read_index_section("MESH_CVI", 0, ind);
+    else { ind.resize(nbc); for (size_type i = 0; i < nbc; ++i) ind[i] = i; }
+    std::vector<size_type> cvgt, cvpts;
+    f.read_index_section("MESH_CVGT", 0, cvgt);
+    f.read_index_section("MESH_CVPTS", 0, cvpts);
+    GMM_ASSERT1(ind.size() == nbc && cvgt.size() == nbc,
+                "Corrupted binary file " << f.name());
+    for (size_type i = 0, j = 0; i < nbc; ++i) {
+      GMM_ASSERT1(cvgt[i] < gts.size(), "Corrupted binary file "<< f.name());
+      bgeot::pgeometric_trans pgt = gts[cvgt[i]];
+      GMM_ASSERT1(j + pgt->nb_points() <= cvpts.size(),
+                  "Corrupted binary file " << f.name());
+      for (size_type l = j; l < j + pgt->nb_points(); ++l)
+        GMM_ASSERT1(cvpts[l] < npmax, "Corrupted binary file " << f.name());
+      size_type ic = add_convex(pgt, cvpts.begin() + j);
+      if (ic != ind[i]) swap_convex(ic, ind[i]);
+      j += pgt->nb_points();
+    }
+    for (size_type i : holes) sup_point(i);
+
+    for (size_type bnum : f.section_ids("MESH_RGCV")) {
+      bgeot::binary_section<short_type>
+        faces = f.section<short_type>("MESH_RGF", bnum);
+      f.read_index_section("MESH_RGCV", bnum, ind);
+      GMM_ASSERT1(faces.size() == ind.size(), "Corrupted binary file "
+                  << f.name());
+      mesh_region &rg = region(bnum);
+      for (size_type i = 0; i < faces.size(); ++i)
+        if (faces[i] == short_type(-1)) rg.add(ind[i]);
+        else rg.add(ind[i], faces[i]);
+    }
+  }
+
+  void mesh::read_from_binary_file(const std::string &name) {
+    bgeot::binary_file_reader f(name);
+    read_from_binary_file(f);
+  }
+
   size_type mesh::memsize(void) const {
     return bgeot::mesh_structure::memsize() - sizeof(bgeot::mesh_structure)
       + pts.memsize() + (pts.index().last_true()+1)*dim()*sizeof(scalar_type)
@@ -746,9 +1076,9 @@ namespace getfem {
                                    const base_matrix& G,
                                    pintegration_method pi) {
     double area(0);
-    static bgeot::pgeometric_trans pgt_old = 0;
-    static bgeot::pgeotrans_precomp pgp = 0;
-    static pintegration_method pim_old = 0;
+    THREAD_SAFE_STATIC bgeot::pgeometric_trans pgt_old = nullptr;
+    THREAD_SAFE_STATIC bgeot::pgeotrans_precomp pgp = nullptr;
+    THREAD_SAFE_STATIC pintegration_method pim_old = nullptr;
     papprox_integration pai = get_approx_im_or_fail(pi);
     if (pgt_old != pgt || pim_old != pi) {
       pgt_old = pgt;
@@ -771,8 +1101,8 @@ namespace getfem {
   */
   scalar_type convex_quality_estimate(bgeot::pgeometric_trans pgt,
                                       const base_matrix& G) {
-    static bgeot::pgeometric_trans pgt_old = 0;
-    static bgeot::pgeotrans_precomp pgp = 0;
+    THREAD_SAFE_STATIC bgeot::pgeometric_trans pgt_old = nullptr;
+    THREAD_SAFE_STATIC bgeot::pgeotrans_precomp pgp = nullptr;
     if (pgt_old != pgt) {
       pgt_old=pgt;
       pgp=bgeot::geotrans_precomp(pgt, pgt->pgeometric_nodes(), 0);
@@ -797,8 +1127,8 @@ namespace getfem {
 
   scalar_type convex_radius_estimate(bgeot::pgeometric_trans pgt,
                                      const base_matrix& G) {
-    static bgeot::pgeometric_trans pgt_old = 0;
-    static bgeot::pgeotrans_precomp pgp = 0;
+    THREAD_SAFE_STATIC bgeot::pgeometric_trans pgt_old = nullptr;
+    THREAD_SAFE_STATIC bgeot::pgeotrans_precomp pgp = nullptr;
     if (pgt_old != pgt) {
       pgt_old=pgt;
       pgp=bgeot::geotrans_precomp(pgt, pgt->pgeometric_nodes(), 0);
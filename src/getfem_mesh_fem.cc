@@ -21,6 +21,7 @@
 
 
 #include <queue>
+#include <unordered_map>
 #include "getfem/dal_singleton.h"
 #include "getfem/getfem_mesh_fem.h"
 #include "getfem/getfem_torus.h"
@@ -28,9 +29,35 @@
 namespace getfem {
 
   void mesh_fem::update_from_context() const {
+    // Follows a renumbering of the convexes done by optimize_structure
+    dal::bit_vector renumbered;
+    for (dal::bv_visitor cv(linked_mesh_->convex_index());
+         !cv.finished(); ++cv)
+      if (linked_mesh_->renumbered_convex_origin(cv, v_num_update)
+          != size_type(-1)) renumbered.add(cv);
+    if (renumbered.card()) {
+      std::vector<pfem> old_elems = f_elems;
+      std::vector<size_type> old_partition = dof_partition;
+      dal::bit_vector old_fe_convex = fe_convex;
+      mesh_fem &mf = const_cast<mesh_fem &>(*this);
+      if (f_elems.size() < linked_mesh_->nb_allocated_convex())
+        mf.f_elems.resize(linked_mesh_->nb_allocated_convex());
+      for (dal::bv_visitor cv(renumbered); !cv.finished(); ++cv) {
+        size_type ocv
+          = linked_mesh_->renumbered_convex_origin(cv, v_num_update);
+        mf.fe_convex[cv] = old_fe_convex.is_in(ocv);
+        mf.f_elems[cv] = old_fe_convex.is_in(ocv) ? old_elems[ocv] : 0;
+        if (cv < dof_partition.size())
+          mf.dof_partition[cv] = (ocv < old_partition.size())
+                               ? old_partition[ocv] : 0;
+      }
+      dof_enumeration_made = false;
+    }
+
     for (dal::bv_visitor cv(fe_convex); !cv.finished(); ++cv) {
       if (linked_mesh_->convex_index().is_in(cv)) {
-        if (v_num_update < linked_mesh_->convex_version_number(cv)) {
+        if (v_num_update < linked_mesh_->convex_version_number(cv)
+            && !renumbered.is_in(cv)) {
           if (auto_add_elt_pf != 0)
             const_cast<mesh_fem *>(this)
               ->set_finite_element(cv, auto_add_elt_pf);
@@ -53,7 +80,7 @@ namespace getfem {
     }
     for (dal::bv_visitor cv(linked_mesh_->convex_index());
          !cv.finished(); ++cv) {
-      if (!fe_convex.is_in(cv)
+      if (!fe_convex.is_in(cv) && !renumbered.is_in(cv)
           && v_num_update < linked_mesh_->convex_version_number(cv)) {
         if (auto_add_elt_pf != 0)
           const_cast<mesh_fem *>(this)
@@ -317,6 +344,191 @@ namespace getfem {
     return is_uniformly_vectorized_;
   }
 
+  /* Topological identification of dofs. For Lagrange type elements on
+     simplices, parallelepipeds and prisms, a linkable dof is characterized
+     by the global indices of the vertices of the smallest face containing
+     its node, together with the (quantized) values at this node of the
+     basis functions of the linear geometric transformation. Two dofs
+     having the same characterization, the same partition and compatible
+     dof descriptions are identified. No kdtree and no coordinate are used,
+     the characterizations are computed in parallel and the numbering is
+     the same as the one of the geometric identification on conforming
+     meshes.
+  */
+
+  struct dof_topo_table { // Description of the dofs for a couple fem/geotrans
+    std::vector<size_type> kind; // index of the dof description, or
+                                 // size_type(-1) for a global dof and
+                                 // size_type(-2) for a non linkable dof.
+    // (local vertex number, quantized weight) for each linkable dof
+    std::vector<std::vector<std::pair<size_type, size_type>>> weights;
+  };
+
+  // Keys are stored as [length, kind, partition, v0, w0, v1, w1 ...]
+  struct dof_topo_key_hash {
+    size_type operator()(const size_type *k) const {
+      size_type h = k[0];
+      for (size_type i = 1; i <= k[0]; ++i)
+        h ^= k[i] + size_type(0x9e3779b97f4a7c15ULL) + (h << 6) + (h >> 2);
+      return h;
+    }
+  };
+
+  struct dof_topo_key_equal {
+    bool operator()(const size_type *k1, const size_type *k2) const
+    { return std::equal(k1, k1 + k1[0] + 1, k2); }
+  };
+
+  static bool build_dof_topo_table(pfem pf, size_type cv,
+                                   bgeot::pgeometric_trans pgt,
+                                   const bgeot::stored_point_tab &pts,
+                                   std::vector<pdof_description> &pnds,
+                                   dof_topo_table &tab) {
+    const scalar_type quantum(1 << 24);
+    dim_type n = pgt->dim();
+    bgeot::pconvex_structure cvs = pgt->basic_structure();
+    if (pf->dim() != n
+        || bgeot::basic_structure(pf->basic_structure(cv)) != cvs)
+      return false;
+    if (cvs != bgeot::simplex_structure(n)
+        && cvs != bgeot::parallelepiped_structure(n)
+        && cvs != bgeot::prism_P1_structure(n)) return false;
+    bgeot::pgeometric_trans pgt1 = bgeot::default_trans_of_cvs(cvs);
+    size_type nbv = pgt->nb_vertices();
+    if (pgt1->nb_points() != nbv) return false;
+    for (size_type j = 0; j < nbv; ++j)
+      if (gmm::vect_dist2(pgt1->convex_ref()->points()[j],
+                          pgt->convex_ref()->points()[pgt->vertices()[j]])
+          > 1e-10) return false;
+
+    size_type nbd = pf->nb_dof(cv);
+    if (pts.size() < nbd) return false;
+    pdof_description andof = global_dof(pf->dim());
+    tab.kind.resize(nbd); tab.weights.resize(nbd);
+    base_vector val;
+    for (size_type i = 0; i < nbd; ++i) {
+      pdof_description pnd = pf->dof_types()[i];
+      if (pnd == andof) { tab.kind[i] = size_type(-1); continue; }
+      if (!dof_linkable(pnd)) { tab.kind[i] = size_type(-2); continue; }
+      size_type k = 0;
+      for (; k < pnds.size(); ++k)
+        if (dof_description_compare(pnds[k], pnd) == 0) break;
+      if (k == pnds.size()) pnds.push_back(pnd);
+      tab.kind[i] = k;
+      pgt1->poly_vector_val(pts[i], val);
+      for (size_type j = 0; j < nbv; ++j) {
+        if (val[j] < -1e-10) return false;
+        size_type w = size_type(val[j] * quantum + 0.5);
+        if (w) tab.weights[i].push_back(std::make_pair(j, w));
+      }
+    }
+    return true;
+  }
+
+  bool mesh_fem::enumerate_dof_by_topology() const {
+    const mesh &m = linked_mesh();
+    pfem first_pf = f_elems[fe_convex.first_true()];
+
+    // Description of the dofs for each couple fem/geotrans
+    std::vector<size_type> cvs, tab_of_cv;
+    std::map<std::tuple<const void *, const void *, const void *>, size_type>
+      tab_index;
+    std::vector<dof_topo_table> tabs;
+    std::vector<pdof_description> pnds;
+    cvs.reserve(fe_convex.card()); tab_of_cv.reserve(fe_convex.card());
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+      if (!fe_convex.is_in(cv)) continue;
+      pfem pf = fem_of_element(cv);
+      if (!(pf->is_lagrange()) || pf->is_on_real_element()) return false;
+      bgeot::pgeometric_trans pgt = m.trans_of_convex(cv);
+      bgeot::pstored_point_tab pspt = pf->node_tab(cv);
+      auto key = std::make_tuple((const void *)(pf.get()),
+                                 (const void *)(pgt.get()),
+                                 (const void *)(pspt.get()));
+      auto it = tab_index.find(key);
+      if (it == tab_index.end()) {
+        it = tab_index.emplace(key, tabs.size()).first;
+        tabs.emplace_back();
+        if (!build_dof_topo_table(pf, cv, pgt, *pspt, pnds, tabs.back()))
+          return false;
+      }
+      if (tabs[it->second].kind.size() != pf->nb_dof(cv)) return false;
+      cvs.push_back(cv); tab_of_cv.push_back(it->second);
+    }
+
+    // Characterization of the linkable dofs of each element
+    size_type nbcv = cvs.size();
+    std::vector<std::vector<size_type>> keys(nbcv);
+    auto build_keys = [&](size_type ic) {
+      size_type cv = cvs[ic];
+      const dof_topo_table &tab = tabs[tab_of_cv[ic]];
+      const std::vector<size_type> &vert = m.trans_of_convex(cv)->vertices();
+      const mesh::ind_cv_ct &ipts = m.ind_points_of_convex(cv);
+      size_type part = get_dof_partition(cv);
+      std::vector<size_type> &k = keys[ic];
+      std::vector<std::pair<size_type, size_type>> ent;
+      for (size_type i = 0; i < tab.kind.size(); ++i) {
+        if (tab.kind[i] >= size_type(-2)) continue;
+        ent.resize(0);
+        for (const auto &w : tab.weights[i])
+          ent.push_back(std::make_pair(ipts[vert[w.first]], w.second));
+        std::sort(ent.begin(), ent.end());
+        k.push_back(2 + 2*ent.size()); k.push_back(tab.kind[i]);
+        k.push_back(part);
+        for (const auto &e : ent)
+          { k.push_back(e.first); k.push_back(e.second); }
+      }
+    };
+    GETFEM_OMP_FOR(size_type ic = 0, ic < nbcv, ++ic, build_keys(ic););
+
+    // Numbering, in the order of the elements
+    size_type nbdof = 0;
+    dal::bit_vector encountered_global_dof;
+    dal::dynamic_array<size_type> ind_global_dof;
+    std::unordered_map<const size_type *, size_type, dof_topo_key_hash,
+                       dof_topo_key_equal> linked_dofs;
+    std::vector<size_type> dofs, first_dof(nbcv+1);
+    for (size_type ic = 0; ic < nbcv; ++ic) {
+      size_type cv = cvs[ic], nbdof0 = nbdof;
+      const dof_topo_table &tab = tabs[tab_of_cv[ic]];
+      const size_type *k = keys[ic].data();
+      pfem pf = fem_of_element(cv);
+      if (pf != first_pf) is_uniform_ = false;
+      if (pf->target_dim() > 1) is_uniformly_vectorized_ = false;
+      size_type nbd_step = Qdim / pf->target_dim();
+      first_dof[ic] = dofs.size();
+      for (size_type i = 0; i < tab.kind.size(); ++i) {
+        if (tab.kind[i] == size_type(-1)) { // global dof
+          size_type num = pf->index_of_global_dof(cv, i);
+          if (!(encountered_global_dof[num])) {
+            ind_global_dof[num] = nbdof;
+            nbdof += nbd_step;
+            encountered_global_dof[num] = true;
+          }
+          dofs.push_back(ind_global_dof[num]);
+        } else if (tab.kind[i] == size_type(-2)) { // non linkable dof
+          dofs.push_back(nbdof); nbdof += nbd_step;
+        } else {
+          auto r = linked_dofs.emplace(k, nbdof);
+          k += k[0] + 1;
+          if (r.second) { dofs.push_back(nbdof); nbdof += nbd_step; }
+          else if (r.first->second >= nbdof0)
+            return false; // two dofs of the same element would be linked
+          else dofs.push_back(r.first->second);
+        }
+      }
+    }
+    first_dof[nbcv] = dofs.size();
+
+    dof_structure.clear();
+    for (size_type ic = 0; ic < nbcv; ++ic)
+      dof_structure.add_convex_noverif
+        (fem_of_element(cvs[ic])->structure(cvs[ic]),
+         dofs.begin() + first_dof[ic], cvs[ic]);
+    nb_total_dof = nbdof;
+    return true;
+  }
+
   /// Enumeration of dofs
   void mesh_fem::enumerate_dof() const {
     bgeot::index_node_pair ipt;
@@ -330,6 +542,9 @@ namespace getfem {
     if (first_pf && first_pf->is_on_real_element()) is_uniform_ = false;
     if (first_pf && first_pf->target_dim() > 1) is_uniformly_vectorized_=false;
 
+    if (enumerate_dof_by_topology())
+      { dof_enumeration_made = true; return; }
+
     // Dof counter
     size_type nbdof = 0;
 
@@ -701,6 +916,7 @@ namespace getfem {
   }
 
   void mesh_fem::read_from_file(const std::string &name) {
+    if (bgeot::is_binary_file(name)) { read_from_binary_file(name); return; }
     std::ifstream o(name.c_str());
     GMM_ASSERT1(o, "Mesh_fem file '" << name << "' does not exist");
     read_from_file(o);
@@ -791,6 +1007,160 @@ namespace getfem {
     write_to_file(o);
   }
 
+  template <typename MAT> static void
+  write_compressed_matrix(bgeot::binary_file_writer &f,
+                          const std::string &tag, size_type id,
+                          const MAT &M) {
+    std::vector<gmm::uint64_type> dims = { M.nr, M.nc };
+    f.write_section(tag, id, dims);
+    f.write_section(tag + "_PR", id, M.pr);
+    f.write_section(tag + "_IR", id, M.ir);
+    f.write_section(tag + "_JC", id, M.jc);
+  }
+
+  template <typename MAT> static void
+  read_compressed_matrix(const bgeot::binary_file_reader &f,
+                         const std::string &tag, size_type id,
+                         MAT &M) {
+    bgeot::binary_section<gmm::uint64_type>
+      dims = f.section<gmm::uint64_type>(tag, id);
+    GMM_ASSERT1(dims.size() == 2, "Corrupted binary file " << f.name());
+    M = MAT(size_type(dims[0]), size_type(dims[1]));
+    f.read_section(tag + "_PR", id, M.pr);
+    f.read_section(tag + "_IR", id, M.ir);
+    f.read_section(tag + "_JC", id, M.jc);
+  }
+
+  /* Sections of a mesh_fem in a binary file (all with the same id):
+     MF        : format version, qdim, with dof partition, with reduction
+     MF_FEM    : names of the finite element methods
+     MF_CVI    : indices of the convexes having a finite element method
+     MF_CVFEM  : finite element method of each of these convexes
+     MF_DOFP   : dof partition of each of these convexes
+     MF_DOF    : scalar basic dofs of these convexes, concatenated
+     MF_R*, MF_E* : reduction and extension matrices
+  */
+  void mesh_fem::write_to_binary_file(bgeot::binary_file_writer &f,
+                                      size_type id) const {
+    context_check();
+    if (!dof_enumeration_made) enumerate_dof();
+    std::vector<gmm::uint64_type> hdr = { 1, get_qdim(),
+                                          !dof_partition.empty(),
+                                          use_reduction };
+    f.write_section("MF", id, hdr);
+    std::map<pfem, size_type> femnum;
+    std::vector<std::string> femnames;
+    std::vector<size_type> cvs, cvfem, dofs;
+    std::vector<gmm::uint32_type> partition;
+    for (dal::bv_visitor cv(convex_index()); !cv.finished(); ++cv) {
+      pfem pf = fem_of_element(cv);
+      auto it = femnum.find(pf);
+      if (it == femnum.end()) {
+        it = femnum.emplace(pf, femnames.size()).first;
+        femnames.push_back(name_of_fem(pf));
+      }
+      cvs.push_back(cv);
+      cvfem.push_back(it->second);
+      if (!dof_partition.empty())
+        partition.push_back(gmm::uint32_type(get_dof_partition(cv)));
+      const auto &ct = ind_scalar_basic_dof_of_element(cv);
+      dofs.insert(dofs.end(), ct.begin(), ct.end());
+    }
+    f.write_string_section("MF_FEM", id, femnames);
+    f.write_index_section("MF_CVI", id, cvs);
+    f.write_index_section("MF_CVFEM", id, cvfem);
+    if (!dof_partition.empty()) f.write_section("MF_DOFP", id, partition);
+    f.write_index_section("MF_DOF", id, dofs);
+    if (use_reduction) {
+      write_compressed_matrix(f, "MF_R", id, R_);
+      write_compressed_matrix(f, "MF_E", id, E_);
+    }
+  }
+
+  void mesh_fem::write_to_binary_file(const std::string &name,
+                                      bool with_mesh) const {
+    bgeot::binary_file_writer f(name);
+    if (with_mesh) linked_mesh().write_to_binary_file(f);
+    write_to_binary_file(f);
+    f.close();
+  }
+
+  void mesh_fem::read_from_binary_file(const bgeot::binary_file_reader &f,
+                                      size_type id) {
+    GMM_ASSERT1(linked_mesh_ != 0, "Uninitialized mesh_fem");
+    clear();
+    bgeot::binary_section<gmm::uint64_type>
+      hdr = f.section<gmm::uint64_type>("MF", id);
+    GMM_ASSERT1(hdr.size() >= 4 && hdr[0] == 1, "Unsupported version of "
+                "the mesh_fem sections in binary file " << f.name());
+    GMM_ASSERT1(hdr[1] > 0 && hdr[1] <= 250, "invalid qdim: " << hdr[1]);
+    set_qdim(dim_type(hdr[1]));
+
+    std::vector<std::string> femnames;
+    f.read_string_section("MF_FEM", id, femnames);
+    std::vector<pfem> fems(femnames.size());
+    for (size_type i = 0; i < femnames.size(); ++i) {
+      fems[i] = fem_descriptor(femnames[i]);
+      GMM_ASSERT1(fems[i], "could not create the FEM '" << femnames[i]
+                  << "'");
+    }
+    std::vector<size_type> cvs, cvfem, dofs;
+    f.read_index_section("MF_CVI", id, cvs);
+    f.read_index_section("MF_CVFEM", id, cvfem);
+    GMM_ASSERT1(cvs.size() == cvfem.size(), "Corrupted binary file "
+                << f.name());
+    for (size_type i = 0; i < cvs.size(); ++i) {
+      GMM_ASSERT1(linked_mesh().convex_index().is_in(cvs[i]), "Convex "
+                  << cvs[i] << " does not exist, are you sure "
+                  "that the mesh attached to this object is right one ?");
+      GMM_ASSERT1(cvfem[i] < fems.size(), "Corrupted binary file "
+                  << f.name());
+      set_finite_element(cvs[i], fems[cvfem[i]]);
+    }
+    if (hdr[2]) {
+      bgeot::binary_section<gmm::uint32_type>
+        partition = f.section<gmm::uint32_type>("MF_DOFP", id);
+      GMM_ASSERT1(partition.size() == cvs.size(), "Corrupted binary file "
+                  << f.name());
+      for (size_type i = 0; i < partition.size(); ++i)
+        set_dof_partition(cvs[i], partition[i]);
+    }
+
+    // The dof enumeration is read directly, as in read_from_file
+    f.read_index_section("MF_DOF", id, dofs);
+    dal::bit_vector doflst;
+    dof_structure.clear();
+    is_uniform_ = true;
+    size_type nbdof_unif = size_type(-1), j = 0;
+    for (size_type cv : cvs) {
+      pfem pf = f_elems[cv];
+      size_type nbd = pf->nb_dof(cv), qmult = Qdim / pf->target_dim();
+      GMM_ASSERT1(j + nbd <= dofs.size(), "Corrupted binary file "
+                  << f.name());
+      if (nbdof_unif == size_type(-1)) nbdof_unif = nbd * qmult;
+      else if (nbdof_unif != nbd * qmult) is_uniform_ = false;
+      for (size_type i = j; i < j + nbd; ++i)
+        for (size_type q = 0; q < qmult; ++q) doflst.add(dofs[i] + q);
+      dof_structure.add_convex_noverif(pf->structure(cv), dofs.begin() + j,
+                                       cv);
+      j += nbd;
+    }
+    dof_enumeration_made = true;
+    touch(); v_num = act_counter();
+    nb_total_dof = doflst.card();
+
+    if (hdr[3]) {
+      read_compressed_matrix(f, "MF_R", id, R_);
+      read_compressed_matrix(f, "MF_E", id, E_);
+      use_reduction = true;
+    }
+  }
+
+  void mesh_fem::read_from_binary_file(const std::string &name) {
+    bgeot::binary_file_reader f(name);
+    read_from_binary_file(f);
+  }
+
   struct mf__key_ : public context_dependencies {
     const mesh *pmsh;
     dim_type order, qdim;
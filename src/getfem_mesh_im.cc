@@ -25,9 +25,26 @@
 namespace getfem {
 
   void mesh_im::update_from_context(void) const {
+    // Follows a renumbering of the convexes done by optimize_structure
+    dal::bit_vector renumbered;
+    for (dal::bv_visitor i(linked_mesh_->convex_index()); !i.finished(); ++i)
+      if (linked_mesh_->renumbered_convex_origin(i, v_num_update)
+          != size_type(-1)) renumbered.add(i);
+    if (renumbered.card()) {
+      dal::dynamic_array<pintegration_method> old_ims = ims;
+      dal::bit_vector old_im_convexes = im_convexes;
+      mesh_im &mim = const_cast<mesh_im &>(*this);
+      for (dal::bv_visitor i(renumbered); !i.finished(); ++i) {
+        size_type oi = linked_mesh_->renumbered_convex_origin(i, v_num_update);
+        mim.im_convexes[i] = old_im_convexes.is_in(oi);
+        if (old_im_convexes.is_in(oi)) mim.ims[i] = old_ims[oi];
+      }
+    }
+
     for (dal::bv_visitor i(im_convexes); !i.finished(); ++i) {
       if (linked_mesh_->convex_index().is_in(i)) {
-	if (v_num_update < linked_mesh_->convex_version_number(i))
+	if (v_num_update < linked_mesh_->convex_version_number(i)
+            && !renumbered.is_in(i))
 	  const_cast<mesh_im *>(this)
 	    ->set_integration_method(i, auto_add_elt_pim);
       }
@@ -35,7 +52,7 @@ namespace getfem {
     }
     for (dal::bv_visitor i(linked_mesh_->convex_index());
 	 !i.finished(); ++i) {
-      if (!im_convexes.is_in(i)
+      if (!im_convexes.is_in(i) && !renumbered.is_in(i)
 	  && v_num_update < linked_mesh_->convex_version_number(i)) {
 	if (auto_add_elt_pim != 0)
 	  const_cast<mesh_im *>(this)
@@ -196,6 +213,7 @@ namespace getfem {
 
   void mesh_im::read_from_file(const std::string &name)
   { 
+    if (bgeot::is_binary_file(name)) { read_from_binary_file(name); return; }
     std::ifstream o(name.c_str());
     GMM_ASSERT1(o, "mesh_im file '" << name << "' does not exist");
     read_from_file(o);
@@ -226,6 +244,79 @@ namespace getfem {
     o.close();
   }
 
+  /* Sections of a mesh_im in a binary file:
+     MIM       : format version
+     MIM_IM    : names of the integration methods
+     MIM_CVI   : indices of the convexes having an integration method
+     MIM_CVIM  : integration method of each of these convexes
+  */
+  void mesh_im::write_to_binary_file(bgeot::binary_file_writer &f,
+                                     size_type id) const {
+    context_check();
+    std::vector<gmm::uint64_type> hdr = { 1 };
+    f.write_section("MIM", id, hdr);
+    std::map<pintegration_method, size_type> imnum;
+    std::vector<std::string> imnames;
+    std::vector<size_type> cvs, cvim;
+    for (dal::bv_visitor cv(convex_index()); !cv.finished(); ++cv) {
+      pintegration_method pim = int_method_of_element(cv);
+      auto it = imnum.find(pim);
+      if (it == imnum.end()) {
+        it = imnum.emplace(pim, imnames.size()).first;
+        imnames.push_back(name_of_int_method(pim));
+      }
+      cvs.push_back(cv);
+      cvim.push_back(it->second);
+    }
+    f.write_string_section("MIM_IM", id, imnames);
+    f.write_index_section("MIM_CVI", id, cvs);
+    f.write_index_section("MIM_CVIM", id, cvim);
+  }
+
+  void mesh_im::write_to_binary_file(const std::string &name,
+                                     bool with_mesh) const {
+    bgeot::binary_file_writer f(name);
+    if (with_mesh) linked_mesh().write_to_binary_file(f);
+    write_to_binary_file(f);
+    f.close();
+  }
+
+  void mesh_im::read_from_binary_file(const bgeot::binary_file_reader &f,
+                                     size_type id) {
+    GMM_ASSERT1(linked_mesh_ != 0, "Uninitialized mesh_im");
+    clear();
+    bgeot::binary_section<gmm::uint64_type>
+      hdr = f.section<gmm::uint64_type>("MIM", id);
+    GMM_ASSERT1(hdr.size() >= 1 && hdr[0] == 1, "Unsupported version of "
+                "the mesh_im sections in binary file " << f.name());
+    std::vector<std::string> imnames;
+    f.read_string_section("MIM_IM", id, imnames);
+    std::vector<pintegration_method> ims_(imnames.size());
+    for (size_type i = 0; i < imnames.size(); ++i) {
+      ims_[i] = int_method_descriptor(imnames[i]);
+      GMM_ASSERT1(ims_[i], "could not create the integration method '"
+                  << imnames[i] << "'");
+    }
+    std::vector<size_type> cvs, cvim;
+    f.read_index_section("MIM_CVI", id, cvs);
+    f.read_index_section("MIM_CVIM", id, cvim);
+    GMM_ASSERT1(cvs.size() == cvim.size(), "Corrupted binary file "
+                << f.name());
+    for (size_type i = 0; i < cvs.size(); ++i) {
+      GMM_ASSERT1(linked_mesh().convex_index().is_in(cvs[i]), "Convex "
+                  << cvs[i] << " does not exist, are you sure "
+                  "that the mesh attached to this object is right one ?");
+      GMM_ASSERT1(cvim[i] < ims_.size(), "Corrupted binary file "
+                  << f.name());
+      set_integration_method(cvs[i], ims_[cvim[i]]);
+    }
+  }
+
+  void mesh_im::read_from_binary_file(const std::string &name) {
+    bgeot::binary_file_reader f(name);
+    read_from_binary_file(f);
+  }
+
   struct dummy_mesh_im_ {
     mesh_im mim;
     dummy_mesh_im_() : mim() {}
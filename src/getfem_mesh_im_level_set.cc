@@ -29,8 +29,8 @@ namespace getfem {
   { is_adapted = false; }
 
   void mesh_im_level_set::clear_build_methods() {
-    for (size_type i = 0; i < build_methods.size(); ++i)
-      del_stored_object(build_methods[i]);
+    for (const auto &bm : build_methods)
+      if (bm.second.get()) del_stored_object(bm.second);
     build_methods.clear();
     cut_im.clear();
   }
@@ -218,7 +218,39 @@ namespace getfem {
     return r;
   }
 
-  void mesh_im_level_set::build_method_of_convex(size_type cv) {
+  /* The integration method built on a cut convex only depends on its
+     geometric transformation, on the values of the level sets on it
+     (from which its sub-mesh is computed) and, for the integration on the
+     boundary, on its shape (up to a translation). */
+  void mesh_im_level_set::method_key_of_convex(size_type cv,
+                                               cut_method_key &key) const {
+    key.objects.resize(0); key.values.resize(0);
+    key.objects.push_back(linked_mesh().trans_of_convex(cv));
+    key.objects.push_back(regular_simplex_pim);
+    key.objects.push_back(base_singular_pim);
+    key.values.push_back(scalar_type(integrate_where));
+    key.values.push_back(mls->crack_tip_convexes().is_in(cv) ? 1. : 0.);
+    for (unsigned i = 0; i < mls->nb_level_sets(); ++i) {
+      const level_set &ls = *(mls->get_level_set(i));
+      const mesh_fem &mf = ls.get_mesh_fem();
+      key.objects.push_back(mf.fem_of_element(cv));
+      key.values.push_back(ls.get_shift());
+      for (unsigned lsnum = 0; lsnum < (ls.has_secondary() ? 2u : 1u);
+           ++lsnum)
+        for (size_type dof : mf.ind_basic_dof_of_element(cv))
+          key.values.push_back(ls.values(lsnum)[dof]);
+    }
+    if (integrate_where == INTEGRATE_BOUNDARY) {
+      const base_node P0 = linked_mesh().points_of_convex(cv)[0];
+      for (size_type i = 0; i < linked_mesh().nb_points_of_convex(cv); ++i)
+        for (size_type k = 0; k < P0.size(); ++k)
+          key.values.push_back(linked_mesh().points_of_convex(cv)[i][k]
+                               - P0[k]);
+    }
+  }
+
+  pintegration_method
+  mesh_im_level_set::build_method_of_convex(size_type cv) {
     const mesh &msh(mls->mesh_of_convex(cv));
     GMM_ASSERT3(msh.convex_index().card() != 0, "Internal error");
     base_matrix G;
@@ -392,48 +424,100 @@ namespace getfem {
 
     if (new_approx->nb_points()) {
       new_approx->valid_method();
-      pintegration_method
-        pim = std::make_shared<integration_method>(new_approx);
-      dal::pstatic_stored_object_key
-        pk = std::make_shared<special_imls_key>(new_approx);
-      dal::add_stored_object(pk, pim, new_approx->ref_convex(),
-                             new_approx->pintegration_points());
-      build_methods.push_back(pim);
-      cut_im.set_integration_method(cv, pim);
+      return std::make_shared<integration_method>(new_approx);
     }
+    return pintegration_method();
   }
 
   void mesh_im_level_set::adapt(void) {
     GMM_ASSERT1(linked_mesh_ != 0, "mesh level set uninitialized");
     context_check();
-    clear_build_methods();
+    if (build_methods_csg != ls_csg_description) clear_build_methods();
+    build_methods_csg = ls_csg_description;
     ignored_im.clear();
-    for (dal::bv_visitor cv(linked_mesh().convex_index());
-         !cv.finished(); ++cv) {
-      if (mls->is_convex_cut(cv)) build_method_of_convex(cv);
-
-      if (!cut_im.convex_index().is_in(cv)) {
-        /* not exclusive with mls->is_convex_cut ... sometimes, cut cv
-           contains no integration points.. */
 
-        if (integrate_where == INTEGRATE_BOUNDARY) {
-          ignored_im.add(cv);
-        } else if (integrate_where != (INTEGRATE_OUTSIDE|INTEGRATE_INSIDE)) {
-          /* remove convexes that are not in the integration area */
-          std::vector<pmesher_signed_distance> mesherls0(mls->nb_level_sets());
-          std::vector<pmesher_signed_distance> mesherls1(mls->nb_level_sets());
-          for (unsigned i = 0; i < mls->nb_level_sets(); ++i) {
-            mesherls0[i] = mls->get_level_set(i)->mls_of_convex(cv, 0, false);
-            if (mls->get_level_set(i)->has_secondary())
-              mesherls1[i] = mls->get_level_set(i)->mls_of_convex(cv,1, false);
+    // The dofs of the level sets are enumerated before the parallel loops
+    for (unsigned i = 0; i < mls->nb_level_sets(); ++i)
+      mls->get_level_set(i)->get_mesh_fem().nb_dof();
+
+    /* Methods of the cut convexes, shared by the convexes having the same
+       configuration and taken from the previous call when possible. */
+    typedef std::map<cut_method_key, pintegration_method> methods_map;
+    methods_map methods;
+    std::vector<size_type> cut_cvs, to_build;
+    std::vector<methods_map::iterator> cv_methods;
+    cut_method_key key;
+    for (dal::bv_visitor cv(linked_mesh().convex_index());
+         !cv.finished(); ++cv)
+      if (mls->is_convex_cut(cv)) {
+        method_key_of_convex(cv, key);
+        methods_map::iterator it = methods.find(key);
+        if (it == methods.end()) {
+          methods_map::iterator itold = build_methods.find(key);
+          if (itold != build_methods.end()) {
+            it = methods.insert(*itold).first;
+            build_methods.erase(itold);
+          } else {
+            it = methods.insert(std::make_pair(key,
+                                               pintegration_method())).first;
+            to_build.push_back(cut_cvs.size());
           }
-
-          base_node B(gmm::mean_value(linked_mesh().trans_of_convex(cv)
-                                      ->convex_ref()->points()));
-          if (!is_point_in_selected_area(mesherls0, mesherls1, B).in)
-            ignored_im.add(cv);
         }
+        cut_cvs.push_back(cv);
+        cv_methods.push_back(it);
+      }
+    clear_build_methods(); // methods of the previous call no longer used
+
+    size_type nbb = to_build.size();
+    std::vector<pintegration_method> built(nbb);
+    auto build = [&](size_type j)
+      { built[j] = build_method_of_convex(cut_cvs[to_build[j]]); };
+    GETFEM_OMP_FOR(size_type j = 0, j < nbb, ++j, build(j););
+
+    for (size_type j = 0; j < nbb; ++j)
+      if (built[j]) {
+        papprox_integration pai = built[j]->approx_method();
+        dal::pstatic_stored_object_key
+          pk = std::make_shared<special_imls_key>(pai);
+        dal::add_stored_object(pk, built[j], pai->ref_convex(),
+                               pai->pintegration_points());
+        cv_methods[to_build[j]]->second = built[j];
       }
+    for (size_type i = 0; i < cut_cvs.size(); ++i)
+      if (cv_methods[i]->second)
+        cut_im.set_integration_method(cut_cvs[i], cv_methods[i]->second);
+    std::swap(build_methods, methods);
+
+    /* not exclusive with mls->is_convex_cut ... sometimes, cut cv
+       contains no integration points.. */
+    std::vector<size_type> cvs;
+    for (dal::bv_visitor cv(linked_mesh().convex_index());
+         !cv.finished(); ++cv)
+      if (!cut_im.convex_index().is_in(cv)) cvs.push_back(cv);
+
+    if (integrate_where == INTEGRATE_BOUNDARY) {
+      for (size_type cv : cvs) ignored_im.add(cv);
+    } else if (integrate_where != (INTEGRATE_OUTSIDE|INTEGRATE_INSIDE)) {
+      /* remove convexes that are not in the integration area */
+      size_type nbcv = cvs.size();
+      std::vector<char> ignored(nbcv, 0);
+      auto is_ignored = [&](size_type j) {
+        size_type cv = cvs[j];
+        std::vector<pmesher_signed_distance> mesherls0(mls->nb_level_sets());
+        std::vector<pmesher_signed_distance> mesherls1(mls->nb_level_sets());
+        for (unsigned i = 0; i < mls->nb_level_sets(); ++i) {
+          mesherls0[i] = mls->get_level_set(i)->mls_of_convex(cv, 0, false);
+          if (mls->get_level_set(i)->has_secondary())
+            mesherls1[i] = mls->get_level_set(i)->mls_of_convex(cv,1, false);
+        }
+
+        base_node B(gmm::mean_value(linked_mesh().trans_of_convex(cv)
+                                    ->convex_ref()->points()));
+        ignored[j] = !is_point_in_selected_area(mesherls0, mesherls1, B).in;
+      };
+      GETFEM_OMP_FOR(size_type j = 0, j < nbcv, ++j, is_ignored(j););
+      for (size_type j = 0; j < nbcv; ++j)
+        if (ignored[j]) ignored_im.add(cvs[j]);
     }
     is_adapted = true; touch();
     // cout << "Number of built methods : " << build_methods.size() << endl;
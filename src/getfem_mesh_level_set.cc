@@ -20,10 +20,24 @@
 ===========================================================================*/
 
 #include "getfem/getfem_mesh_level_set.h"
+#include <random>
 
 
 namespace getfem {
 
+  /* Pseudo random point in [-1,1]^n depending only on cv and k, so that
+     the cut of a convex does not depend on the order in which the
+     convexes are processed (they are cut in parallel). */
+  static void random_point_of_convex(size_type cv, size_type k,
+                                     base_node &X) {
+    std::minstd_rand gen(std::minstd_rand::result_type(cv * 64 + k + 1));
+    scalar_type a = scalar_type(std::minstd_rand::min());
+    scalar_type b = scalar_type(std::minstd_rand::max());
+    for (size_type i = 0; i < X.size(); ++i)
+      X[i] = scalar_type(2) * (scalar_type(gen()) - a) / (b - a)
+        - scalar_type(1);
+  }
+
   std::ostream &operator<<(std::ostream &os, const mesh_level_set::zone &z) {
     os << "zone[";
     for (mesh_level_set::zone::const_iterator it = z.begin();
@@ -360,13 +374,15 @@ struct Chrono {
   }
 
   /* prezone was filled for the whole convex by find_crossing_level_set. 
-     This information is now refined for each sub-convex.
+     This information is now refined for each sub-convex. The sub-zones
+     are then merged into the zoneset of the convex by adapt.
   */
   void mesh_level_set::find_zones_of_element(size_type cv,
-					     std::string &prezone,
-					     scalar_type radius) {
-    convex_info &cvi = cut_cv[cv];
-    cvi.zones.clear();
+					     const std::string &prezone,
+					     scalar_type radius,
+					     std::vector<std::string> &subzones) {
+    const convex_info &cvi = cut_cv.find(cv)->second;
+    subzones.resize(0);
     for (dal::bv_visitor i(cvi.pmsh->convex_index()); !i.finished();++i) {
       // If the sub element is too small, the zone is not taken into account
       if (cvi.pmsh->convex_area_estimate(i) > 1e-8) {
@@ -379,11 +395,30 @@ struct Chrono {
 	    subz[j] = (s < 0) ? '-' : ((s > 0) ? '+' : '0');
 	  }
 	}
-	merge_zoneset(cvi.zones, subz);
+	subzones.push_back(subz);
       }
     }
-    if (noisy) cout << "Number of zones for convex " << cv << " : "
-		    << cvi.zones.size() << endl;
+  }
+
+  void mesh_level_set::convex_ls_values(size_type cv,
+					std::vector<scalar_type> &v) const {
+    v.resize(0);
+    for (size_type k = 0; k < level_sets.size(); ++k) {
+      const level_set &ls = *(level_sets[k]);
+      const mesh_fem::ind_dof_ct &dofs
+	= ls.get_mesh_fem().ind_basic_dof_of_element(cv);
+      v.push_back(scalar_type(ls.degree()));
+      v.push_back(ls.get_shift());
+      for (unsigned lsnum = 0; lsnum < (ls.has_secondary() ? 2u : 1u);
+	   ++lsnum)
+	for (mesh_fem::ind_dof_ct::const_iterator it = dofs.begin();
+	     it != dofs.end(); ++it)
+	  v.push_back(ls.values(lsnum)[*it]);
+    }
+    for (size_type i = 0; i < linked_mesh().nb_points_of_convex(cv); ++i) {
+      const base_node &pt = linked_mesh().points_of_convex(cv)[i];
+      v.insert(v.end(), pt.begin(), pt.end());
+    }
   }
 
 
@@ -392,8 +427,12 @@ struct Chrono {
 				   const dal::bit_vector &secondary,
 				   scalar_type radius_cv) {
     
-    cut_cv[cv] = convex_info();
-    cut_cv[cv].pmsh = std::make_shared<mesh>();
+    // The entry of cut_cv is created by adapt before the parallel loop.
+    std::map<size_type, convex_info>::iterator itcv = cut_cv.find(cv);
+    GMM_ASSERT1(itcv != cut_cv.end(), "Internal error");
+    convex_info &cvi = itcv->second;
+    cvi = convex_info();
+    cvi.pmsh = std::make_shared<mesh>();
     if (noisy) cout << "cutting element " << cv << endl;
     bgeot::pgeometric_trans pgt = linked_mesh().trans_of_convex(cv);
     pmesher_signed_distance ref_element = new_ref_element(pgt);
@@ -419,7 +458,7 @@ struct Chrono {
     mesher_level_sets.reserve(nbtotls);
     for (size_type ll = 0; ll < level_sets.size(); ++ll) {
       if (primary[ll]) {
-	base_node X(n); gmm::fill_random(X);
+	base_node X(n); random_point_of_convex(cv, ll, X);
 	K = std::max(K, (level_sets[ll])->degree());
 	mesher_level_sets.push_back(level_sets[ll]->mls_of_convex(cv, 0));
 	pmesher_signed_distance mls(mesher_level_sets.back());
@@ -525,9 +564,9 @@ struct Chrono {
       
       std::vector<base_node> fixed_points;
       std::vector<dal::bit_vector> fixed_points_constraints;
-      mesh &msh(*(cut_cv[cv].pmsh));
+      mesh &msh(*(cvi.pmsh));
 	
-      mesh_region &ls_border_faces(cut_cv[cv].ls_border_faces);
+      mesh_region &ls_border_faces(cvi.ls_border_faces);
       std::vector<base_node> cvpts;
 
       size_type nb_delaunay = 0;
@@ -858,33 +897,86 @@ struct Chrono {
     }    
   }
 
-  void mesh_level_set::adapt(void) {
+  void mesh_level_set::adapt(bool incremental) {
 
     // compute the elements touched by each level set
     // for each element touched, compute the sub mesh
     //   then compute the adapted integration method
     GMM_ASSERT1(linked_mesh_ != 0, "Uninitialized mesh_level_set");
+    std::map<size_type, convex_info> previous_cut_cv;
+    if (incremental) // the kept zonesets refer to allzones and allsubzones
+      std::swap(previous_cut_cv, cut_cv);
+    else {
+      allsubzones.clear();
+      allzones.clear();
+    }
     cut_cv.clear();
-    allsubzones.clear();
     zones_of_convexes.clear();
-    allzones.clear();
 
     // noisy = true;
 
-    std::string z;
+    // The dofs of the level sets are enumerated before the parallel loops
+    for (size_type k = 0; k < level_sets.size(); ++k)
+      level_sets[k]->get_mesh_fem().nb_dof();
+
+    std::vector<size_type> cvs;
+    cvs.reserve(linked_mesh().nb_convex());
     for (dal::bv_visitor cv(linked_mesh().convex_index()); 
-	 !cv.finished(); ++cv) {
-      scalar_type radius = linked_mesh().convex_radius_estimate(cv);
-      dal::bit_vector prim, sec;
-      find_crossing_level_set(cv, prim, sec, z, radius);
-      zones_of_convexes[cv] = &(*(allsubzones.insert(z).first));
+	 !cv.finished(); ++cv)
+      cvs.push_back(cv);
+    size_type nbcv = cvs.size();
+    std::vector<scalar_type> radius(nbcv);
+    std::vector<dal::bit_vector> prim(nbcv), sec(nbcv);
+    std::vector<std::string> z(nbcv);
+    auto find_crossing = [&](size_type i) {
+      radius[i] = linked_mesh().convex_radius_estimate(cvs[i]);
+      find_crossing_level_set(cvs[i], prim[i], sec[i], z[i], radius[i]);
+    };
+    GETFEM_OMP_FOR(size_type i = 0, i < nbcv, ++i, find_crossing(i););
+
+    // A convex already cut whose level set values and vertices did not
+    // change keeps its sub-mesh and zones in incremental mode.
+    std::vector<size_type> to_cut;
+    std::vector<scalar_type> ls_values;
+    for (size_type i = 0; i < nbcv; ++i) {
+      size_type cv = cvs[i];
+      zones_of_convexes[cv] = &(*(allsubzones.insert(z[i]).first));
       if (noisy) cout << "element " << cv << " cut level sets : "
-		      << prim << " zone : " << z << endl;
-      if (prim.card()) {
-	cut_element(cv, prim, sec, radius);
-	find_zones_of_element(cv, z, radius);
+		      << prim[i] << " zone : " << z[i] << endl;
+      if (prim[i].card()) {
+	convex_info &cvi = cut_cv[cv];
+	std::map<size_type, convex_info>::iterator
+	  it = previous_cut_cv.find(cv);
+	if (it != previous_cut_cv.end()) {
+	  convex_ls_values(cv, ls_values);
+	  if (ls_values == it->second.ls_values)
+	    { std::swap(cvi, it->second); continue; }
+	}
+	to_cut.push_back(i);
       }
     }
+    previous_cut_cv.clear();
+
+    // Each convex is cut with its own point stock.
+    size_type nbcut = to_cut.size();
+    std::vector<std::vector<std::string> > subzones(nbcut);
+    auto cut = [&](size_type j) {
+      size_type i = to_cut[j], cv = cvs[i];
+      cut_element(cv, prim[i], sec[i], radius[i]);
+      find_zones_of_element(cv, z[i], radius[i], subzones[j]);
+      convex_ls_values(cv, cut_cv.find(cv)->second.ls_values);
+    };
+    GETFEM_OMP_FOR(size_type j = 0, j < nbcut, ++j, cut(j););
+
+    for (size_type j = 0; j < nbcut; ++j) {
+      size_type cv = cvs[to_cut[j]];
+      convex_info &cvi = cut_cv[cv];
+      cvi.zones.clear();
+      for (size_type k = 0; k < subzones[j].size(); ++k)
+	merge_zoneset(cvi.zones, subzones[j][k]);
+      if (noisy) cout << "Number of zones for convex " << cv << " : "
+		      << cvi.zones.size() << endl;
+    }
     if (noisy) {
       getfem::stored_mesh_slice sl;
       sl.build(global_mesh(), getfem::slicer_none(), 6);
@@ -928,7 +1020,7 @@ struct Chrono {
 						    scalar_type radius) {
     scalar_type EPS = 1e-7 * radius;
     bgeot::pgeometric_trans pgt = linked_mesh().trans_of_convex(cv);
-    convex_info &cvi = cut_cv[cv];
+    const convex_info &cvi = cut_cv.find(cv)->second;
     bgeot::pgeometric_trans pgt2 = cvi.pmsh->trans_of_convex(sub_cv);
 
     // cout << "cv " << cv << " radius = " << radius << endl;
@@ -981,19 +1073,20 @@ struct Chrono {
 
     pmesher_signed_distance mls1 = ls->mls_of_convex(cv, lsnum, false);
     base_node X(pf->dim()), G(pf->dim());
-    gmm::fill_random(X); X *= 1E-2;
+    size_type k0 = 16 + 6 * lsnum; // other seeds than in cut_element
+    random_point_of_convex(cv, k0, X); X *= 1E-2;
     scalar_type d = mls1->grad(X, G);
     if (gmm::vect_norm2(G)*2.5 < gmm::abs(d)) return p;
 
     bgeot::pgeometric_trans pgt = linked_mesh().trans_of_convex(cv);
     pmesher_signed_distance ref_element = new_ref_element(pgt);
     
-    gmm::fill_random(X); X *= 1E-2;
+    random_point_of_convex(cv, k0+1, X); X *= 1E-2;
     mesher_intersection mi1(ref_element, mls1);
     if (!try_projection(mi1, X)) return p;
     if ((*ref_element)(X) > 1E-8) return p;
     
-    gmm::fill_random(X); X *= 1E-2;
+    random_point_of_convex(cv, k0+2, X); X *= 1E-2;
     pmesher_signed_distance mls2 = ls->mls_of_convex(cv, lsnum, true);
     mesher_intersection mi2(ref_element, mls2);
     if (!try_projection(mi2, X)) return p;
@@ -0,0 +1,274 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+#include "getfem/getfem_mesh_partition.h"
+
+namespace getfem {
+
+  /* Dual graph of the mesh in compressed row format, indexed by the
+     convex indices (two convexes are connected if they share a face). */
+  static void mesh_dual_graph(const mesh &m, std::vector<size_type> &xadj,
+                              std::vector<size_type> &adj) {
+    size_type nbc = m.nb_allocated_convex();
+    std::vector<std::vector<size_type>> neighbors(nbc);
+    auto build = [&](size_type ic) {
+      if (m.convex_index().is_in(ic))
+        m.neighbors_of_convex(ic, neighbors[ic]);
+    };
+    GETFEM_OMP_FOR(size_type ic = 0, ic < nbc, ++ic, build(ic););
+    xadj.assign(nbc+1, 0);
+    for (size_type ic = 0; ic < nbc; ++ic)
+      xadj[ic+1] = xadj[ic] + neighbors[ic].size();
+    adj.resize(xadj[nbc]);
+    for (size_type ic = 0; ic < nbc; ++ic)
+      std::copy(neighbors[ic].begin(), neighbors[ic].end(),
+                adj.begin() + xadj[ic]);
+  }
+
+  static inline scalar_type
+  convex_weight(const std::vector<scalar_type> &weights, size_type ic)
+  { return weights.empty() ? scalar_type(1) : weights[ic]; }
+
+  /* Weighted recursive coordinate bisection of the centroids. */
+  struct rcb_partitioner {
+    const std::vector<scalar_type> &c;
+    size_type N;
+    const std::vector<scalar_type> &weights;
+    std::vector<size_type> &part;
+
+    void bisect(std::vector<size_type>::iterator b,
+                std::vector<size_type>::iterator e,
+                size_type nbp, size_type first_part) {
+      size_type nb = size_type(e - b);
+      if (nbp == 1 || nb == 0) {
+        for (auto it = b; it != e; ++it) part[*it] = first_part;
+        return;
+      }
+
+      // Direction of largest extent
+      size_type k = 0;
+      scalar_type ext = scalar_type(-1);
+      for (size_type d = 0; d < N; ++d) {
+        scalar_type cmin = c[(*b)*N+d], cmax = cmin;
+        for (auto it = b; it != e; ++it) {
+          cmin = std::min(cmin, c[(*it)*N+d]);
+          cmax = std::max(cmax, c[(*it)*N+d]);
+        }
+        if (cmax - cmin > ext) { ext = cmax - cmin; k = d; }
+      }
+      std::sort(b, e, [&](size_type i, size_type j) {
+          return (c[i*N+k] < c[j*N+k]) || (c[i*N+k] == c[j*N+k] && i < j);
+        });
+
+      size_type nbp1 = nbp / 2, nb1 = 0;
+      scalar_type W(0);
+      for (auto it = b; it != e; ++it) W += convex_weight(weights, *it);
+      if (W > scalar_type(0)) {
+        scalar_type target = W * scalar_type(nbp1) / scalar_type(nbp);
+        scalar_type acc(0);
+        for (auto it = b; it != e; ++it, ++nb1) {
+          scalar_type w = convex_weight(weights, *it);
+          if (acc + w/scalar_type(2) > target) break;
+          acc += w;
+        }
+      } else
+        nb1 = nb * nbp1 / nbp;
+      if (nb >= nbp) // At least one convex in each part
+        nb1 = std::max(nbp1, std::min(nb1, nb - (nbp - nbp1)));
+
+      bisect(b, b + nb1, nbp1, first_part);
+      bisect(b + nb1, e, nbp - nbp1, first_part + nbp1);
+    }
+
+    rcb_partitioner(const std::vector<scalar_type> &c_, size_type N_,
+                    const std::vector<scalar_type> &w,
+                    std::vector<size_type> &p)
+      : c(c_), N(N_), weights(w), part(p) {}
+  };
+
+  /* Greedy refinement: a convex on the boundary of its part is moved to
+     the neighbor part which reduces the most the edge cut, provided the
+     weight of this part stays below the allowed maximum. Moves which do
+     not change the edge cut are accepted when they improve the balance.
+     A part is never emptied. */
+  static void refine_partition(const mesh &m, size_type nb_parts,
+                               std::vector<size_type> &part,
+                               const std::vector<scalar_type> &weights,
+                               const std::vector<size_type> &xadj,
+                               const std::vector<size_type> &adj,
+                               size_type nb_passes,
+                               scalar_type max_imbalance) {
+    std::vector<scalar_type> pw(nb_parts, scalar_type(0));
+    std::vector<size_type> pc(nb_parts, 0);
+    scalar_type W(0);
+    for (dal::bv_visitor ic(m.convex_index()); !ic.finished(); ++ic) {
+      scalar_type w = convex_weight(weights, ic);
+      pw[part[ic]] += w; pc[part[ic]]++; W += w;
+    }
+    scalar_type maxw = max_imbalance * W / scalar_type(nb_parts);
+    std::vector<std::pair<size_type, size_type>> cnt;
+
+    for (size_type pass = 0; pass < nb_passes; ++pass) {
+      size_type nb_moves = 0;
+      for (dal::bv_visitor ic(m.convex_index()); !ic.finished(); ++ic) {
+        size_type p = part[ic];
+        if (pc[p] <= 1) continue;
+        cnt.resize(0);
+        size_type nin = 0;
+        for (size_type k = xadj[ic]; k < xadj[ic+1]; ++k) {
+          size_type q = part[adj[k]];
+          if (q == p) { ++nin; continue; }
+          auto it = std::find_if(cnt.begin(), cnt.end(),
+                                 [q](const std::pair<size_type, size_type> &a)
+                                 { return a.first == q; });
+          if (it == cnt.end()) cnt.push_back(std::make_pair(q, 1));
+          else it->second++;
+        }
+        if (cnt.empty()) continue;
+
+        scalar_type w = convex_weight(weights, ic);
+        size_type best = size_type(-1), best_gain = 0;
+        for (const auto &a : cnt) {
+          if (a.second < nin || pw[a.first] + w > maxw) continue;
+          size_type gain = a.second - nin;
+          if (gain == 0 && pw[a.first] + w >= pw[p]) continue;
+          if (best == size_type(-1) || gain > best_gain
+              || (gain == best_gain && pw[a.first] < pw[best]))
+            { best = a.first; best_gain = gain; }
+        }
+        if (best != size_type(-1)) {
+          part[ic] = best;
+          pw[p] -= w; pw[best] += w; pc[p]--; pc[best]++;
+          ++nb_moves;
+        }
+      }
+      if (nb_moves == 0) break;
+    }
+  }
+
+  void partition_mesh(const mesh &m, size_type nb_parts,
+                      std::vector<size_type> &part,
+                      const std::vector<scalar_type> &weights,
+                      size_type nb_refinement_passes,
+                      scalar_type max_imbalance) {
+    GMM_ASSERT1(nb_parts > 0, "The number of parts should be positive");
+    GMM_ASSERT1(weights.empty()
+                || weights.size() >= m.nb_allocated_convex(),
+                "Wrong size of the vector of weights");
+    size_type nbc = m.nb_allocated_convex(), N = m.dim();
+    part.assign(nbc, size_type(-1));
+    if (m.nb_convex() == 0) return;
+
+    std::vector<scalar_type> c(nbc*N);
+    auto centroid = [&](size_type ic) {
+      if (!m.convex_index().is_in(ic)) return;
+      const auto &ipts = m.ind_points_of_convex(ic);
+      for (size_type ip : ipts)
+        for (size_type k = 0; k < N; ++k) c[ic*N+k] += m.points()[ip][k];
+      for (size_type k = 0; k < N; ++k)
+        c[ic*N+k] /= scalar_type(ipts.size());
+    };
+    GETFEM_OMP_FOR(size_type ic = 0, ic < nbc, ++ic, centroid(ic););
+
+    std::vector<size_type> cvs;
+    cvs.reserve(m.nb_convex());
+    for (dal::bv_visitor ic(m.convex_index()); !ic.finished(); ++ic)
+      cvs.push_back(ic);
+    rcb_partitioner(c, N, weights, part).bisect(cvs.begin(), cvs.end(),
+                                                nb_parts, 0);
+
+    if (nb_parts > 1 && nb_refinement_passes > 0) {
+      std::vector<size_type> xadj, adj;
+      mesh_dual_graph(m, xadj, adj);
+      refine_partition(m, nb_parts, part, weights, xadj, adj,
+                       nb_refinement_passes, max_imbalance);
+    }
+  }
+
+  void partition_statistics(const mesh &m,
+                            const std::vector<size_type> &part,
+                            mesh_partition_statistics &stats,
+                            const std::vector<scalar_type> &weights) {
+    GMM_ASSERT1(part.size() >= m.nb_allocated_convex(),
+                "Wrong size of the partition vector");
+    stats = mesh_partition_statistics();
+    for (dal::bv_visitor ic(m.convex_index()); !ic.finished(); ++ic)
+      stats.nb_parts = std::max(stats.nb_parts, part[ic] + 1);
+    stats.part_weight.assign(stats.nb_parts, scalar_type(0));
+    bgeot::mesh_structure::ind_set s;
+    scalar_type W(0);
+    for (dal::bv_visitor ic(m.convex_index()); !ic.finished(); ++ic) {
+      scalar_type w = convex_weight(weights, ic);
+      stats.part_weight[part[ic]] += w; W += w;
+      m.neighbors_of_convex(ic, s);
+      for (size_type jc : s)
+        if (jc > ic && part[jc] != part[ic]) stats.edge_cut++;
+    }
+    if (stats.nb_parts) {
+      stats.mean_weight = W / scalar_type(stats.nb_parts);
+      stats.max_weight = *std::max_element(stats.part_weight.begin(),
+                                           stats.part_weight.end());
+    }
+  }
+
+  void mesh_im_convex_weights(const mesh_im &mim,
+                              std::vector<scalar_type> &weights) {
+    weights.assign(mim.linked_mesh().nb_allocated_convex(), scalar_type(0));
+    for (dal::bv_visitor cv(mim.convex_index()); !cv.finished(); ++cv) {
+      pintegration_method pim = mim.int_method_of_element(cv);
+      if (pim->type() == IM_APPROX)
+        weights[cv]
+          = scalar_type(pim->approx_method()->nb_points_on_convex());
+      else if (pim->type() == IM_EXACT)
+        weights[cv] = scalar_type(1);
+    }
+  }
+
+  void renumber_convexes_by_partition(mesh &m, size_type nb_parts,
+                                      const std::vector<scalar_type> &weights,
+                                      mesh_partition_statistics *stats) {
+    if (nb_parts == 0)
+      nb_parts = partition_master::get().get_nb_partitions();
+
+    std::vector<size_type> part;
+    partition_mesh(m, nb_parts, part, weights);
+
+    std::vector<size_type> order;
+    order.reserve(m.nb_convex());
+    for (dal::bv_visitor ic(m.convex_index()); !ic.finished(); ++ic)
+      order.push_back(ic);
+    std::stable_sort(order.begin(), order.end(),
+                     [&part](size_type i, size_type j)
+                     { return part[i] < part[j]; });
+    m.renumber_convexes(order);
+
+    if (stats) {
+      std::vector<size_type> new_part(order.size());
+      std::vector<scalar_type> new_weights(weights.empty() ? 0 : order.size());
+      for (size_type i = 0; i < order.size(); ++i) {
+        new_part[i] = part[order[i]];
+        if (!weights.empty()) new_weights[i] = weights[order[i]];
+      }
+      partition_statistics(m, new_part, *stats, new_weights);
+    }
+  }
+
+}  /* end of namespace getfem.                                             */
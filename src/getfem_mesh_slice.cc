@@ -276,13 +276,75 @@ namespace getfem {
                                 const slicer_action *c, 
                                 size_type nrefine) {
     clear();
-    mesh_slicer slicer(m);
-    slicer.push_back_action(*const_cast<slicer_action*>(a));
-    if (b) slicer.push_back_action(*const_cast<slicer_action*>(b));
-    if (c) slicer.push_back_action(*const_cast<slicer_action*>(c));
-    slicer_build_stored_mesh_slice sbuild(*this);
-    slicer.push_back_action(sbuild);
-    slicer.exec(nrefine);
+    size_type nbcv = m.convex_index().card();
+    size_type nbth = true_thread_policy::num_threads();
+    size_type nbparts = std::min(4*nbth, nbcv);
+    if (nbth <= 1 || nbparts <= 1 || me_is_multithreaded_now()
+        || !a->thread_safe() || (b && !b->thread_safe())
+        || (c && !c->thread_safe())) {
+      mesh_slicer slicer(m);
+      slicer.push_back_action(*const_cast<slicer_action*>(a));
+      if (b) slicer.push_back_action(*const_cast<slicer_action*>(b));
+      if (c) slicer.push_back_action(*const_cast<slicer_action*>(c));
+      slicer_build_stored_mesh_slice sbuild(*this);
+      slicer.push_back_action(sbuild);
+      slicer.exec(nrefine);
+      return;
+    }
+
+    /* Each thread slices a contiguous range of convexes with its own
+       mesh_slicer into its own slice. The partial slices are then
+       appended in the order of the convexes, which gives the same
+       numbering of the nodes and simplexes as the serial build. */
+    std::vector<size_type> cvs;
+    cvs.reserve(nbcv);
+    bgeot::pconvex_ref cvr = 0;
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+      cvs.push_back(cv);
+      // The refined meshes are stored objects, built here once for all.
+      if (m.trans_of_convex(cv)->convex_ref() != cvr) {
+        cvr = m.trans_of_convex(cv)->convex_ref();
+        bgeot::refined_simplex_mesh_for_convex(cvr, short_type(nrefine));
+      }
+    }
+    std::vector<std::unique_ptr<stored_mesh_slice>> parts(nbparts);
+    auto build_part = [&](size_type i) {
+      mesh_region rg;
+      for (size_type j = i*nbcv/nbparts; j < (i+1)*nbcv/nbparts; ++j)
+        rg.add(cvs[j]);
+      rg.prohibit_partitioning();
+      parts[i] = std::make_unique<stored_mesh_slice>();
+      mesh_slicer slicer(m);
+      slicer.push_back_action(*const_cast<slicer_action*>(a));
+      if (b) slicer.push_back_action(*const_cast<slicer_action*>(b));
+      if (c) slicer.push_back_action(*const_cast<slicer_action*>(c));
+      slicer_build_stored_mesh_slice sbuild(*parts[i]);
+      slicer.push_back_action(sbuild);
+      slicer.exec(nrefine, rg);
+    };
+    GETFEM_OMP_FOR(size_type i = 0, i < nbparts, ++i, build_part(i););
+
+    for (size_type i = 0; i < nbparts; ++i) {
+      stored_mesh_slice &sl = *parts[i];
+      if (!sl.poriginal_mesh) continue;
+      if (!poriginal_mesh) {
+        poriginal_mesh = sl.poriginal_mesh;
+        dim_ = sl.dim_;
+        cv2pos.assign(sl.cv2pos.size(), size_type(-1));
+      }
+      dim_ = std::max(dim_, sl.dim_);
+      if (simplex_cnt.size() < sl.simplex_cnt.size())
+        simplex_cnt.resize(sl.simplex_cnt.size(), 0);
+      for (size_type d = 0; d < sl.simplex_cnt.size(); ++d)
+        simplex_cnt[d] += sl.simplex_cnt[d];
+      for (convex_slice &sc : sl.cvlst) {
+        cv2pos[sc.cv_num] = cvlst.size();
+        sc.global_points_count += points_cnt;
+        cvlst.push_back(std::move(sc));
+      }
+      points_cnt += sl.points_cnt;
+      parts[i].reset();
+    }
   }
 
   void stored_mesh_slice::replay(slicer_action *a, slicer_action *b,
@@ -186,7 +186,7 @@ namespace getfem {
                                     std::bitset<32> spin, std::bitset<32> spbin) {
     scalar_type alpha = 0; size_type iA=0, iB = 0;
     bool intersection = false;
-    static int level = 0;
+    THREAD_SAFE_STATIC int level = 0;
 
     level++;    
     /*
@@ -214,7 +214,7 @@ namespace getfem {
       n.faces = A.faces & B.faces;
       size_type nn = ms.nodes.size();
       ms.nodes.push_back(n); /* invalidate A and B.. */
-      pt_bin.add(nn); pt_in.add(nn);
+      pt_bin.thrd_cast().add(nn); pt_in.thrd_cast().add(nn);
       
       std::bitset<32> spin2(spin), spbin2(spbin); 
       std::swap(s.inodes[iA],nn);
@@ -265,6 +265,7 @@ namespace getfem {
     //cerr << "\n----\nslicer_volume::slice : entree, splx_in=" << splx_in << endl;
     if (ms.splx_in.card() == 0) return;
     prepare(ms.cv,ms.nodes,ms.nodes_index);
+    const dal::bit_vector &ptin = pt_in, &ptbin = pt_bin;
     for (dal::bv_visitor_c cnt(ms.splx_in); !cnt.finished(); ++cnt) {
       slice_simplex& s = ms.simplexes[cnt];
       /*cerr << "\n--------slicer_volume::slice : slicing convex " << cnt << endl;
@@ -275,8 +276,8 @@ namespace getfem {
       size_type in_cnt = 0, in_bcnt = 0;
       std::bitset<32> spin, spbin;
       for (size_type i=0; i < s.dim()+1; ++i) {
-        if (pt_in.is_in(s.inodes[i])) { ++in_cnt; spin.set(i); }
-        if (pt_bin.is_in(s.inodes[i])) { ++in_bcnt; spbin.set(i); }
+        if (ptin.is_in(s.inodes[i])) { ++in_cnt; spin.set(i); }
+        if (ptbin.is_in(s.inodes[i])) { ++in_bcnt; spbin.set(i); }
       }
 
       if (in_cnt == 0) {
@@ -288,11 +289,11 @@ namespace getfem {
     }
 
     /* signalement des points qui se trouvent pile-poil sur la bordure */
-    if (pt_bin.card()) {
+    if (ptbin.card()) {
       GMM_ASSERT1(ms.fcnt != dim_type(-1), 
                   "too much {faces}/{slices faces} in the convex " << ms.cv 
                   << " (nbfaces=" << ms.fcnt << ")");
-      for (dal::bv_visitor cnt(pt_bin); !cnt.finished(); ++cnt) {
+      for (dal::bv_visitor cnt(ptbin); !cnt.finished(); ++cnt) {
         ms.nodes[cnt].faces.set(ms.fcnt);
       }
       ms.fcnt++;
@@ -374,9 +375,11 @@ namespace getfem {
   void slicer_isovalues::prepare(size_type cv,
                                  const mesh_slicer::cs_nodes_ct& nodes, 
                                  const dal::bit_vector& nodes_index) {
-    pt_in.clear(); pt_bin.clear();
+    dal::bit_vector &ptin = pt_in, &ptbin = pt_bin;
+    std::vector<scalar_type> &U = Uval;
+    ptin.clear(); ptbin.clear();
     std::vector<base_node> refpts(nodes.size());
-    Uval.resize(nodes.size());
+    U.resize(nodes.size());
     base_vector coeff;
     base_matrix G;
     pfem pf = mfU->pmf->fem_of_element(cv);
@@ -396,14 +399,14 @@ namespace getfem {
       v[0] = 0;
       ctx.set_ii(i);
       pf->interpolation(ctx, coeff, v, mfU->pmf->get_qdim());
-      Uval[i] = v[0];
+      U[i] = v[0];
       // optimisable -- les bit_vectors sont lents..
-      pt_bin[i] = (gmm::abs(Uval[i] - val) < EPS * val_scaling);
-      pt_in[i] = (Uval[i] - val < 0); if (orient>0) pt_in[i] = !pt_in[i]; 
-      pt_in[i] = pt_in[i] || pt_bin[i];
+      ptbin[i] = (gmm::abs(U[i] - val) < EPS * val_scaling);
+      ptin[i] = (U[i] - val < 0); if (orient>0) ptin[i] = !ptin[i]; 
+      ptin[i] = ptin[i] || ptbin[i];
       // cerr << "cv=" << cv << ", node["<< i << "]=" << nodes[i].pt
-      //      << ", Uval[i]=" << Uval[i] << ", pt_in[i]=" << pt_in[i]
-      //      << ", pt_bin[i]=" << pt_bin[i] << endl;
+      //      << ", U[i]=" << U[i] << ", ptin[i]=" << ptin[i]
+      //      << ", ptbin[i]=" << ptbin[i] << endl;
     }
   }
 
@@ -28,11 +28,11 @@ namespace getfem {
     for (dim_type d=0; d < base.dim(); ++d) {
       gradient[d] = base; gradient[d].derivative(d);
     }
-    initialized = 1; 
+    initialized.store(1, std::memory_order_release);
   }
 
   void mesher_level_set::init_hess(void) const {
-    if (initialized < 1) init_grad();
+    if (initialized.load(std::memory_order_relaxed) < 1) init_grad();
     hessian.resize(base.dim()*base.dim());
     for (dim_type d=0; d < base.dim(); ++d) {
       for (dim_type e=0; e < base.dim(); ++e) {
@@ -40,12 +40,17 @@ namespace getfem {
         hessian[d*base.dim()+e].derivative(e);
       }
     }
-    initialized = 2;
+    initialized.store(2, std::memory_order_release);
   }
 
   scalar_type mesher_level_set::grad(const base_node &P,
                                      base_small_vector &G) const {
-    if (initialized < 1) init_grad();
+    /* The derivatives are built once, by the first thread which needs
+       them. The acquire load makes them visible to the other threads. */
+    if (initialized.load(std::memory_order_acquire) < 1) {
+      GLOBAL_OMP_GUARD
+      if (initialized.load(std::memory_order_relaxed) < 1) init_grad();
+    }
     gmm::resize(G, P.size());
     for (size_type i = 0; i < P.size(); ++i)
       G[i] = bgeot::to_scalar(gradient[i].eval(P.begin()));
@@ -53,7 +58,10 @@ namespace getfem {
   }
 
   void mesher_level_set::hess(const base_node &P, base_matrix &H) const {
-    if (initialized < 2) init_hess();
+    if (initialized.load(std::memory_order_acquire) < 2) {
+      GLOBAL_OMP_GUARD
+      if (initialized.load(std::memory_order_relaxed) < 2) init_hess();
+    }
     gmm::resize(H, P.size(), P.size()); 
     for (size_type i = 0; i < base.dim(); ++i)
       for (size_type j = 0; j < base.dim(); ++j) {
@@ -62,6 +70,242 @@ namespace getfem {
   }
 
 
+  //
+  // Evaluation on a set of points
+  //
+
+  /* The loops on the points are written in such a way that they can be
+     vectorized by the compiler. The results are the same as the ones of
+     the evaluation point by point. */
+
+  void mesher_signed_distance::batch_eval(size_type N, size_type nb,
+                                          const scalar_type *X,
+                                          scalar_type *d) const {
+    base_node P(N);
+    for (size_type i = 0; i < nb; ++i) {
+      for (size_type k = 0; k < N; ++k) P[k] = X[k*nb+i];
+      d[i] = (*this)(P);
+    }
+  }
+
+  static void grad_at_point(const mesher_signed_distance &dist,
+                            size_type N, size_type nb, const scalar_type *X,
+                            size_type i, scalar_type *d, scalar_type *G) {
+    base_node P(N);
+    base_small_vector V(N);
+    for (size_type k = 0; k < N; ++k) P[k] = X[k*nb+i];
+    d[i] = dist.grad(P, V);
+    for (size_type k = 0; k < N; ++k) G[k*nb+i] = V[k];
+  }
+
+  void mesher_signed_distance::batch_grad(size_type N, size_type nb,
+                                          const scalar_type *X,
+                                          scalar_type *d,
+                                          scalar_type *G) const {
+    for (size_type i = 0; i < nb; ++i) grad_at_point(*this, N, nb, X, i, d, G);
+  }
+
+  void mesher_half_space::batch_eval(size_type N, size_type nb,
+                                     const scalar_type *X,
+                                     scalar_type *d) const {
+    std::fill(d, d+nb, scalar_type(0));
+    for (size_type k = 0; k < N; ++k) {
+      const scalar_type *Xk = X + k*nb, nk = n[k];
+      for (size_type i = 0; i < nb; ++i) d[i] += Xk[i] * nk;
+    }
+    for (size_type i = 0; i < nb; ++i) d[i] = xon - d[i];
+  }
+
+  void mesher_half_space::batch_grad(size_type N, size_type nb,
+                                     const scalar_type *X, scalar_type *d,
+                                     scalar_type *G) const {
+    batch_eval(N, nb, X, d);
+    for (size_type k = 0; k < N; ++k)
+      std::fill(G + k*nb, G + (k+1)*nb, -n[k]);
+  }
+
+  void mesher_ball::batch_eval(size_type N, size_type nb,
+                               const scalar_type *X, scalar_type *d) const {
+    std::fill(d, d+nb, scalar_type(0));
+    for (size_type k = 0; k < N; ++k) {
+      const scalar_type *Xk = X + k*nb, xk = x0[k];
+      for (size_type i = 0; i < nb; ++i) d[i] += gmm::sqr(Xk[i] - xk);
+    }
+    for (size_type i = 0; i < nb; ++i) d[i] = gmm::sqrt(d[i]) - R;
+  }
+
+  void mesher_ball::batch_grad(size_type N, size_type nb,
+                               const scalar_type *X, scalar_type *d,
+                               scalar_type *G) const {
+    std::fill(d, d+nb, scalar_type(0));
+    for (size_type k = 0; k < N; ++k) {
+      const scalar_type *Xk = X + k*nb, xk = x0[k];
+      scalar_type *Gk = G + k*nb;
+      for (size_type i = 0; i < nb; ++i) {
+        Gk[i] = Xk[i] - xk;
+        d[i] += gmm::sqr(Gk[i]);
+      }
+    }
+    std::vector<scalar_type> inv(nb);
+    for (size_type i = 0; i < nb; ++i)
+      { d[i] = gmm::sqrt(d[i]); inv[i] = scalar_type(1) / d[i]; }
+    for (size_type k = 0; k < N; ++k) {
+      scalar_type *Gk = G + k*nb;
+      for (size_type i = 0; i < nb; ++i) Gk[i] *= inv[i];
+    }
+    for (size_type i = 0; i < nb; ++i) {
+      if (d[i] == scalar_type(0)) grad_at_point(*this, N, nb, X, i, d, G);
+      else d[i] -= R;
+    }
+  }
+
+  void mesher_rectangle::batch_eval(size_type N, size_type nb,
+                                    const scalar_type *X,
+                                    scalar_type *d) const {
+    for (size_type i = 0; i < nb; ++i) d[i] = rmin[0] - X[i];
+    for (size_type k = 0; k < N; ++k) {
+      const scalar_type *Xk = X + k*nb, a = rmin[k], b = rmax[k];
+      for (size_type i = 0; i < nb; ++i)
+        d[i] = std::max(std::max(d[i], a - Xk[i]), Xk[i] - b);
+    }
+  }
+
+  void mesher_rectangle::batch_grad(size_type N, size_type nb,
+                                    const scalar_type *X, scalar_type *d,
+                                    scalar_type *G) const {
+    // index of the active half space, as in grad
+    std::vector<size_type> ih(nb, 0);
+    for (size_type i = 0; i < nb; ++i) d[i] = rmin[0] - X[i];
+    for (size_type k = 0; k < N; ++k) {
+      const scalar_type *Xk = X + k*nb, a = rmin[k], b = rmax[k];
+      for (size_type i = 0; i < nb; ++i) {
+        if (a - Xk[i] > d[i]) { d[i] = a - Xk[i]; ih[i] = 2*k; }
+        if (Xk[i] - b > d[i]) { d[i] = Xk[i] - b; ih[i] = 2*k+1; }
+      }
+    }
+    std::fill(G, G + N*nb, scalar_type(0));
+    for (size_type i = 0; i < nb; ++i)
+      G[(ih[i]/2)*nb+i] = (ih[i] % 2) ? scalar_type(1) : scalar_type(-1);
+  }
+
+  void mesher_union::batch_eval(size_type N, size_type nb,
+                                const scalar_type *X, scalar_type *d) const {
+    if (!with_min)
+      { mesher_signed_distance::batch_eval(N, nb, X, d); return; }
+    dists[0]->batch_eval(N, nb, X, d);
+    std::vector<scalar_type> d2(nb);
+    for (size_type k = 1; k < dists.size(); ++k) {
+      dists[k]->batch_eval(N, nb, X, &d2[0]);
+      for (size_type i = 0; i < nb; ++i) d[i] = std::min(d[i], d2[i]);
+    }
+  }
+
+  void mesher_union::batch_grad(size_type N, size_type nb,
+                                const scalar_type *X, scalar_type *d,
+                                scalar_type *G) const {
+    if (!with_min)
+      { mesher_signed_distance::batch_grad(N, nb, X, d, G); return; }
+    dists[0]->batch_grad(N, nb, X, d, G);
+    std::vector<scalar_type> d2(nb), G2(N*nb);
+    for (size_type k = 1; k < dists.size(); ++k) {
+      dists[k]->batch_grad(N, nb, X, &d2[0], &G2[0]);
+      for (size_type i = 0; i < nb; ++i)
+        if (d2[i] < d[i]) {
+          d[i] = d2[i];
+          for (size_type l = 0; l < N; ++l) G[l*nb+i] = G2[l*nb+i];
+        }
+    }
+  }
+
+  void mesher_intersection::batch_eval(size_type N, size_type nb,
+                                       const scalar_type *X,
+                                       scalar_type *d) const {
+    dists[0]->batch_eval(N, nb, X, d);
+    std::vector<scalar_type> d2(nb);
+    for (size_type k = 1; k < dists.size(); ++k) {
+      dists[k]->batch_eval(N, nb, X, &d2[0]);
+      for (size_type i = 0; i < nb; ++i) d[i] = std::max(d[i], d2[i]);
+    }
+  }
+
+  void mesher_intersection::batch_grad(size_type N, size_type nb,
+                                       const scalar_type *X, scalar_type *d,
+                                       scalar_type *G) const {
+    dists[0]->batch_grad(N, nb, X, d, G);
+    std::vector<scalar_type> d2(nb), G2(N*nb);
+    for (size_type k = 1; k < dists.size(); ++k) {
+      dists[k]->batch_grad(N, nb, X, &d2[0], &G2[0]);
+      for (size_type i = 0; i < nb; ++i)
+        if (d2[i] > d[i]) {
+          d[i] = d2[i];
+          for (size_type l = 0; l < N; ++l) G[l*nb+i] = G2[l*nb+i];
+        }
+    }
+  }
+
+  void mesher_setminus::batch_eval(size_type N, size_type nb,
+                                   const scalar_type *X,
+                                   scalar_type *d) const {
+    std::vector<scalar_type> d2(nb);
+    a->batch_eval(N, nb, X, d);
+    b->batch_eval(N, nb, X, &d2[0]);
+    for (size_type i = 0; i < nb; ++i) d[i] = std::max(d[i], -d2[i]);
+  }
+
+  void mesher_setminus::batch_grad(size_type N, size_type nb,
+                                   const scalar_type *X, scalar_type *d,
+                                   scalar_type *G) const {
+    std::vector<scalar_type> d2(nb), G2(N*nb);
+    a->batch_grad(N, nb, X, d, G);
+    b->batch_grad(N, nb, X, &d2[0], &G2[0]);
+    for (size_type i = 0; i < nb; ++i)
+      if (!(d[i] > -d2[i])) {
+        d[i] = -d2[i];
+        for (size_type l = 0; l < N; ++l) G[l*nb+i] = -G2[l*nb+i];
+      }
+  }
+
+  void mesher_tube::batch_eval(size_type N, size_type nb,
+                               const scalar_type *X, scalar_type *d) const {
+    std::vector<scalar_type> G(N*nb);
+    batch_grad(N, nb, X, d, &G[0]);
+  }
+
+  void mesher_tube::batch_grad(size_type N, size_type nb,
+                               const scalar_type *X, scalar_type *d,
+                               scalar_type *G) const {
+    // G = (X - x0) - ((X - x0).n) n, then normalized
+    std::vector<scalar_type> s(nb, scalar_type(0));
+    for (size_type k = 0; k < N; ++k) {
+      const scalar_type *Xk = X + k*nb, xk = x0[k];
+      scalar_type *Gk = G + k*nb;
+      for (size_type i = 0; i < nb; ++i) {
+        Gk[i] = Xk[i] - xk;
+        s[i] += Gk[i] * n[k];
+      }
+    }
+    std::fill(d, d+nb, scalar_type(0));
+    for (size_type k = 0; k < N; ++k) {
+      scalar_type *Gk = G + k*nb, nk = n[k];
+      for (size_type i = 0; i < nb; ++i) {
+        Gk[i] += -s[i] * nk;
+        d[i] += gmm::sqr(Gk[i]);
+      }
+    }
+    std::vector<scalar_type> inv(nb);
+    for (size_type i = 0; i < nb; ++i)
+      { d[i] = gmm::sqrt(d[i]); inv[i] = scalar_type(1) / d[i]; }
+    for (size_type k = 0; k < N; ++k) {
+      scalar_type *Gk = G + k*nb;
+      for (size_type i = 0; i < nb; ++i) Gk[i] *= inv[i];
+    }
+    for (size_type i = 0; i < nb; ++i) {
+      if (d[i] == scalar_type(0)) grad_at_point(*this, N, nb, X, i, d, G);
+      else d[i] -= R;
+    }
+  }
+
+
   //
   // Exported functions
   //
@@ -255,6 +499,25 @@ namespace getfem {
   }
 
 
+  void signed_distance_of_points(const mesher_signed_distance &dist,
+                                 const std::vector<base_node> &pts,
+                                 std::vector<scalar_type> &d) {
+    const size_type block_size = 1024;
+    size_type nb = pts.size(), nbb = (nb + block_size - 1) / block_size;
+    d.resize(nb);
+    if (nb == 0) return;
+    size_type N = pts[0].size();
+    auto eval_block = [&](size_type b) {
+      size_type i0 = b * block_size, nbi = std::min(block_size, nb - i0);
+      std::vector<scalar_type> X(N*nbi);
+      for (size_type i = 0; i < nbi; ++i)
+        for (size_type k = 0; k < N; ++k) X[k*nbi+i] = pts[i0+i][k];
+      dist.batch_eval(N, nbi, &X[0], &d[i0]);
+    };
+    GETFEM_OMP_FOR(size_type b = 0, b < nbb, ++b, eval_block(b););
+  }
+
+
   //
   // local functions
   //
@@ -320,6 +583,12 @@ namespace getfem {
 
     gmm::dense_matrix<scalar_type> W;
     bgeot::mesh_structure edges_mesh;
+    // edges of each point, in compressed row format
+    std::vector<size_type> pts_edges_ptr, pts_edges;
+    // new index of each point after cleanup_points (size_type(-1) if removed)
+    std::vector<size_type> pts_new_index;
+    // sign of the orientation of the elements after the last triangulation
+    std::vector<int> t_orientation;
 
     std::vector<size_type> attracted_points;
     std::vector<base_node> attractor_points;
@@ -710,11 +979,20 @@ namespace getfem {
       pts_attr[ip] = get_attr(pts_attr[ip]->fixed, new_cts);
     }
 
+    void project_point(size_type ip, dal::bit_vector &new_cts) {
+      multi_constraint_projection(pts[ip], pts_attr[ip]->constraints);
+      new_cts.clear();
+      (*dist)(pts[ip], new_cts);
+    }
+
     void project_and_update_constraints(size_type ip) {
-      const dal::bit_vector& cts = pts_attr[ip]->constraints;
       dal::bit_vector new_cts;
-      multi_constraint_projection(pts[ip], cts);
-      (*dist)(pts[ip], new_cts);
+      project_point(ip, new_cts);
+      update_constraints(ip, new_cts);
+    }
+
+    void update_constraints(size_type ip, const dal::bit_vector &new_cts) {
+      const dal::bit_vector& cts = pts_attr[ip]->constraints;
       if (noisy > 1 && !new_cts.contains(cts)) {
         cout << "Point #" << ip << " has been downgraded from "
              << cts << " to " << new_cts << endl;
@@ -730,7 +1008,7 @@ namespace getfem {
       
     }
     
-    template <class VECT> void move_carefully(size_type ip, const VECT &VV) {
+    template <class VECT> void move_point(size_type ip, const VECT &VV) {
       base_node V(N); gmm::copy(VV, V);
 //       if (pts_attr[ip]->constraints.card() != 0) {
 //         base_small_vector grad;
@@ -743,9 +1021,11 @@ namespace getfem {
         gmm::add(V, pts[ip]);
       else
         gmm::add(gmm::scaled(V, h0 / (scalar_type(4) * norm)), pts[ip]);
-      project_and_update_constraints(ip);
     }
 
+    template <class VECT> void move_carefully(size_type ip, const VECT &VV)
+    { move_point(ip, VV); project_and_update_constraints(ip); }
+
      template <class VECT> void move_carefully(const VECT &V) {
        scalar_type norm_max(0), lambda(1);
        size_type npt = gmm::vect_size(V) / N;
@@ -755,9 +1035,16 @@ namespace getfem {
        if (norm_max > h0/scalar_type(3.7))
                 lambda = h0 / (scalar_type(3.7) * norm_max);
        
-       for (size_type i = 0; i < npt; ++i)
-                move_carefully(i, gmm::scaled(gmm::sub_vector
-                                       (V, gmm::sub_interval(i*N, N)),lambda));
+       // The points are moved and projected in parallel, the attributes
+       // are updated afterwards.
+       std::vector<dal::bit_vector> new_cts(npt);
+       auto move = [&](size_type i) {
+         move_point(i, gmm::scaled(gmm::sub_vector
+                                   (V, gmm::sub_interval(i*N, N)), lambda));
+         project_point(i, new_cts[i]);
+       };
+       GETFEM_OMP_FOR(size_type i = 0, i < npt, ++i, move(i););
+       for (size_type i = 0; i < npt; ++i) update_constraints(i, new_cts[i]);
      }
 
     void distribute_points_regularly(const std::vector<base_node>
@@ -923,9 +1210,11 @@ namespace getfem {
         }
       }
       pts_prev.resize(keep_pts.card());
+      pts_new_index.assign(pts.size(), size_type(-1));
       size_type cnt = 0;
       std::vector<const pt_attribute*> pts_attr2(keep_pts.card());
       for (dal::bv_visitor i(keep_pts); !i.finished(); ++i, ++cnt) {
+        pts_new_index[idx[i]] = cnt;
         pts_prev[cnt].swap(pts[idx[i]]);
         pts_attr2[cnt] = pts_attr[idx[i]];
       }
@@ -937,51 +1226,79 @@ namespace getfem {
     scalar_type worst_q;
     base_node worst_q_P;
 
-    void select_elements(int version) {
-      size_type nbpt = pts.size();
-
-      worst_q = 1.;
-      base_node weights(N+1);
-      for (size_type i=0; i < gmm::mat_ncols(t); )  {
+    /* Signed distance at the centers of the elements of t (not
+       significant for the elements having a vertex out of pts). */
+    void centers_distance(std::vector<scalar_type> &dG) {
+      size_type nbt = gmm::mat_ncols(t), nbpt = pts.size();
+      std::vector<base_node> centers(nbt, base_node(N));
+      for (size_type i = 0; i < nbt; ++i) {
         bool ext_simplex = false;
-        // bool boundary_simplex = true;
-        bool on_boundary_simplex = false;
-        bool is_bridge_simplex = false;
-        scalar_type q(0), dG(0);
-        base_node G;
-        
-        for (size_type k=0; k <= N; ++k)
+        for (size_type k = 0; k <= N; ++k)
           if (t(k, i) >= nbpt) ext_simplex = true;
+        if (ext_simplex) continue;
+        base_node &G = centers[i];
+        G = pts[t(0,i)];
+        for (size_type k=1; k <= N; ++k) G += pts[t(k,i)];
+        gmm::scale(G, scalar_type(1)/scalar_type(N+1));
+      }
+      signed_distance_of_points(*dist, centers, dG);
+    }
 
-        if (!ext_simplex) {
-          G = pts[t(0,i)];
-          for (size_type k=1; k <= N; ++k) G += pts[t(k,i)];
-          gmm::scale(G, scalar_type(1)/scalar_type(N+1));
-          dG = (*dist)(G);
-          gmm::clear(weights);
-          
-          q = quality_of_element(i);
-          
-          for (size_type k=0; k <= N; ++k) {
-            if (!(pts_attr[t(k,i)]->constraints.card() == 0))
-              on_boundary_simplex = true;
-            // else
-            //  boundary_simplex = false;
-          }
-          
-          if (version == 1 && on_boundary_simplex) 
-            for (size_type k=1; k < N+1; ++k) 
-              for (size_type l=0; l < k; ++l) {
-                dal::bit_vector all_cts = pts_attr[t(k,i)]->constraints
-                  | pts_attr[t(l,i)]->constraints;
-                if (/* gmm::vect_dist2(pts[t(k,i)], pts[t(l,i)]) > h0 && */
-                    !(pts_attr[t(k,i)]->constraints.contains(all_cts))
-                    && !(pts_attr[t(l,i)]->constraints.contains(all_cts))
-                    && (*dist)(0.5*(pts[t(k,i)] + pts[t(l,i)])) > 0.)
-                  is_bridge_simplex = true;
-              }
+    /* Return true if the element i of t is outside the domain, is a bridge
+       between two parts of the boundary or is flat. Its quality and its
+       center are returned in q and G. dG is the signed distance at its
+       center. */
+    bool element_to_be_deleted(size_type i, int version, scalar_type dG,
+                               scalar_type &q, base_node &G) {
+      size_type nbpt = pts.size();
+      bool ext_simplex = false;
+      // bool boundary_simplex = true;
+      bool on_boundary_simplex = false;
+      bool is_bridge_simplex = false;
+      q = scalar_type(0);
+      
+      for (size_type k=0; k <= N; ++k)
+        if (t(k, i) >= nbpt) ext_simplex = true;
+
+      if (!ext_simplex) {
+        G = pts[t(0,i)];
+        for (size_type k=1; k <= N; ++k) G += pts[t(k,i)];
+        gmm::scale(G, scalar_type(1)/scalar_type(N+1));
+        
+        q = quality_of_element(i);
+        
+        for (size_type k=0; k <= N; ++k) {
+          if (!(pts_attr[t(k,i)]->constraints.card() == 0))
+            on_boundary_simplex = true;
+          // else
+          //  boundary_simplex = false;
         }
-        if (ext_simplex || dG > 0 || is_bridge_simplex || q < 1e-14) {
+        
+        if (version == 1 && on_boundary_simplex) 
+          for (size_type k=1; k < N+1; ++k) 
+            for (size_type l=0; l < k; ++l) {
+              dal::bit_vector all_cts = pts_attr[t(k,i)]->constraints
+                | pts_attr[t(l,i)]->constraints;
+              if (/* gmm::vect_dist2(pts[t(k,i)], pts[t(l,i)]) > h0 && */
+                  !(pts_attr[t(k,i)]->constraints.contains(all_cts))
+                  && !(pts_attr[t(l,i)]->constraints.contains(all_cts))
+                  && (*dist)(0.5*(pts[t(k,i)] + pts[t(l,i)])) > 0.)
+                is_bridge_simplex = true;
+            }
+      }
+      return (ext_simplex || dG > 0 || is_bridge_simplex || q < 1e-14);
+    }
+
+    void select_elements(int version) {
+      worst_q = 1.;
+      scalar_type q;
+      base_node G;
+      std::vector<scalar_type> dG;
+      centers_distance(dG);
+      // The deleted elements are replaced by the last ones
+      for (size_type i=0; i < gmm::mat_ncols(t); )  {
+        if (element_to_be_deleted(i, version, dG[i], q, G)) {
+          dG[i] = dG[gmm::mat_ncols(t)-1];
           delete_element(i);
         } else {
           ++i;
@@ -1166,6 +1483,195 @@ namespace getfem {
     }
 
 
+    void build_edges(void) {
+      edges_mesh.clear();
+      for (size_type i=0; i < gmm::mat_ncols(t); ++i)
+        for (size_type j=0; j < N+1; ++j)
+          for (size_type k=j+1; k < N+1; ++k)
+            edges_mesh.add_segment(t(j,i), t(k,i));
+      // The edges are numbered contiguously since edges_mesh is cleared
+      size_type nbe = edges_mesh.nb_convex();
+      pts_edges_ptr.assign(pts.size()+1, 0);
+      for (size_type ie = 0; ie < nbe; ++ie)
+        for (size_type ip : edges_mesh.ind_points_of_convex(ie))
+          pts_edges_ptr[ip+1]++;
+      for (size_type ip = 0; ip < pts.size(); ++ip)
+        pts_edges_ptr[ip+1] += pts_edges_ptr[ip];
+      pts_edges.resize(pts_edges_ptr.back());
+      std::vector<size_type> pos(pts_edges_ptr.begin(), pts_edges_ptr.end()-1);
+      for (size_type ie = 0; ie < nbe; ++ie)
+        for (size_type ip : edges_mesh.ind_points_of_convex(ie))
+          pts_edges[pos[ip]++] = ie;
+    }
+
+    /* Determinant of the edge vectors of the element i, whose sign gives
+       its orientation. The circumcenter of the element is computed in C
+       if it is not degenerated. */
+    scalar_type element_orientation(size_type i, base_node &C) {
+      base_matrix E(N, N), F(N, N);
+      base_vector b(N), c(N);
+      const base_node &P0 = pts[t(0,i)];
+      scalar_type scale(1);
+      for (size_type k = 0; k < N; ++k) {
+        const base_node &P = pts[t(k+1,i)];
+        for (size_type l = 0; l < N; ++l) E(k, l) = P[l] - P0[l];
+        b[k] = gmm::vect_dist2_sqr(P, P0) / scalar_type(2);
+        scale *= gmm::sqrt(b[k] * scalar_type(2));
+      }
+      gmm::copy(E, F);
+      scalar_type det = gmm::lu_det(F);
+      if (gmm::abs(det) <= 1e-12 * scale) return scalar_type(0);
+      gmm::lu_solve(E, c, b);
+      C = P0; gmm::add(c, C);
+      return det;
+    }
+
+    /* Neighbor of the element i opposite to its local vertex k, for each
+       element and each vertex (size_type(-1) on the boundary). */
+    void elements_neighbors(std::vector<size_type> &nbs) {
+      size_type nbt = gmm::mat_ncols(t);
+      bgeot::mesh_structure ms;
+      bgeot::pconvex_structure cs = bgeot::simplex_structure(dim_type(N));
+      for (size_type i = 0; i < nbt; ++i)
+        ms.add_convex_noverif(cs, t.begin() + i*(N+1), i);
+      nbs.assign(nbt*(N+1), size_type(-1));
+      auto neighbors = [&](size_type i) {
+        for (short_type f = 0; f <= N; ++f) {
+          size_type j = ms.neighbor_of_convex(i, f);
+          if (j != size_type(-1))
+            for (size_type k = 0; k <= N; ++k)
+              if (std::find(t.begin() + j*(N+1), t.begin() + (j+1)*(N+1),
+                            t(k, i)) == t.begin() + (j+1)*(N+1))
+                nbs[i*(N+1)+k] = j;
+        }
+      };
+      GETFEM_OMP_FOR(size_type i = 0, i < nbt, ++i, neighbors(i););
+    }
+
+    size_type opposite_vertex(size_type i, size_type j) {
+      for (size_type k = 0; k <= N; ++k)
+        if (std::find(t.begin() + i*(N+1), t.begin() + (i+1)*(N+1), t(k, j))
+            == t.begin() + (i+1)*(N+1)) return k;
+      return size_type(-1);
+    }
+
+    /* Return true if no vertex of the neighbors of the element i lies in
+       its circumsphere. */
+    bool is_locally_delaunay(size_type i, const std::vector<size_type> &nbs) {
+      base_node C;
+      if (element_orientation(i, C) == scalar_type(0)) return false;
+      scalar_type R2 = gmm::vect_dist2_sqr(C, pts[t(0,i)]);
+      for (size_type k = 0; k <= N; ++k) {
+        size_type j = nbs[i*(N+1)+k];
+        if (j == size_type(-1)) continue;
+        size_type l = opposite_vertex(i, j);
+        if (gmm::vect_dist2_sqr(pts[t(l, j)], C) < R2 * (1. - 1E-10))
+          return false;
+      }
+      return true;
+    }
+
+    /* Lawson flips on a triangulation of dimension 2, starting with the
+       elements marked in to_check. The edges shared by two triangles
+       which do not satisfy the empty circumcircle property are flipped
+       until the triangulation is a Delaunay one. Return false if a flip
+       would produce an inverted triangle. The flipped elements are marked
+       in to_check. */
+    bool delaunay_flips(std::vector<size_type> &nbs,
+                        std::vector<int> &to_check) {
+      size_type nbt = gmm::mat_ncols(t), nb_flips = 0;
+      std::vector<size_type> stack;
+      for (size_type i = 0; i < nbt; ++i) if (to_check[i]) stack.push_back(i);
+      auto replace_neighbor = [&](size_type k, size_type old, size_type nw)
+        { if (k != size_type(-1))
+            for (size_type l = 0; l < 3; ++l)
+              if (nbs[k*3+l] == old) { nbs[k*3+l] = nw; return; } };
+      while (!stack.empty()) {
+        size_type i = stack.back(); stack.pop_back();
+        if (is_locally_delaunay(i, nbs)) continue;
+        base_node C;
+        element_orientation(i, C);
+        scalar_type R2 = gmm::vect_dist2_sqr(C, pts[t(0,i)]);
+        for (size_type f = 0; f < 3; ++f) {
+          size_type j = nbs[i*3+f];
+          if (j == size_type(-1)) continue;
+          size_type g = opposite_vertex(i, j);
+          if (gmm::vect_dist2_sqr(pts[t(g, j)], C) >= R2 * (1. - 1E-10))
+            continue;
+          // i = (a, b, c) and j = (b, a, d) become (a, d, c) and (d, b, c)
+          size_type ia = (f+1)%3, ib = (f+2)%3;
+          size_type a = t(ia,i), b = t(ib,i), c = t(f,i), d = t(g,j);
+          size_type ja = 0, jb = 0;
+          for (size_type l = 0; l < 3; ++l) {
+            if (t(l,j) == a) ja = l;
+            if (t(l,j) == b) jb = l;
+          }
+          size_type nb_bc = nbs[i*3+ia], nb_ca = nbs[i*3+ib];
+          size_type nb_bd = nbs[j*3+ja], nb_ad = nbs[j*3+jb];
+          scalar_type o = scalar_type(t_orientation[i]);
+          t(0,i) = a; t(1,i) = d; t(2,i) = c;
+          t(0,j) = d; t(1,j) = b; t(2,j) = c;
+          if (element_orientation(i, C) * o <= scalar_type(0)
+              || element_orientation(j, C) * o <= scalar_type(0)
+              || ++nb_flips > 10*nbt + 100)
+            return false;
+          t_orientation[j] = t_orientation[i];
+          nbs[i*3+0] = j;     nbs[i*3+1] = nb_ca; nbs[i*3+2] = nb_ad;
+          nbs[j*3+0] = nb_bc; nbs[j*3+1] = i;     nbs[j*3+2] = nb_bd;
+          replace_neighbor(nb_ad, j, i);
+          replace_neighbor(nb_bc, i, j);
+          to_check[i] = to_check[j] = 1;
+          stack.push_back(i); stack.push_back(j);
+          break;
+        }
+      }
+      return true;
+    }
+
+    /* After a small displacement of the points, the current triangulation
+       is kept if all the elements keep their orientation and are still
+       selected and if the faces shared by two elements still satisfy the
+       empty circumsphere property, in which case it is still a Delaunay
+       triangulation. In dimension 2, the faulty edges are repaired by
+       local flips. Some elements could be missing at the boundary, but a
+       complete triangulation is periodically done anyway. The point
+       renumbering done by cleanup_points is applied to t before. */
+    bool keep_triangulation(void) {
+      size_type nbt = gmm::mat_ncols(t);
+      if (nbt == 0 || t_orientation.size() != nbt) return false;
+      for (size_type i = 0; i < nbt; ++i)
+        for (size_type k = 0; k <= N; ++k) t(k, i) = pts_new_index[t(k, i)];
+
+      std::vector<size_type> nbs;
+      elements_neighbors(nbs);
+      std::vector<scalar_type> dG;
+      centers_distance(dG);
+      std::vector<int> valid(nbt, 1), to_check(nbt, 0);
+      auto check = [&](size_type i) {
+        base_node C, G;
+        scalar_type q, det = element_orientation(i, C);
+        if (det * scalar_type(t_orientation[i]) <= scalar_type(0)
+            || element_to_be_deleted(i, 1, dG[i], q, G))
+          valid[i] = 0;
+        else if (!is_locally_delaunay(i, nbs))
+          to_check[i] = 1;
+      };
+      GETFEM_OMP_FOR(size_type i = 0, i < nbt, ++i, check(i););
+      if (std::find(valid.begin(), valid.end(), 0) != valid.end())
+        return false;
+      if (std::find(to_check.begin(), to_check.end(), 1) != to_check.end()) {
+        if (N != 2 || !delaunay_flips(nbs, to_check)) return false;
+        base_node G;
+        scalar_type q;
+        centers_distance(dG);
+        for (size_type i = 0; i < nbt; ++i)
+          if (to_check[i] && element_to_be_deleted(i, 1, dG[i], q, G))
+            return false;
+      }
+      build_edges();
+      return true;
+    }
+
     void running_delaunay(bool mct) {
       if (noisy > 0)
         cout << "NEW DELAUNAY, running on " << pts.size() << " points\n";
@@ -1177,42 +1683,45 @@ namespace getfem {
                           << gmm::mat_ncols(t) << "\n";
       if (mct) {
         select_elements(0);
-        edges_mesh.clear();
-        for (size_type i=0; i < gmm::mat_ncols(t); ++i)
-          for (size_type j=0; j < N+1; ++j)
-            for (size_type k=j+1; k < N+1; ++k)
-              edges_mesh.add_segment(t(j,i), t(k,i));
+        build_edges();
         special_constraints_management();
       }
       select_elements(1);
       if (noisy > 0) cout << "number of elements after selection = "
                           << gmm::mat_ncols(t) << "\n";
-      edges_mesh.clear();
-      for (size_type i=0; i < gmm::mat_ncols(t); ++i)
-        for (size_type j=0; j < N+1; ++j)
-          for (size_type k=j+1; k < N+1; ++k)
-            edges_mesh.add_segment(t(j,i), t(k,i));
+      build_edges();
+      size_type nbt = gmm::mat_ncols(t);
+      t_orientation.resize(nbt);
+      auto orientation = [&](size_type i) {
+        base_node C;
+        scalar_type det = element_orientation(i, C);
+        t_orientation[i] = (det > 0) ? 1 : ((det < 0) ? -1 : 0);
+      };
+      GETFEM_OMP_FOR(size_type i = 0, i < nbt, ++i, orientation(i););
     }
 
+    /* The force on each point is accumulated from its edges, which gives
+       the same result as the accumulation edge by edge. */
     void standard_move_strategy(base_vector &X) {
-      for (dal::bv_visitor ie(edges_mesh.convex_index());
-           !ie.finished(); ++ie) {
-        size_type iA = edges_mesh.ind_points_of_convex(ie)[0];
-        size_type iB = edges_mesh.ind_points_of_convex(ie)[1];
-        base_node bar = pts[iB]-pts[iA];
-        scalar_type F = std::max(L0[ie]-L[ie], 0.);
-        
-        if (F) {
-          base_node Fbar = (bar)*(F/L[ie]);
-          
-          if (!pts_attr[iA]->fixed) // pts[iA] -= deltat*Fbar; 
-            gmm::add(gmm::scaled(Fbar, -deltat),
-                     gmm::sub_vector(X, gmm::sub_interval(iA*N, N)));
-          if (!pts_attr[iB]->fixed) // pts[iB] += deltat*Fbar;
-            gmm::add(gmm::scaled(Fbar, deltat),
-                     gmm::sub_vector(X, gmm::sub_interval(iB*N, N)));
+      size_type npt = pts.size();
+      GMM_ASSERT1(pts_edges_ptr.size() == npt+1, "Internal error");
+      auto move = [&](size_type ip) {
+        if (pts_attr[ip]->fixed) return;
+        for (size_type k = pts_edges_ptr[ip]; k < pts_edges_ptr[ip+1]; ++k) {
+          size_type ie = pts_edges[k];
+          size_type iA = edges_mesh.ind_points_of_convex(ie)[0];
+          size_type iB = edges_mesh.ind_points_of_convex(ie)[1];
+          scalar_type F = std::max(L0[ie]-L[ie], 0.);
+
+          if (F) {
+            base_node Fbar = (pts[iB]-pts[iA])*(F/L[ie]);
+            // pts[iA] -= deltat*Fbar; pts[iB] += deltat*Fbar;
+            gmm::add(gmm::scaled(Fbar, (ip == iA) ? -deltat : deltat),
+                     gmm::sub_vector(X, gmm::sub_interval(ip*N, N)));
+          }
         }
-      }
+      };
+      GETFEM_OMP_FOR(size_type ip = 0, ip < npt, ++ip, move(ip););
     }
 
     void do_build_mesh(mesh &m,
@@ -1244,7 +1753,11 @@ namespace getfem {
             mct = true;
             count_ct = 0;
           }
-          running_delaunay(mct);
+          if (count == 0 || mct || nbpt != pts.size()
+              || !keep_triangulation())
+            running_delaunay(mct);
+          else if (noisy > 0)
+            cout << "Delaunay triangulation kept\n";
           pt_changed = nbpt != pts.size();
           count_id = 0;
         }
@@ -1256,13 +1769,15 @@ namespace getfem {
         GMM_ASSERT1(nbcv != 0, "no more edges!");
         L.resize(nbcv); L0.resize(nbcv);
         scalar_type sL = 0, sL0 = 0;
-        for (dal::bv_visitor ie(edges_mesh.convex_index());
-             !ie.finished(); ++ie) {
+        auto edge_lengths = [&](size_type ie) {
           const base_node &A = pts[edges_mesh.ind_points_of_convex(ie)[0]];
           const base_node &B = pts[edges_mesh.ind_points_of_convex(ie)[1]];
           base_node C(A); C+=B; C /= scalar_type(2);
           L[ie] = gmm::vect_dist2(A, B);
           L0[ie] = edge_len(C);
+        };
+        GETFEM_OMP_FOR(size_type ie = 0, ie < nbcv, ++ie, edge_lengths(ie););
+        for (size_type ie = 0; ie < nbcv; ++ie) {
           sL += pow(L[ie],scalar_type(N));
           sL0 += pow(L0[ie],scalar_type(N));
         }
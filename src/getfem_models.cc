@@ -1996,6 +1996,184 @@ namespace getfem {
       }
   }
 
+  /* Sections of a model checkpoint:
+     CKP        : format version, complex version, time integration, init
+                  step
+     CKP_DT     : time step and time step for the initialization
+     CKP_VARS   : names of the variables and data
+     CKP_VDESC  : for the variable i (id i), its number of versions, its
+                  size, the kind of layout (0 : none, 1 : mesh_fem,
+                  2 : im_data) and a checksum of the layout
+     CKP_SUM    : checksums of the versions of the variable i (id i)
+     CKP_V<j>   : version j of the variable i (id i)
+  */
+  enum { CKP_NO_LAYOUT, CKP_MESH_FEM, CKP_IM_DATA };
+
+  static void checkpoint_layout(const mesh_fem *mf, const im_data *imd,
+                                gmm::uint64_type &kind,
+                                gmm::uint64_type &sum) {
+    std::vector<gmm::uint64_type> l;
+    if (mf) {
+      kind = CKP_MESH_FEM;
+      l.push_back(mf->nb_basic_dof());
+      for (dal::bv_visitor cv(mf->convex_index()); !cv.finished(); ++cv) {
+        l.push_back(cv);
+        for (size_type d : mf->ind_basic_dof_of_element(cv)) l.push_back(d);
+      }
+    } else if (imd) {
+      kind = CKP_IM_DATA;
+      l = { imd->nb_filtered_index(), imd->nb_tensor_elem(),
+            imd->filtered_region() };
+    } else
+      kind = CKP_NO_LAYOUT;
+    sum = bgeot::binary_checksum(l.data(), l.size()*sizeof(gmm::uint64_type));
+  }
+
+  static std::string checkpoint_tag(size_type j) {
+    std::stringstream tag;
+    tag << "CKP_V" << j;
+    return tag.str();
+  }
+
+  void model::write_checkpoint(bgeot::binary_file_writer &f) const {
+    context_check(); if (act_size_to_be_done) actualize_sizes();
+    std::vector<gmm::uint64_type> hdr = { 1, complex_version,
+                                          gmm::uint64_type(time_integration),
+                                          init_step };
+    f.write_section("CKP", 0, hdr);
+    std::vector<scalar_type> dt = { time_step, init_time_step };
+    f.write_section("CKP_DT", 0, dt);
+
+    std::vector<std::string> names;
+    for (const auto &v : variables)
+      if (!v.second.is_affine_dependent) names.push_back(v.first);
+    f.write_string_section("CKP_VARS", 0, names);
+    for (size_type i = 0; i < names.size(); ++i) {
+      const var_description &vd = variables.find(names[i])->second;
+      std::vector<gmm::uint64_type> desc(4), sums(vd.n_iter);
+      desc[0] = vd.n_iter; desc[1] = vd.size();
+      checkpoint_layout(vd.mf, vd.imd, desc[2], desc[3]);
+      for (size_type j = 0; j < vd.n_iter; ++j) {
+        if (complex_version) {
+          const model_complex_plain_vector &V = vd.complex_value[j];
+          sums[j] = bgeot::binary_checksum(V.data(),
+                                           V.size()*sizeof(complex_type));
+          f.write_section(checkpoint_tag(j), i, V);
+        } else {
+          const model_real_plain_vector &V = vd.real_value[j];
+          sums[j] = bgeot::binary_checksum(V.data(),
+                                           V.size()*sizeof(scalar_type));
+          f.write_section(checkpoint_tag(j), i, V);
+        }
+      }
+      f.write_section("CKP_VDESC", i, desc);
+      f.write_section("CKP_SUM", i, sums);
+    }
+  }
+
+  void model::write_checkpoint(const std::string &name) const {
+    bgeot::binary_file_writer f(name);
+    write_checkpoint(f);
+    f.close();
+  }
+
+  template <typename T> static bgeot::binary_section<T>
+  checked_checkpoint_vector(const bgeot::binary_file_reader &f, size_type i,
+                            size_type j, gmm::uint64_type sum,
+                            const std::string &name, size_type size) {
+    bgeot::binary_section<T> p = f.section<T>(checkpoint_tag(j), i);
+    GMM_ASSERT1(p.size() == size, "Wrong size of variable " << name
+                << " in checkpoint file " << f.name());
+    GMM_ASSERT1(bgeot::binary_checksum(p.data(), size*sizeof(T)) == sum,
+                "Wrong checksum of variable " << name << " in checkpoint "
+                "file " << f.name() << ", the file is corrupted");
+    return p;
+  }
+
+  void model::read_checkpoint(const bgeot::binary_file_reader &f) {
+    context_check(); if (act_size_to_be_done) actualize_sizes();
+    bgeot::binary_section<gmm::uint64_type>
+      hdr = f.section<gmm::uint64_type>("CKP", 0);
+    GMM_ASSERT1(hdr.size() >= 4 && hdr[0] == 1, "File " << f.name()
+                << " is not a model checkpoint or its version is not "
+                "supported");
+    GMM_ASSERT1(bool(hdr[1]) == complex_version, "The checkpoint has not "
+                "been written by a " << (complex_version ? "complex" : "real")
+                << " model");
+    bgeot::binary_section<scalar_type>
+      dt = f.section<scalar_type>("CKP_DT", 0);
+    GMM_ASSERT1(dt.size() == 2, "Corrupted checkpoint file " << f.name());
+
+    // All the sections are checked before any variable is modified, so
+    // that the model is left untouched if the file is not valid.
+    std::vector<std::string> names;
+    f.read_string_section("CKP_VARS", 0, names);
+    std::set<std::string> found;
+    std::vector<var_description *> vars;
+    std::vector<bgeot::binary_section<scalar_type>> rversions;
+    std::vector<bgeot::binary_section<complex_type>> cversions;
+    for (size_type i = 0; i < names.size(); ++i) {
+      auto it = variables.find(names[i]);
+      if (it == variables.end()) {
+        GMM_WARNING2("Variable " << names[i] << " of the checkpoint file "
+                     << f.name() << " does not exist in the model");
+        continue;
+      }
+      var_description &vd = it->second;
+      GMM_ASSERT1(!vd.is_affine_dependent, "Variable " << names[i]
+                  << " is affine dependent in the model");
+      found.insert(names[i]);
+      std::vector<gmm::uint64_type> desc, sums;
+      f.read_section("CKP_VDESC", i, desc);
+      f.read_section("CKP_SUM", i, sums);
+      GMM_ASSERT1(desc.size() == 4 && sums.size() == desc[0],
+                  "Corrupted checkpoint file " << f.name());
+      GMM_ASSERT1(desc[0] == vd.n_iter && desc[1] == vd.size(), "Variable "
+                  << names[i] << " has not the same number of versions or "
+                  "the same size in the model and in the checkpoint file");
+      gmm::uint64_type kind, sum;
+      checkpoint_layout(vd.mf, vd.imd, kind, sum);
+      GMM_ASSERT1(desc[2] == kind && desc[3] == sum, "The mesh_fem or "
+                  "im_data of variable " << names[i] << " is not the same "
+                  "in the model and in the checkpoint file");
+      vars.push_back(&vd);
+      for (size_type j = 0; j < vd.n_iter; ++j) {
+        if (complex_version)
+          cversions.push_back(checked_checkpoint_vector<complex_type>
+                              (f, i, j, sums[j], names[i], vd.size()));
+        else
+          rversions.push_back(checked_checkpoint_vector<scalar_type>
+                              (f, i, j, sums[j], names[i], vd.size()));
+      }
+    }
+    for (const auto &v : variables)
+      if (!v.second.is_affine_dependent && !found.count(v.first))
+        GMM_WARNING2("Variable " << v.first << " is not in the checkpoint "
+                     "file " << f.name());
+
+    size_type k = 0;
+    for (var_description *pvd : vars) {
+      var_description &vd = *pvd;
+      for (size_type j = 0; j < vd.n_iter; ++j, ++k) {
+        if (complex_version)
+          std::copy(cversions[k].begin(), cversions[k].end(),
+                    vd.complex_value[j].begin());
+        else
+          std::copy(rversions[k].begin(), rversions[k].end(),
+                    vd.real_value[j].begin());
+        vd.v_num_data[j] = act_counter();
+      }
+    }
+    time_integration = int(hdr[2]);
+    init_step = bool(hdr[3]);
+    time_step = dt[0]; init_time_step = dt[1];
+  }
+
+  void model::read_checkpoint(const std::string &name) {
+    bgeot::binary_file_reader f(name);
+    read_checkpoint(f);
+  }
+
   bool model::is_var_newer_than_brick(const std::string &varname,
                                       size_type ib, size_type niter) const {
     const brick_description &brick = bricks[ib];
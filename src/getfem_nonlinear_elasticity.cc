@@ -2019,6 +2019,265 @@ namespace getfem {
   };
 
 
+  // First Piola-Kirchhoff stress tensor P = (Id+Grad_u)*S in closed form,
+  // with its derivative with respect to Grad_u, for the laws whose strain
+  // energy is a function W(I1, I2, I3) of the invariants of C = F'F,
+  // F = Id+Grad_u. With Wk = dW/dIk, the second Piola-Kirchhoff stress is
+  // S = 2(W1 Id + W2 (I1 Id - C) + W3 I3 C^{-1}), so that
+  //   P = b0 F + b1 F C + b2 F^{-T},
+  // with b0 = 2(W1 + I1 W2), b1 = -2 W2, b2 = 2 I3 W3. The derivative is
+  // obtained from dI1 = 2F:dF, dI2 = 2(I1 F - F C):dF, dI3 = 2 I3 F^{-T}:dF
+  // and the second derivatives Wkm of W. Everything is computed on small
+  // arrays on the stack. For the Plane_Strain_ versions, the computation
+  // is done in 3D with F33 = 1. Otherwise, in 2D, the invariants are the
+  // ones of the 2x2 matrix C, as in the corresponding
+  // abstract_hyperelastic_law, which is only possible for the laws
+  // defined in 2D.
+  //
+  // A law is described by a struct giving its number of parameters, if
+  // S is penalized by 1e200 C for a non positive det(F) (as in the
+  // corresponding abstract_hyperelastic_law), if it is defined in 2D, and
+  // the non zero derivatives of W in dimension n (the others are
+  // initialized to zero).
+
+  struct SVK_invariants { // lambda, mu
+    static const size_type nb_params = 2;
+    static const bool penalized = false;
+    static const bool defined_in_2D = true;
+    static void derivatives(const base_tensor &p, size_type n,
+                            scalar_type I1, scalar_type, scalar_type,
+                            scalar_type W[3], scalar_type WW[3][3]) {
+      scalar_type lambda = p[0], mu = p[1];
+      W[0] = lambda*(I1-scalar_type(n))/scalar_type(4)
+        + mu*(I1-scalar_type(1))/scalar_type(2);
+      W[1] = -mu/scalar_type(2);
+      WW[0][0] = lambda/scalar_type(4) + mu/scalar_type(2);
+    }
+  };
+
+  struct Ciarlet_Geymonat_invariants { // lambda, mu, a
+    static const size_type nb_params = 3;
+    static const bool penalized = true;
+    static const bool defined_in_2D = true;
+    static void derivatives(const base_tensor &p, size_type,
+                            scalar_type, scalar_type, scalar_type I3,
+                            scalar_type W[3], scalar_type WW[3][3]) {
+      scalar_type a = p[2], b = p[1]/scalar_type(2) - p[2];
+      scalar_type c = p[0]/scalar_type(4) - p[1]/scalar_type(2) + p[2];
+      scalar_type d = p[0]/scalar_type(2) + p[1];
+      W[0] = a; W[1] = b; W[2] = c - d/(scalar_type(2)*I3);
+      WW[2][2] = d/(scalar_type(2)*I3*I3);
+    }
+  };
+
+  // c1 (j1 - 3) + c2 (j2 - 3) + d1 (sqrt(I3) - 1)^2, with j1 = I1 I3^{-1/3}
+  // and j2 = I2 I3^{-2/3}.
+  template <bool COMPRESSIBLE, bool NEOHOOKEAN>
+  struct Mooney_Rivlin_invariants { // c1, [c2], [d1]
+    static const size_type nb_params = 2 + (COMPRESSIBLE ? 1:0)
+                                         - (NEOHOOKEAN ? 1:0);
+    static const bool penalized = COMPRESSIBLE;
+    static const bool defined_in_2D = false;
+    static void derivatives(const base_tensor &p, size_type,
+                            scalar_type I1, scalar_type I2, scalar_type I3,
+                            scalar_type W[3], scalar_type WW[3][3]) {
+      scalar_type c1 = p[0], c2 = NEOHOOKEAN ? scalar_type(0) : p[1];
+      scalar_type i3 = gmm::abs(I3);
+      scalar_type i3m13 = pow(i3, -scalar_type(1)/scalar_type(3));
+      scalar_type i3m23 = i3m13*i3m13, i3m1 = scalar_type(1)/i3;
+      W[0] = c1*i3m13;
+      W[1] = c2*i3m23;
+      W[2] = -(c1*I1*i3m13 + scalar_type(2)*c2*I2*i3m23)*i3m1/scalar_type(3);
+      WW[0][2] = WW[2][0] = -c1*i3m13*i3m1/scalar_type(3);
+      WW[1][2] = WW[2][1] = -scalar_type(2)*c2*i3m23*i3m1/scalar_type(3);
+      WW[2][2] = (scalar_type(4)*c1*I1*i3m13 + scalar_type(10)*c2*I2*i3m23)
+        * i3m1*i3m1/scalar_type(9);
+      if (COMPRESSIBLE) {
+        scalar_type d1 = p[nb_params-1], sqi3 = sqrt(i3);
+        W[2] += d1 - d1/sqi3;
+        WW[2][2] += d1/(scalar_type(2)*i3*sqi3);
+      }
+    }
+  };
+
+  // Bonet:   mu/2 (I1 - 3 - log(I3)) + lambda/8 log(I3)^2
+  // Ciarlet: mu/2 (I1 - 3 - log(I3)) + lambda/4 (I3 - 1 - log(I3))
+  template <bool BONET>
+  struct Neo_Hookean_invariants { // lambda, mu
+    static const size_type nb_params = 2;
+    static const bool penalized = true;
+    static const bool defined_in_2D = false;
+    static void derivatives(const base_tensor &p, size_type,
+                            scalar_type, scalar_type, scalar_type I3,
+                            scalar_type W[3], scalar_type WW[3][3]) {
+      scalar_type lambda = p[0], mu = p[1], i3m2 = scalar_type(1)/(I3*I3);
+      W[0] = mu/scalar_type(2);
+      W[2] = -mu/(scalar_type(2)*I3);
+      WW[2][2] = mu*i3m2/scalar_type(2);
+      if (BONET) {
+        scalar_type logi3 = log(I3);
+        W[2] += lambda*logi3/(scalar_type(4)*I3);
+        WW[2][2] += lambda*(scalar_type(1)-logi3)*i3m2/scalar_type(4);
+      } else {
+        W[2] += lambda*(scalar_type(1)-scalar_type(1)/I3)/scalar_type(4);
+        WW[2][2] += lambda*i3m2/scalar_type(4);
+      }
+    }
+  };
+
+  // F is stored in 3D, with F33 = 1 in 2D. The invariants are the ones of
+  // the n x n upper left block of C (n = 3 for the plane strain
+  // versions). The other quantities do not depend on n.
+  struct hyperelastic_PK1_kinematics {
+    size_type N, n;
+    scalar_type F[3][3], C[3][3], FC[3][3], G[3][3]; // G = F^{-T}
+    scalar_type I1, I2, I3, J;
+
+    hyperelastic_PK1_kinematics(const base_tensor &Gu, bool plane_strain) {
+      N = Gu.sizes()[0];
+      n = plane_strain ? 3 : N;
+      for (size_type i = 0; i < 3; ++i)
+        for (size_type j = 0; j < 3; ++j)
+          F[i][j] = (i == j) ? scalar_type(1) : scalar_type(0);
+      for (size_type j = 0; j < N; ++j)
+        for (size_type i = 0; i < N; ++i) F[i][j] += Gu[i+N*j];
+      I1 = I2 = scalar_type(0);
+      for (size_type i = 0; i < 3; ++i)
+        for (size_type j = 0; j < 3; ++j) {
+          C[i][j] = F[0][i]*F[0][j] + F[1][i]*F[1][j] + F[2][i]*F[2][j];
+          if (i < n && j < n) I2 -= C[i][j]*C[i][j];
+        }
+      for (size_type i = 0; i < 3; ++i)
+        for (size_type j = 0; j < 3; ++j)
+          FC[i][j] = F[i][0]*C[0][j] + F[i][1]*C[1][j] + F[i][2]*C[2][j];
+      for (size_type i = 0; i < n; ++i) I1 += C[i][i];
+      I2 = (I2 + I1*I1) / scalar_type(2);
+      // Cofactor matrix of F
+      G[0][0] = F[1][1]*F[2][2] - F[1][2]*F[2][1];
+      G[0][1] = F[1][2]*F[2][0] - F[1][0]*F[2][2];
+      G[0][2] = F[1][0]*F[2][1] - F[1][1]*F[2][0];
+      G[1][0] = F[0][2]*F[2][1] - F[0][1]*F[2][2];
+      G[1][1] = F[0][0]*F[2][2] - F[0][2]*F[2][0];
+      G[1][2] = F[0][1]*F[2][0] - F[0][0]*F[2][1];
+      G[2][0] = F[0][1]*F[1][2] - F[0][2]*F[1][1];
+      G[2][1] = F[0][2]*F[1][0] - F[0][0]*F[1][2];
+      G[2][2] = F[0][0]*F[1][1] - F[0][1]*F[1][0];
+      J = F[0][0]*G[0][0] + F[0][1]*G[0][1] + F[0][2]*G[0][2];
+      I3 = J*J;
+      for (size_type i = 0; i < 3; ++i)
+        for (size_type j = 0; j < 3; ++j) G[i][j] /= J;
+    }
+  };
+
+  template <class LAW, bool PLANE_STRAIN>
+  struct hyperelastic_PK1_operator : public ga_nonlinear_operator {
+    bool result_size(const arg_list &args, bgeot::multi_index &sizes) const {
+      if (args.size() != 2 || args[0]->sizes().size() != 2
+          || args[1]->size() != LAW::nb_params
+          || args[0]->sizes()[0] != args[0]->sizes()[1])
+        return false;
+      size_type N = args[0]->sizes()[0];
+      if (N < 2 || N > 3 || (N == 2 && !PLANE_STRAIN && !LAW::defined_in_2D))
+        return false;
+      ga_init_square_matrix_(sizes, args[0]->sizes()[0]);
+      return true;
+    }
+
+    static void coefficients(const hyperelastic_PK1_kinematics &K,
+                             const base_tensor &params,
+                             scalar_type W[3], scalar_type WW[3][3],
+                             scalar_type b[3]) {
+      for (size_type i = 0; i < 3; ++i) {
+        W[i] = scalar_type(0);
+        for (size_type j = 0; j < 3; ++j) WW[i][j] = scalar_type(0);
+      }
+      LAW::derivatives(params, K.n, K.I1, K.I2, K.I3, W, WW);
+      b[0] = scalar_type(2)*(W[0] + K.I1*W[1]);
+      b[1] = -scalar_type(2)*W[1];
+      b[2] = scalar_type(2)*K.I3*W[2];
+    }
+
+    // Value : P = b0 F + b1 F C + b2 F^{-T}
+    void value(const arg_list &args, base_tensor &result) const {
+      hyperelastic_PK1_kinematics K(*(args[0]), PLANE_STRAIN);
+      scalar_type W[3], WW[3][3], b[3];
+      coefficients(K, *(args[1]), W, WW, b);
+      if (LAW::penalized && K.J <= scalar_type(0)) b[1] += 1e200;
+      size_type N = K.N;
+      base_tensor::iterator it = result.begin();
+      for (size_type j = 0; j < N; ++j)
+        for (size_type i = 0; i < N; ++i, ++it)
+          *it = b[0]*K.F[i][j] + b[1]*K.FC[i][j] + b[2]*K.G[i][j];
+    }
+
+    // Derivative / Grad_u :
+    //   A{ijkl} = b0 delta{ik}delta{jl} - b2 G{il}G{kj}
+    //      + b1 (delta{ik}C{lj} + F{il}F{kj} + (FF'){ik}delta{jl})
+    //      + F{ij} M0{kl} + (FC){ij} M1{kl} + G{ij} M2{kl}
+    // with Mr = sum_m db_r/dI_m dI_m/dF.
+    void derivative(const arg_list &args, size_type nder,
+                    base_tensor &result) const {
+      GMM_ASSERT1(nder == 1, "Sorry, the derivative of this hyperelastic "
+                  "law with respect to its parameters is not available.");
+      hyperelastic_PK1_kinematics K(*(args[0]), PLANE_STRAIN);
+      scalar_type W[3], WW[3][3], b[3];
+      coefficients(K, *(args[1]), W, WW, b);
+      size_type N = K.N;
+
+      // db_r/dI_m
+      scalar_type db[3][3];
+      for (size_type m = 0; m < 3; ++m) {
+        db[0][m] = scalar_type(2)*(WW[0][m] + K.I1*WW[1][m]);
+        db[1][m] = -scalar_type(2)*WW[1][m];
+        db[2][m] = scalar_type(2)*K.I3*WW[2][m];
+      }
+      db[0][0] += scalar_type(2)*W[1];
+      db[2][2] += scalar_type(2)*W[2];
+
+      scalar_type M[3][3][3], B[3][3];
+      for (size_type k = 0; k < 3; ++k)
+        for (size_type l = 0; l < 3; ++l) {
+          scalar_type dI1 = scalar_type(2)*K.F[k][l];
+          scalar_type dI2 = scalar_type(2)*(K.I1*K.F[k][l] - K.FC[k][l]);
+          scalar_type dI3 = scalar_type(2)*K.I3*K.G[k][l];
+          for (size_type r = 0; r < 3; ++r)
+            M[r][k][l] = db[r][0]*dI1 + db[r][1]*dI2 + db[r][2]*dI3;
+          B[k][l] = K.F[k][0]*K.F[l][0] + K.F[k][1]*K.F[l][1]
+            + K.F[k][2]*K.F[l][2];
+        }
+
+      base_tensor::iterator it = result.begin();
+      for (size_type l = 0; l < N; ++l)
+        for (size_type k = 0; k < N; ++k)
+          for (size_type j = 0; j < N; ++j)
+            for (size_type i = 0; i < N; ++i, ++it) {
+              scalar_type a = K.F[i][j]*M[0][k][l] + K.FC[i][j]*M[1][k][l]
+                + K.G[i][j]*M[2][k][l] - b[2]*K.G[i][l]*K.G[k][j]
+                + b[1]*K.F[i][l]*K.F[k][j];
+              if (i == k) a += b[1]*K.C[l][j];
+              if (j == l) a += b[1]*B[i][k];
+              if (i == k && j == l) a += b[0];
+              *it = a;
+            }
+      GMM_ASSERT1(it == result.end(), "Internal error");
+    }
+
+    // Second derivative : not implemented (not necessary)
+    void second_derivative(const arg_list &, size_type, size_type,
+                           base_tensor &) const {
+      GMM_ASSERT1(false, "Sorry, second derivative not implemented");
+    }
+  };
+
+
+  template <class LAW>
+  static void add_PK1_operators(ga_predef_operator_tab &tab,
+                                const std::string &name) {
+    tab.add_method(name + "_PK1",
+                   std::make_shared<hyperelastic_PK1_operator<LAW, false>>());
+    tab.add_method("Plane_Strain_" + name + "_PK1",
+                   std::make_shared<hyperelastic_PK1_operator<LAW, true>>());
+  }
 
   static bool init_predef_operators() {
 
@@ -2260,6 +2519,24 @@ namespace getfem {
        std::make_shared<AHL_wrapper_potential>
        (std::make_shared<plane_strain_hyperelastic_law>(cneocilaw)));
 
+    // Closed form first Piola-Kirchhoff stress tensors
+    add_PK1_operators<SVK_invariants>
+      (PREDEF_OPERATORS, "Saint_Venant_Kirchhoff");
+    add_PK1_operators<Ciarlet_Geymonat_invariants>
+      (PREDEF_OPERATORS, "Ciarlet_Geymonat");
+    add_PK1_operators<Mooney_Rivlin_invariants<false, false>>
+      (PREDEF_OPERATORS, "Incompressible_Mooney_Rivlin");
+    add_PK1_operators<Mooney_Rivlin_invariants<true, false>>
+      (PREDEF_OPERATORS, "Compressible_Mooney_Rivlin");
+    add_PK1_operators<Mooney_Rivlin_invariants<false, true>>
+      (PREDEF_OPERATORS, "Incompressible_Neo_Hookean");
+    add_PK1_operators<Mooney_Rivlin_invariants<true, true>>
+      (PREDEF_OPERATORS, "Compressible_Neo_Hookean");
+    add_PK1_operators<Neo_Hookean_invariants<true>>
+      (PREDEF_OPERATORS, "Compressible_Neo_Hookean_Bonet");
+    add_PK1_operators<Neo_Hookean_invariants<false>>
+      (PREDEF_OPERATORS, "Compressible_Neo_Hookean_Ciarlet");
+
     return true;
   }
 
@@ -2302,7 +2579,7 @@ namespace getfem {
   size_type add_finite_strain_elasticity_brick
   (model &md, const mesh_im &mim, const std::string &lawname,
    const std::string &varname, const std::string &params,
-   size_type region) {
+   size_type region, bool closed_form) {
     std::string test_varname = "Test_" + sup_previous_and_dot_to_varname(varname);
     size_type N = mim.linked_mesh().dim();
     GMM_ASSERT1(N >= 2 && N <= 3,
@@ -2319,6 +2596,10 @@ namespace getfem {
 
     std::string expr = "((Id(meshdim)+Grad_"+varname+")*(" + adapted_lawname
       + "_PK2(Grad_"+varname+","+params+"))):Grad_" + test_varname;
+    if (closed_form && dal::singleton<ga_predef_operator_tab>::instance()
+        .tab.count(adapted_lawname + "_PK1"))
+      expr = "(" + adapted_lawname + "_PK1(Grad_" + varname + "," + params
+        + ")):Grad_" + test_varname;
 
     return add_nonlinear_term
       (md, mim, expr, region, true, false,
@@ -343,30 +343,27 @@ namespace getfem {
       return true;
     }
 
-    // Value : ru/|u| if |u| > r, else u 
-    void value(const arg_list &args, base_tensor &result) const {
-      const base_tensor &t = *args[0];
-      scalar_type r = (*args[1])[0];
-      scalar_type no = gmm::vect_norm2(t.as_vector());
-      if (no > r)
-	gmm::copy(gmm::scaled(t.as_vector(), r/no), result.as_vector());
-      else
-	gmm::copy(t.as_vector(), result.as_vector());
+    // Value : ru/|u| if |u| > r, else u
+    static void value_(const scalar_type *t, size_type N, scalar_type r,
+                       scalar_type *res) {
+      scalar_type no(0);
+      for (size_type i = 0; i < N; ++i) no += t[i]*t[i];
+      no = ::sqrt(no);
+      scalar_type a = (no > r) ? r/no : scalar_type(1);
+      for (size_type i = 0; i < N; ++i) res[i] = a*t[i];
     }
 
-    // Derivative
-    void derivative(const arg_list &args, size_type n,
-                    base_tensor &result) const {
-      const base_tensor &t = *args[0];
-      size_type N = t.size();
-      scalar_type r = (*args[1])[0];
-      scalar_type no = gmm::vect_norm2(t.as_vector()), rno3 = r/(no*no*no);
-
-      gmm::clear(result.as_vector());
+    static void derivative_(const scalar_type *t, size_type N, scalar_type r,
+                            size_type n, scalar_type *result) {
+      scalar_type no(0);
+      for (size_type i = 0; i < N; ++i) no += t[i]*t[i];
+      no = ::sqrt(no);
+      scalar_type rno3 = r/(no*no*no);
 
       switch(n) {
 
       case 1 : // derivative with respect to u
+        std::fill(result, result+N*N, scalar_type(0));
 	if (r > 0) {
 	  if (no <= r) {
 	    for (size_type i = 0; i < N; ++i)
@@ -381,6 +378,7 @@ namespace getfem {
 	}
 	break;
       case 2 : // derivative with respect to r
+        std::fill(result, result+N, scalar_type(0));
 	if (r > 0 && no > r) {
 	  for (size_type i = 0; i < N; ++i)
 	    result[i] = t[i]/no;
@@ -389,6 +387,16 @@ namespace getfem {
       default : GMM_ASSERT1(false, "Wrong derivative number");
       }
     }
+
+    void value(const arg_list &args, base_tensor &result) const
+    { value_(&((*args[0])[0]), args[0]->size(), (*args[1])[0], &(result[0])); }
+
+    // Derivative
+    void derivative(const arg_list &args, size_type n,
+                    base_tensor &result) const {
+      derivative_(&((*args[0])[0]), args[0]->size(), (*args[1])[0], n,
+                  &(result[0]));
+    }
     
     // Second derivative : not implemented
     void second_derivative(const arg_list &/*args*/, size_type, size_type,
@@ -471,72 +479,83 @@ namespace getfem {
       return true;
     }
 
-    // Value:
-    void value(const arg_list &args, base_tensor &result) const {
-      size_type N = (args[0]->sizes().size() == 2) ? args[0]->sizes()[0] : 1;
-      base_matrix tau(N, N), tau_D(N, N);
-      gmm::copy(args[0]->as_vector(), tau.as_vector());
-      scalar_type s = (*(args[1]))[0];
-
-      scalar_type tau_m = gmm::mat_trace(tau) / scalar_type(N);
-      gmm::copy(tau, tau_D);
-      for (size_type i = 0; i < N; ++i) tau_D(i,i) -= tau_m;
-
-      scalar_type norm_tau_D = gmm::mat_euclidean_norm(tau_D);
-
-      if (norm_tau_D > s) gmm::scale(tau_D, s / norm_tau_D);
-
-      for (size_type i = 0; i < N; ++i) tau_D(i,i) += tau_m;
+    // Projection of the deviatoric part of the N x N matrix tau on the
+    // ball of radius s. tau_D receives the normalized deviatoric part.
+    static scalar_type deviator_(const scalar_type *tau, size_type N,
+                                 scalar_type &tau_m, scalar_type *tau_D) {
+      size_type N2 = N*N;
+      tau_m = scalar_type(0);
+      for (size_type i = 0; i < N; ++i) tau_m += tau[i*(N+1)];
+      tau_m /= scalar_type(N);
+      scalar_type norm_tau_D(0);
+      for (size_type k = 0; k < N2; ++k) {
+        tau_D[k] = (k % (N+1)) ? tau[k] : tau[k] - tau_m;
+        norm_tau_D += tau_D[k] * tau_D[k];
+      }
+      return ::sqrt(norm_tau_D);
+    }
 
-      gmm::copy(tau_D.as_vector(), result.as_vector());
+    static void value_(const scalar_type *tau, size_type N, scalar_type s,
+                       scalar_type *res) {
+      size_type N2 = N*N;
+      scalar_type tau_m, norm_tau_D = deviator_(tau, N, tau_m, res);
+      if (norm_tau_D > s)
+        for (size_type k = 0; k < N2; ++k) res[k] *= s / norm_tau_D;
+      for (size_type i = 0; i < N; ++i) res[i*(N+1)] += tau_m;
     }
 
-    // Derivative:
-    void derivative(const arg_list &args, size_type nder,
-                    base_tensor &result) const {
-      size_type N = (args[0]->sizes().size() == 2) ? args[0]->sizes()[0] : 1;
-      base_matrix tau(N, N), tau_D(N, N);
-      gmm::copy(args[0]->as_vector(), tau.as_vector());
-      scalar_type s = (*(args[1]))[0];
-      scalar_type tau_m = gmm::mat_trace(tau) / scalar_type(N);
-      gmm::copy(tau, tau_D);
-      for (size_type i = 0; i < N; ++i) tau_D(i,i) -= tau_m;
-      scalar_type norm_tau_D = gmm::mat_euclidean_norm(tau_D);
+    static void derivative_(const scalar_type *tau, size_type N,
+                            scalar_type s, size_type nder,
+                            scalar_type *result, scalar_type *tau_D) {
+      size_type N2 = N*N;
+      scalar_type tau_m, norm_tau_D = deviator_(tau, N, tau_m, tau_D);
 
       if (norm_tau_D != scalar_type(0))
-        gmm::scale(tau_D, scalar_type(1)/norm_tau_D);
+        for (size_type k = 0; k < N2; ++k) tau_D[k] /= norm_tau_D;
 
       switch(nder) {
       case 1:
+        std::fill(result, result+N2*N2, scalar_type(0));
         if (norm_tau_D <= s) {
-          gmm::clear(result.as_vector());
-          for (size_type i = 0; i < N; ++i)
-            for (size_type j = 0; j < N; ++j)
-              result(i,j,i,j) = scalar_type(1);
+          for (size_type k = 0; k < N2; ++k)
+            result[k*(N2+1)] = scalar_type(1);
         } else {
+          scalar_type a = s / norm_tau_D;
+          for (size_type l = 0; l < N2; ++l)
+            for (size_type k = 0; k < N2; ++k)
+              result[k+l*N2] = -a * tau_D[k] * tau_D[l];
+          for (size_type k = 0; k < N2; ++k)
+            result[k*(N2+1)] += a;
+          scalar_type b = (scalar_type(1) - a) / scalar_type(N);
           for (size_type i = 0; i < N; ++i)
             for (size_type j = 0; j < N; ++j)
-              for (size_type m = 0; m < N; ++m)
-                for (size_type n = 0; n < N; ++n)
-                  result(i,j,m,n)
-                    = s * (-tau_D(i,j) * tau_D(m,n)
-                           + ((i == m && j == n) ? scalar_type(1) : scalar_type(0))
-                           - ((i == j && m == n) ? scalar_type(1)/scalar_type(N)
-                              : scalar_type(0))) / norm_tau_D;
-          for (size_type i = 0; i < N; ++i)
-            for (size_type j = 0; j < N; ++j)
-              result(i,i,j,j) += scalar_type(1)/scalar_type(N);
+              result[i*(N+1) + j*(N+1)*N2] += b;
         }
         break;
       case 2:
         if (norm_tau_D < s)
-          gmm::clear(result.as_vector());
+          std::fill(result, result+N2, scalar_type(0));
         else
-          gmm::copy(tau_D.as_vector(), result.as_vector());
+          std::copy(tau_D, tau_D+N2, result);
         break;
       }
     }
 
+    // Value:
+    void value(const arg_list &args, base_tensor &result) const {
+      size_type N = (args[0]->sizes().size() == 2) ? args[0]->sizes()[0] : 1;
+      value_(&((*args[0])[0]), N, (*(args[1]))[0], &(result[0]));
+    }
+
+    // Derivative:
+    void derivative(const arg_list &args, size_type nder,
+                    base_tensor &result) const {
+      size_type N = (args[0]->sizes().size() == 2) ? args[0]->sizes()[0] : 1;
+      base_vector tau_D(N*N);
+      derivative_(&((*args[0])[0]), N, (*(args[1]))[0], nder, &(result[0]),
+                  &(tau_D[0]));
+    }
+
     // Second derivative : not implemented
     void second_derivative(const arg_list &, size_type, size_type,
                            base_tensor &) const {
@@ -1297,6 +1316,220 @@ namespace getfem {
     }
   }
 
+  // Return mapping of the laws without plastic multiplier as an unknown
+  // (DISPLACEMENT_ONLY), computed directly on the integration points when
+  // the plastic strain, the plastic multiplier and the accumulated plastic
+  // strain are stored on compatible im_data. The strains, the previous
+  // plastic multiplier and the parameters are interpolated with a single
+  // pass of the generic assembly. The update is then done by blocks of
+  // points, each block being transposed into one array per component so
+  // that the loops on the points are vectorizable, and the blocks are
+  // treated in parallel. The formulas are those of the expressions built
+  // by build_isotropic_perfect_elastoplasticity_expressions_*_no_mult*.
+  // Returns false if the data are not stored in a suitable way.
+  static const size_type SMALL_STRAIN_RM_BLOCK = 64;
+
+  static bool small_strain_elastoplasticity_return_mapping
+  (model &md, const std::string &lawname,
+   const std::vector<std::string> &varnames,
+   const std::vector<std::string> &params, size_type region) {
+
+    bool hardening = (lawname.find("_hardening") != std::string::npos);
+    bool plane_strain = (lawname.find("plane_strain") == 0);
+    size_type nhard = hardening ? 2 : 0;
+    const std::string disp = sup_previous_and_dot_to_varname(varnames[0]);
+    const std::string xi   = sup_previous_and_dot_to_varname(varnames[1]);
+    const std::string &Previous_Ep = varnames[2];
+    const std::string &Previous_alpha = hardening ? varnames[3] : "";
+
+    const im_data *pimd = md.pim_data_of_variable(Previous_Ep);
+    const im_data *pimd_xi = md.pim_data_of_variable(xi);
+    const im_data *pimd_alpha
+      = hardening ? md.pim_data_of_variable(Previous_alpha) : 0;
+    if (!pimd || !pimd_xi || (hardening && !pimd_alpha)) return false;
+    auto compatible = [pimd](const im_data *pimd2) {
+      return &(pimd2->linked_mesh_im()) == &(pimd->linked_mesh_im())
+        && pimd2->filtered_region() == pimd->filtered_region()
+        && pimd2->nb_tensor_elem() == 1;
+    };
+    if (!compatible(pimd_xi) || (hardening && !compatible(pimd_alpha)))
+      return false;
+
+    size_type N = pimd->linked_mesh().dim(), NN = N*N;
+    size_type np = pimd->nb_filtered_index();
+    const model_real_plain_vector &Epn = md.real_variable(Previous_Ep);
+    if (gmm::vect_size(Epn) != NN*np ||
+        gmm::vect_size(md.real_variable(xi)) != np ||
+        (hardening && gmm::vect_size(md.real_variable(Previous_alpha)) != np))
+      return false;
+
+    const std::string &mu      = params[1];
+    const std::string &sigma_y = params[2];
+    const std::string &theta   = (params.size() >= 4+nhard)
+                               ? params[3+nhard] : "1";
+    const std::string &dt      = (params.size() >= 5+nhard)
+                               ? params[4+nhard] : "timestep";
+
+    // Packed input at each point: Grad_u, Grad_Previous_u, Previous_xi,
+    // mu, sigma_y, theta, dt, (Hk, Hi) and a last component equal to 1
+    // which is zero on the points not visited (outside the region).
+    std::stringstream expr;
+    expr << std::setprecision(17) << "[";
+    for (const std::string &g : {"Grad_"+disp, "Grad_Previous_"+disp})
+      for (size_type j = 1; j <= N; ++j)
+        for (size_type i = 1; i <= N; ++i)
+          expr << g << "(" << i << "," << j << "),";
+    expr << "Previous_" << xi << ",(" << mu << "),(" << sigma_y << "),("
+         << theta << "),(" << dt << "),";
+    if (hardening) expr << "(" << params[3] << "),(" << params[4] << "),";
+    expr << "1]";
+    size_type nin = 2*NN + 6 + nhard;
+    bgeot::multi_index in_size; in_size.push_back(nin);
+    im_data imd_in(pimd->linked_mesh_im(), in_size, pimd->filtered_region());
+    base_vector in(nin*np);
+    ga_interpolation_im_data(md, expr.str(), imd_in, in, region);
+    if (gmm::vect_size(in) != nin*np) return false;
+
+    base_vector Epnp1(NN*np), xinp1(np), alphanp1(hardening ? np : 0);
+    const model_real_plain_vector *alphan
+      = hardening ? &(md.real_variable(Previous_alpha)) : 0;
+    const size_type BS = SMALL_STRAIN_RM_BLOCK;
+    const scalar_type d = plane_strain ? scalar_type(3) : scalar_type(N);
+    const scalar_type s23 = sqrt(2./3.), s32 = sqrt(3./2.);
+
+    auto update_block = [&](size_type ib) {
+      scalar_type E1[9][BS], E0[9][BS], Z[9][BS], B[9][BS];
+      scalar_type xin[BS], mu_[BS], sy[BS], th[BS], dt_[BS], hk[BS], hi[BS];
+      scalar_type msk[BS], tr1[BS], tr0[BS], trZ[BS], nB[BS], c[BS], K[BS];
+      size_type i0 = ib*BS, nb = std::min(BS, np - i0);
+
+      for (size_type p = 0; p < nb; ++p) {
+        const scalar_type *q = &(in[(i0+p)*nin]);
+        for (size_type i = 0; i < N; ++i)
+          for (size_type j = 0; j < N; ++j) {
+            E1[i+N*j][p] = (q[i+N*j] + q[j+N*i]) * 0.5;
+            E0[i+N*j][p] = (q[NN+i+N*j] + q[NN+j+N*i]) * 0.5;
+          }
+        q += 2*NN;
+        xin[p] = q[0]; mu_[p] = q[1]; sy[p] = q[2]; th[p] = q[3];
+        dt_[p] = q[4]; msk[p] = q[nin-2*NN-1];
+        if (hardening) { hk[p] = q[5]; hi[p] = q[6]; }
+        for (size_type k = 0; k < NN; ++k) Z[k][p] = Epn[(i0+p)*NN+k];
+      }
+
+      // Traces and deviatoric parts of the strains
+      for (size_type p = 0; p < nb; ++p)
+        tr1[p] = tr0[p] = trZ[p] = nB[p] = scalar_type(0);
+      for (size_type i = 0; i < N; ++i)
+        for (size_type p = 0; p < nb; ++p) {
+          tr1[p] += E1[i*(N+1)][p]; tr0[p] += E0[i*(N+1)][p];
+          trZ[p] += Z[i*(N+1)][p];
+        }
+      for (size_type i = 0; i < N; ++i)
+        for (size_type p = 0; p < nb; ++p)
+          { E1[i*(N+1)][p] -= tr1[p]/d; E0[i*(N+1)][p] -= tr0[p]/d; }
+
+      if (!hardening) {
+        // zetan = Epn + (1-theta)*2*mu*dt*Previous_xi*(Deviator(En)-Epn)
+        for (size_type p = 0; p < nb; ++p)
+          c[p] = (scalar_type(1)-th[p])*(scalar_type(2)*mu_[p]*dt_[p]*xin[p]);
+        for (size_type k = 0; k < NN; ++k)
+          for (size_type p = 0; p < nb; ++p)
+            Z[k][p] += c[p]*(E0[k][p] - Z[k][p]);
+        // B = Deviator(Enp1) - zetan
+        for (size_type k = 0; k < NN; ++k)
+          for (size_type p = 0; p < nb; ++p) {
+            B[k][p] = E1[k][p] - Z[k][p];
+            nB[p] += B[k][p]*B[k][p];
+          }
+        if (plane_strain) {
+          for (size_type p = 0; p < nb; ++p) trZ[p] = scalar_type(0);
+          for (size_type i = 0; i < N; ++i)
+            for (size_type p = 0; p < nb; ++p) trZ[p] += Z[i*(N+1)][p];
+        }
+        for (size_type p = 0; p < nb; ++p) {
+          scalar_type nBf = plane_strain
+            ? sqrt(nB[p] + gmm::sqr(tr1[p]/scalar_type(3) - trZ[p]))
+            : sqrt(nB[p]);
+          scalar_type eps = plane_strain ? 1e-25 : 1e-40;
+          nB[p] = sqrt(nB[p]);
+          c[p] = std::max(scalar_type(1) - s23*sy[p]
+                          / (scalar_type(2)*mu_[p]*nBf + eps), scalar_type(0));
+          scalar_type x = std::max(s32*nB[p]/sy[p]
+                                   - scalar_type(1)/(scalar_type(2)*mu_[p]),
+                                   scalar_type(0)) / (th[p]*dt_[p]);
+          xinp1[i0+p] = (msk[p] != scalar_type(0)) ? x : scalar_type(0);
+        }
+      } else {
+        // A = 2*mu*Deviator(En) - (2*mu+2/3*Hk)*Epn, stored in B
+        for (size_type p = 0; p < nb; ++p)
+          K[p] = scalar_type(2)*mu_[p] + scalar_type(2)/scalar_type(3)*hk[p];
+        for (size_type k = 0; k < NN; ++k)
+          for (size_type p = 0; p < nb; ++p) {
+            B[k][p] = scalar_type(2)*mu_[p]*E0[k][p] - K[p]*Z[k][p];
+            nB[p] += B[k][p]*B[k][p];
+          }
+        if (plane_strain)
+          for (size_type p = 0; p < nb; ++p)
+            nB[p] += gmm::sqr(scalar_type(2)*mu_[p]*tr0[p]/scalar_type(3)
+                              - K[p]*trZ[p]);
+        // zetan = Epn + (1-theta)*dt*Previous_xi*A
+        // etan = alphan + sqrt(2/3)*(1-theta)*dt*Previous_xi*Norm(A)
+        scalar_type etan[BS];
+        for (size_type p = 0; p < nb; ++p) {
+          c[p] = (scalar_type(1)-th[p])*(dt_[p]*xin[p]);
+          etan[p] = (*alphan)[i0+p] + s23*c[p]*sqrt(nB[p]);
+          nB[p] = trZ[p] = scalar_type(0);
+        }
+        for (size_type k = 0; k < NN; ++k)
+          for (size_type p = 0; p < nb; ++p)
+            Z[k][p] += c[p]*B[k][p];
+        // B = 2*mu*Deviator(Enp1) - (2*mu+2/3*Hk)*zetan
+        for (size_type k = 0; k < NN; ++k)
+          for (size_type p = 0; p < nb; ++p) {
+            B[k][p] = scalar_type(2)*mu_[p]*E1[k][p] - K[p]*Z[k][p];
+            nB[p] += B[k][p]*B[k][p];
+          }
+        if (plane_strain) {
+          for (size_type i = 0; i < N; ++i)
+            for (size_type p = 0; p < nb; ++p) trZ[p] += Z[i*(N+1)][p];
+          for (size_type p = 0; p < nb; ++p)
+            nB[p] += gmm::sqr(scalar_type(2)*mu_[p]*tr1[p]/scalar_type(3)
+                              - K[p]*trZ[p]);
+        }
+        for (size_type p = 0; p < nb; ++p) {
+          nB[p] = sqrt(nB[p]);
+          scalar_type beta
+            = std::max(nB[p] - s23*(sy[p] + hi[p]*etan[p]), scalar_type(0))
+            / ((nB[p] + 1e-40)*(K[p] + scalar_type(2)/scalar_type(3)*hi[p]));
+          c[p] = beta;
+          scalar_type a = etan[p] + s23*beta*nB[p];
+          scalar_type x = (beta/(scalar_type(1) - K[p]*beta))/(th[p]*dt_[p]);
+          bool visited = (msk[p] != scalar_type(0));
+          alphanp1[i0+p] = visited ? a : scalar_type(0);
+          xinp1[i0+p] = visited ? x : scalar_type(0);
+        }
+      }
+
+      // Epnp1 = zetan + c*B
+      for (size_type p = 0; p < nb; ++p) {
+        bool visited = (msk[p] != scalar_type(0));
+        for (size_type k = 0; k < NN; ++k)
+          Epnp1[(i0+p)*NN+k] = visited ? Z[k][p] + c[p]*B[k][p]
+                                       : scalar_type(0);
+      }
+    };
+
+    size_type nbblocks = (np + BS - 1) / BS;
+    GETFEM_OMP_FOR(size_type ib = 0, ib < nbblocks, ++ib, update_block(ib););
+
+    gmm::copy(xinp1, md.set_real_variable(xi));
+    if (hardening)
+      gmm::copy(alphanp1, md.set_real_variable(Previous_alpha));
+    gmm::copy(Epnp1, md.set_real_variable(Previous_Ep));
+    return true;
+  }
+
   void small_strain_elastoplasticity_next_iter
   (model &md, const mesh_im &mim,
    std::string lawname, plasticity_unknowns_type unknowns_type,
@@ -1316,6 +1549,13 @@ namespace getfem {
     std::string xi   = sup_previous_and_dot_to_varname(varnames[1]);
     std::string Previous_Ep = varnames[2];
 
+    if (xi_np1.size() && small_strain_elastoplasticity_return_mapping
+        (md, lawname, varnames, params, region)) {
+      gmm::copy(md.real_variable(disp), md.set_real_variable("Previous_"+disp));
+      gmm::copy(md.real_variable(xi), md.set_real_variable("Previous_"+xi));
+      return;
+    }
+
     std::string Previous_alpha;
     base_vector tmpv_alpha;
     if (alphanp1.size()) { // Interpolation of the accumulated plastic strain
@@ -139,7 +139,7 @@ namespace gmm {
 
   template<typename T>
   int SuperLU_solve(const gmm::csc_matrix<T> &csc_A, T *sol, T *rhs,
-                    double& rcond_, int permc_spec) {
+                    double& rcond_, int permc_spec, int nrhs) {
     /*
      * Get column permutation vector perm_c[], according to permc_spec:
      *   permc_spec = 0: use the natural ordering
@@ -150,7 +150,7 @@ namespace gmm {
     typedef typename gmm::number_traits<T>::magnitude_type R;
 
     int m = int(mat_nrows(csc_A)), n = int(mat_ncols(csc_A));
-    int nrhs = 1, info = 0, nz = int(nnz(csc_A));
+    int info = 0, nz = int(nnz(csc_A));
 
     GMM_ASSERT1(nz != 0, "Cannot factor a matrix full of zeros!");
     GMM_ASSERT1(n == m, "Cannot factor a non-square matrix");
@@ -217,10 +217,10 @@ namespace gmm {
     return info;
   }
 
-  template int SuperLU_solve(const gmm::csc_matrix<float> &csc_A, float *sol, float *rhs, double& rcond_, int permc_spec);
-  template int SuperLU_solve(const gmm::csc_matrix<double> &csc_A, double *sol, double *rhs, double& rcond_, int permc_spec);
-  template int SuperLU_solve(const gmm::csc_matrix<std::complex<float> > &csc_A, std::complex<float> *sol, std::complex<float> *rhs, double& rcond_, int permc_spec);
-  template int SuperLU_solve(const gmm::csc_matrix<std::complex<double> > &csc_A, std::complex<double> *sol, std::complex<double> *rhs, double& rcond_, int permc_spec);
+  template int SuperLU_solve(const gmm::csc_matrix<float> &csc_A, float *sol, float *rhs, double& rcond_, int permc_spec, int nrhs);
+  template int SuperLU_solve(const gmm::csc_matrix<double> &csc_A, double *sol, double *rhs, double& rcond_, int permc_spec, int nrhs);
+  template int SuperLU_solve(const gmm::csc_matrix<std::complex<float> > &csc_A, std::complex<float> *sol, std::complex<float> *rhs, double& rcond_, int permc_spec, int nrhs);
+  template int SuperLU_solve(const gmm::csc_matrix<std::complex<double> > &csc_A, std::complex<double> *sol, std::complex<double> *rhs, double& rcond_, int permc_spec, int nrhs);
 
   struct SuperLU_factor_impl_common {
     mutable SuperMatrix SA, SL, SB, SU, SX;
@@ -0,0 +1,260 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+#include "getfem/getfem_time_series.h"
+#include "getfem/getfem_models.h"
+#include "getfem/getfem_partial_mesh_fem.h"
+
+namespace getfem {
+
+  /* Sections of a time series, besides the ones of the mesh, of the
+     mesh_fems (with id the mesh_fem number) and of the mesh_ims:
+     TS        : format version
+     TS_FIELD  : name of the field i (id i)
+     TS_FDESC  : description of the field i (id i): kind, id of the
+                 mesh_fem or mesh_im, filtered region and tensor size
+                 of the im_data
+     TS_STEP   : time of the step s (id s)
+     TS_D<i>   : values of the field i at step s (id s)
+  */
+  enum { TS_NO_DESC, TS_MESH_FEM, TS_IM_DATA };
+
+  /* ******************************************************************** */
+  /*    Writer.                                                            */
+  /* ******************************************************************** */
+
+  time_series_writer::time_series_writer(const std::string &name,
+                                         bool compress)
+    : f(name), pmesh(0), nb_steps_(0) {
+    std::vector<gmm::uint64_type> hdr = { 1 };
+    f.write_section("TS", 0, hdr);
+    f.set_compression(compress);
+  }
+
+  void time_series_writer::set_mesh(const mesh &m) {
+    if (pmesh) {
+      GMM_ASSERT1(pmesh == &m, "All the fields of a time series should be "
+                  "defined on the same mesh");
+      return;
+    }
+    pmesh = &m;
+    m.write_to_binary_file(f);
+  }
+
+  size_type
+  time_series_writer::new_field(const std::string &name,
+                                const std::vector<gmm::uint64_type> &desc) {
+    GMM_ASSERT1(field_index(name) == size_type(-1), "Field " << name
+                << " already declared");
+    size_type i = names.size();
+    names.push_back(name);
+    f.write_string_section("TS_FIELD", i, std::vector<std::string>(1, name));
+    f.write_section("TS_FDESC", i, desc);
+    return i;
+  }
+
+  size_type time_series_writer::add_field(const std::string &name,
+                                          const mesh_fem &mf) {
+    set_mesh(mf.linked_mesh());
+    size_type id = std::find(mfs.begin(), mfs.end(), &mf) - mfs.begin();
+    if (id == mfs.size()) {
+      mfs.push_back(&mf);
+      mf.write_to_binary_file(f, id);
+    }
+    return new_field(name, { TS_MESH_FEM, id, gmm::uint64_type(-1) });
+  }
+
+  size_type time_series_writer::add_field(const std::string &name,
+                                          const im_data &imd) {
+    const mesh_im &mim = imd.linked_mesh_im();
+    set_mesh(mim.linked_mesh());
+    size_type id = std::find(mims.begin(), mims.end(), &mim) - mims.begin();
+    if (id == mims.size()) {
+      mims.push_back(&mim);
+      mim.write_to_binary_file(f, id);
+    }
+    std::vector<gmm::uint64_type> desc = { TS_IM_DATA, id,
+                                           imd.filtered_region() };
+    for (size_type k = 0; k < imd.tensor_size().size(); ++k)
+      desc.push_back(imd.tensor_size()[k]);
+    return new_field(name, desc);
+  }
+
+  size_type time_series_writer::add_field(const std::string &name)
+  { return new_field(name, { TS_NO_DESC, 0, gmm::uint64_type(-1) }); }
+
+  void time_series_writer::add_model_variables(const model &md,
+                                               bool with_data) {
+    model::varnamelist vl;
+    md.variable_list(vl);
+    for (const std::string &name : vl) {
+      if (field_index(name) != size_type(-1)
+          || md.is_affine_dependent_variable(name)
+          || (!with_data && md.is_true_data(name))) continue;
+      const mesh_fem *mf = md.pmesh_fem_of_variable(name);
+      const im_data *imd = md.pim_data_of_variable(name);
+      // the dofs of a filtered variable are not described by its mesh_fem
+      if (mf && !dynamic_cast<const partial_mesh_fem *>(mf))
+        add_field(name, *mf);
+      else if (imd)
+        add_field(name, *imd);
+      else
+        add_field(name);
+    }
+  }
+
+  size_type time_series_writer::field_index(const std::string &name) const {
+    auto it = std::find(names.begin(), names.end(), name);
+    return (it == names.end()) ? size_type(-1) : size_type(it - names.begin());
+  }
+
+  size_type time_series_writer::new_step(scalar_type t) {
+    f.write_section("TS_STEP", nb_steps_, &t, 1, sizeof(scalar_type));
+    return nb_steps_++;
+  }
+
+  void time_series_writer::write_field_data(size_type i, const void *data,
+                                            size_type nb,
+                                            size_type elem_size) {
+    GMM_ASSERT1(nb_steps_ > 0, "new_step should be called first");
+    GMM_ASSERT1(i < names.size(), "Undeclared field");
+    std::stringstream tag;
+    tag << "TS_D" << i;
+    f.write_section(tag.str(), nb_steps_-1, data, nb, elem_size);
+  }
+
+  void time_series_writer::write_model_variables(const model &md) {
+    for (size_type i = 0; i < names.size(); ++i)
+      if (md.variable_exists(names[i])) {
+        if (md.is_complex())
+          write_field(i, md.complex_variable(names[i]));
+        else
+          write_field(i, md.real_variable(names[i]));
+      }
+  }
+
+  /* ******************************************************************** */
+  /*    Reader.                                                            */
+  /* ******************************************************************** */
+
+  time_series_reader::time_series_reader(const std::string &name)
+    : f(name) {
+    bgeot::binary_section<gmm::uint64_type>
+      hdr = f.section<gmm::uint64_type>("TS", 0);
+    GMM_ASSERT1(hdr.size() >= 1 && hdr[0] == 1, "File " << name << " is not "
+                "a time series or its version is not supported");
+    for (size_type i = 0; f.has_section("TS_FIELD", i); ++i) {
+      std::vector<std::string> v;
+      f.read_string_section("TS_FIELD", i, v);
+      GMM_ASSERT1(v.size() == 1, "Corrupted binary file " << name);
+      names.push_back(v[0]);
+      descs.push_back(std::vector<gmm::uint64_type>());
+      f.read_section("TS_FDESC", i, descs.back());
+      GMM_ASSERT1(descs.back().size() >= 3, "Corrupted binary file "
+                  << name);
+    }
+    for (size_type s = 0; f.has_section("TS_STEP", s); ++s) {
+      bgeot::binary_section<scalar_type>
+        t = f.section<scalar_type>("TS_STEP", s);
+      GMM_ASSERT1(t.size() == 1, "Corrupted binary file " << name);
+      times.push_back(t[0]);
+    }
+  }
+
+  std::string time_series_reader::data_tag(size_type i) {
+    std::stringstream tag;
+    tag << "TS_D" << i;
+    return tag.str();
+  }
+
+  const std::vector<gmm::uint64_type> &
+  time_series_reader::desc(size_type i) const {
+    GMM_ASSERT1(i < descs.size(), "Field " << i << " does not exist");
+    return descs[i];
+  }
+
+  size_type time_series_reader::field_index(const std::string &name) const {
+    auto it = std::find(names.begin(), names.end(), name);
+    return (it == names.end()) ? size_type(-1) : size_type(it - names.begin());
+  }
+
+  bool time_series_reader::field_is_complex(size_type s, size_type i) const {
+    size_type k = f.find_section(data_tag(i), s);
+    GMM_ASSERT1(k != size_type(-1), "Field " << names[i]
+                << " not written at step " << s);
+    return f.section_record(k).elem_size == sizeof(complex_type);
+  }
+
+  bool time_series_reader::field_on_mesh_fem(size_type i) const
+  { return desc(i)[0] == TS_MESH_FEM; }
+
+  void time_series_reader::read_mesh_fem(size_type i, mesh_fem &mf) const {
+    GMM_ASSERT1(field_on_mesh_fem(i), "Field " << names[i]
+                << " is not defined on a mesh_fem");
+    mf.read_from_binary_file(f, size_type(desc(i)[1]));
+  }
+
+  bool time_series_reader::field_on_im_data(size_type i) const
+  { return desc(i)[0] == TS_IM_DATA; }
+
+  void time_series_reader::read_mesh_im(size_type i, mesh_im &mim) const {
+    GMM_ASSERT1(field_on_im_data(i), "Field " << names[i]
+                << " is not defined on an im_data");
+    mim.read_from_binary_file(f, size_type(desc(i)[1]));
+  }
+
+  bgeot::multi_index
+  time_series_reader::im_data_tensor_size(size_type i) const {
+    GMM_ASSERT1(field_on_im_data(i), "Field " << names[i]
+                << " is not defined on an im_data");
+    bgeot::multi_index mi;
+    for (size_type k = 3; k < desc(i).size(); ++k)
+      mi.push_back(size_type(desc(i)[k]));
+    return mi;
+  }
+
+  size_type time_series_reader::im_data_filtered_region(size_type i) const {
+    GMM_ASSERT1(field_on_im_data(i), "Field " << names[i]
+                << " is not defined on an im_data");
+    return size_type(desc(i)[2]);
+  }
+
+  void time_series_reader::read_model_variables(size_type s,
+                                                model &md) const {
+    for (size_type i = 0; i < names.size(); ++i) {
+      if (!md.variable_exists(names[i]) || !has_field(s, i)
+          || md.is_affine_dependent_variable(names[i])) continue;
+      if (md.is_complex()) {
+        bgeot::binary_section<complex_type> p = field_data<complex_type>(s, i);
+        GMM_ASSERT1(p.size() == md.complex_variable(names[i]).size(),
+                    "Wrong size of the variable " << names[i]);
+        std::copy(p.begin(), p.end(),
+                  md.set_complex_variable(names[i]).begin());
+      } else {
+        bgeot::binary_section<scalar_type> p = field_data<scalar_type>(s, i);
+        GMM_ASSERT1(p.size() == md.real_variable(names[i]).size(),
+                    "Wrong size of the variable " << names[i]);
+        std::copy(p.begin(), p.end(), md.set_real_variable(names[i]).begin());
+      }
+    }
+  }
+
+}  /* end of namespace getfem.                                             */
@@ -167,19 +167,13 @@ namespace gmm {
   }
 
 
-  /** MUMPS solve interface  
-   *  Works only with sparse or skyline matrices
-   */
-  template <typename MAT, typename VECTX, typename VECTB>
-  bool MUMPS_solve(const MAT &A, const VECTX &X_, const VECTB &B,
-                   bool sym = false, bool distributed = false) {
-    VECTX &X = const_cast<VECTX &>(X_);
-
-    typedef typename linalg_traits<MAT>::value_type T;
+  /* Solve in place for nrhs right hand sides stored one after the other
+     in rhs. */
+  template <typename MAT, typename T>
+  bool MUMPS_solve_in_place(const MAT &A, std::vector<T> &rhs, int nrhs,
+                            bool sym, bool distributed) {
     typedef typename mumps_interf<T>::value_type MUMPS_T;
     GMM_ASSERT2(gmm::mat_nrows(A) == gmm::mat_ncols(A), "Non-square matrix");
-  
-    std::vector<T> rhs(gmm::vect_size(B)); gmm::copy(B, rhs);
 
     ij_sparse_matrix<T> AA(A, sym);
   
@@ -213,8 +207,10 @@ namespace gmm {
         id.jcn = &(AA.jcn[0]);
         id.a = (MUMPS_T*)(&(AA.a[0]));
       }
-      if (rank == 0)
+      if (rank == 0) {
         id.rhs = (MUMPS_T*)(&(rhs[0]));
+        if (nrhs > 1) { id.nrhs = nrhs; id.lrhs = id.n; }
+      }
     }
 
     id.ICNTL(1) = -1; // output stream for error messages
@@ -244,13 +240,45 @@ namespace gmm {
     mumps_interf<T>::mumps_c(id);
 
 #ifdef GMM_USES_MPI
-    MPI_Bcast(&(rhs[0]),id.n,gmm::mpi_type(T()),0,MPI_COMM_WORLD);
+    MPI_Bcast(&(rhs[0]),int(rhs.size()),gmm::mpi_type(T()),0,MPI_COMM_WORLD);
 #endif
 
-    gmm::copy(rhs, X);
+    return ok;
+  }
 
+  /** MUMPS solve interface  
+   *  Works only with sparse or skyline matrices
+   */
+  template <typename MAT, typename VECTX, typename VECTB>
+  bool MUMPS_solve(const MAT &A, const VECTX &X_, const VECTB &B,
+                   bool sym = false, bool distributed = false) {
+    VECTX &X = const_cast<VECTX &>(X_);
+    typedef typename linalg_traits<MAT>::value_type T;
+    std::vector<T> rhs(gmm::vect_size(B)); gmm::copy(B, rhs);
+    bool ok = MUMPS_solve_in_place(A, rhs, 1, sym, distributed);
+    gmm::copy(rhs, X);
     return ok;
+  }
 
+  /** MUMPS solve interface for several right hand sides, with a single
+   *  factorization of the matrix.
+   *  Works only with sparse or skyline matrices
+   */
+  template <typename MAT, typename VECTX, typename VECTB>
+  bool MUMPS_solve_multiple_rhs(const MAT &A, std::vector<VECTX> &X,
+                                const std::vector<VECTB> &B,
+                                bool sym = false, bool distributed = false) {
+    typedef typename linalg_traits<MAT>::value_type T;
+    GMM_ASSERT2(X.size() == B.size(), "dimensions mismatch");
+    size_type n = gmm::mat_nrows(A), nrhs = B.size();
+    if (nrhs == 0) return true;
+    std::vector<T> rhs(n*nrhs);
+    for (size_type i = 0; i < nrhs; ++i)
+      gmm::copy(B[i], gmm::sub_vector(rhs, gmm::sub_interval(i*n, n)));
+    bool ok = MUMPS_solve_in_place(A, rhs, int(nrhs), sym, distributed);
+    for (size_type i = 0; i < nrhs; ++i)
+      gmm::copy(gmm::sub_vector(rhs, gmm::sub_interval(i*n, n)), X[i]);
+    return ok;
   }
 
 
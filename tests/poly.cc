@@ -66,6 +66,50 @@ void dump_poly_eval() {
   }
 }
 
+/* The compiled evaluation of a set of polynomials, of their gradients
+   and hessians, is compared to base_poly::eval. */
+void check_polynomial_set_evaluator() {
+  typedef bgeot::scalar_type T;
+  typedef bgeot::size_type size_type;
+  for (bgeot::short_type dim = 1; dim <= 3; ++dim) {
+    for (bgeot::short_type dg = 0; dg <= 4; ++dg) {
+      std::vector<bgeot::base_poly> P(5, bgeot::base_poly(dim, dg));
+      for (bgeot::base_poly &p : P)
+        for (unsigned i = 0; i < p.size(); ++i)
+          p[i] = (rand() % 3) ? T(rand()) / T(RAND_MAX) : T(0);
+      bgeot::polynomial_set_evaluator E(P);
+      size_type R = P.size(), np = 4;
+      assert(E.dim() == dim && E.nb_polynomials() == R);
+
+      std::vector<T> x(np*dim), w(E.work_size());
+      for (T &v : x) v = T(rand()) / T(RAND_MAX) - T(0.5);
+      for (bgeot::short_type order = 0; order <= 2; ++order) {
+        size_type nc = E.nb_components(order);
+        assert(nc == R * size_type(pow(dim, order)));
+        bgeot::base_matrix res;
+        E.eval(order, x.data(), np, res);
+        std::vector<T> r(nc);
+        for (size_type ip = 0; ip < np; ++ip) {
+          const T *xp = x.data() + ip*dim;
+          E.eval(order, xp, r.data(), w.data());
+          for (size_type c = 0; c < nc; ++c) {
+            /* component c is P_i, dP_i/dx_j or d2P_i/dx_jdx_k with
+               c = i + R*(j + dim*k) */
+            size_type i = c % R, j = (c / R) % dim, k = (c / R) / dim;
+            bgeot::base_poly Q = P[i];
+            if (order >= 1) Q.derivative(bgeot::short_type(j));
+            if (order >= 2) Q.derivative(bgeot::short_type(k));
+            T a = bgeot::to_scalar(Q.eval(xp));
+            assert(gmm::abs(r[c] - a) < 1e-12);
+            assert(gmm::abs(res(c, ip) - a) < 1e-12);
+          }
+        }
+      }
+    }
+  }
+  cout << "polynomial_set_evaluator is ok\n";
+}
+
 int main(void)
 {
   try {
@@ -178,6 +222,8 @@ int main(void)
     }
     cout << "poly derivative : " << gmm::uclock_sec() - t0 << "sec\n";
 
+    check_polynomial_set_evaluator();
+
     bgeot::base_poly P2;
     std::stringstream ss; ss << P;
     P2 = bgeot::read_base_poly(P.dim(), ss);
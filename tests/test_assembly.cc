@@ -24,6 +24,7 @@
 #include "getfem/getfem_regular_meshes.h"
 #include "getfem/getfem_partial_mesh_fem.h"
 #include "getfem/getfem_mat_elem.h"
+#include "getfem/getfem_nonlinear_elasticity.h"
 #include "gmm/gmm.h"
 #ifdef GETFEM_HAVE_SYS_TIMES
 # include <sys/times.h>
@@ -887,6 +888,207 @@ static void test_new_assembly(int N, int NX, int pK) {
 
 
 
+/* Compare the residual and the tangent matrix of the term expr1 and of
+   the term expr2 for the displacement U, or of the finite strain
+   elasticity bricks with and without the closed form. */
+static void compare_nonlinear_terms(const getfem::mesh_im &mim,
+                                    const getfem::mesh_fem &mf_u,
+                                    const std::vector<scalar_type> &U,
+                                    const std::vector<scalar_type> &params,
+                                    const std::string &expr1,
+                                    const std::string &expr2,
+                                    bool brick = false) {
+  getfem::model_real_plain_vector V[2];
+  getfem::model_real_sparse_matrix K[2];
+  for (size_type k = 0; k < 2; ++k) {
+    getfem::model md;
+    md.add_fem_variable("u", mf_u);
+    gmm::copy(U, md.set_real_variable("u"));
+    md.add_initialized_fixed_size_data("params", params);
+    const std::string &expr = (k == 0) ? expr1 : expr2;
+    if (brick)
+      getfem::add_finite_strain_elasticity_brick(md, mim, expr, "u",
+                                                 "params", size_type(-1),
+                                                 k == 0);
+    else
+      getfem::add_nonlinear_term(md, mim, expr);
+    md.assembly(getfem::model::BUILD_ALL);
+    gmm::resize(V[k], gmm::vect_size(md.real_rhs()));
+    gmm::copy(md.real_rhs(), V[k]);
+    gmm::resize(K[k], gmm::mat_nrows(md.real_tangent_matrix()),
+                gmm::mat_ncols(md.real_tangent_matrix()));
+    gmm::copy(md.real_tangent_matrix(), K[k]);
+  }
+  scalar_type nV = gmm::vect_norminf(V[0]), nK = gmm::mat_maxnorm(K[0]);
+  gmm::add(gmm::scaled(V[1], scalar_type(-1)), V[0]);
+  gmm::add(gmm::scaled(K[1], scalar_type(-1)), K[0]);
+  scalar_type eV = gmm::vect_norminf(V[0]) / nV;
+  scalar_type eK = gmm::mat_maxnorm(K[0]) / nK;
+  cout << expr1 << " : relative errors " << eV << " " << eK << endl;
+  GMM_ASSERT1(eV < 1E-10 && eK < 1E-10, "The residual or the tangent "
+              "matrix of " << expr1 << " differ from the ones of " << expr2);
+}
+
+/* The closed form Law_PK1 operators of the hyperelastic laws against
+   (Id+Grad_u)*Law_PK2 and its symbolic derivative. */
+static void test_hyperelastic_PK1(int N) {
+  getfem::mesh m;
+  bgeot::pgeometric_trans pgt = bgeot::simplex_geotrans(N, 1);
+  getfem::regular_unit_mesh(m, std::vector<size_type>(N, 3), pgt);
+  getfem::mesh_fem mf_u(m, dim_type(N));
+  mf_u.set_classical_finite_element(2);
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(m.convex_index(), 4);
+
+  std::vector<scalar_type> U(mf_u.nb_dof());
+  gmm::fill_random(U);
+  gmm::scale(U, scalar_type(0.02));
+
+  struct law_params { std::string name; std::vector<scalar_type> p; };
+  std::vector<law_params> laws = {
+    { "Saint_Venant_Kirchhoff", { 1.2, 0.8 } },
+    { "Ciarlet_Geymonat", { 1.2, 0.8, 0.3 } },
+    { "Incompressible_Mooney_Rivlin", { 0.3, 0.2 } },
+    { "Compressible_Mooney_Rivlin", { 0.3, 0.2, 1.0 } },
+    { "Incompressible_Neo_Hookean", { 0.3 } },
+    { "Compressible_Neo_Hookean", { 0.3, 1.0 } },
+    { "Compressible_Neo_Hookean_Bonet", { 1.2, 0.8 } },
+    { "Compressible_Neo_Hookean_Ciarlet", { 1.2, 0.8 } }
+  };
+  for (const law_params &law : laws) {
+    std::vector<std::string> names;
+    // In 2D, only these laws are defined without the plane strain version.
+    if (N == 3 || law.name == "Saint_Venant_Kirchhoff"
+        || law.name == "Ciarlet_Geymonat")
+      names.push_back(law.name);
+    if (N == 2) names.push_back("Plane_Strain_" + law.name);
+    for (const std::string &name : names)
+      compare_nonlinear_terms
+        (mim, mf_u, U, law.p, name + "_PK1(Grad_u,params):Grad_Test_u",
+         "((Id(meshdim)+Grad_u)*" + name + "_PK2(Grad_u,params))"
+         ":Grad_Test_u");
+    compare_nonlinear_terms(mim, mf_u, U, law.p, law.name, law.name, true);
+  }
+}
+
+
+/* The matrix operators having unrolled versions for 2x2 and 3x3 matrices
+   against the same expressions written with the components. */
+static void test_unrolled_matrix_operators(int N) {
+  getfem::mesh m;
+  bgeot::pgeometric_trans pgt = bgeot::simplex_geotrans(N, 1);
+  getfem::regular_unit_mesh(m, std::vector<size_type>(N, 3), pgt);
+  getfem::mesh_fem mf_u(m, dim_type(N));
+  mf_u.set_classical_finite_element(2);
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(m.convex_index(), 4);
+
+  std::vector<scalar_type> U(mf_u.nb_dof());
+  gmm::fill_random(U);
+  gmm::scale(U, scalar_type(0.1));
+
+  auto comp = [](const std::string &A, int i, int j) {
+    std::stringstream s; s << A << "(" << i+1 << "," << j+1 << ")";
+    return s.str();
+  };
+  /* The test functions cannot be taken by components: the references are
+     matrices written component by component contracted with Grad_Test_u. */
+  auto literal = [N](std::function<std::string(int, int)> c) {
+    std::string s = "[";
+    for (int i = 0; i < N; ++i)
+      for (int j = 0; j < N; ++j)
+        s += c(i, j) + (j < N-1 ? "," : (i < N-1 ? ";" : "]"));
+    return s;
+  };
+  auto g = [&](int i, int j) { return comp("Grad_u", i, j); };
+  std::string tr = "(0";
+  for (int i = 0; i < N; ++i) tr += "+" + g(i, i);
+  tr += ")";
+  std::stringstream sN; sN << N;
+  std::string T = ":Grad_Test_u", div = "(Id(meshdim):Grad_Test_u)";
+
+  // Closed form determinant and cofactors of F = Id + Grad_u
+  auto f = [&](int i, int j)
+  { return "(" + std::string(i == j ? "1+" : "") + g(i, j) + ")"; };
+  std::vector<std::string> cof(N*N);
+  std::string det;
+  if (N == 2) {
+    cof = { f(1,1), "(-" + f(1,0) + ")", "(-" + f(0,1) + ")", f(0,0) };
+    det = "(" + f(0,0) + "*" + f(1,1) + "-" + f(0,1) + "*" + f(1,0) + ")";
+  } else {
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        cof[i*3+j] = "(" + f((i+1)%3, (j+1)%3) + "*" + f((i+2)%3, (j+2)%3)
+          + "-" + f((i+1)%3, (j+2)%3) + "*" + f((i+2)%3, (j+1)%3) + ")";
+    det = "(0";
+    for (int j = 0; j < 3; ++j) det += "+" + f(0, j) + "*" + cof[j];
+    det += ")";
+  }
+
+  std::vector<scalar_type> params(1, 0.);
+  std::vector<std::pair<std::string, std::string>> exprs = {
+    { "Trace(Grad_u)*Trace(Grad_Test_u)", tr + "*" + div },
+    { "Deviator(Grad_u):Deviator(Grad_Test_u)", literal([&](int i, int j)
+      { return g(i, j) + (i == j ? "-" + tr + "/" + sN.str() : ""); }) + T },
+    { "Grad_u':Grad_Test_u",
+      literal([&](int i, int j) { return g(j, i); }) + T },
+    { "Grad_u:Grad_Test_u'",
+      literal([&](int i, int j) { return g(j, i); }) + T },
+    { "Sym(Grad_u):Sym(Grad_Test_u)", literal([&](int i, int j)
+      { return "0.5*(" + g(i, j) + "+" + g(j, i) + ")"; }) + T },
+    { "Skew(Grad_u):Skew(Grad_Test_u)", literal([&](int i, int j)
+      { return "0.5*(" + g(i, j) + "-" + g(j, i) + ")"; }) + T },
+    { "Det(Id(meshdim)+Grad_u)*Div_Test_u", det + "*" + div },
+    { "Inv(Id(meshdim)+Grad_u):Grad_Test_u", literal([&](int i, int j)
+      { return cof[j*N+i] + "/" + det; }) + T }
+  };
+  for (const auto &e : exprs)
+    compare_nonlinear_terms(mim, mf_u, U, params, e.first, e.second);
+
+  /* For u = (-x, 0, ...), Id+Grad_u is singular of rank N-1: its
+     determinant vanishes but not its first derivative (the cofactor
+     matrix), nor its second derivative for N = 3. */
+  for (size_type i = 0; i < mf_u.nb_dof(); ++i)
+    U[i] = (i % N == 0) ? -mf_u.point_of_basic_dof(i)[0] : scalar_type(0);
+  compare_nonlinear_terms(mim, mf_u, U, params,
+                          "Det(Id(meshdim)+Grad_u)*Div_Test_u",
+                          det + "*" + div);
+  compare_nonlinear_terms(mim, mf_u, U, params,
+                          "sqr(1+Det(Id(meshdim)+Grad_u))",
+                          "sqr(1+" + det + ")");
+}
+
+/* The Von_Mises_projection and Ball_projection operators against the
+   projections written with min and Norm, and their symbolic derivatives.
+   The radius depends on u to test the derivatives with respect to it. */
+static void test_projection_operators(int N) {
+  getfem::mesh m;
+  bgeot::pgeometric_trans pgt = bgeot::simplex_geotrans(N, 1);
+  getfem::regular_unit_mesh(m, std::vector<size_type>(N, 3), pgt);
+  getfem::mesh_fem mf_u(m, dim_type(N));
+  mf_u.set_classical_finite_element(2);
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(m.convex_index(), 4);
+
+  std::vector<scalar_type> U(mf_u.nb_dof());
+  gmm::fill_random(U);
+  gmm::scale(U, scalar_type(0.1));
+
+  // Thresholds chosen so that only a part of the points are projected.
+  std::vector<scalar_type> params(1, 0.8);
+  std::string s = "(params*(1+sqr(Trace(Grad_u))))";
+  compare_nonlinear_terms
+    (mim, mf_u, U, params,
+     "Von_Mises_projection(Grad_u," + s + "):Grad_Test_u",
+     "(Grad_u-Deviator(Grad_u)+min(1," + s + "/Norm(Deviator(Grad_u)))"
+     "*Deviator(Grad_u)):Grad_Test_u");
+  params[0] = 0.05;
+  std::string r = "(params*(1+sqr(u(1))))";
+  compare_nonlinear_terms
+    (mim, mf_u, U, params, "Ball_projection(u," + r + ").Test_u",
+     "(min(1," + r + "/Norm(u))*u).Test_u");
+}
+
 int main(int argc, char *argv[]) {
   
   GETFEM_MPI_INIT(argc, argv);
@@ -895,6 +1097,12 @@ int main(int argc, char *argv[]) {
   
   test_new_assembly(2, 25, 2);
   test_new_assembly(3, 7, 2);
+  test_hyperelastic_PK1(2);
+  test_hyperelastic_PK1(3);
+  test_unrolled_matrix_operators(2);
+  test_unrolled_matrix_operators(3);
+  test_projection_operators(2);
+  test_projection_operators(3);
 
 
   // testbug();
@@ -0,0 +1,320 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent.
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/* Round trips through the binary files of bgeot_binary_file.h, of the
+   mesh, mesh_fem and mesh_im objects, of the time series and of the model
+   checkpoints, including the reading of a file whose writing has been
+   interrupted after a flush(). */
+
+#include "getfem/bgeot_binary_file.h"
+#include "getfem/getfem_time_series.h"
+#include "getfem/getfem_regular_meshes.h"
+#include "getfem/getfem_models.h"
+
+using std::endl; using std::cout; using std::cerr;
+using bgeot::size_type;
+using bgeot::scalar_type;
+
+static std::vector<scalar_type> values(size_type n, scalar_type a) {
+  std::vector<scalar_type> v(n);
+  for (size_type i = 0; i < n; ++i) v[i] = a + scalar_type(i) * 0.5;
+  return v;
+}
+
+static void check_section(const bgeot::binary_file_reader &f,
+                          const std::string &tag, size_type id,
+                          const std::vector<scalar_type> &v) {
+  std::vector<scalar_type> w;
+  f.read_section(tag, id, w);
+  GMM_ASSERT1(w == v, "Wrong values for section " << tag << " " << id);
+}
+
+static void test_flush(bool compress) {
+  const std::string name = "test_binary_file.bin";
+  std::vector<scalar_type> a = values(1000, 1.), b = values(300000, 2.),
+    c = values(5000, 3.);
+  std::vector<size_type> idx = { 0, 3, size_type(-1), 7 };
+  std::vector<std::string> strs = { "first", "", "third" };
+
+  {
+    bgeot::binary_file_writer w(name);
+    w.set_compression(compress);
+    w.write_section("A", 0, a);
+    w.write_index_section("IDX", 0, idx);
+    w.write_string_section("STR", 0, strs);
+    w.flush();
+
+    /* The writing is interrupted here: a section is appended after the
+       flush, larger than the buffer of the stream, and the file is read
+       while it is not closed. The content up to the flush is readable. */
+    w.write_section("B", 1, b);
+    {
+      bgeot::binary_file_reader r(name);
+      check_section(r, "A", 0, a);
+      GMM_ASSERT1(!r.has_section("B", 1), "Section written after the "
+                  "flush is in the table of contents");
+      std::vector<size_type> idx2;
+      r.read_index_section("IDX", 0, idx2);
+      GMM_ASSERT1(idx2 == idx, "Wrong index section");
+      std::vector<std::string> strs2;
+      r.read_string_section("STR", 0, strs2);
+      GMM_ASSERT1(strs2 == strs, "Wrong string section");
+    }
+
+    w.flush();
+    w.write_section("C", 2, c);
+    {
+      bgeot::binary_file_reader r(name);
+      check_section(r, "A", 0, a);
+      check_section(r, "B", 1, b);
+      GMM_ASSERT1(!r.has_section("C", 2), "Section written after the "
+                  "flush is in the table of contents");
+    }
+  } // closed by the destructor
+
+  bgeot::binary_file_reader r(name);
+  check_section(r, "A", 0, a);
+  check_section(r, "B", 1, b);
+  check_section(r, "C", 2, c);
+  GMM_ASSERT1(r.section_ids("B") == std::vector<size_type>(1, 1),
+              "Wrong section ids");
+}
+
+static void test_mesh_objects(bool compress) {
+  const std::string name = "test_binary_file.msh";
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(2, 4),
+                            bgeot::simplex_geotrans(2, 1));
+  // Holes in the numbering of the convexes and of the points
+  m.sup_convex(3, true);
+  m.sup_convex(10, true);
+  m.region(1).add(5);
+  m.region(1).add(6, 1);
+  m.region(4).add(7, 0);
+
+  getfem::mesh_fem mf(m, 2);
+  mf.set_classical_finite_element(1);
+  dal::bit_vector cvs2;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    if (cv % 3 == 0) cvs2.add(cv);
+  mf.set_finite_element(cvs2, getfem::classical_fem(m.trans_of_convex(0),
+                                                     2));
+  mf.set_dof_partition(5, 1);
+  dal::bit_vector kept;
+  for (size_type i = 0; i < mf.nb_basic_dof(); i += 2) kept.add(i);
+  mf.reduce_to_basic_dof(kept);
+
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(getfem::int_method_descriptor("IM_TRIANGLE(3)"));
+  mim.set_integration_method(cvs2,
+                             getfem::int_method_descriptor("IM_TRIANGLE(6)"));
+
+  {
+    bgeot::binary_file_writer w(name);
+    w.set_compression(compress);
+    m.write_to_binary_file(w);
+    mf.write_to_binary_file(w, 2);
+    mim.write_to_binary_file(w, 3);
+  }
+
+  getfem::mesh m2;
+  m2.read_from_file(name); // the binary format is detected
+  GMM_ASSERT1(m2.convex_index() == m.convex_index()
+              && m2.points().index() == m.points().index()
+              && m2.regions_index() == m.regions_index(), "Wrong mesh");
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    GMM_ASSERT1(m2.trans_of_convex(cv) == m.trans_of_convex(cv)
+                && m2.ind_points_of_convex(cv) == m.ind_points_of_convex(cv),
+                "Wrong convex " << cv);
+  for (dal::bv_visitor ip(m.points().index()); !ip.finished(); ++ip)
+    GMM_ASSERT1(gmm::vect_dist2(m2.points()[ip], m.points()[ip]) == 0.,
+                "Wrong point " << ip);
+  GMM_ASSERT1(m2.region(1).index() == m.region(1).index()
+              && m2.region(1).faces_of_convex(6)
+                 == m.region(1).faces_of_convex(6)
+              && m2.region(4).faces_of_convex(7)
+                 == m.region(4).faces_of_convex(7), "Wrong regions");
+
+  bgeot::binary_file_reader r(name);
+  getfem::mesh_fem mf2(m2);
+  mf2.read_from_binary_file(r, 2);
+  GMM_ASSERT1(mf2.get_qdim() == 2 && mf2.nb_basic_dof() == mf.nb_basic_dof()
+              && mf2.nb_dof() == mf.nb_dof() && mf2.is_reduced()
+              && mf2.get_dof_partition(5) == 1, "Wrong mesh_fem");
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+    GMM_ASSERT1(mf2.fem_of_element(cv) == mf.fem_of_element(cv),
+                "Wrong fem on convex " << cv);
+    const auto &d = mf.ind_basic_dof_of_element(cv);
+    const auto &d2 = mf2.ind_basic_dof_of_element(cv);
+    GMM_ASSERT1(std::vector<size_type>(d.begin(), d.end())
+                == std::vector<size_type>(d2.begin(), d2.end()),
+                "Wrong dofs on convex " << cv);
+  }
+  std::vector<scalar_type> V = values(mf.nb_basic_dof(), 1.);
+  std::vector<scalar_type> RV(mf.nb_dof()), RV2(mf.nb_dof());
+  gmm::mult(mf.reduction_matrix(), V, RV);
+  gmm::mult(mf2.reduction_matrix(), V, RV2);
+  GMM_ASSERT1(RV == RV2, "Wrong reduction matrix");
+  gmm::mult(mf.extension_matrix(), RV, V);
+  std::vector<scalar_type> V2(mf.nb_basic_dof());
+  gmm::mult(mf2.extension_matrix(), RV, V2);
+  GMM_ASSERT1(V == V2, "Wrong extension matrix");
+
+  getfem::mesh_im mim2(m2);
+  mim2.read_from_binary_file(r, 3);
+  GMM_ASSERT1(mim2.convex_index() == mim.convex_index(), "Wrong mesh_im");
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    GMM_ASSERT1(mim2.int_method_of_element(cv)
+                == mim.int_method_of_element(cv),
+                "Wrong integration method on convex " << cv);
+}
+
+static void test_time_series(bool compress) {
+  const std::string name = "test_binary_file.ts";
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(2, 4),
+                            bgeot::simplex_geotrans(2, 1));
+  getfem::mesh_fem mf(m, 2);
+  mf.set_classical_finite_element(2);
+  size_type nbd = mf.nb_dof();
+
+  {
+    getfem::time_series_writer w(name, compress);
+    size_type iu = w.add_field("u", mf);
+    size_type ip = w.add_field("p");
+    for (size_type s = 0; s < 3; ++s) {
+      w.new_step(0.1 * scalar_type(s));
+      w.write_field(iu, values(nbd, scalar_type(s)));
+      w.write_field(ip, values(3, -scalar_type(s)));
+      if (s == 1) w.flush();
+    }
+
+    // The steps written before the flush are readable.
+    getfem::time_series_reader r(name);
+    GMM_ASSERT1(r.nb_steps() == 2 && r.nb_fields() == 2,
+                "Wrong number of steps or fields after a flush");
+    std::vector<scalar_type> v;
+    r.read_field(1, iu, v);
+    GMM_ASSERT1(v == values(nbd, 1.), "Wrong field value");
+  }
+
+  getfem::time_series_reader r(name);
+  GMM_ASSERT1(r.nb_steps() == 3, "Wrong number of steps");
+  GMM_ASSERT1(gmm::abs(r.time(2) - 0.2) < 1e-15, "Wrong time");
+  size_type iu = r.field_index("u"), ip = r.field_index("p");
+  GMM_ASSERT1(iu != size_type(-1) && ip != size_type(-1)
+              && r.field_on_mesh_fem(iu) && !r.field_on_mesh_fem(ip),
+              "Wrong field descriptions");
+  getfem::mesh m2;
+  r.read_mesh(m2);
+  GMM_ASSERT1(m2.convex_index() == m.convex_index()
+              && m2.nb_points() == m.nb_points(), "Wrong mesh");
+  getfem::mesh_fem mf2(m2);
+  r.read_mesh_fem(iu, mf2);
+  GMM_ASSERT1(mf2.nb_dof() == nbd, "Wrong mesh_fem");
+  for (size_type s = 0; s < 3; ++s) {
+    std::vector<scalar_type> v;
+    r.read_field(s, iu, v);
+    GMM_ASSERT1(v == values(nbd, scalar_type(s)), "Wrong field value");
+    r.read_field(s, ip, v);
+    GMM_ASSERT1(v == values(3, -scalar_type(s)), "Wrong field value");
+  }
+
+  // The data of several sections is held at the same time.
+  std::vector<bgeot::binary_section<scalar_type>> data;
+  for (size_type s = 0; s < 3; ++s)
+    data.push_back(r.field_data<scalar_type>(s, iu));
+  for (size_type s = 0; s < 3; ++s)
+    GMM_ASSERT1(std::vector<scalar_type>(data[s].begin(), data[s].end())
+                == values(nbd, scalar_type(s)), "Wrong field data");
+
+  // The sections are read by all the threads at the same time.
+  size_type nb_threads = getfem::true_thread_policy::num_threads();
+  std::vector<int> errors(nb_threads, 0);
+  GETFEM_OMP_PARALLEL_NO_PARTITION(
+    for (size_type s = 0; s < 3; ++s) {
+      std::vector<scalar_type> v;
+      r.read_field(s, iu, v);
+      if (v != values(nbd, scalar_type(s)))
+        ++errors[getfem::true_thread_policy::this_thread()];
+    }
+  )
+  for (size_type t = 0; t < nb_threads; ++t)
+    GMM_ASSERT1(errors[t] == 0, "Wrong field read on thread " << t);
+}
+
+static void test_checkpoint(void) {
+  const std::string name = "test_binary_file.ckp";
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(2, 3),
+                            bgeot::simplex_geotrans(2, 1));
+  getfem::mesh_fem mf(m, 2);
+  mf.set_classical_finite_element(1);
+  size_type nbd = mf.nb_dof();
+
+  getfem::model md;
+  md.add_fem_variable("u", mf, 2);
+  md.add_fixed_size_variable("v", 3);
+  md.set_time_step(0.25);
+  gmm::copy(values(nbd, 1.), md.set_real_variable("u", 0));
+  gmm::copy(values(nbd, 2.), md.set_real_variable("u", 1));
+  gmm::copy(values(3, 3.), md.set_real_variable("v"));
+  md.write_checkpoint(name);
+
+  getfem::model md2;
+  md2.add_fem_variable("u", mf, 2);
+  md2.add_fixed_size_variable("v", 3);
+  md2.read_checkpoint(name);
+  GMM_ASSERT1(md2.get_time_step() == 0.25, "Wrong time step");
+  GMM_ASSERT1(md2.real_variable("u", 0) == values(nbd, 1.)
+              && md2.real_variable("u", 1) == values(nbd, 2.)
+              && md2.real_variable("v") == values(3, 3.),
+              "Wrong variables read from the checkpoint");
+
+  /* "u" is valid but not "v": the checkpoint is rejected and "u" is left
+     unchanged. */
+  getfem::model md3;
+  md3.add_fem_variable("u", mf, 2);
+  md3.add_fixed_size_variable("v", 4);
+  gmm::copy(values(nbd, 5.), md3.set_real_variable("u", 0));
+  bool rejected = false;
+  try {
+    md3.read_checkpoint(name);
+  } catch (const gmm::gmm_error &) {
+    rejected = true;
+  }
+  GMM_ASSERT1(rejected, "Invalid checkpoint accepted");
+  GMM_ASSERT1(md3.real_variable("u", 0) == values(nbd, 5.),
+              "Model modified by an invalid checkpoint");
+}
+
+int main(void) {
+  for (int compress = 0; compress < 2; ++compress) {
+    if (compress && !bgeot::binary_file_writer::compression_available())
+      break;
+    test_flush(compress != 0);
+    test_mesh_objects(compress != 0);
+    test_time_series(compress != 0);
+  }
+  test_checkpoint();
+  cout << "binary files are ok\n";
+  return 0;
+}
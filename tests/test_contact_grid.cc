@@ -0,0 +1,121 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent.
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/* The nearest node search of the nodal contact bricks against a brute
+   force search, for nodes on curves and surfaces, degenerated sets of
+   nodes and points far from the nodes. */
+
+#include "getfem/getfem_contact_and_friction_nodal.h"
+
+using std::endl; using std::cout; using std::cerr;
+using bgeot::size_type;
+using bgeot::scalar_type;
+using bgeot::base_node;
+
+static scalar_type rnd(void)
+{ return scalar_type(rand()) / scalar_type(RAND_MAX); }
+
+static base_node random_point(size_type N, scalar_type a, scalar_type b) {
+  base_node P(N);
+  for (size_type k = 0; k < N; ++k) P[k] = a + (b - a) * rnd();
+  return P;
+}
+
+static scalar_type brute_force(const std::vector<base_node> &pts,
+                               const base_node &P, scalar_type max_dist2,
+                               size_type &ind) {
+  ind = size_type(-1);
+  for (size_type i = 0; i < pts.size(); ++i) {
+    scalar_type d2 = gmm::vect_dist2_sqr(pts[i], P);
+    if (d2 < max_dist2) { max_dist2 = d2; ind = i; }
+  }
+  return max_dist2;
+}
+
+static void check_nearest(const std::vector<base_node> &pts,
+                          const std::string &title) {
+  getfem::contact_node_grid grid(pts);
+  size_type N = pts.empty() ? 3 : pts[0].size(), nb = 0;
+  std::vector<base_node> queries;
+  for (size_type i = 0; i < 300; ++i)
+    queries.push_back(random_point(N, -1.5, 1.5)); // near the nodes
+  for (size_type i = 0; i < 20; ++i)
+    queries.push_back(random_point(N, -1e3, 1e3)); // far from the grid
+  queries.push_back(base_node(N));      // in the grid, far from the nodes
+  for (const base_node &P : pts) queries.push_back(P); // on the nodes
+
+  for (const base_node &P : queries)
+    for (scalar_type max_dist2 : { scalar_type(1e300), scalar_type(0.01) }) {
+      size_type ind1, ind2;
+      scalar_type d1 = grid.nearest_node(P, max_dist2, ind1);
+      scalar_type d2 = brute_force(pts, P, max_dist2, ind2);
+      GMM_ASSERT1(ind1 == ind2 && d1 == d2, title << ": wrong nearest node "
+                  "of " << P << ": " << ind1 << " instead of " << ind2);
+      if (ind1 != size_type(-1)) ++nb;
+    }
+  cout << title << ": " << nb << " nodes found for " << 2*queries.size()
+       << " searches\n";
+}
+
+int main(void) {
+  srand(1);
+  std::vector<base_node> pts;
+
+  check_nearest(pts, "no node");
+
+  pts.push_back(base_node(0.5, 0.5, 0.5));
+  check_nearest(pts, "one node");
+
+  // Nodes on a circle and on a sphere
+  pts.clear();
+  for (size_type i = 0; i < 500; ++i) {
+    scalar_type t = 2. * M_PI * rnd();
+    pts.push_back(base_node(cos(t), sin(t)));
+  }
+  check_nearest(pts, "circle");
+  pts.clear();
+  for (size_type i = 0; i < 2000; ++i) {
+    base_node P = random_point(3, -1., 1.);
+    if (gmm::vect_norm2(P) > 1e-3) pts.push_back(P / gmm::vect_norm2(P));
+  }
+  check_nearest(pts, "sphere");
+
+  // A plane face of a regular mesh, with duplicated nodes
+  pts.clear();
+  for (size_type i = 0; i <= 20; ++i)
+    for (size_type j = 0; j <= 20; ++j) {
+      base_node P(scalar_type(i) / 20., scalar_type(j) / 20., 0.25);
+      pts.push_back(P);
+      if ((i + j) % 7 == 0) pts.push_back(P);
+    }
+  check_nearest(pts, "plane with duplicates");
+
+  // Aligned nodes in 3D and nodes all at the same place
+  pts.clear();
+  for (size_type i = 0; i < 100; ++i)
+    pts.push_back(base_node(rnd(), 0., 0.));
+  check_nearest(pts, "segment");
+  pts.assign(10, base_node(0.1, 0.2, 0.3));
+  check_nearest(pts, "single location");
+
+  cout << "nearest node searches are ok\n";
+  return 0;
+}
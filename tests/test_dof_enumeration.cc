@@ -0,0 +1,114 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent.
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/* The dofs of a mesh_fem enumerated through the mesh vertices (fast path
+   of enumerate_dof) and with the kdtree have the same numbering. */
+
+#include "getfem/getfem_mesh_fem.h"
+#include "getfem/getfem_regular_meshes.h"
+
+using std::endl; using std::cout; using std::cerr;
+using bgeot::size_type;
+using bgeot::dim_type;
+
+namespace {
+
+  // mesh_fem identifying its dofs with the kdtree only.
+  struct kdtree_mesh_fem : public getfem::mesh_fem {
+    explicit kdtree_mesh_fem(const getfem::mesh &m, dim_type Q = 1)
+      : getfem::mesh_fem(m, Q) {}
+    bool enumerate_dof_by_topology() const override { return false; }
+  };
+
+  /* fem_name is a fem name, or "K" or "DK" for the classical continuous
+     or discontinuous elements of degree K. */
+  template <typename MF>
+  void set_fem(MF &mf, const std::string &fem_name) {
+    if (fem_name[0] == 'D')
+      mf.set_classical_discontinuous_finite_element
+        (dim_type(std::stoi(fem_name.substr(1))));
+    else if (isdigit(fem_name[0]))
+      mf.set_classical_finite_element(dim_type(std::stoi(fem_name)));
+    else
+      mf.set_finite_element(getfem::fem_descriptor(fem_name));
+  }
+
+  void check_same_dofs(const getfem::mesh &m, const std::string &fem_name,
+                       dim_type Q, bool partition, const std::string &name) {
+    getfem::mesh_fem mf(m, Q);
+    kdtree_mesh_fem mf_ref(m, Q);
+    set_fem(mf, fem_name); set_fem(mf_ref, fem_name);
+    // Two partitions: the dofs of their interface are not identified.
+    if (partition)
+      for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+        if (cv % 3 == 0)
+          { mf.set_dof_partition(cv, 1); mf_ref.set_dof_partition(cv, 1); }
+    GMM_ASSERT1(mf.nb_dof() == mf_ref.nb_dof(), name << " : " << mf.nb_dof()
+                << " dofs instead of " << mf_ref.nb_dof());
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+      auto dofs = mf.ind_basic_dof_of_element(cv);
+      auto dofs_ref = mf_ref.ind_basic_dof_of_element(cv);
+      GMM_ASSERT1(dofs.size() == dofs_ref.size()
+                  && std::equal(dofs.begin(), dofs.end(), dofs_ref.begin()),
+                  name << " : different dofs on element " << cv);
+    }
+    cout << name << " : " << mf.nb_dof() << " dofs, same numbering" << endl;
+  }
+
+  void test_mesh(const getfem::mesh &m, const std::string &mesh_name,
+                 const std::vector<std::string> &fems) {
+    for (const std::string &f : fems)
+      for (dim_type Q : {dim_type(1), dim_type(m.dim())})
+        for (bool partition : {false, true}) {
+          std::stringstream name;
+          name << mesh_name << ", " << f << ", Qdim " << int(Q)
+               << (partition ? ", partitioned" : "");
+          check_same_dofs(m, f, Q, partition, name.str());
+        }
+  }
+}
+
+int main(void) {
+  const std::vector<std::string> degrees = {"1", "2", "3", "D1", "D2"};
+  for (const char *gt : {"GT_PK(2,1)", "GT_PK(2,2)", "GT_QK(2,1)",
+                         "GT_QK(2,2)", "GT_PK(3,1)", "GT_QK(3,1)",
+                         "GT_PRISM(3,1)"}) {
+    getfem::mesh m;
+    bgeot::pgeometric_trans pgt = bgeot::geometric_trans_descriptor(gt);
+    getfem::regular_unit_mesh(m, std::vector<size_type>(pgt->dim(), 3), pgt,
+                              true);
+    // Holes in the numbering of the convexes.
+    for (size_type cv = 1; cv < m.nb_allocated_convex(); cv += 7)
+      m.sup_convex(cv);
+    test_mesh(m, gt, degrees);
+  }
+
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(2, 4),
+                            bgeot::simplex_geotrans(2, 1));
+  test_mesh(m, "GT_PK(2,1)", {"FEM_PK_WITH_CUBIC_BUBBLE(2,2)",
+                              "FEM_PK_HIERARCHICAL(2,3)", "FEM_HERMITE(2)"});
+
+  getfem::mesh mb;
+  getfem::regular_ball_mesh(mb, "GT='GT_QK(2,2)'; NSUBDIV=[2,3]");
+  test_mesh(mb, "ball", degrees);
+  return 0;
+}
@@ -0,0 +1,279 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent.
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/* Checks the content of the files written by the VTU exports (inline
+   base64 and parallel) and by the asynchronous export queue. */
+
+#include "getfem/getfem_export.h"
+#include "getfem/getfem_export_queue.h"
+#include "getfem/getfem_regular_meshes.h"
+#include <cstring>
+
+using std::endl; using std::cout; using std::cerr;
+using bgeot::size_type;
+using bgeot::scalar_type;
+
+static std::string file_content(const std::string &name) {
+  std::ifstream f(name.c_str(), std::ios::binary);
+  GMM_ASSERT1(f, "cannot open " << name);
+  std::stringstream s; s << f.rdbuf();
+  return s.str();
+}
+
+static bool file_exists(const std::string &name)
+{ std::ifstream f(name.c_str()); return bool(f); }
+
+static size_type count(const std::string &s, const std::string &w) {
+  size_type n = 0;
+  for (size_type p = s.find(w); p != std::string::npos; p = s.find(w, p+1))
+    ++n;
+  return n;
+}
+
+static size_type attribute(const std::string &s, const std::string &att,
+                           size_type from = 0) {
+  size_type p = s.find(att + "=\"", from);
+  GMM_ASSERT1(p != std::string::npos, "no attribute " << att);
+  return size_type(std::stoul(s.substr(p + att.size() + 2)));
+}
+
+/* Values of the data array "name" of a piece written in the appended raw
+   format. */
+static std::vector<float> appended_array(const std::string &s,
+                                         const std::string &name) {
+  size_type p = s.find("Name=\"" + name + "\"");
+  GMM_ASSERT1(p != std::string::npos, "no data array " << name);
+  size_type offset = attribute(s, "offset", p);
+  size_type start = s.find("<AppendedData encoding=\"raw\">\n_");
+  GMM_ASSERT1(start != std::string::npos, "no appended data");
+  const char *d = s.data() + s.find('_', start) + 1 + offset;
+  gmm::uint64_type nb;
+  memcpy(&nb, d, sizeof(nb));
+  std::vector<float> v(nb / sizeof(float));
+  memcpy(v.data(), d + sizeof(nb), nb);
+  return v;
+}
+
+static std::string base64_decode(const std::string &s) {
+  static const std::string chars =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string r;
+  unsigned acc = 0; int nb = 0;
+  for (char c : s) {
+    size_type k = chars.find(c);
+    if (k == std::string::npos) continue; // padding and blanks
+    acc = (acc << 6) | unsigned(k); nb += 6;
+    if (nb >= 8) { nb -= 8; r.push_back(char((acc >> nb) & 0xFF)); }
+  }
+  return r;
+}
+
+/* Byte count header and values of the data array "name" written inline in
+   base64. */
+static std::vector<float> base64_array(const std::string &s,
+                                       const std::string &name,
+                                       unsigned &nb_bytes) {
+  size_type p = s.find("Name=\"" + name + "\"");
+  GMM_ASSERT1(p != std::string::npos, "no data array " << name);
+  size_type b = s.find('\n', p) + 1, e = s.find("</DataArray>", b);
+  std::string d = base64_decode(s.substr(b, e - b));
+  GMM_ASSERT1(d.size() >= sizeof(unsigned), "no header");
+  memcpy(&nb_bytes, d.data(), sizeof(unsigned));
+  std::vector<float> v((d.size() - sizeof(unsigned)) / sizeof(float));
+  memcpy(v.data(), d.data() + sizeof(unsigned), v.size() * sizeof(float));
+  return v;
+}
+
+/* Inline base64 arrays are preceded by their size in bytes, and the cell
+   data of a mesh_fem defined on a part of the mesh only has the values of
+   its convexes. */
+static void test_base64(void) {
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(2, 4),
+                            bgeot::simplex_geotrans(2, 1));
+  getfem::mesh_fem mf(m);
+  dal::bit_vector cvs;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    if (cv % 3 != 1) cvs.add(cv);
+  mf.set_finite_element(cvs, getfem::classical_fem(m.trans_of_convex(0), 1));
+
+  std::vector<scalar_type> X(mf.nb_dof()), C(m.convex_index().card());
+  for (size_type i = 0; i < mf.nb_dof(); ++i)
+    X[i] = mf.point_of_basic_dof(i)[0];
+  for (size_type i = 0; i < C.size(); ++i) C[i] = scalar_type(i);
+
+  std::stringstream s;
+  {
+    getfem::vtu_export exp(s);
+    exp.exporting(mf);
+    exp.write_point_data(mf, X, "x");
+    exp.write_cell_data(C, "cv");
+  }
+  std::string vtu = s.str();
+  size_type nbp = attribute(vtu, "NumberOfPoints");
+  size_type nbc = attribute(vtu, "NumberOfCells");
+  GMM_ASSERT1(nbc == cvs.card(), "wrong number of cells");
+
+  unsigned nb_bytes;
+  std::vector<float> x = base64_array(vtu, "x", nb_bytes);
+  GMM_ASSERT1(x.size() == nbp && nb_bytes == nbp * sizeof(float),
+              "wrong header of the point data");
+  std::vector<float> c = base64_array(vtu, "cv", nb_bytes);
+  GMM_ASSERT1(c.size() == nbc && nb_bytes == nbc * sizeof(float),
+              "wrong header of the cell data");
+  size_type k = 0, i = 0;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv, ++i)
+    if (cvs.is_in(cv))
+      GMM_ASSERT1(c[k++] == float(C[i]), "wrong cell data");
+}
+
+static void test_pvtu(void) {
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(2, 6),
+                            bgeot::simplex_geotrans(2, 1));
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(1);
+  size_type nbcv = m.convex_index().card();
+
+  std::vector<scalar_type> X(mf.nb_dof()), C(nbcv);
+  for (size_type i = 0; i < mf.nb_dof(); ++i) X[i] = mf.point_of_basic_dof(i)[0];
+  size_type k = 0;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv, ++k)
+    C[k] = scalar_type(cv);
+
+  const size_type nb_pieces = 3;
+  std::remove("test_export.pvtu");
+  {
+    getfem::pvtu_export exp("test_export", nb_pieces);
+    exp.exporting(mf);
+    exp.write_mesh();
+    exp.write_point_data(mf, X, "x");
+    exp.write_cell_data(C, "cv");
+    GMM_ASSERT1(exp.nb_exported_pieces() == nb_pieces, "wrong nb of pieces");
+    GMM_ASSERT1(!file_exists("test_export.pvtu"), ".pvtu written too early");
+    exp.close();
+    exp.close(); // no effect
+    bool closed = false;
+    try { exp.write_cell_data(C, "cv2"); }
+    catch (const gmm::gmm_error &) { closed = true; }
+    GMM_ASSERT1(closed, "data written after close()");
+  }
+
+  std::string pvtu = file_content("test_export.pvtu");
+  GMM_ASSERT1(count(pvtu, "<Piece Source=") == nb_pieces
+              && count(pvtu, "Name=\"x\"") == 1
+              && count(pvtu, "Name=\"cv\"") == 1, "wrong .pvtu file");
+
+  /* Each convex is in exactly one piece. */
+  dal::bit_vector seen;
+  size_type nb_cells = 0;
+  for (size_type i = 0; i < nb_pieces; ++i) {
+    std::stringstream name; name << "test_export_" << i << ".vtu";
+    std::string piece = file_content(name.str());
+    GMM_ASSERT1(pvtu.find(name.str()) != std::string::npos,
+                "piece " << name.str() << " not referenced");
+    size_type nbp = attribute(piece, "NumberOfPoints");
+    size_type nbc = attribute(piece, "NumberOfCells");
+    std::vector<float> x = appended_array(piece, "x");
+    std::vector<float> c = appended_array(piece, "cv");
+    GMM_ASSERT1(x.size() == nbp && c.size() == nbc, "wrong array sizes");
+    for (float v : x) GMM_ASSERT1(v >= 0.f && v <= 1.f, "wrong point data");
+    for (float v : c) {
+      size_type cv = size_type(v);
+      GMM_ASSERT1(m.convex_index().is_in(cv) && !seen.is_in(cv),
+                  "wrong cell data");
+      seen.add(cv);
+    }
+    nb_cells += nbc;
+  }
+  GMM_ASSERT1(nb_cells == nbcv && seen.card() == nbcv,
+              "the pieces do not cover the mesh");
+
+  /* Without close(), no .pvtu file is written. */
+  std::remove("test_export.pvtu");
+  {
+    getfem::pvtu_export exp("test_export", nb_pieces);
+    exp.exporting(mf);
+    exp.write_mesh();
+  }
+  GMM_ASSERT1(!file_exists("test_export.pvtu"), "unexpected .pvtu file");
+}
+
+static void test_async_queue(void) {
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(2, 4),
+                            bgeot::simplex_geotrans(2, 1));
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(1);
+  std::vector<scalar_type> U(mf.nb_dof());
+
+  getfem::async_export_queue queue(2);
+  std::vector<size_type> done;
+  std::vector<std::string> contents;
+  for (size_type step = 0; step < 4; ++step) {
+    /* The file is formatted on this thread, only its writing is done by
+       the queue. */
+    for (size_type i = 0; i < U.size(); ++i) U[i] = scalar_type(i + step);
+    std::stringstream s;
+    {
+      getfem::vtu_export exp(s);
+      exp.set_vtu_binary_format(getfem::vtk_export::VTU_APPENDED_RAW);
+      exp.exporting(mf);
+      exp.write_point_data(mf, U, "u");
+    }
+    contents.push_back(s.str());
+    /* The arrays spilled one by one to the appended data section. */
+    std::vector<float> u = appended_array(s.str(), "u");
+    GMM_ASSERT1(u.size() == U.size(), "wrong size of the appended array");
+    for (size_type i = 0; i < U.size(); ++i)
+      GMM_ASSERT1(u[i] == float(U[i]), "wrong appended value");
+    std::stringstream name; name << "test_export_async_" << step << ".vtu";
+    queue.write_file(name.str(), s.str());
+    queue.push([&done, step]() { done.push_back(step); });
+    GMM_ASSERT1(queue.nb_pending() <= 2, "too many pending tasks");
+  }
+  queue.wait();
+  GMM_ASSERT1(queue.nb_pending() == 0, "pending tasks after wait()");
+  GMM_ASSERT1(done == std::vector<size_type>({0, 1, 2, 3}),
+              "tasks not executed in order");
+  for (size_type step = 0; step < 4; ++step) {
+    std::stringstream name; name << "test_export_async_" << step << ".vtu";
+    GMM_ASSERT1(file_content(name.str()) == contents[step],
+                "wrong content of " << name.str());
+  }
+
+  /* An error in a task is thrown again on this thread. */
+  queue.push([]() { GMM_ASSERT1(false, "error in a task"); });
+  bool thrown = false;
+  try { queue.wait(); } catch (const gmm::gmm_error &) { thrown = true; }
+  GMM_ASSERT1(thrown, "the error of the task is lost");
+  queue.push([&done]() { done.push_back(4); });
+  queue.wait();
+  GMM_ASSERT1(done.size() == 5, "the queue is not usable after an error");
+}
+
+int main(void) {
+  test_base64();
+  test_pvtu();
+  test_async_queue();
+  cout << "exports are ok\n";
+  return 0;
+}
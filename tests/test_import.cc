@@ -0,0 +1,187 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent.
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/* Import of the same mesh written in the gmsh formats 2.2 and 4.1 (ASCII
+   and binary, with dense and sparse node tags). */
+
+#include "getfem/getfem_import.h"
+#include "getfem/getfem_mesh.h"
+
+using std::endl; using std::cout; using std::cerr;
+using bgeot::size_type;
+using bgeot::scalar_type;
+
+/* A 3x2 grid of the unit square: a row of quadrangles (region 1), a row of
+   triangles (region 3) and the lines of the bottom side (region 2). */
+struct gmsh_element { unsigned type, region; std::vector<size_type> nodes; };
+
+static void grid(std::vector<scalar_type> &coords,
+                 std::vector<gmsh_element> &elts) {
+  for (size_type j = 0; j < 3; ++j)
+    for (size_type i = 0; i < 4; ++i) {
+      coords.push_back(scalar_type(i) / 3.);
+      coords.push_back(scalar_type(j) / 2.);
+      coords.push_back(0.);
+    }
+  for (size_type i = 0; i < 3; ++i)
+    elts.push_back({3, 1, {i, i+1, i+5, i+4}});
+  for (size_type i = 0; i < 3; ++i) {
+    elts.push_back({2, 3, {i+4, i+5, i+9}});
+    elts.push_back({2, 3, {i+4, i+9, i+8}});
+  }
+  for (size_type i = 0; i < 3; ++i)
+    elts.push_back({1, 2, {i, i+1}});
+}
+
+static const char *physical_names =
+  "$PhysicalNames\n3\n2 1 \"quads\"\n1 2 \"bottom\"\n2 3 \"triangles\"\n"
+  "$EndPhysicalNames\n";
+
+static std::string gmsh22(void) {
+  std::vector<scalar_type> coords; std::vector<gmsh_element> elts;
+  grid(coords, elts);
+  std::stringstream s;
+  s.precision(17);
+  s << "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n" << physical_names;
+  s << "$Nodes\n" << coords.size() / 3 << "\n";
+  for (size_type i = 0; i < coords.size() / 3; ++i)
+    s << i+1 << " " << coords[3*i] << " " << coords[3*i+1] << " "
+      << coords[3*i+2] << "\n";
+  s << "$EndNodes\n$Elements\n" << elts.size() << "\n";
+  for (size_type i = 0; i < elts.size(); ++i) {
+    s << i+1 << " " << elts[i].type << " 2 " << elts[i].region << " "
+      << elts[i].region;
+    for (size_type n : elts[i].nodes) s << " " << n+1;
+    s << "\n";
+  }
+  s << "$EndElements\n";
+  return s.str();
+}
+
+template <typename T> static void put(std::ostream &s, T v)
+{ s.write(reinterpret_cast<const char *>(&v), sizeof(T)); }
+
+/* Format 4.1, the nodes being split in two entity blocks. In binary, the
+   sizes are written on data_size bytes. */
+static std::string gmsh41(bool binary, size_type data_size,
+                          size_type tag_step) {
+  std::vector<scalar_type> coords; std::vector<gmsh_element> elts;
+  grid(coords, elts);
+  size_type nbn = coords.size() / 3;
+  auto tag = [tag_step](size_type i) { return (i+1) * tag_step; };
+
+  std::stringstream s;
+  s.precision(17);
+  auto size = [&](size_type v) {
+    if (!binary) s << v << " ";
+    else if (data_size == 8) put(s, gmm::uint64_type(v));
+    else put(s, gmm::uint32_type(v));
+  };
+  auto integer = [&](int v) { if (binary) put(s, v); else s << v << " "; };
+  auto real = [&](double v) { if (binary) put(s, v); else s << v << " "; };
+  auto eol = [&]() { if (!binary) s << "\n"; };
+
+  s << "$MeshFormat\n4.1 " << (binary ? 1 : 0) << " " << data_size << "\n";
+  if (binary) { put(s, int(1)); s << "\n"; }
+  s << "$EndMeshFormat\n" << physical_names;
+
+  s << "$Nodes\n";
+  size(2); size(nbn); size(tag(0)); size(tag(nbn-1)); eol();
+  size_type blocks[3] = { 0, 5, nbn };
+  for (size_type b = 0; b < 2; ++b) {
+    integer(2); integer(int(b+1)); integer(0);
+    size(blocks[b+1] - blocks[b]); eol();
+    for (size_type i = blocks[b]; i < blocks[b+1]; ++i) { size(tag(i)); eol(); }
+    for (size_type i = blocks[b]; i < blocks[b+1]; ++i) {
+      real(coords[3*i]); real(coords[3*i+1]); real(coords[3*i+2]); eol();
+    }
+  }
+  s << "\n$EndNodes\n";
+
+  s << "$Elements\n";
+  size(3); size(elts.size()); size(1); size(elts.size()); eol();
+  for (size_type i = 0; i < elts.size(); ) {
+    size_type j = i;
+    while (j < elts.size() && elts[j].type == elts[i].type) ++j;
+    integer(elts[i].type == 1 ? 1 : 2); integer(int(elts[i].region));
+    integer(int(elts[i].type)); size(j - i); eol();
+    for (; i < j; ++i) {
+      size(i+1);
+      for (size_type n : elts[i].nodes) size(tag(n));
+      eol();
+    }
+  }
+  s << "\n$EndElements\n";
+  return s.str();
+}
+
+static void import(const std::string &content, getfem::mesh &m) {
+  std::stringstream s(content);
+  std::map<std::string, size_type> region_map;
+  getfem::import_mesh_gmsh(s, m, region_map);
+  GMM_ASSERT1(region_map.size() == 3 && region_map["quads"] == 1
+              && region_map["bottom"] == 2 && region_map["triangles"] == 3,
+              "Wrong region names");
+}
+
+static void check_same_mesh(const getfem::mesh &m, const getfem::mesh &m2) {
+  GMM_ASSERT1(m2.dim() == 2 && m2.nb_points() == m.nb_points()
+              && m2.convex_index() == m.convex_index(), "Wrong mesh");
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+    GMM_ASSERT1(m2.trans_of_convex(cv) == m.trans_of_convex(cv),
+                "Wrong geometric transformation of convex " << cv);
+    for (size_type k = 0; k < m.nb_points_of_convex(cv); ++k)
+      GMM_ASSERT1(gmm::vect_dist2(m.points_of_convex(cv)[k],
+                                  m2.points_of_convex(cv)[k]) < 1e-14,
+                  "Wrong points of convex " << cv);
+  }
+  GMM_ASSERT1(m2.regions_index() == m.regions_index(), "Wrong regions");
+  for (dal::bv_visitor rg(m.regions_index()); !rg.finished(); ++rg)
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+      GMM_ASSERT1(m.region(rg).faces_of_convex(cv)
+                  == m2.region(rg).faces_of_convex(cv)
+                  && m.region(rg).is_in(cv) == m2.region(rg).is_in(cv),
+                  "Wrong region " << rg);
+}
+
+int main(void) {
+  getfem::mesh m;
+  import(gmsh22(), m);
+  GMM_ASSERT1(m.dim() == 2 && m.nb_points() == 12
+              && m.convex_index().card() == 9, "Wrong reference mesh");
+  GMM_ASSERT1(m.region(1).index().card() == 3
+              && m.region(3).index().card() == 6, "Wrong element regions");
+  size_type nb_faces = 0;
+  for (getfem::mr_visitor i(m.region(2)); !i.finished(); ++i, ++nb_faces)
+    GMM_ASSERT1(i.is_face(), "The lines are not faces");
+  GMM_ASSERT1(nb_faces == 3, "Wrong face region");
+
+  for (int binary = 0; binary < 2; ++binary)
+    for (size_type data_size : {4, 8})
+      for (size_type tag_step : {1, 1000}) {
+        if (!binary && data_size == 4) continue;
+        getfem::mesh m2;
+        import(gmsh41(binary != 0, data_size, tag_step), m2);
+        check_same_mesh(m, m2);
+      }
+  cout << "gmsh import is ok\n";
+  return 0;
+}
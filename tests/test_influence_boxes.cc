@@ -0,0 +1,235 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent.
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/* The hierarchy on the influence boxes of multi_contact_frame: the boxes
+   found by the built and refitted hierarchies against a brute force
+   search, and the contact pairs of a frame refitting its hierarchy from
+   a computation to the next against those of new frames. */
+
+#include "getfem/getfem_contact_and_friction_common.h"
+#include "getfem/getfem_regular_meshes.h"
+#include <random>
+
+using std::endl; using std::cout; using std::cerr;
+using bgeot::size_type;
+using bgeot::scalar_type;
+using bgeot::base_node;
+using getfem::influence_box_tree;
+
+namespace {
+
+  std::mt19937 gen;
+
+  scalar_type rnd(scalar_type a, scalar_type b)
+  { return std::uniform_real_distribution<scalar_type>(a, b)(gen); }
+
+  // nb boxes of half size at most h centered in [0, L]^N.
+  void random_boxes(size_type N, size_type nb, scalar_type L, scalar_type h,
+                    std::vector<scalar_type> &bmin,
+                    std::vector<scalar_type> &bmax) {
+    bmin.resize(N*nb); bmax.resize(N*nb);
+    for (size_type i = 0; i < N*nb; ++i) {
+      scalar_type c = rnd(0., L), r = rnd(0., h);
+      bmin[i] = c - r; bmax[i] = c + r;
+    }
+  }
+
+  /* The boxes found at random points and at the corners of the boxes
+     (on their boundary) are those of a brute force search. The searches
+     in the hierarchy are done in parallel. */
+  void check_queries(const influence_box_tree &tree, size_type N,
+                     const std::vector<scalar_type> &bmin,
+                     const std::vector<scalar_type> &bmax,
+                     const std::string &name) {
+    size_type nb = bmin.size() / N;
+    GMM_ASSERT1(tree.nb_boxes() == nb, name << " : wrong number of boxes");
+    scalar_type lo(1E300), hi(-1E300);
+    for (size_type i = 0; i < N*nb; ++i)
+      { lo = std::min(lo, bmin[i]); hi = std::max(hi, bmax[i]); }
+    std::vector<base_node> pts;
+    for (size_type i = 0; i < 2000; ++i) {
+      base_node P(N);
+      for (size_type k = 0; k < N; ++k) P[k] = rnd(lo - 0.1, hi + 0.1);
+      pts.push_back(P);
+    }
+    for (size_type i = 0; i < nb; i += 3) {
+      base_node P(N), Q(N);
+      for (size_type k = 0; k < N; ++k)
+        { P[k] = bmin[i*N+k]; Q[k] = bmax[i*N+k]; }
+      pts.push_back(P); pts.push_back(Q);
+    }
+
+    size_type nbpt = pts.size();
+    std::vector<std::vector<size_type>> found(nbpt);
+    GETFEM_OMP_FOR(size_type ip = 0, ip < nbpt, ++ip,
+                   tree.find_boxes_at_point(pts[ip], found[ip]););
+    size_type nb_found = 0;
+    for (size_type ip = 0; ip < nbpt; ++ip) {
+      std::vector<size_type> ids;
+      for (size_type i = 0; i < nb; ++i) {
+        bool in = true;
+        for (size_type k = 0; k < N && in; ++k)
+          in = (pts[ip][k] >= bmin[i*N+k] && pts[ip][k] <= bmax[i*N+k]);
+        if (in) ids.push_back(i);
+      }
+      GMM_ASSERT1(ids == found[ip], name << " : wrong boxes at point "
+                  << pts[ip] << ", " << found[ip].size() << " instead of "
+                  << ids.size());
+      nb_found += ids.size();
+    }
+    cout << name << " : " << nb_found << " boxes found at " << nbpt
+         << " points" << endl;
+  }
+
+  void test_tree(size_type N) {
+    std::stringstream name; name << "dimension " << N;
+    influence_box_tree tree;
+    std::vector<scalar_type> bmin, bmax, b1, b2;
+    random_boxes(N, 1000, 1., 0.08, bmin, bmax);
+    b1 = bmin; b2 = bmax;
+    tree.build(N, b1, b2);
+    check_queries(tree, N, bmin, bmax, name.str() + ", built");
+    scalar_type built_extent = tree.built_extent;
+
+    // Small moves: the nodes are only refitted.
+    for (size_type i = 0; i < N*tree.nb_boxes(); ++i) {
+      scalar_type d = rnd(-0.01, 0.01);
+      bmin[i] += d; bmax[i] += d + rnd(0., 0.005);
+    }
+    b1 = bmin; b2 = bmax;
+    tree.refit(b1, b2);
+    GMM_ASSERT1(tree.built_extent == built_extent,
+                "Hierarchy built again after small moves");
+    check_queries(tree, N, bmin, bmax, name.str() + ", refitted");
+
+    // The boxes scattered on a larger domain: the refitted nodes are too
+    // loose and the hierarchy is built again.
+    random_boxes(N, tree.nb_boxes(), 4., 0.08, bmin, bmax);
+    b1 = bmin; b2 = bmax;
+    tree.refit(b1, b2);
+    GMM_ASSERT1(tree.built_extent != built_extent
+                && tree.built_extent == tree.total_extent(),
+                "Hierarchy not built again after large moves");
+    check_queries(tree, N, bmin, bmax, name.str() + ", refitted and rebuilt");
+
+    // Another set of boxes, smaller than a leaf, then no box.
+    random_boxes(N, 5, 1., 0.3, bmin, bmax);
+    b1 = bmin; b2 = bmax;
+    tree.build(N, b1, b2);
+    check_queries(tree, N, bmin, bmax, name.str() + ", a single leaf");
+    bmin.clear(); bmax.clear(); b1.clear(); b2.clear();
+    tree.build(N, b1, b2);
+    std::vector<size_type> ids(1);
+    tree.find_boxes_at_point(base_node(N), ids);
+    GMM_ASSERT1(ids.empty(), "Box found in an empty hierarchy");
+  }
+
+  // Faces of the boundary of m whose outward normal has a component
+  // along the last axis of sign s.
+  void add_faces(getfem::mesh &m, size_type region, scalar_type s) {
+    getfem::mesh_region border;
+    getfem::outer_faces_of_mesh(m, border);
+    for (getfem::mr_visitor i(border); !i.finished(); ++i) {
+      bgeot::base_small_vector n = m.normal_of_face_of_convex(i.cv(), i.f());
+      if (s * n[m.dim()-1] > 0.5 * gmm::vect_norm2(n))
+        m.region(region).add(i.cv(), i.f());
+    }
+  }
+
+  bool same_pairs(const getfem::multi_contact_frame &f1,
+                  const getfem::multi_contact_frame &f2) {
+    if (f1.nb_contact_pairs() != f2.nb_contact_pairs()) return false;
+    for (size_type i = 0; i < f1.nb_contact_pairs(); ++i) {
+      const auto &p1 = f1.ct_pairs()[i], &p2 = f2.ct_pairs()[i];
+      if (p1.slave_ind_boundary != p2.slave_ind_boundary
+          || p1.slave_ind_element != p2.slave_ind_element
+          || p1.slave_ind_face != p2.slave_ind_face
+          || p1.slave_ind_pt != p2.slave_ind_pt
+          || p1.master_ind_boundary != p2.master_ind_boundary
+          || p1.master_ind_element != p2.master_ind_element
+          || p1.master_ind_face != p2.master_ind_face
+          || gmm::abs(p1.signed_dist - p2.signed_dist) > 1E-12)
+        return false;
+    }
+    return true;
+  }
+
+  /* Two bodies, the master one above the slave one, are pressed together
+     and the master one is then stretched. The frame computing all the
+     contact pairs keeps its hierarchy, refitted or built again. */
+  void test_frame(size_type N) {
+    getfem::mesh m1, m2;
+    bgeot::pgeometric_trans pgt = bgeot::simplex_geotrans(N, 1);
+    getfem::regular_unit_mesh(m1, std::vector<size_type>(N, N == 2 ? 8 : 4),
+                              pgt);
+    getfem::regular_unit_mesh(m2, std::vector<size_type>(N, N == 2 ? 7 : 3),
+                              pgt);
+    // Shifted so that no slave point is projected on a master edge.
+    bgeot::base_small_vector t(N);
+    for (size_type k = 0; k+1 < N; ++k) t[k] = 0.0137 * scalar_type(k+1);
+    t[N-1] = 1.02;
+    m2.translation(t);
+    add_faces(m1, 1, 1.); add_faces(m2, 1, -1.);
+
+    getfem::mesh_fem mf1(m1, bgeot::dim_type(N)), mf2(m2, bgeot::dim_type(N));
+    mf1.set_classical_finite_element(1); mf2.set_classical_finite_element(1);
+    getfem::mesh_im mim1(m1), mim2(m2);
+    mim1.set_integration_method(2); mim2.set_integration_method(2);
+    getfem::model_real_plain_vector U1(mf1.nb_dof()), U2(mf2.nb_dof());
+
+    getfem::multi_contact_frame frame(N, 0.1, false, false);
+    frame.add_slave_boundary(mim1, &mf1, &U1, 1);
+    frame.add_master_boundary(mim2, &mf2, &U2, 1);
+
+    size_type nb_with_pairs = 0;
+    for (size_type step = 0; step < 6; ++step) {
+      for (size_type i = 0; i < mf1.nb_dof(); i += N) {
+        base_node P = mf1.point_of_basic_dof(i);
+        U1[i+N-1] = 0.012 * scalar_type(step) * (1. + sin(3. * P[0]));
+      }
+      if (step >= 4) // stretching of the master body
+        for (size_type i = 0; i < mf2.nb_dof(); i += N) {
+          base_node P = mf2.point_of_basic_dof(i);
+          U2[i] = scalar_type(step - 2) * (P[0] - 0.5);
+        }
+      frame.compute_contact_pairs();
+
+      getfem::multi_contact_frame new_frame(N, 0.1, false, false);
+      new_frame.add_slave_boundary(mim1, &mf1, &U1, 1);
+      new_frame.add_master_boundary(mim2, &mf2, &U2, 1);
+      new_frame.compute_contact_pairs();
+      GMM_ASSERT1(same_pairs(frame, new_frame), "Step " << step
+                  << " : different contact pairs, " << frame.nb_contact_pairs()
+                  << " instead of " << new_frame.nb_contact_pairs());
+      if (frame.nb_contact_pairs()) ++nb_with_pairs;
+    }
+    GMM_ASSERT1(nb_with_pairs >= 3, "Too few steps with contact pairs");
+    cout << "contact pairs in dimension " << N << " are ok" << endl;
+  }
+}
+
+int main(void) {
+  for (size_type N = 2; N <= 3; ++N) {
+    test_tree(N);
+    test_frame(N);
+  }
+  return 0;
+}
@@ -23,6 +23,8 @@
 #include "getfem/bgeot_comma_init.h"
 #include "getfem/getfem_export.h"
 #include "getfem/bgeot_node_tab.h"
+#include "getfem/getfem_mesh_fem.h"
+#include "getfem/getfem_mesh_partition.h"
 using std::endl; using std::cout; using std::cerr;
 using std::ends; using std::cin;
 using getfem::size_type;
@@ -632,6 +634,167 @@ void test_incomplete_Q2(void) {
 
 
 
+static base_node convex_centroid(const getfem::mesh &m, size_type cv) {
+  base_node c(m.dim());
+  for (const base_node &P : m.points_of_convex(cv)) c += P;
+  return c / getfem::scalar_type(m.nb_points_of_convex(cv));
+}
+
+static getfem::scalar_type mean_step(const getfem::mesh &m) {
+  getfem::scalar_type d = 0;
+  for (size_type cv = 1; cv < m.nb_convex(); ++cv)
+    d += gmm::vect_dist2(convex_centroid(m, cv-1), convex_centroid(m, cv));
+  return d / getfem::scalar_type(m.nb_convex()-1);
+}
+
+/* Renumbering along a space filling curve: the mesh is packed, the
+   convexes, the points, the regions and the dependent mesh_fem are
+   preserved, and consecutive convexes are close to each other. */
+void test_space_filling_curve(unsigned dim,
+                              getfem::mesh::renumbering_method meth) {
+  const size_type NX = 8;
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(dim, NX),
+                            bgeot::parallelepiped_geotrans(dim, 1));
+  // Shuffle the convexes, so that the numbering is not local.
+  std::vector<size_type> order(m.nb_convex());
+  for (size_type i = 0; i < order.size(); ++i) order[i] = i;
+  for (size_type i = order.size()-1; i > 0; --i)
+    std::swap(order[i], order[size_type(rand()) % (i+1)]);
+  m.renumber_convexes(order);
+  getfem::scalar_type step0 = mean_step(m);
+
+  std::set<std::vector<getfem::scalar_type>> centroids, reg_centroids;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+    base_node c = convex_centroid(m, cv);
+    std::vector<getfem::scalar_type> v(c.begin(), c.end());
+    centroids.insert(v);
+    if (c[0] < 0.5) { m.region(1).add(cv); reg_centroids.insert(v); }
+  }
+  size_type nbc = m.nb_convex(), nbp = m.nb_points();
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(1);
+  size_type nbd = mf.nb_dof();
+
+  m.optimize_structure(true, meth);
+
+  assert(m.nb_convex() == nbc && m.nb_points() == nbp);
+  assert(m.convex_index().last_true() == nbc-1);
+  assert(m.points_index().last_true() == nbp-1);
+  std::set<std::vector<getfem::scalar_type>> centroids2, reg_centroids2;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+    base_node c = convex_centroid(m, cv);
+    std::vector<getfem::scalar_type> v(c.begin(), c.end());
+    centroids2.insert(v);
+    if (m.region(1).is_in(cv)) reg_centroids2.insert(v);
+  }
+  assert(centroids == centroids2);
+  assert(reg_centroids == reg_centroids2);
+  assert(mf.nb_dof() == nbd);
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    assert(mf.fem_of_element(cv));
+
+  // Along a Hilbert curve, consecutive cells of a regular grid share a
+  // face. A Morton curve has some longer jumps.
+  getfem::scalar_type h = 1. / getfem::scalar_type(NX), step = mean_step(m);
+  cout << "mean distance between consecutive convexes: " << step0
+       << " before, " << step << " after renumbering\n";
+  if (meth == getfem::mesh::HILBERT)
+    assert(gmm::abs(step - h) < 1e-10);
+  else
+    assert(step < 2.*h);
+}
+
+/* Invariants of the built-in partitioner: each convex is in exactly one
+   non-empty part, the statistics are those of the partition, and the
+   refinement passes neither increase the edge cut nor exceed the allowed
+   imbalance. */
+void test_partition(unsigned dim, size_type nb_parts) {
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(dim, 6),
+                            bgeot::simplex_geotrans(dim, 1));
+  m.sup_convex(2); m.sup_convex(7); // holes in the numbering
+  getfem::mesh_im mim(m);
+  dal::bit_vector cvs;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    if (cv % 5 == 0) cvs.add(cv);
+  mim.set_integration_method(m.convex_index(), 2);
+  mim.set_integration_method(cvs, 6);
+  std::vector<getfem::scalar_type> weights;
+  getfem::mesh_im_convex_weights(mim, weights);
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    assert(weights[cv] == getfem::scalar_type
+           (mim.int_method_of_element(cv)->approx_method()
+            ->nb_points_on_convex()));
+
+  for (int weighted = 0; weighted < 2; ++weighted) {
+    const std::vector<getfem::scalar_type> &w
+      = weighted ? weights : std::vector<getfem::scalar_type>();
+    std::vector<size_type> part0, part;
+    getfem::partition_mesh(m, nb_parts, part0, w, 0);
+    getfem::partition_mesh(m, nb_parts, part, w);
+    assert(part.size() == m.nb_allocated_convex());
+
+    std::vector<size_type> nb_in_part(nb_parts, 0);
+    getfem::scalar_type W = 0;
+    for (size_type cv = 0; cv < part.size(); ++cv)
+      if (m.convex_index().is_in(cv)) {
+        assert(part[cv] < nb_parts);
+        nb_in_part[part[cv]]++;
+        W += weighted ? w[cv] : 1.;
+      } else
+        assert(part[cv] == size_type(-1));
+    for (size_type p = 0; p < nb_parts; ++p) assert(nb_in_part[p] > 0);
+
+    getfem::mesh_partition_statistics st0, st;
+    getfem::partition_statistics(m, part0, st0, w);
+    getfem::partition_statistics(m, part, st, w);
+    size_type edge_cut = 0;
+    getfem::scalar_type sumw = 0;
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+      for (bgeot::short_type f = 0; f < m.nb_faces_of_convex(cv); ++f) {
+        size_type cv2 = m.neighbor_of_convex(cv, f);
+        if (cv2 != size_type(-1) && cv2 > cv && part[cv2] != part[cv])
+          ++edge_cut;
+      }
+    for (getfem::scalar_type pw : st.part_weight) sumw += pw;
+    assert(st.nb_parts == nb_parts && st.edge_cut == edge_cut);
+    assert(gmm::abs(sumw - W) < 1e-10
+           && gmm::abs(st.mean_weight * getfem::scalar_type(nb_parts) - W)
+              < 1e-10);
+    assert(st.edge_cut <= st0.edge_cut);
+    assert(st.max_weight <= std::max(st0.max_weight,
+                                     1.05 * st.mean_weight) + 1e-10);
+    cout << "partition in " << nb_parts << " parts, dim " << dim
+         << (weighted ? ", weighted" : "") << ": edge cut " << st0.edge_cut
+         << " -> " << st.edge_cut << ", imbalance " << st0.imbalance()
+         << " -> " << st.imbalance() << endl;
+
+    /* The renumbering keeps the partition and its statistics, and the
+       mesh_fem follows. */
+    getfem::mesh m2; m2.copy_from(m);
+    getfem::mesh_fem mf(m2); // without auto add, the fems have to follow
+    mf.set_finite_element(m2.convex_index(),
+                          getfem::classical_fem(m2.trans_of_convex(0), 1));
+    size_type nbd = mf.nb_dof();
+    std::set<std::vector<getfem::scalar_type>> centroids, centroids2;
+    for (dal::bv_visitor cv(m2.convex_index()); !cv.finished(); ++cv) {
+      base_node c = convex_centroid(m2, cv);
+      centroids.insert(std::vector<getfem::scalar_type>(c.begin(), c.end()));
+    }
+    getfem::mesh_partition_statistics st2;
+    getfem::renumber_convexes_by_partition(m2, nb_parts, w, &st2);
+    assert(m2.convex_index().last_true() == m2.nb_convex() - 1);
+    assert(st2.edge_cut == st.edge_cut && st2.part_weight == st.part_weight);
+    for (dal::bv_visitor cv(m2.convex_index()); !cv.finished(); ++cv) {
+      base_node c = convex_centroid(m2, cv);
+      centroids2.insert(std::vector<getfem::scalar_type>(c.begin(), c.end()));
+      assert(mf.convex_index().is_in(cv) && mf.fem_of_element(cv));
+    }
+    assert(centroids == centroids2 && mf.nb_dof() == nbd);
+  }
+}
+
 int main(void) {
 
   test_mesh_building(2, 100); 
@@ -659,6 +822,15 @@ int main(void) {
   test_refinable(3, 3);
 
   test_incomplete_Q2();
+
+  for (unsigned d = 2; d <= 3; ++d) {
+    test_space_filling_curve(d, getfem::mesh::MORTON);
+    test_space_filling_curve(d, getfem::mesh::HILBERT);
+  }
+
+  test_partition(2, 4);
+  test_partition(2, 7);
+  test_partition(3, 5);
   
   return 0;
 }
@@ -25,6 +25,34 @@ using std::endl; using std::cout; using std::cerr;
 using std::ends; using std::cin;
 using getfem::base_node;
 using getfem::scalar_type;
+using getfem::size_type;
+
+/* The parallel loops of build_mesh keep the order of the serial ones: the
+   mesh built by all the threads is the one built by a single thread. */
+static void
+check_parallel_build(const getfem::mesh &m,
+                     const getfem::pmesher_signed_distance &dist,
+                     scalar_type h, const std::vector<base_node> &fixed,
+                     int K, int max_iter, int prefind) {
+  size_type nb_threads = getfem::true_thread_policy::num_threads();
+  getfem::set_num_threads(1);
+  getfem::mesh m1;
+  getfem::build_mesh(m1, dist, h, fixed, K, 2, max_iter, prefind);
+  getfem::set_num_threads(int(nb_threads));
+  GMM_ASSERT1(m1.points().index() == m.points().index()
+              && m1.convex_index() == m.convex_index(), "The parallel and "
+              "the serial mesh generations give different meshes");
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    GMM_ASSERT1(m1.ind_points_of_convex(cv) == m.ind_points_of_convex(cv),
+                "Different convex " << cv << " in the parallel and the "
+                "serial mesh generations");
+  for (dal::bv_visitor ip(m.points().index()); !ip.finished(); ++ip)
+    GMM_ASSERT1(gmm::vect_dist2(m1.points()[ip], m.points()[ip]) < 1E-8*h,
+                "Different point " << ip << " in the parallel and the "
+                "serial mesh generations");
+  cout << "The mesh built on " << nb_threads << " thread(s) is the one "
+       << "built on a single thread" << endl;
+}
 
 int main(int argc, char **argv) {
 
@@ -209,6 +237,8 @@ int main(int argc, char **argv) {
       break;
     }
     getfem::build_mesh(m, dist, h, fixed, K, 2, max_iter, prefind);
+    if (argc == 1)
+      check_parallel_build(m, dist, h, fixed, K, max_iter, prefind);
     cout << "You can view the result with"
 	 << "\n mayavi -d totoq.vtk -m BandedSurfaceMap\n";
   }
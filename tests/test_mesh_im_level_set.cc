@@ -19,7 +19,7 @@
 
 ===========================================================================*/
 #include "getfem/getfem_mesh_im_level_set.h"
-#include "getfem/getfem_mesh_im_level_set.h"
+#include "getfem/getfem_regular_meshes.h"
 using std::endl; using std::cout; using std::cerr;
 using std::ends; using std::cin;
 
@@ -101,6 +101,176 @@ void test_2d() {
 }
 
 
+static void circle_level_set(getfem::level_set &ls, const base_node &C,
+			     scalar_type R) {
+  const getfem::mesh_fem &mf = ls.get_mesh_fem();
+  for (size_type i = 0; i < mf.nb_dof(); ++i)
+    ls.values()[i] = gmm::vect_dist2_sqr(mf.point_of_basic_dof(i), C) - R*R;
+  ls.touch();
+}
+
+static std::string zones_of_convex(const getfem::mesh_level_set &mls,
+				   size_type cv) {
+  std::stringstream s;
+  s << mls.primary_zone_of_convex(cv) << " ";
+  getfem::operator<<(s, mls.zoneset_of_convex(cv));
+  return s.str();
+}
+
+/* The cut convexes, their sub-meshes and their zones are the same after
+   a full and after an incremental adapt, and do not depend on the order
+   in which the convexes are cut (they are cut in parallel). */
+static void check_same_cut(const getfem::mesh_level_set &mls1,
+			   const getfem::mesh_level_set &mls2) {
+  const getfem::mesh &m = mls1.linked_mesh();
+  size_type nb_cut = 0;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+    GMM_ASSERT1(mls1.is_convex_cut(cv) == mls2.is_convex_cut(cv),
+		"Convex " << cv << " differently cut");
+    GMM_ASSERT1(zones_of_convex(mls1, cv) == zones_of_convex(mls2, cv),
+		"Different zones for convex " << cv);
+    if (!mls1.is_convex_cut(cv)) continue;
+    ++nb_cut;
+    const getfem::mesh &m1 = mls1.mesh_of_convex(cv);
+    const getfem::mesh &m2 = mls2.mesh_of_convex(cv);
+    GMM_ASSERT1(m1.convex_index() == m2.convex_index()
+		&& m1.points().index() == m2.points().index(),
+		"Different sub-meshes for convex " << cv);
+    for (dal::bv_visitor i(m1.points().index()); !i.finished(); ++i)
+      GMM_ASSERT1(gmm::vect_dist2(m1.points()[i], m2.points()[i]) == 0.,
+		  "Different sub-meshes for convex " << cv);
+    for (dal::bv_visitor i(m1.convex_index()); !i.finished(); ++i)
+      GMM_ASSERT1(std::equal(m1.ind_points_of_convex(i).begin(),
+			     m1.ind_points_of_convex(i).end(),
+			     m2.ind_points_of_convex(i).begin()),
+		  "Different sub-meshes for convex " << cv);
+  }
+  GMM_ASSERT1(nb_cut > 0, "No cut convex");
+}
+
+void test_incremental_adapt() {
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(2, 12),
+			    bgeot::simplex_geotrans(2, 1));
+  getfem::level_set ls1(m, 2), ls2(m, 2);
+  circle_level_set(ls1, base_node(0.3, 0.3), 0.15);
+  circle_level_set(ls2, base_node(0.7, 0.7), 0.12);
+
+  getfem::mesh_level_set mls(m), mls_bis(m);
+  mls.add_level_set(ls1); mls.add_level_set(ls2);
+  mls_bis.add_level_set(ls1); mls_bis.add_level_set(ls2);
+  mls.adapt(); mls_bis.adapt();
+  check_same_cut(mls, mls_bis);
+
+  // Only the convexes cut by the second level set are cut again.
+  circle_level_set(ls2, base_node(0.7, 0.65), 0.14);
+  mls.adapt(true);
+  getfem::mesh_level_set mls_full(m);
+  mls_full.add_level_set(ls1); mls_full.add_level_set(ls2);
+  mls_full.adapt();
+  check_same_cut(mls, mls_full);
+  cout << "incremental adapt is ok\n";
+}
+
+
+/* mesh_im_level_set giving access to its shared methods. */
+struct shared_mesh_im_level_set : public getfem::mesh_im_level_set {
+  shared_mesh_im_level_set(getfem::mesh_level_set &mls, int where,
+			   getfem::pintegration_method reg)
+    : getfem::mesh_im_level_set(mls, where, reg) {}
+  size_type nb_shared_methods() const { return build_methods.size(); }
+};
+
+static scalar_type integrand(const base_node &P)
+{ return 1. + P[0] + P[0]*P[1]*P[1]; }
+
+static scalar_type integral_on_convex(const getfem::mesh_im &mim,
+				      size_type cv) {
+  const getfem::mesh &m = mim.linked_mesh();
+  getfem::papprox_integration pai
+    = mim.int_method_of_element(cv)->approx_method();
+  base_matrix G;
+  bgeot::vectors_to_base_matrix(G, m.points_of_convex(cv));
+  bgeot::geotrans_interpolation_context c(m.trans_of_convex(cv),
+					  pai->point(0), G);
+  scalar_type r(0);
+  for (size_type j = 0; j < pai->nb_points_on_convex(); ++j) {
+    c.set_xref(pai->point(j));
+    r += pai->coeff(j) * c.J() * integrand(c.xreal());
+  }
+  return r;
+}
+
+/* On a structured mesh cut by straight level sets, the cut convexes of a
+   same row or diagonal have the same configuration and share their
+   integration method. Their integrals are the ones computed with the
+   method built on each of them alone, in a mesh of a single convex. */
+static void check_shared_methods(getfem::mesh &m, getfem::level_set &ls,
+				 int where, const std::string &name) {
+  getfem::pintegration_method
+    reg = getfem::int_method_descriptor("IM_TRIANGLE(6)");
+  getfem::mesh_level_set mls(m);
+  mls.add_level_set(ls);
+  mls.adapt();
+  shared_mesh_im_level_set mim(mls, where, reg);
+  mim.adapt();
+
+  const getfem::mesh_fem &mf = ls.get_mesh_fem();
+  size_type nb_cut = 0;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+    if (!mls.is_convex_cut(cv)) continue;
+    ++nb_cut;
+    getfem::mesh m1;
+    m1.add_convex_by_points(m.trans_of_convex(cv),
+			    m.points_of_convex(cv).begin());
+    getfem::level_set ls1(m1, ls.degree());
+    const getfem::mesh_fem &mf1 = ls1.get_mesh_fem();
+    for (size_type i = 0; i < mf.nb_basic_dof_of_element(cv); ++i)
+      ls1.values()[mf1.ind_basic_dof_of_element(0)[i]]
+	= ls.values()[mf.ind_basic_dof_of_element(cv)[i]];
+    getfem::mesh_level_set mls1(m1);
+    mls1.add_level_set(ls1);
+    mls1.adapt();
+    getfem::mesh_im_level_set mim1(mls1, where, reg);
+    mim1.adapt();
+
+    scalar_type I = integral_on_convex(mim, cv);
+    scalar_type I1 = integral_on_convex(mim1, 0);
+    GMM_ASSERT1(gmm::abs(I - I1) <= 1E-12, name << " : integral " << I
+		<< " on convex " << cv << " instead of " << I1);
+  }
+  GMM_ASSERT1(nb_cut > 0 && mim.nb_shared_methods() < nb_cut,
+	      name << " : " << mim.nb_shared_methods()
+	      << " methods for " << nb_cut << " cut convexes");
+  cout << name << " : " << nb_cut << " cut convexes sharing "
+       << mim.nb_shared_methods() << " methods, integrals are ok\n";
+}
+
+void test_shared_methods() {
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(2, 8),
+			    bgeot::simplex_geotrans(2, 1));
+  getfem::level_set ls1(m, 1), ls2(m, 2);
+  const getfem::mesh_fem &mf1 = ls1.get_mesh_fem();
+  for (size_type i = 0; i < mf1.nb_dof(); ++i)
+    ls1.values()[i] = mf1.point_of_basic_dof(i)[1] - 0.37;
+  const getfem::mesh_fem &mf2 = ls2.get_mesh_fem();
+  for (size_type i = 0; i < mf2.nb_dof(); ++i) {
+    base_node P = mf2.point_of_basic_dof(i);
+    ls2.values()[i] = P[0] - P[1] + 0.05;
+  }
+  ls1.touch(); ls2.touch();
+  using getfem::mesh_im_level_set;
+  check_shared_methods(m, ls1, mesh_im_level_set::INTEGRATE_INSIDE,
+		       "horizontal level set, inside");
+  check_shared_methods(m, ls1, mesh_im_level_set::INTEGRATE_BOUNDARY,
+		       "horizontal level set, boundary");
+  check_shared_methods(m, ls2, mesh_im_level_set::INTEGRATE_OUTSIDE,
+		       "diagonal level set, outside");
+  check_shared_methods(m, ls2, mesh_im_level_set::INTEGRATE_BOUNDARY,
+		       "diagonal level set, boundary");
+}
+
 void test_3d() {
   getfem::mesh m; m.read_from_file("meshes/ball_3D_P2_84_elements.mesh");
   getfem::mesh_fem mf(m);
@@ -178,6 +348,8 @@ int main(/* int argc, char **argv */) {
   try {
     // getfem::getfem_mesh_level_set_noisy();
     test_2d();
+    test_incremental_adapt();
+    test_shared_methods();
   }
   GMM_STANDARD_CATCH_ERROR;
   return 0;
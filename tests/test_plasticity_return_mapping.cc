@@ -0,0 +1,176 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent.
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/* The return mapping of small_strain_elastoplasticity_next_iter computed
+   directly on the integration points, when the internal variables are
+   stored on im_data of the same mesh_im, against the generic assembly
+   path, taken when the plastic multiplier is stored on an im_data of
+   another mesh_im with the same integration method. */
+
+#include "getfem/getfem_plasticity.h"
+#include "getfem/getfem_regular_meshes.h"
+
+using std::endl; using std::cout; using std::cerr;
+using bgeot::size_type;
+using bgeot::scalar_type;
+using bgeot::base_node;
+using getfem::model_real_plain_vector;
+
+namespace {
+
+  struct return_mapping_problem {
+    getfem::mesh m;
+    getfem::mesh_fem mf_u;
+    getfem::mesh_im mim, mim2;
+    getfem::im_data imd_ep, imd_scalar, imd_scalar2;
+
+    return_mapping_problem(size_type N)
+      : mf_u(m), mim(m), mim2(m), imd_ep(mim), imd_scalar(mim),
+        imd_scalar2(mim2) {
+      getfem::regular_unit_mesh(m, std::vector<size_type>(N, N == 2 ? 6 : 3),
+                                bgeot::simplex_geotrans(N, 1));
+      mf_u.set_qdim(bgeot::dim_type(N));
+      mf_u.set_classical_finite_element(2);
+      mim.set_integration_method(getfem::classical_approx_im
+                                 (bgeot::simplex_geotrans(N, 1), 4));
+      mim2.set_integration_method(m.convex_index(),
+                                  mim.int_method_of_element(0));
+      imd_ep.set_tensor_size(bgeot::multi_index(N, N));
+    }
+  };
+
+  /* Model holding the same state for both paths, the plastic multiplier
+     being stored on imd_xi. */
+  void init_model(getfem::model &md, return_mapping_problem &pb,
+                  const getfem::im_data &imd_xi, bool hardening) {
+    const getfem::mesh_fem &mf_u = pb.mf_u;
+    size_type N = pb.m.dim();
+    md.add_fem_variable("u", mf_u);
+    md.add_fem_data("Previous_u", mf_u);
+    model_real_plain_vector U(mf_u.nb_dof()), U0(mf_u.nb_dof());
+    for (size_type i = 0; i < mf_u.nb_dof(); ++i) {
+      base_node P = mf_u.point_of_basic_dof(i);
+      size_type k = i % N;
+      scalar_type a = 0.;
+      for (size_type j = 0; j < N; ++j)
+        a += scalar_type(j+k+1) * P[j] / scalar_type(N);
+      U[i] = 0.05 * sin(3. * a) + 0.02 * P[k] * P[(k+1) % N];
+      U0[i] = 0.03 * cos(2. * a);
+    }
+    gmm::copy(U, md.set_real_variable("u"));
+    gmm::copy(U0, md.set_real_variable("Previous_u"));
+
+    md.add_im_data("xi", imd_xi);
+    md.add_im_data("Previous_xi", imd_xi);
+    md.add_im_data("Previous_Ep", pb.imd_ep);
+    model_real_plain_vector &xi0 = md.set_real_variable("Previous_xi");
+    for (size_type i = 0; i < xi0.size(); ++i)
+      xi0[i] = 0.5 * (1. + sin(scalar_type(7*i)));
+    model_real_plain_vector &Ep = md.set_real_variable("Previous_Ep");
+    size_type NN = N*N;
+    for (size_type p = 0; p < Ep.size() / NN; ++p) // symmetric, traceless
+      for (size_type i = 0; i < N; ++i)
+        for (size_type j = 0; j <= i; ++j)
+          Ep[p*NN+i+N*j] = Ep[p*NN+j+N*i]
+            = 0.004 * sin(scalar_type(p + 3*i + 5*j));
+    for (size_type p = 0; p < Ep.size() / NN; ++p) {
+      scalar_type tr = 0.;
+      for (size_type i = 0; i < N; ++i) tr += Ep[p*NN+i*(N+1)];
+      for (size_type i = 0; i < N; ++i) Ep[p*NN+i*(N+1)] -= tr / N;
+    }
+    if (hardening) {
+      md.add_im_data("alpha", pb.imd_scalar);
+      model_real_plain_vector &alpha = md.set_real_variable("alpha");
+      for (size_type i = 0; i < alpha.size(); ++i)
+        alpha[i] = 0.01 * (1. + cos(scalar_type(5*i)));
+    }
+
+    md.add_initialized_scalar_data("lambda", 2.);
+    md.add_initialized_scalar_data("mu", 1.);
+    md.add_initialized_scalar_data("sigma_y", N == 2 ? 0.3 : 0.5);
+    md.add_initialized_scalar_data("Hk", 0.3);
+    md.add_initialized_scalar_data("Hi", 0.2);
+  }
+
+  void check_same(const model_real_plain_vector &v1,
+                  const model_real_plain_vector &v2,
+                  const std::string &what) {
+    GMM_ASSERT1(v1.size() == v2.size(), "Wrong size of " << what);
+    scalar_type err = gmm::vect_dist2(v1, v2);
+    GMM_ASSERT1(err <= 1E-10 * (1. + gmm::vect_norm2(v2)),
+                "Different values of " << what << " : error " << err);
+  }
+
+  void test_law(size_type N, const std::string &lawname, bool theta_scheme) {
+    bool hardening = (lawname.find("hardening") != std::string::npos);
+    return_mapping_problem pb(N);
+    std::vector<std::string> varnames = {"u", "xi", "Previous_Ep"};
+    std::vector<std::string> params = {"lambda", "mu", "sigma_y"};
+    if (hardening) {
+      varnames.push_back("alpha");
+      params.push_back("Hk"); params.push_back("Hi");
+    }
+    if (theta_scheme) { params.push_back("0.6"); params.push_back("0.1"); }
+
+    getfem::model md1, md2;
+    init_model(md1, pb, pb.imd_scalar, hardening);  // direct return mapping
+    init_model(md2, pb, pb.imd_scalar2, hardening); // generic assembly
+    for (getfem::model *md : {&md1, &md2})
+      getfem::small_strain_elastoplasticity_next_iter
+        (*md, pb.mim, lawname, getfem::DISPLACEMENT_ONLY, varnames, params);
+
+    const model_real_plain_vector &xi = md2.real_variable("xi");
+    size_type nb_plastic = 0;
+    for (scalar_type x : xi) if (x > 0.) ++nb_plastic;
+    GMM_ASSERT1(nb_plastic > xi.size() / 10 && nb_plastic < xi.size(),
+                "No mixing of elastic and plastic points: " << nb_plastic
+                << " plastic points of " << xi.size());
+
+    check_same(md1.real_variable("Previous_Ep"),
+               md2.real_variable("Previous_Ep"), "Previous_Ep");
+    check_same(md1.real_variable("xi"), xi, "xi");
+    check_same(md1.real_variable("Previous_xi"), xi, "Previous_xi");
+    if (hardening)
+      check_same(md1.real_variable("alpha"), md2.real_variable("alpha"),
+                 "alpha");
+    cout << lawname << (theta_scheme ? " (theta-scheme)" : "")
+         << " in dimension " << N << " : " << nb_plastic
+         << " plastic points of " << xi.size() << ", return mappings are ok"
+         << endl;
+  }
+}
+
+int main(void) {
+  for (bool theta_scheme : {false, true}) {
+    for (const char *law :
+           {"Plane strain isotropic perfect plasticity",
+            "plane_strain_prandtl_reuss",
+            "plane_strain_isotropic_plasticity_linear_hardening",
+            "plane_strain_prandtl_reuss_linear_hardening"})
+      test_law(2, law, theta_scheme);
+    for (const char *law :
+           {"isotropic_perfect_plasticity", "Prandtl Reuss",
+            "isotropic_plasticity_linear_hardening",
+            "prandtl_reuss_linear_hardening"})
+      test_law(3, law, theta_scheme);
+  }
+  return 0;
+}
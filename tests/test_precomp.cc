@@ -0,0 +1,153 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent.
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/* The fem and geometric transformation precomputations shared by the
+   threads: the tables against the pointwise evaluations, the pools of all
+   the threads returning the same object, and the pools deleting only the
+   objects they built. */
+
+#include "getfem/getfem_fem.h"
+#include "getfem/getfem_omp.h"
+
+using std::endl; using std::cout; using std::cerr;
+using bgeot::size_type;
+using bgeot::base_node;
+using bgeot::base_vector;
+using bgeot::base_matrix;
+using bgeot::base_tensor;
+using bgeot::scalar_type;
+
+namespace {
+
+  bgeot::pstored_point_tab test_points(size_type N) {
+    std::vector<base_node> pts;
+    for (size_type k = 0; k < 5; ++k) {
+      base_node P(N);
+      for (size_type d = 0; d < N; ++d)
+        P[d] = 0.05 + 0.15 * scalar_type((k + d) % 5) / scalar_type(N);
+      pts.push_back(P);
+    }
+    return bgeot::store_point_tab(pts);
+  }
+
+  template <typename T1, typename T2>
+  void check_same(const T1 &t1, const T2 &t2, const char *what) {
+    GMM_ASSERT1(t1.size() == t2.size(), "Wrong size of the " << what);
+    for (size_type i = 0; i < t1.size(); ++i)
+      GMM_ASSERT1(gmm::abs(t1[i] - t2[i]) < 1E-12, "Wrong " << what);
+  }
+
+  /* The pools of all the threads return the object p, without owning
+     it: p still exists when they are destroyed. */
+  template <typename POOL, typename P, typename OBJ>
+  void check_shared(const P &p, const OBJ &obj,
+                    bgeot::pstored_point_tab pspt) {
+    size_type nb_threads = getfem::true_thread_policy::num_threads();
+    std::vector<int> errors(nb_threads, 0);
+    GETFEM_OMP_PARALLEL_NO_PARTITION(
+      POOL pool;
+      if (pool(obj, pspt) != p)
+        ++errors[getfem::true_thread_policy::this_thread()];
+    )
+    for (size_type t = 0; t < nb_threads; ++t)
+      GMM_ASSERT1(errors[t] == 0, "Another precomputation on thread " << t);
+    GMM_ASSERT1(dal::exists_stored_object(p),
+                "Precomputation deleted by a pool which did not build it");
+  }
+
+  void test_fem_precomp(const std::string &name) {
+    getfem::pfem pf = getfem::fem_descriptor(name);
+    bgeot::pstored_point_tab pspt = test_points(pf->dim());
+    getfem::pfem_precomp pfp;
+    {
+      getfem::fem_precomp_pool pool;
+      pfp = pool(pf, pspt);
+      GMM_ASSERT1(pool(pf, pspt) == pfp, "Two precomputations in a pool");
+      GMM_ASSERT1(getfem::fem_precomp(pf, pspt, 0) == pfp,
+                  "The pool and fem_precomp do not share the tables");
+      check_shared<getfem::fem_precomp_pool>(pfp, pf, pspt);
+
+      base_tensor t;
+      for (size_type i = 0; i < pspt->size(); ++i) {
+        pf->base_value((*pspt)[i], t);
+        check_same(pfp->val(i), t, "values");
+        pf->grad_base_value((*pspt)[i], t);
+        check_same(pfp->grad(i), t, "gradients");
+        pf->hess_base_value((*pspt)[i], t);
+        check_same(pfp->hess(i), t, "hessians");
+      }
+    }
+    GMM_ASSERT1(!dal::exists_stored_object(pfp),
+                "Precomputation not deleted by its pool");
+
+    /* Built outside of the pools, it is kept when they are destroyed. The
+       point tab, deleted with its last dependent, is stored again. */
+    pspt = test_points(pf->dim());
+    pfp = getfem::fem_precomp(pf, pspt, 0);
+    check_shared<getfem::fem_precomp_pool>(pfp, pf, pspt);
+    getfem::delete_fem_precomp(pfp);
+    cout << name << " precomputations are ok" << endl;
+  }
+
+  void test_geotrans_precomp(const std::string &name) {
+    bgeot::pgeometric_trans pgt = bgeot::geometric_trans_descriptor(name);
+    bgeot::pstored_point_tab pspt = test_points(pgt->dim());
+    bgeot::pgeotrans_precomp pgp;
+    {
+      bgeot::geotrans_precomp_pool pool;
+      pgp = pool(pgt, pspt);
+      GMM_ASSERT1(pool(pgt, pspt) == pgp, "Two precomputations in a pool");
+      GMM_ASSERT1(bgeot::geotrans_precomp(pgt, pspt, 0) == pgp,
+                  "The pool and geotrans_precomp do not share the tables");
+      check_shared<bgeot::geotrans_precomp_pool>(pgp, pgt, pspt);
+
+      base_vector v(pgt->nb_points());
+      base_matrix g(pgt->nb_points(), pgt->dim());
+      base_matrix h(pgt->nb_points(), gmm::sqr(pgt->dim()));
+      for (size_type i = 0; i < pspt->size(); ++i) {
+        pgt->poly_vector_val((*pspt)[i], v);
+        check_same(pgp->val(i), v, "values");
+        pgt->poly_vector_grad((*pspt)[i], g);
+        check_same(pgp->grad(i).as_vector(), g.as_vector(), "gradients");
+        pgt->poly_vector_hess((*pspt)[i], h);
+        check_same(pgp->hessian(i).as_vector(), h.as_vector(), "hessians");
+      }
+    }
+    GMM_ASSERT1(!dal::exists_stored_object(pgp),
+                "Precomputation not deleted by its pool");
+
+    pspt = test_points(pgt->dim());
+    pgp = bgeot::geotrans_precomp(pgt, pspt, 0);
+    check_shared<bgeot::geotrans_precomp_pool>(pgp, pgt, pspt);
+    bgeot::delete_geotrans_precomp(pgp);
+    cout << name << " precomputations are ok" << endl;
+  }
+}
+
+int main(void) {
+  test_fem_precomp("FEM_PK(2,3)");
+  test_fem_precomp("FEM_QK(3,2)");
+  test_fem_precomp("FEM_PK_PRISM(3,2)");
+  test_geotrans_precomp("GT_PK(2,2)");
+  test_geotrans_precomp("GT_QK(3,2)");
+  test_geotrans_precomp("GT_PRISM(3,1)");
+  return 0;
+}
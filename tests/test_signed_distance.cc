@@ -0,0 +1,194 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent.
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/* Evaluation of the signed distances of the mesher on unions,
+   intersections and set differences, done concurrently by all the threads
+   (sequentially without OpenMP), as in the parallel loops of build_mesh,
+   on batches of points and on the dofs of a level set. */
+
+#include "getfem/getfem_mesher.h"
+#include "getfem/getfem_level_set.h"
+#include "getfem/getfem_regular_meshes.h"
+
+using std::endl; using std::cout; using std::cerr;
+using getfem::size_type;
+using getfem::scalar_type;
+using getfem::base_node;
+using getfem::base_small_vector;
+using getfem::pmesher_signed_distance;
+
+namespace {
+
+  // Points of a regular grid of [-2.5, 2.5]^N, slightly shifted.
+  std::vector<base_node> grid_points(size_type N, size_type n) {
+    size_type nb = 1;
+    for (size_type k = 0; k < N; ++k) nb *= n;
+    std::vector<base_node> pts(nb, base_node(N));
+    for (size_type i = 0; i < nb; ++i)
+      for (size_type k = 0, j = i; k < N; ++k, j /= n)
+        pts[i][k] = -2.5 + 5. * scalar_type(j % n) / scalar_type(n-1)
+          + 0.013 * scalar_type(k+1);
+    return pts;
+  }
+
+  struct dist_values {
+    scalar_type d, dbv, dg;
+    dal::bit_vector bv;
+    base_small_vector G;
+  };
+
+  void eval(const pmesher_signed_distance &dist, const base_node &P,
+            dist_values &v) {
+    v.d = (*dist)(P);
+    v.bv.clear();
+    v.dbv = (*dist)(P, v.bv);
+    v.dg = dist->grad(P, v.G);
+  }
+
+  bool same(const dist_values &v1, const dist_values &v2) {
+    return v1.d == v2.d && v1.dbv == v2.dbv && v1.dg == v2.dg
+      && v1.bv == v2.bv && gmm::vect_dist2(v1.G, v2.G) == scalar_type(0);
+  }
+
+  /* Each thread evaluates the distance, its active constraints and its
+     gradient on all the points and compares them with a serial
+     evaluation. */
+  void check_concurrent_evaluations(const pmesher_signed_distance &dist,
+                                    const std::vector<base_node> &pts,
+                                    const std::string &name) {
+    std::vector<const getfem::mesher_signed_distance *> constraints;
+    dist->register_constraints(constraints);
+    std::vector<dist_values> ref(pts.size());
+    for (size_type i = 0; i < pts.size(); ++i) eval(dist, pts[i], ref[i]);
+
+    size_type nb_threads = getfem::true_thread_policy::num_threads();
+    std::vector<int> errors(nb_threads, 0);
+    GETFEM_OMP_PARALLEL_NO_PARTITION(
+      dist_values v;
+      for (size_type i = 0; i < pts.size(); ++i) {
+        eval(dist, pts[i], v);
+        if (!same(v, ref[i]))
+          ++errors[getfem::true_thread_policy::this_thread()];
+      }
+    )
+    for (size_type t = 0; t < nb_threads; ++t)
+      GMM_ASSERT1(errors[t] == 0, errors[t] << " wrong evaluations of "
+                  << name << " on thread " << t);
+    cout << name << " : concurrent evaluations are ok" << endl;
+  }
+
+  bool near(scalar_type a, scalar_type b)
+  { return gmm::abs(a - b) <= 1E-12 * (1. + gmm::abs(b)); }
+
+  /* The evaluations of batch_eval and batch_grad, on all the points and on
+     a batch of a few points starting in the middle, are the pointwise
+     ones. */
+  void check_batch_evaluations(const pmesher_signed_distance &dist,
+                               const std::vector<base_node> &pts,
+                               const std::string &name) {
+    size_type N = pts[0].size();
+    base_small_vector G(N);
+    for (size_type first : {size_type(0), pts.size() / 2}) {
+      size_type nb = first ? std::min(size_type(7), pts.size() - first)
+                           : pts.size();
+      std::vector<scalar_type> X(N*nb), d(nb), dg(nb), GG(N*nb);
+      for (size_type i = 0; i < nb; ++i)
+        for (size_type k = 0; k < N; ++k) X[k*nb+i] = pts[first+i][k];
+      dist->batch_eval(N, nb, X.data(), d.data());
+      dist->batch_grad(N, nb, X.data(), dg.data(), GG.data());
+      for (size_type i = 0; i < nb; ++i) {
+        const base_node &P = pts[first+i];
+        scalar_type dref = (*dist)(P), dgref = dist->grad(P, G);
+        GMM_ASSERT1(near(d[i], dref), name << " : batch_eval gives " << d[i]
+                    << " instead of " << dref << " at " << P);
+        GMM_ASSERT1(near(dg[i], dgref), name << " : batch_grad gives "
+                    << dg[i] << " instead of " << dgref << " at " << P);
+        for (size_type k = 0; k < N; ++k)
+          GMM_ASSERT1(near(GG[k*nb+i], G[k]), name << " : wrong gradient "
+                      << "of batch_grad at " << P);
+      }
+    }
+    cout << name << " : batch evaluations are ok" << endl;
+  }
+
+  // The values set by level_set::set_values are the distances at the dofs.
+  void check_level_set_values(const pmesher_signed_distance &dist,
+                              size_type N, const std::string &name) {
+    getfem::mesh m;
+    base_node org(N); gmm::fill(org, -2.5);
+    std::vector<base_small_vector> vects(N, base_small_vector(N));
+    std::vector<int> ref(N, N == 2 ? 10 : 4);
+    for (size_type k = 0; k < N; ++k) vects[k][k] = 5. / ref[k];
+    getfem::parallelepiped_regular_simplex_mesh(m, bgeot::dim_type(N), org,
+                                                vects.begin(), ref.begin());
+    getfem::level_set ls(m, 2);
+    ls.set_values(*dist);
+    const getfem::mesh_fem &mf = ls.get_mesh_fem();
+    GMM_ASSERT1(ls.values().size() == mf.nb_dof(), name
+                << " : wrong number of level set values");
+    for (size_type i = 0; i < mf.nb_dof(); ++i) {
+      scalar_type dref = (*dist)(mf.point_of_basic_dof(i));
+      GMM_ASSERT1(near(ls.values()[i], dref), name << " : level set value "
+                  << ls.values()[i] << " instead of " << dref);
+    }
+    cout << name << " : level set values are ok" << endl;
+  }
+
+  struct named_dist {
+    std::string name;
+    pmesher_signed_distance dist;
+  };
+
+  std::vector<named_dist> test_shapes(size_type N) {
+    base_node O(N), A(N), B(N), C(N);
+    A[0] = 0.8; B[0] = -0.8; C[N-1] = 0.6;
+    base_node rmin(N), rmax(N);
+    gmm::fill(rmin, -1.5); gmm::fill(rmax, 1.5);
+    pmesher_signed_distance
+      b1 = getfem::new_mesher_ball(A, 1.2),
+      b2 = getfem::new_mesher_ball(B, 1.2),
+      b3 = getfem::new_mesher_ball(C, 0.7),
+      r = getfem::new_mesher_rectangle(rmin, rmax),
+      u = getfem::new_mesher_union(b1, b2, b3),
+      i = getfem::new_mesher_intersection(b1, b2, r);
+    return {
+      { "union", u },
+      { "intersection", i },
+      { "setminus", getfem::new_mesher_setminus(r, b3) },
+      { "nested", getfem::new_mesher_setminus
+        (getfem::new_mesher_union(i, b3), getfem::new_mesher_ball(O, 0.3)) }
+    };
+  }
+}
+
+int main(void) {
+  for (size_type N = 2; N <= 3; ++N) {
+    std::vector<base_node> pts = grid_points(N, N == 2 ? 41 : 13);
+    for (const named_dist &s : test_shapes(N)) {
+      std::stringstream name;
+      name << s.name << " in dimension " << N;
+      check_concurrent_evaluations(s.dist, pts, name.str());
+      check_batch_evaluations(s.dist, pts, name.str());
+      check_level_set_values(s.dist, N, name.str());
+    }
+  }
+  return 0;
+}
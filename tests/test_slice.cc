@@ -21,6 +21,7 @@
 #include "getfem/bgeot_comma_init.h"
 #include "getfem/bgeot_comma_init.h"
 #include "getfem/getfem_mesh_slice.h"
+#include "getfem/getfem_regular_meshes.h"
 using std::endl; using std::cout; using std::cerr;
 using std::ends; using std::cin;
 
@@ -64,6 +65,89 @@ namespace getfem {
 #endif
 }
 
+/* Delegates to a slicer while declaring itself not thread safe, so that
+   stored_mesh_slice::build slices the convexes serially. */
+struct serial_slicer : public getfem::slicer_action {
+  getfem::slicer_action &A;
+  serial_slicer(getfem::slicer_action &A_) : A(A_) {}
+  void exec(getfem::mesh_slicer &ms) { A.exec(ms); }
+};
+
+static std::string slice_contents(const getfem::stored_mesh_slice &sl) {
+  std::stringstream s;
+  s.precision(17);
+  sl.write_to_file(s);
+  std::vector<size_type> nbs;
+  sl.nb_simplexes(nbs);
+  s << "points " << sl.nb_points() << " simplexes";
+  for (size_type nb : nbs) s << " " << nb;
+  return s.str();
+}
+
+/* The slices built by the thread safe slicers, in parallel when there is
+   more than one thread, are the slices built serially, with the same
+   numbering of their nodes and simplexes. */
+static void check_parallel_build(const getfem::mesh &m,
+                                 std::vector<getfem::slicer_action *> a,
+                                 size_type nrefine, const std::string &name) {
+  for (getfem::slicer_action *s : a)
+    GMM_ASSERT1(s->thread_safe(), name << " : slicer is not thread safe");
+  serial_slicer sa(*a[0]);
+  a.resize(3, 0);
+  getfem::stored_mesh_slice sl, sl_ref;
+  sl.build(m, a[0], a[1], a[2], nrefine);
+  sl_ref.build(m, &sa, a[1], a[2], nrefine);
+  GMM_ASSERT1(sl.nb_convex() > 0, name << " : empty slice");
+  GMM_ASSERT1(slice_contents(sl) == slice_contents(sl_ref),
+              name << " : the parallel and serial slices differ");
+  cout << name << " : " << sl.nb_convex() << " convexes, " << sl.nb_points()
+       << " points, same slices" << endl;
+}
+
+static void test_parallel_build(size_type N) {
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(N, N == 2 ? 10 : 4),
+                            bgeot::simplex_geotrans(N, 1), true);
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(2);
+  std::vector<getfem::scalar_type> U(mf.nb_dof());
+  for (size_type i = 0; i < mf.nb_dof(); ++i) {
+    getfem::base_node P = mf.point_of_basic_dof(i);
+    U[i] = P[0] * P[0] + P[N-1];
+  }
+  getfem::mesh_slice_cv_dof_data<std::vector<getfem::scalar_type> >
+    mfU(mf, U);
+
+  getfem::base_node x0(N), n0(N), c(N), x1(N);
+  gmm::fill(c, 0.5); n0[0] = 1.; n0[N-1] = -2.; x0[0] = 0.4;
+  x1 = c; x1[N-1] = 1.;
+  using getfem::slicer_volume;
+  getfem::slicer_half_space half(x0, n0, slicer_volume::VOLIN);
+  getfem::slicer_sphere sphere(c, 0.37, slicer_volume::VOLOUT);
+  getfem::slicer_sphere sphere_bound(c, 0.37, slicer_volume::VOLBOUND);
+  getfem::slicer_cylinder cyl(c, x1, 0.3, slicer_volume::VOLIN);
+  getfem::slicer_isovalues iso(mfU, 0.6, slicer_volume::VOLSPLIT);
+  getfem::slicer_sphere ball(x1, 0.45, slicer_volume::VOLIN);
+  getfem::slicer_union un(half, sphere);
+  // slicer_cylinder is three-dimensional
+  getfem::slicer_intersect inter(N == 3 ? static_cast<getfem::slicer_action &>
+                                 (cyl) : ball, iso);
+  getfem::slicer_complementary comp(inter);
+  getfem::slicer_boundary bound(m);
+  getfem::slicer_explode explode(0.8);
+
+  std::stringstream dim; dim << " in dimension " << N;
+  check_parallel_build(m, {&half}, 1, "half space" + dim.str());
+  check_parallel_build(m, {&sphere}, 3, "sphere" + dim.str());
+  check_parallel_build(m, {&sphere_bound}, 2, "sphere boundary" + dim.str());
+  if (N == 3) check_parallel_build(m, {&cyl}, 2, "cylinder" + dim.str());
+  check_parallel_build(m, {&iso}, 2, "isovalues" + dim.str());
+  check_parallel_build(m, {&un, &explode}, 1, "union" + dim.str());
+  check_parallel_build(m, {&comp, &half, &explode}, 2,
+                       "complementary" + dim.str());
+  check_parallel_build(m, {&bound, &iso}, 1, "boundary" + dim.str());
+}
+
 int 
 main() {
 
@@ -113,5 +197,8 @@ main() {
   cout << sl << endl;
 
   cout << "memory 1: " << sl.memsize() << " bytes\n";
+
+  test_parallel_build(2);
+  test_parallel_build(3);
   return 0;
 }
@@ -0,0 +1,150 @@
+/*===========================================================================
+
+ Copyright (C) 2026 agent.
+
+ This file is a part of GetFEM
+
+ GetFEM  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/* Additions, searches and deletions of static stored objects, done
+   concurrently by all the threads (sequentially without OpenMP). The
+   searches go through the snapshots of the tables, which are rebuilt
+   while objects are added, the deleted objects being marked in them. */
+
+#include "getfem/dal_static_stored_objects.h"
+#include "getfem/getfem_omp.h"
+
+using std::endl; using std::cout; using std::cerr;
+using bgeot::size_type;
+
+namespace {
+  DAL_DOUBLE_KEY(test_key, size_type, size_type);
+
+  struct test_object : public dal::static_stored_object {
+    size_type thread, i;
+    test_object(size_type t, size_type ii) : thread(t), i(ii) {}
+  };
+
+  dal::pstatic_stored_object_key key(size_type t, size_type i)
+  { return std::make_shared<test_key>(t, i); }
+
+  const size_type NB = 3000;
+
+  /* Each object is added then searched, with a former one, an absent one
+     and a deleted one. Every seventh object is deleted. */
+  void fill_thread_table(size_type t, std::vector<int> &errors) {
+    int nb_err = 0;
+    for (size_type i = 0; i < NB; ++i) {
+      auto o = std::make_shared<test_object>(t, i);
+      dal::add_stored_object(key(t, i), o);
+      if (dal::search_stored_object(key(t, i)) != o) ++nb_err;
+      auto o2 = std::dynamic_pointer_cast<const test_object>
+        (dal::search_stored_object(key(t, i / 2)));
+      if ((i / 2) % 7 == 6) {
+        if (o2) ++nb_err;
+      } else if (!o2 || o2->thread != t || o2->i != i / 2) ++nb_err;
+      if (dal::search_stored_object(key(t, i + 1))) ++nb_err;
+      if (i % 7 == 6) {
+        dal::del_stored_object(o);
+        if (dal::search_stored_object(key(t, i))) ++nb_err;
+      }
+    }
+    errors[t] += nb_err;
+  }
+
+  /* Deletions one by one, marking the objects dead in the snapshot: the
+     deleted objects are not found, and stored again under the same keys,
+     the new objects are found. The deleted objects are released once the
+     snapshot is rebuilt. */
+  void test_deletions() {
+    std::vector<dal::pstatic_stored_object> objs;
+    for (size_type i = 0; i < NB; ++i) {
+      objs.push_back(std::make_shared<test_object>(size_type(-1), i));
+      dal::add_stored_object(key(size_type(-1), i), objs.back());
+    }
+    for (size_type i = 0; i < NB; ++i)
+      GMM_ASSERT1(dal::search_stored_object(key(size_type(-1), i)) == objs[i],
+                  "Object not found");
+    std::vector<std::weak_ptr<const dal::static_stored_object>> deleted;
+    for (size_type i = 0; i < NB; i += 2) {
+      dal::del_stored_object(objs[i]);
+      deleted.push_back(objs[i]);
+      objs[i].reset();
+      GMM_ASSERT1(!dal::search_stored_object(key(size_type(-1), i)),
+                  "Deleted object found");
+      GMM_ASSERT1(dal::search_stored_object(key(size_type(-1), i+1))
+                  == objs[i+1], "Object not found after a deletion");
+    }
+    for (size_type i = 0; i < NB; i += 2) {
+      objs[i] = std::make_shared<test_object>(size_type(-1), i);
+      dal::add_stored_object(key(size_type(-1), i), objs[i]);
+    }
+    std::list<dal::pstatic_stored_object> to_delete;
+    for (size_type i = 0; i < NB; ++i) {
+      GMM_ASSERT1(dal::search_stored_object(key(size_type(-1), i)) == objs[i],
+                  "Object stored again not found");
+      to_delete.push_back(objs[i]);
+      deleted.push_back(objs[i]);
+    }
+    dal::del_stored_objects(to_delete, false);
+    to_delete.clear(); objs.clear();
+    // Released by the snapshot, rebuilt after this batch of deletions.
+    for (const auto &w : deleted)
+      GMM_ASSERT1(w.expired(), "Deleted object kept alive");
+  }
+}
+
+int main(void) {
+  size_type nb_threads = getfem::true_thread_policy::num_threads();
+  size_type nb0 = dal::nb_stored_objects();
+  std::vector<int> errors(nb_threads, 0);
+
+  GETFEM_OMP_PARALLEL_NO_PARTITION(
+    fill_thread_table(getfem::true_thread_policy::this_thread(), errors);
+  )
+  for (size_type t = 0; t < nb_threads; ++t)
+    GMM_ASSERT1(errors[t] == 0, errors[t] << " wrong searches on thread "
+                << t);
+
+  size_type nb_deleted = NB / 7;
+  GMM_ASSERT1(dal::nb_stored_objects() == nb0 + nb_threads*(NB-nb_deleted),
+              "Wrong number of stored objects");
+
+  // The objects of all the threads are found from any thread.
+  std::list<dal::pstatic_stored_object> to_delete;
+  for (size_type t = 0; t < nb_threads; ++t)
+    for (size_type i = 0; i < NB; ++i) {
+      auto o = std::dynamic_pointer_cast<const test_object>
+        (dal::search_stored_object_on_all_threads(key(t, i)));
+      if (i % 7 == 6) {
+        GMM_ASSERT1(!o, "Deleted object found");
+      } else {
+        GMM_ASSERT1(o && o->thread == t && o->i == i, "Object not found");
+        to_delete.push_back(o);
+      }
+    }
+  dal::del_stored_objects(to_delete, false);
+  GMM_ASSERT1(dal::nb_stored_objects() == nb0, "Objects not deleted");
+  for (size_type t = 0; t < nb_threads; ++t)
+    GMM_ASSERT1(!dal::search_stored_object_on_all_threads(key(t, 0)),
+                "Deleted object found");
+  test_deletions();
+  GMM_ASSERT1(dal::nb_stored_objects() == nb0, "Objects not deleted");
+  dal::test_stored_objects();
+
+  cout << "stored objects are ok on " << nb_threads << " thread(s)\n";
+  return 0;
+}